@@ -4,6 +4,7 @@
 */
 
 #include "CurvatureFlow.h"
+#include "circulator.h"
 
 #include <boost/numeric/ublas/matrix_sparse.hpp>
 #include <boost/numeric/ublas/vector.hpp>
@@ -123,28 +124,26 @@ boost::numeric::ublas::compressed_matrix<double> CurvatureFlow::calc_curvature_o
 	for(size_t i = 0; i < input_mesh.num_vertices(); i++)
 	{
 		vertex* v = input_mesh.get_vertex(i);
-		std::vector<const vertex*> neighbours = v->get_neighbours();
 
-		// FIXME: Used to update the correct matrix entries
-		// below. This assumes that the IDs have been allocated
-		// sequentially.
-		size_t cur_id = v->get_id();
+		// Rows and columns of the matrix correspond to the slots
+		// of the vertices, which are always dense
+		size_t cur_slot = v->get_slot();
 
 		// Find "opposing angles" for all neighbours; these are
 		// the $\alpha_{ij}$ and $\beta_{ij}$ values used for
 		// calculating the discrete curvature
 
-		for(size_t j = 0; j < neighbours.size(); j++)
+		for(vertex_edge_circulator it(v); it.valid(); it.next())
 		{
-			std::pair<double, double> angles = v->find_opposite_angles(neighbours[j]);
+			std::pair<double, double> angles = v->find_opposite_angles(it.get_edge());
 			if(angles.first >= 0.0 && angles.second >= 0.0)
 			{
 				// calculate contribution to matrix entries
 
 				double contribution = 1.0/tan(angles.first) + 1.0/tan(angles.second);
 
-				K(cur_id, cur_id)			+= contribution;
-				K(cur_id, neighbours[j]->get_id())	-= contribution;
+				K(cur_slot, cur_slot)				+= contribution;
+				K(cur_slot, it.get_vertex()->get_slot())	-= contribution;
 			}
 		}
 	}
@@ -5,6 +5,7 @@
 
 #include <list>
 #include "PlanarSegmentation.h"
+#include "circulator.h"
 
 namespace psalm
 {
@@ -13,32 +14,37 @@ namespace psalm
 *	Performs a planar segmentation to the input mesh: Planar vertices are
 *	identified by calculating the discrete mean curvature of a vertex. If
 *	all planar vertices have been identified, edges leading to planar
-*	vertices will be inserted into a new, which is returned as the
-*	function's result.
+*	vertices will be inserted into a new mesh.
 *
 *	@param	input_mesh Mesh for which the planar segmentation shall be
 *		performed
 *
-*	@return	Segmented mesh
+*	@param	output_mesh Segmented mesh. Since mesh elements are owned by
+*		the mesh that created them, the result cannot be returned by
+*		value.
+*
+*	@return	true if the segmentation could be performed, else false
 */
 
-mesh PlanarSegmentation::apply_to(mesh& input_mesh)
+bool PlanarSegmentation::apply_to(mesh& input_mesh, mesh& output_mesh)
 {
-	mesh res;
+	mesh& res = output_mesh;
 
 	this->label_planar_vertices(input_mesh);
 	this->label_nonplanar_faces(input_mesh);
 	this->label_regions(input_mesh);
 
+	const property<size_t>& region = *input_mesh.get_vertex_property<size_t>("region");
+
 	size_t cur_region = 0;
 	size_t written = 0;
 	do
 	{
 		for(size_t i = 0; i < input_mesh.num_vertices(); i++)
 		{
-			if(input_mesh.get_vertex(i)->region != std::numeric_limits<size_t>::max())
+			if(region[i] != std::numeric_limits<size_t>::max())
 			{
-				if(input_mesh.get_vertex(i)->region == cur_region)
+				if(region[i] == cur_region)
 				{
 					written++;
 					std::cout << input_mesh.get_vertex(i)->get_position();
@@ -59,15 +65,10 @@ mesh PlanarSegmentation::apply_to(mesh& input_mesh)
 	}
 	while(true);
 
-	return(res);
-
-	/*
-	*	FIXME: This assumes that the vertex IDs are numbered
-	*	sequentially. If this is not the case, the function will
-	*	fail...
-	*/
+	return(true);
 
-	// Identify planar vertices
+	// Identify planar vertices; the array is indexed by the slots of
+	// the vertices
 
 	size_t n = input_mesh.num_vertices();
 	bool* is_planar = new bool[n];
@@ -90,7 +91,7 @@ mesh PlanarSegmentation::apply_to(mesh& input_mesh)
 		size_t non_planar = 0;
 		for(size_t j = 0; j < f->num_vertices(); j++)
 		{
-			if(!is_planar[f->get_vertex(j)->get_id()])
+			if(!is_planar[f->get_vertex(j)->get_slot()])
 				non_planar++;
 		}
 
@@ -105,7 +106,7 @@ mesh PlanarSegmentation::apply_to(mesh& input_mesh)
 	}
 
 	delete[] is_planar;
-	return(res);
+	return(true);
 }
 
 /*!
@@ -172,13 +173,16 @@ void PlanarSegmentation::label_nonplanar_faces(mesh& input_mesh)
 
 void PlanarSegmentation::label_regions(mesh& input_mesh)
 {
+	// Vertices without a region are labelled with the largest value
+	property<size_t>& region = input_mesh.add_vertex_property<size_t>("region", std::numeric_limits<size_t>::max());
+
 	size_t cur_region = 0;
 	while(nonplanar_vertices.size() > 0)
 	{
 		std::list<vertex*> unprocessed_vertices;
 
 		vertex* v = nonplanar_vertices.front();
-		if(v->region != std::numeric_limits<size_t>::max())
+		if(region[v->get_slot()] != std::numeric_limits<size_t>::max())
 		{
 			nonplanar_vertices.erase(nonplanar_vertices.begin());
 			continue;
@@ -188,11 +192,10 @@ void PlanarSegmentation::label_regions(mesh& input_mesh)
 		while(unprocessed_vertices.size() > 0)
 		{
 			vertex* v = unprocessed_vertices.front();
-			v->region = cur_region;
-			std::vector<const vertex*> neighbours = v->get_neighbours();
-			for(size_t i = 0; i < neighbours.size(); i++)
+			region[v->get_slot()] = cur_region;
+			for(vertex_edge_circulator it(v); it.valid(); it.next())
 			{
-				vertex* w = const_cast<vertex*>(neighbours[i]);
+				vertex* w = const_cast<vertex*>(it.get_vertex());
 
 				// TODO: Optimize
 				if(std::find(planar_vertices.begin(), planar_vertices.end(), w) != planar_vertices.end())
@@ -202,9 +205,9 @@ void PlanarSegmentation::label_regions(mesh& input_mesh)
 					continue;
 				}
 
-				if(w->region == std::numeric_limits<size_t>::max())
+				if(region[w->get_slot()] == std::numeric_limits<size_t>::max())
 				{
-					w->region = cur_region;
+					region[w->get_slot()] = cur_region;
 					unprocessed_vertices.push_back(w);
 				}
 			}
@@ -233,9 +236,9 @@ void PlanarSegmentation::label_regions(mesh& input_mesh)
 			}
 
 			// Check if vertex has been visited already
-			if(v->region == std::numeric_limits<size_t>::max())
+			if(region[v->get_slot()] == std::numeric_limits<size_t>::max())
 			{
-				v->region = cur_region;
+				region[v->get_slot()] = cur_region;
 				unprocessed_vertices.push_back(v);
 			}
 		}
@@ -245,10 +248,9 @@ void PlanarSegmentation::label_regions(mesh& input_mesh)
 		while(unprocessed_vertices.size() > 0)
 		{
 			vertex* v = unprocessed_vertices.front();
-			std::vector<const vertex*> neighbours = v->get_neighbours();
-			for(size_t i = 0; i < neighbours.size(); i++)
+			for(vertex_edge_circulator it(v); it.valid(); it.next())
 			{
-				vertex* w = const_cast<vertex*>(neighbours[i]);
+				vertex* w = const_cast<vertex*>(it.get_vertex());
 
 				// TODO: Optimize
 				if(std::find(planar_vertices.begin(), planar_vertices.end(), w) != planar_vertices.end())
@@ -258,9 +260,9 @@ void PlanarSegmentation::label_regions(mesh& input_mesh)
 					continue;
 				}
 
-				if(w->region == std::numeric_limits<size_t>::max())
+				if(region[w->get_slot()] == std::numeric_limits<size_t>::max())
 				{
-					w->region = cur_region;
+					region[w->get_slot()] = cur_region;
 					unprocessed_vertices.push_back(w);
 				}
 			}
@@ -20,7 +20,7 @@ namespace psalm
 class PlanarSegmentation : public SegmentationAlgorithm
 {
 	public:
-		mesh apply_to(mesh& input_mesh);
+		bool apply_to(mesh& input_mesh, mesh& output_mesh);
 	
 	private:
 		void label_planar_vertices(mesh& input_mesh);
@@ -21,7 +21,7 @@ class SegmentationAlgorithm
 	public:
 		SegmentationAlgorithm();
 
-		virtual mesh apply_to(mesh& input_mesh) = 0;
+		virtual bool apply_to(mesh& input_mesh, mesh& output_mesh) = 0;
 };
 
 } // end of namespace "psalm"
@@ -3,7 +3,11 @@
 *	@brief	Implementation of Catmull and Clark's subdivision scheme
 */
 
+#include <algorithm>
+
 #include "CatmullClark.h"
+#include "circulator.h"
+#include "v3ctor_kernels.h"
 
 namespace psalm
 {
@@ -14,7 +18,19 @@ namespace psalm
 
 CatmullClark::CatmullClark()
 {
-	weight_function = weights_catmull_clark;
+	weight_function		= weights_catmull_clark;
+	non_quadrangular_face	= false;
+}
+
+/*!
+*	Forgets about non-quadrangular faces of the previous mesh. Within a
+*	series of subdivision steps, the flag is kept: Once a mesh contained
+*	such faces, all vertex points are created geometrically.
+*/
+
+void CatmullClark::reset_state()
+{
+	non_quadrangular_face = false;
 }
 
 /*!
@@ -50,67 +66,194 @@ bool CatmullClark::set_weights(weights new_weights)
 
 /*!
 *	Applies Catmull and Clark's subdivision algorithm to the given mesh.
-*	The mesh will be irreversibly _changed_ by this function.
 *
-*	@param	input_mesh Mesh on which the algorithm is applied
+*	@param	input_mesh	Mesh on which the algorithm is applied; will not
+*				be modified
+*	@param	output		Sink that receives the subdivided mesh
+*
 *	@return	true on success, else false
 */
 
-bool CatmullClark::apply_to(mesh& input_mesh)
+bool CatmullClark::apply_to(const mesh& input_mesh, mesh_sink& output)
 {
-	mesh output_mesh;
+	// Points are stored per slot of the input mesh, so a mesh with empty
+	// slots of removed elements is subdivided via a compact copy
+	if(!input_mesh.is_compact())
+	{
+		mesh compact_mesh;
+		input_mesh.clone(compact_mesh);
+
+		return(apply_to(static_cast<const mesh&>(compact_mesh), output));
+	}
 
-	create_face_points(input_mesh, output_mesh);
-	create_edge_points(input_mesh, output_mesh);
+	output.reserve(	input_mesh.num_vertices()+input_mesh.num_edges()+input_mesh.num_faces(),
+				2*input_mesh.num_edges());
+
+	reset_points(input_mesh);
+	discarded_vertices.assign(input_mesh.num_vertices(), false);
+
+	create_face_points(input_mesh, output);
+	create_edge_points(input_mesh, output);
 
 	if(non_quadrangular_face || use_geometric_point_creation)
-		create_vertex_points_geometrically(input_mesh, output_mesh);
+		create_vertex_points_geometrically(input_mesh, output);
 	else
-		create_vertex_points_parametrically(input_mesh, output_mesh);
+		create_vertex_points_parametrically(input_mesh, output);
 
 	/*
 		Create new topology of the mesh by connecting
 
 			vertex -- edge -- face -- edge
 
-		points.
+		points. If points are missing, e.g. at the boundary of
+		the mesh, every vertex needs to be checked separately.
 	*/
 
+	if(!create_topology(input_mesh, output))
+		create_topology_by_vertices(input_mesh, output);
+
+	return(true);
+}
+
+/*!
+*	Creates the new faces of the mesh directly from the faces of the input
+*	mesh. For every corner of a face, a quadrangle is created, i.e. n
+*	quadrangles per n-gon. Since the edges of the new faces follow from the
+*	edges and corners of the input mesh, they are numbered by index
+*	arithmetic and passed to the sink, which thus does not need to search
+*	for any edges:
+*
+*		- Every edge of the input mesh is split into two edges, which
+*		  are numbered 2*slot and 2*slot+1 for the halves at its first
+*		  and second vertex.
+*
+*		- Every corner of a face creates an edge from the edge point of
+*		  its edge to the face point, which is numbered by the index of
+*		  the corner, starting after the split edges.
+*
+*	This requires a vertex point for every vertex of a face and an edge
+*	point for every edge.
+*
+*	@param input_mesh	Original input mesh, will not be modified
+*	@param output		Sink that receives the new faces
+*
+*	@return false if points are missing and no faces have been created,
+*	else true
+*/
+
+bool CatmullClark::create_topology(const mesh& input_mesh, mesh_sink& output)
+{
+	size_t num_faces = input_mesh.num_faces();
+	size_t num_edges = input_mesh.num_edges();
+
+	for(size_t i = 0; i < num_edges; i++)
+	{
+		if(edge_points[i] == mesh_sink::NO_VERTEX)
+			return(false);
+	}
+
+	// Offsets of the corners of every face; the new faces are numbered
+	// like the corners
+	std::vector<size_t> corner_offsets(num_faces+1, 0);
+	for(size_t i = 0; i < num_faces; i++)
+	{
+		const face* f = input_mesh.get_face(i);
+		for(size_t j = 0; j < f->num_vertices(); j++)
+		{
+			if(vertex_points[f->get_vertex(j)->get_slot()] == mesh_sink::NO_VERTEX)
+				return(false);
+		}
+
+		corner_offsets[i+1] = corner_offsets[i] + f->num_vertices();
+	}
+
+	size_t num_corners = corner_offsets.back();
+
+	// The new mesh has 4*num_corners corners, and mesh::build_topology()
+	// requires every edge number to be less than this. The largest number
+	// is that of the last corner edge, 2*num_edges + num_corners-1, which
+	// yields 2*num_edges <= 3*num_corners. Every edge with an adjacent face
+	// has at least one corner, so this only fails for meshes with edges
+	// that belong to no face. These meshes, as well as meshes without
+	// faces, are handled by create_topology_by_vertices().
+	if(num_corners == 0 || 2*num_edges > 3*num_corners)
+		return(false);
+
+	std::vector<size_t> face_offsets(num_corners+1);
+	std::vector<size_t> face_indices(4*num_corners);
+	std::vector<size_t> corner_edges(4*num_corners);
+
+	#pragma omp parallel for schedule(static)
+	for(long i = 0; i < static_cast<long>(num_faces); i++)
+	{
+		const face* f	= input_mesh.get_face(i);
+		size_t m	= f->num_vertices();
+		size_t offset	= corner_offsets[i];
+
+		for(size_t j = 0; j < m; j++)
+		{
+			size_t k = (j+m-1) % m;	// previous corner
+
+			const vertex* v	= f->get_vertex(j);
+			const edge* e1	= f->get_edge(j).e;	// from v to the next vertex
+			const edge* e2	= f->get_edge(k).e;	// from the previous vertex to v
+
+			size_t c = 4*(offset+j);
+
+			face_offsets[offset+j]	= c;
+
+			face_indices[c]		= vertex_points[v->get_slot()];
+			face_indices[c+1]	= edge_points[e1->get_slot()];
+			face_indices[c+2]	= face_points[i];
+			face_indices[c+3]	= edge_points[e2->get_slot()];
+
+			corner_edges[c]		= 2*e1->get_slot() + (e1->get_u() == v ? 0 : 1);
+			corner_edges[c+1]	= 2*num_edges + offset+j;
+			corner_edges[c+2]	= 2*num_edges + offset+k;
+			corner_edges[c+3]	= 2*e2->get_slot() + (e2->get_u() == v ? 0 : 1);
+		}
+	}
+
+	face_offsets[num_corners] = 4*num_corners;
+
+	output.add_faces(face_offsets, face_indices, corner_edges);
+	print_progress("Creating topology", 1, 1);
+
+	return(true);
+}
+
+/*!
+*	Creates the new faces of the mesh by visiting the faces around every
+*	vertex of the input mesh. Missing edge points are handled according to
+*	the boundary preservation flag.
+*
+*	@param input_mesh	Original input mesh, will not be modified
+*	@param output		Sink that receives the new faces
+*/
+
+void CatmullClark::create_topology_by_vertices(const mesh& input_mesh, mesh_sink& output)
+{
 	for(size_t i = 0; i < input_mesh.num_vertices(); i++)
 	{
 		print_progress("Creating topology",
 				i,
 				input_mesh.num_vertices()-1);
 
-		vertex* v = input_mesh.get_vertex(i);
+		const vertex* v		= input_mesh.get_vertex(i);
+		size_t vertex_point	= vertex_points[i];
 
-		if(v->vertex_point == NULL)
+		if(vertex_point == mesh_sink::NO_VERTEX)
 			continue; // ignore degenerate vertices
 
-		for(size_t j = 0; j < v->num_adjacent_faces(); j++)
+		for(vertex_face_circulator it(v); it.valid(); it.next())
 		{
-			const face* f = v->get_face(j);
+			const face* f = it.get_face();
 
-			// Find the two incident edges of the current vertex
-			// that are also part of the current adjacent face
+			// The two incident edges of the current vertex that
+			// are also part of the current adjacent face
 
-			const edge* e1 = NULL;
-			const edge* e2 = NULL;
-
-			for(size_t k = 0; k < v->valency(); k++)
-			{
-				const edge* e = v->get_edge(k);
-				if(e->get_f() == f || e->get_g() == f)
-				{
-					if(e1 == NULL)
-						e1 = e;
-					else
-					{
-						e2 = e;
-						break;
-					}
-				}
-			}
+			const edge* e1 = it.get_edge();
+			const edge* e2 = it.get_next_edge();
 
 			// For non-manifold meshes, we may not be able to find
 			// adjacent faces for every combination of vertices and
@@ -119,67 +262,62 @@ bool CatmullClark::apply_to(mesh& input_mesh)
 				e2 == NULL)
 				continue;
 
+			size_t face_point	= face_points[f->get_slot()];
+			size_t edge_point1	= edge_points[e1->get_slot()];
+			size_t edge_point2	= edge_points[e2->get_slot()];
+
 			// If crease handling is not enabled, we may not have
 			// edge points everywhere. These faces need to be
 			// skipped, of course.
-			if(	e1->edge_point == NULL ||
-				e2->edge_point == NULL)
+			if(	edge_point1 == mesh_sink::NO_VERTEX ||
+				edge_point2 == mesh_sink::NO_VERTEX)
 			{
 				if(preserve_boundaries)
 				{
 					bool u1 = (e1->get_u() == v);
 					bool u2 = (e2->get_u() == v);
 
-					vertex* v10;
-					vertex* v11;
-					vertex* v20;
-					vertex* v21;
+					size_t v10;
+					size_t v11;
+					size_t v20;
+					size_t v21;
 
-					if(e1->edge_point == NULL && e2->edge_point == NULL)
+					if(edge_point1 == mesh_sink::NO_VERTEX && edge_point2 == mesh_sink::NO_VERTEX)
 					{
-						v10 = output_mesh.add_vertex(e1->get_u()->get_position());
-						v11 = output_mesh.add_vertex(e1->get_v()->get_position());
-						v20 = output_mesh.add_vertex(e2->get_u()->get_position());
-						v21 = output_mesh.add_vertex(e2->get_v()->get_position());
-
-						v10->set_on_boundary();
-						v11->set_on_boundary();
-						v20->set_on_boundary();
-						v21->set_on_boundary();
-
-						output_mesh.add_face(v10, f->face_point, v11);
-						output_mesh.add_face(v20, f->face_point, v21);
+						v10 = output.add_vertex(e1->get_u()->get_position(), true);
+						v11 = output.add_vertex(e1->get_v()->get_position(), true);
+						v20 = output.add_vertex(e2->get_u()->get_position(), true);
+						v21 = output.add_vertex(e2->get_v()->get_position(), true);
+
+						output.add_face(v10, face_point, v11);
+						output.add_face(v20, face_point, v21);
 					}
-					else if(e1->edge_point != NULL)
+					else if(edge_point1 != mesh_sink::NO_VERTEX)
 					{
-						output_mesh.add_face(v->vertex_point, f->face_point, e1->edge_point);
+						output.add_face(vertex_point, face_point, edge_point1);
 						if(u2)
 						{
-							v20 = output_mesh.add_vertex(e2->get_v()->get_position());
-							v20->set_on_boundary();
-							output_mesh.add_face(v->vertex_point, f->face_point, v20);
+							v20 = output.add_vertex(e2->get_v()->get_position(), true);
+							output.add_face(vertex_point, face_point, v20);
 						}
 						else
 						{
-							v20 = output_mesh.add_vertex(e2->get_u()->get_position());
-							v20->set_on_boundary();
-							output_mesh.add_face(v->vertex_point, f->face_point, v20);
+							v20 = output.add_vertex(e2->get_u()->get_position(), true);
+							output.add_face(vertex_point, face_point, v20);
 						}
 					}
 					else
 					{
-						output_mesh.add_face(v->vertex_point, f->face_point, e2->edge_point);
+						output.add_face(vertex_point, face_point, edge_point2);
 						if(u1)
 						{
-							v10 = output_mesh.add_vertex(e1->get_v()->get_position());
-							v10->set_on_boundary();
-							output_mesh.add_face(v->vertex_point, f->face_point, v10);
+							v10 = output.add_vertex(e1->get_v()->get_position(), true);
+							output.add_face(vertex_point, face_point, v10);
 						}
 						else
 						{
-							v10 = output_mesh.add_vertex(e1->get_u()->get_position());
-							v10->set_on_boundary();
-							output_mesh.add_face(v->vertex_point, f->face_point, v10);
+							v10 = output.add_vertex(e1->get_u()->get_position(), true);
+							output.add_face(vertex_point, face_point, v10);
 						}
 					}
 
@@ -192,26 +330,47 @@ bool CatmullClark::apply_to(mesh& input_mesh)
 			/*
 				Check which edge needs to be used first in
 				order to orient the new face properly. The
-				rationale behind this is to ensure that e1 is
-				the _first_ edge that needs to be visited in
-				order to get CCW orientation.
+				rationale behind this is to ensure that the
+				edge point of the _first_ edge that needs to be
+				visited in order to get CCW orientation is used
+				first.
 			*/
 
-			if(	(e1->get_u()->get_id() == v->get_id() && e1->get_g() == f) ||
-				(e1->get_v()->get_id() == v->get_id() && e1->get_f() == f) ||
-				(e2->get_u()->get_id() == v->get_id() && e2->get_f() == f) ||
-				(e2->get_v()->get_id() == v->get_id() && e2->get_g() == f))
-				std::swap(e1, e2);
+			if(	(e1->get_u() == v && e1->get_g() == f) ||
+				(e1->get_v() == v && e1->get_f() == f) ||
+				(e2->get_u() == v && e2->get_f() == f) ||
+				(e2->get_v() == v && e2->get_g() == f))
+				std::swap(edge_point1, edge_point2);
 
-			output_mesh.add_face(	v->vertex_point,
-						e1->edge_point,
-						f->face_point,
-						e2->edge_point);
+			output.add_face(vertex_point,
+					edge_point1,
+					face_point,
+					edge_point2);
 		}
 	}
+}
 
-	input_mesh.replace_with(output_mesh);
-	return(true);
+/*!
+*	Adds the points of the current phase to the output. The points are
+*	added in the order of the slots of their elements.
+*
+*	@param output	Sink that receives the new vertex points
+*	@param indices	Indices of the new points in the output; elements
+*			without a point are left unchanged
+*	@param message	Message for the progress bar
+*/
+
+void CatmullClark::add_points(mesh_sink& output, std::vector<size_t>& indices, const std::string& message)
+{
+	for(size_t i = 0; i < indices.size(); i++)
+	{
+		print_progress(message, i, indices.size()-1);
+
+		if(point_types[i] == INTERIOR_POINT)
+			indices[i] = output.add_vertex(points[i]);
+		else if(point_types[i] == BOUNDARY_POINT)
+			indices[i] = output.add_vertex(points[i], true);
+	}
 }
 
 /*!
@@ -219,30 +378,37 @@ bool CatmullClark::apply_to(mesh& input_mesh)
 *	new mesh.
 *
 *	@param input_mesh	Original input mesh, will not be modified
-*	@param output_mesh	Mesh that will contain the new vertex points
+*	@param output		Sink that receives the new vertex points
 */
 
-void CatmullClark::create_face_points(mesh& input_mesh, mesh& output_mesh)
+void CatmullClark::create_face_points(const mesh& input_mesh, mesh_sink& output)
 {
-	for(size_t i = 0; i < input_mesh.num_faces(); i++)
-	{
-		print_progress("Creating face points",
-				i,
-				input_mesh.num_faces()-1);
+	long num_faces = static_cast<long>(input_mesh.num_faces());
 
-		face* f = input_mesh.get_face(i);
+	points.resize(num_faces);
+	point_types.assign(num_faces, INTERIOR_POINT);
 
-		v3ctor centroid;
-		for(size_t j = 0; j < f->num_vertices(); j++)
-			centroid += f->get_vertex(j)->get_position();
+	bool non_quadrangular = false;
+
+	#pragma omp parallel for schedule(static) reduction(||:non_quadrangular)
+	for(long i = 0; i < num_faces; i++)
+	{
+		const face* f = input_mesh.get_face(i);
 
-		centroid /= f->num_vertices();
+		small_vector<const v3ctor*, 4> P;
+		for(size_t j = 0; j < f->num_vertices(); j++)
+			P.push_back(&f->get_vertex(j)->get_position());
 
-		f->face_point = output_mesh.add_vertex(centroid);
+		points[i] = calc_centroid(&P[0], P.size());
 
-		if(!non_quadrangular_face && f->num_vertices() != 4)
-			non_quadrangular_face = true;
+		if(f->num_vertices() != 4)
+			non_quadrangular = true;
 	}
+
+	if(non_quadrangular)
+		non_quadrangular_face = true;
+
+	add_points(output, face_points, "Creating face points");
 }
 
 /*!
@@ -250,31 +416,33 @@ void CatmullClark::create_face_points(mesh& input_mesh, mesh& output_mesh)
 *	new mesh.
 *
 *	@param input_mesh	Original input mesh, will not be modified
-*	@param output_mesh	Mesh that will contain the new vertex points
+*	@param output		Sink that receives the new vertex points
 */
 
-void CatmullClark::create_edge_points(mesh& input_mesh, mesh& output_mesh)
+void CatmullClark::create_edge_points(const mesh& input_mesh, mesh_sink& output)
 {
-	for(size_t i = 0; i < input_mesh.num_edges(); i++)
-	{
-		print_progress("Creating edge points",
-				i,
-				input_mesh.num_edges()-1);
+	long num_edges = static_cast<long>(input_mesh.num_edges());
 
-		edge* e = input_mesh.get_edge(i);
-		v3ctor edge_point;
+	points.resize(num_edges);
+	point_types.assign(num_edges, NO_POINT);
+
+	// Only the face points have been added to the output so far, so
+	// their positions may be read concurrently
+	#pragma omp parallel for schedule(static)
+	for(long i = 0; i < num_edges; i++)
+	{
+		const edge* e = input_mesh.get_edge(i);
 
 		// Border/crease edge: Use midpoint of edge for the edge point
 		// if crease handling is enabled
 		if(e->get_g() == NULL)
 		{
-			e->edge_point = NULL;
 			if(handle_creases && !e->get_u()->is_on_boundary() && !e->get_v()->is_on_boundary())
 			{
-				edge_point = (	e->get_u()->get_position()+
+				points[i] = (	e->get_u()->get_position()+
 						e->get_v()->get_position())*0.5;
 
-				e->edge_point = output_mesh.add_vertex(edge_point);
+				point_types[i] = INTERIOR_POINT;
 			}
 
 			// Preserve the original boundaries of the object
@@ -282,36 +450,47 @@ void CatmullClark::create_edge_points(mesh& input_mesh, mesh& output_mesh)
 			// FIXME: else if(preserve_boundaries && e->get_u()->is_on_boundary() && e->get_v()->is_on_boundary())
 			{
 				/*
-				edge_point = (	e->get_u()->get_position()+
+				points[i] = (	e->get_u()->get_position()+
 						e->get_v()->get_position())*0.5;
 
-				e->edge_point = M.add_vertex(edge_point);
-				e->edge_point->set_on_boundary();
+				point_types[i] = BOUNDARY_POINT;
 				*/
-
-				e->edge_point = NULL;
 			}
 			else
 			{
-				// Remove start and end vertex of edge; we will
+				// Discard start and end vertex of edge; we will
 				// not be able to connect them correctly.
 
-				input_mesh.remove_vertex(e->get_u()); // FIXME: This leads to problems later on...
-				input_mesh.remove_vertex(e->get_v());
+				point_types[i] = DISCARDED_EDGE;
 			}
 		}
 
 		// Normal edge
 		else
 		{
-			edge_point = (	e->get_u()->get_position()+
+			points[i] = (	e->get_u()->get_position()+
 					e->get_v()->get_position()+
-					e->get_f()->face_point->get_position()+
-					e->get_g()->face_point->get_position())*0.25;
+					output.get_position(face_points[e->get_f()->get_slot()])+
+					output.get_position(face_points[e->get_g()->get_slot()]))*0.25;
 
-			e->edge_point = output_mesh.add_vertex(edge_point);
+			point_types[i] = INTERIOR_POINT;
 		}
 	}
+
+	// Several edges may discard the same vertex, so this is not done
+	// in parallel
+	for(long i = 0; i < num_edges; i++)
+	{
+		if(point_types[i] == DISCARDED_EDGE)
+		{
+			const edge* e = input_mesh.get_edge(i);
+
+			discarded_vertices[e->get_u()->get_slot()] = true;
+			discarded_vertices[e->get_v()->get_slot()] = true;
+		}
+	}
+
+	add_points(output, edge_points, "Creating edge points");
 }
 
 /*!
@@ -319,24 +498,29 @@ void CatmullClark::create_edge_points(mesh& input_mesh, mesh& output_mesh)
 *	stores them in the new mesh.
 *
 *	@param input_mesh	Original input mesh, will not be modified
-*	@param output_mesh	Mesh that will contain the new vertex points
+*	@param output		Sink that receives the new vertex points
 */
 
-void CatmullClark::create_vertex_points_parametrically(mesh& input_mesh, mesh& output_mesh)
+void CatmullClark::create_vertex_points_parametrically(const mesh& input_mesh, mesh_sink& output)
 {
-	for(size_t i = 0; i < input_mesh.num_vertices(); i++)
+	long num_vertices = static_cast<long>(input_mesh.num_vertices());
+
+	points.resize(num_vertices);
+	point_types.assign(num_vertices, NO_POINT);
+
+	#pragma omp parallel for schedule(dynamic, 1024)
+	for(long i = 0; i < num_vertices; i++)
 	{
-		print_progress("Creating vertex points [parametrically]",
-				i,
-				input_mesh.num_vertices()-1);
+		if(discarded_vertices[i])
+			continue;
 
-		vertex* v = input_mesh.get_vertex(i);
+		const vertex* v = input_mesh.get_vertex(i);
 
 		// Keep boundary vertices if the user chose this behaviour
 		if(preserve_boundaries && v->is_on_boundary())
 		{
-			v->vertex_point = output_mesh.add_vertex(v->get_position());
-			v->vertex_point->set_on_boundary();
+			points[i]	= v->get_position();
+			point_types[i]	= BOUNDARY_POINT;
 			continue;
 		}
 
@@ -346,59 +530,17 @@ void CatmullClark::create_vertex_points_parametrically(mesh& input_mesh, mesh& o
 		if(n < 3)
 			continue; // ignore degenerate vertices
 
-		double gamma	= 0.0;
-		double beta	= 0.0;
-		double alpha	= 0.0;
-
-		if(n == 4 && use_bspline_weights)
-		{
-			gamma	= 1.0/16.0;
-			beta	= 3.0/8.0;
-			alpha	= 9.0/16.0;
-		}
-		else
-		{
-			std::pair<double, double> weights = weight_function(n);
+		double alpha;
+		double beta;
+		double gamma;
 
-			gamma	= weights.second;
-			beta	= weights.first;
-			alpha	= 1.0-beta-gamma;
-		}
+		get_vertex_weights(n, alpha, beta, gamma);
 
-		// sets of vertices with weights beta and gamma
-		std::set<const vertex*> vertices_beta;
-		std::set<const vertex*> vertices_gamma;
+		// vertices with weights beta and gamma
+		neighbour_list vertices_beta;
+		neighbour_list vertices_gamma;
 
-		// All vertices that are connected via an edge with the current
-		// vertex will be assigned the weight beta.
-		for(size_t j = 0; j < n; j++)
-		{
-			edge* e = v->get_edge(j);
-			if(e->get_u()->get_id() != v->get_id())
-				vertices_beta.insert(e->get_u());
-			else
-				vertices_beta.insert(e->get_v());
-		}
-
-		// All remaining vertices of all adjacent faces to the current
-		// vertex will be assigned the weight gamma.
-		for(size_t j = 0; j < n; j++)
-		{
-			const face* f = v->get_face(j);
-			if(f == NULL)
-				continue;
-
-			for(size_t k = 0; k < f->num_vertices(); k++)
-			{
-				const vertex* f_v = f->get_vertex(k);
-
-				// Insert the vertex only if it is not already
-				// counted within in the "beta" set (and if it
-				// is not the current vertex)
-				if(f_v->get_id() != v->get_id() && vertices_beta.find(f_v) == vertices_beta.end())
-					vertices_gamma.insert(f_v);
-			}
-		}
+		find_vertex_neighbours(v, vertices_beta, vertices_gamma);
 
 		// Apply weights; since this is O(n), the function checks
 		// whether the weights for beta and gamma are applicable at all
@@ -407,18 +549,21 @@ void CatmullClark::create_vertex_points_parametrically(mesh& input_mesh, mesh& o
 
 		if(beta != 0.0)
 		{
-			for(std::set<const vertex*>::iterator it = vertices_beta.begin(); it != vertices_beta.end(); it++)
-				vertex_point += (*it)->get_position()*beta/n;
+			for(size_t j = 0; j < vertices_beta.size(); j++)
+				vertex_point += vertices_beta[j]->get_position()*beta/n;
 		}
 
 		if(gamma != 0.0)
 		{
-			for(std::set<const vertex*>::iterator it = vertices_gamma.begin(); it != vertices_gamma.end(); it++)
-				vertex_point += (*it)->get_position()*gamma/n;
+			for(size_t j = 0; j < vertices_gamma.size(); j++)
+				vertex_point += vertices_gamma[j]->get_position()*gamma/n;
 		}
 
-		v->vertex_point = output_mesh.add_vertex(vertex_point);
+		points[i]	= vertex_point;
+		point_types[i]	= INTERIOR_POINT;
 	}
+
+	add_points(output, vertex_points, "Creating vertex points [parametrically]");
 }
 
 /*!
@@ -426,24 +571,29 @@ void CatmullClark::create_vertex_points_parametrically(mesh& input_mesh, mesh& o
 *	stores them in the new mesh.
 *
 *	@param input_mesh	Original input mesh, will not be modified
-*	@param output_mesh	Mesh that will contain the new vertex points
+*	@param output		Sink that receives the new vertex points
 */
 
-void CatmullClark::create_vertex_points_geometrically(mesh& input_mesh, mesh& output_mesh)
+void CatmullClark::create_vertex_points_geometrically(const mesh& input_mesh, mesh_sink& output)
 {
-	for(size_t i = 0; i < input_mesh.num_vertices(); i++)
+	long num_vertices = static_cast<long>(input_mesh.num_vertices());
+
+	points.resize(num_vertices);
+	point_types.assign(num_vertices, NO_POINT);
+
+	#pragma omp parallel for schedule(static)
+	for(long i = 0; i < num_vertices; i++)
 	{
-		print_progress("Creating vertex points [geometrically]",
-				i,
-				input_mesh.num_vertices()-1);
+		if(discarded_vertices[i])
+			continue;
 
-		vertex* v = input_mesh.get_vertex(i);
+		const vertex* v = input_mesh.get_vertex(i);
 
 		// Keep boundary vertices if the user chose this behaviour
 		if(preserve_boundaries && v->is_on_boundary())
 		{
-			v->vertex_point = output_mesh.add_vertex(v->get_position());
-			v->vertex_point->set_on_boundary();
+			points[i]	= v->get_position();
+			point_types[i]	= BOUNDARY_POINT;
 			continue;
 		}
 
@@ -461,7 +611,7 @@ void CatmullClark::create_vertex_points_geometrically(mesh& input_mesh, mesh& ou
 		// Q is the average of the new face points of all faces
 		// adjacent to the old vertex point
 		for(size_t j = 0; j < v->num_adjacent_faces(); j++)
-			Q += v->get_face(j)->face_point->get_position();
+			Q += output.get_position(face_points[v->get_face(j)->get_slot()]);
 
 		Q /= v->num_adjacent_faces();
 
@@ -478,9 +628,192 @@ void CatmullClark::create_vertex_points_geometrically(mesh& input_mesh, mesh& ou
 		// S is the current vertex
 		S = v->get_position();
 
-		v3ctor vertex_point = (Q+R*2+S*(n-3))/n;
-		v->vertex_point = output_mesh.add_vertex(vertex_point);
+		points[i]	= (Q+R*2+S*(n-3))/n;
+		point_types[i]	= INTERIOR_POINT;
+	}
+
+	add_points(output, vertex_points, "Creating vertex points [geometrically]");
+}
+
+/*!
+*	Calculates the weights for a vertex point of the parametric
+*	Catmull-Clark scheme.
+*
+*	@param n	Valency of the vertex
+*	@param alpha	Weight of the vertex itself
+*	@param beta	Weight of all vertices that share an edge with the vertex;
+*			will be divided by n
+*	@param gamma	Weight of all remaining vertices of the adjacent faces;
+*			will be divided by n
+*/
+
+void CatmullClark::get_vertex_weights(size_t n, double& alpha, double& beta, double& gamma) const
+{
+	if(n == 4 && use_bspline_weights)
+	{
+		gamma	= 1.0/16.0;
+		beta	= 3.0/8.0;
+		alpha	= 9.0/16.0;
+	}
+	else
+	{
+		std::pair<double, double> weights = weight_function(n);
+
+		gamma	= weights.second;
+		beta	= weights.first;
+		alpha	= 1.0-beta-gamma;
+	}
+}
+
+/*!
+*	Finds the vertices that contribute to a vertex point of the parametric
+*	Catmull-Clark scheme. Both lists are sorted by address, so the order
+*	in which the points are summed up does not depend on the order of the
+*	edges and faces of the vertex.
+*
+*	@param v		Vertex of the input mesh
+*	@param vertices_beta	Vertices that share an edge with v
+*	@param vertices_gamma	Remaining vertices of the faces adjacent to v
+*/
+
+void CatmullClark::find_vertex_neighbours(	const vertex* v,
+						neighbour_list& vertices_beta,
+						neighbour_list& vertices_gamma) const
+{
+	// All vertices that are connected via an edge with the current
+	// vertex will be assigned the weight beta.
+	for(vertex_edge_circulator it(v); it.valid(); it.next())
+		vertices_beta.push_back(it.get_vertex());
+
+	// The first element is always stored inline, so its address is valid
+	// for empty lists as well
+	const vertex** beta_begin	= &vertices_beta[0];
+	const vertex** beta_end		= beta_begin + vertices_beta.size();
+
+	std::sort(beta_begin, beta_end);
+
+	// All remaining vertices of all adjacent faces to the current
+	// vertex will be assigned the weight gamma.
+	for(vertex_face_circulator it(v); it.valid(); it.next())
+	{
+		for(face_vertex_circulator f_it(it.get_face()); f_it.valid(); f_it.next())
+		{
+			const vertex* f_v = f_it.get_vertex();
+			if(f_v == v || std::binary_search(beta_begin, beta_end, f_v))
+				continue;
+
+			// Vertices that belong to several faces are only
+			// added once
+			const vertex** gamma_end = &vertices_gamma[0] + vertices_gamma.size();
+			if(std::find(&vertices_gamma[0], gamma_end, f_v) == gamma_end)
+				vertices_gamma.push_back(f_v);
+		}
+	}
+
+	std::sort(&vertices_gamma[0], &vertices_gamma[0] + vertices_gamma.size());
+}
+
+/*!
+*	Adds the weights of a face, edge, or vertex point that has been created
+*	during the last subdivision step to a stencil. The weights follow the
+*	rules that have been used for creating the point.
+*
+*	@param	input_mesh	Mesh on which the algorithm has been applied
+*	@param	source		Type of the element that created the point
+*	@param	slot		Slot of the element that created the point
+*	@param	weight		Factor for all weights that are added
+*	@param	S		Stencil that receives the weights
+*
+*	@return	true if the weights could be added, else false
+*/
+
+bool CatmullClark::add_stencil(const mesh& input_mesh, point_source source, size_t slot, double weight, stencil& S)
+{
+	if(source == SOURCE_FACE)
+	{
+		const face* f	= input_mesh.get_face(slot);
+		size_t m	= f->num_vertices();
+
+		for(size_t j = 0; j < m; j++)
+			S.push_back(std::make_pair(f->get_vertex(j)->get_slot(), weight/m));
+	}
+	else if(source == SOURCE_EDGE)
+	{
+		const edge* e = input_mesh.get_edge(slot);
+
+		// Border/crease edge: Midpoint
+		if(e->get_g() == NULL)
+		{
+			S.push_back(std::make_pair(e->get_u()->get_slot(), weight*0.5));
+			S.push_back(std::make_pair(e->get_v()->get_slot(), weight*0.5));
+		}
+		else
+		{
+			S.push_back(std::make_pair(e->get_u()->get_slot(), weight*0.25));
+			S.push_back(std::make_pair(e->get_v()->get_slot(), weight*0.25));
+
+			add_stencil(input_mesh, SOURCE_FACE, e->get_f()->get_slot(), weight*0.25, S);
+			add_stencil(input_mesh, SOURCE_FACE, e->get_g()->get_slot(), weight*0.25, S);
+		}
+	}
+	else if(source == SOURCE_VERTEX)
+	{
+		const vertex* v	= input_mesh.get_vertex(slot);
+		size_t n	= v->valency();
+
+		if(preserve_boundaries && v->is_on_boundary())
+			S.push_back(std::make_pair(slot, weight));
+
+		// Q is the average of the face points, R the average of the
+		// edge midpoints; see create_vertex_points_geometrically()
+		else if(non_quadrangular_face || use_geometric_point_creation)
+		{
+			size_t m = v->num_adjacent_faces();
+			for(size_t j = 0; j < m; j++)
+				add_stencil(input_mesh, SOURCE_FACE, v->get_face(j)->get_slot(), weight/(m*n), S);
+
+			for(size_t j = 0; j < n; j++)
+			{
+				const edge* e = v->get_edge(j);
+
+				S.push_back(std::make_pair(e->get_u()->get_slot(), weight/(n*n)));
+				S.push_back(std::make_pair(e->get_v()->get_slot(), weight/(n*n)));
+			}
+
+			S.push_back(std::make_pair(slot, weight*(n-3.0)/n));
+		}
+		else
+		{
+			double alpha;
+			double beta;
+			double gamma;
+
+			get_vertex_weights(n, alpha, beta, gamma);
+
+			neighbour_list vertices_beta;
+			neighbour_list vertices_gamma;
+
+			find_vertex_neighbours(v, vertices_beta, vertices_gamma);
+
+			S.push_back(std::make_pair(slot, weight*alpha));
+
+			if(beta != 0.0)
+			{
+				for(size_t j = 0; j < vertices_beta.size(); j++)
+					S.push_back(std::make_pair(vertices_beta[j]->get_slot(), weight*beta/n));
+			}
+
+			if(gamma != 0.0)
+			{
+				for(size_t j = 0; j < vertices_gamma.size(); j++)
+					S.push_back(std::make_pair(vertices_gamma[j]->get_slot(), weight*gamma/n));
+			}
+		}
 	}
+	else
+		return(false);
+
+	return(true);
 }
 
 } // end of namespace "psalm"
@@ -7,7 +7,10 @@
 #define __CATMULL_CLARK_H__
 
 #include <utility>
+#include <vector>
+
 #include "BsplineSubdivisionAlgorithm.h"
+#include "small_vector.h"
 
 namespace psalm
 {
@@ -22,14 +25,38 @@ class CatmullClark : public BsplineSubdivisionAlgorithm
 	public:
 		CatmullClark();
 
-		bool apply_to(mesh& input_mesh);
+		using SubdivisionAlgorithm::apply_to;
+
+		bool apply_to(const mesh& input_mesh, mesh_sink& output);
 		bool set_weights(weights new_weights);
 
+	protected:
+		void reset_state();
+		bool add_stencil(const mesh& input_mesh, point_source source, size_t slot, double weight, stencil& S);
+
 	private:
-		void create_face_points(mesh& input_mesh, mesh& output_mesh);
-		void create_edge_points(mesh& input_mesh, mesh& output_mesh);
-		void create_vertex_points_parametrically(mesh& input_mesh, mesh& output_mesh);
-		void create_vertex_points_geometrically(mesh& input_mesh, mesh& output_mesh);
+		/*!
+			Neighbours of a vertex that contribute to its vertex
+			point; regular vertices do not require any memory
+			from the heap.
+		*/
+
+		typedef small_vector<const vertex*, 16> neighbour_list;
+
+		void create_face_points(const mesh& input_mesh, mesh_sink& output);
+		void create_edge_points(const mesh& input_mesh, mesh_sink& output);
+		void create_vertex_points_parametrically(const mesh& input_mesh, mesh_sink& output);
+		void create_vertex_points_geometrically(const mesh& input_mesh, mesh_sink& output);
+
+		void get_vertex_weights(size_t n, double& alpha, double& beta, double& gamma) const;
+		void find_vertex_neighbours(	const vertex* v,
+						neighbour_list& vertices_beta,
+						neighbour_list& vertices_gamma) const;
+
+		void add_points(mesh_sink& output, std::vector<size_t>& indices, const std::string& message);
+
+		bool create_topology(const mesh& input_mesh, mesh_sink& output);
+		void create_topology_by_vertices(const mesh& input_mesh, mesh_sink& output);
 
 		/*!
 			This pointer will be set to an appropriate predefined
@@ -51,8 +78,30 @@ class CatmullClark : public BsplineSubdivisionAlgorithm
 						///< points of the Catmull-Clark scheme cannot be
 						///< created parametrically.
 
-		bool use_bspline_weights;	///< Flag signalling that B-spline weights shall be
-						///< used for all regular parts of a mesh.
+		/*
+			Points of the current phase (face, edge, or vertex
+			points), indexed by the slot of the element they
+			belong to. The points are computed in parallel and
+			added to the output afterwards in the order of the
+			slots, so the output does not depend on the number of
+			threads.
+		*/
+
+		enum point_type
+		{
+			NO_POINT,		///< Element does not receive a point
+			INTERIOR_POINT,		///< Point is added as an interior vertex
+			BOUNDARY_POINT,		///< Point is added as a boundary vertex
+			DISCARDED_EDGE		///< Edge without a point whose vertices are discarded
+		};
+
+		std::vector<v3ctor> points;
+		std::vector<unsigned char> point_types;
+
+		std::vector<bool> discarded_vertices;	///< Vertices of the input mesh (indexed by
+							///< slot) that are incident on boundary edges
+							///< that cannot be subdivided; these vertices
+							///< do not receive a vertex point.
 };
 
 /*!
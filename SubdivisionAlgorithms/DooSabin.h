@@ -32,22 +32,22 @@ class DooSabin : public BsplineSubdivisionAlgorithm
 	 public:
 		DooSabin();
 
-		bool apply_to(mesh& input_mesh);
+		using SubdivisionAlgorithm::apply_to;
+
+		bool apply_to(const mesh& input_mesh, mesh_sink& output);
 		bool set_weights(weights new_weights);
 
 		void set_custom_weights(const weights_map& custom_weights);
 
 	private:
-		void create_face_vertices_geometrically(mesh& input_mesh, mesh& output_mesh);
-		void create_face_vertices_parametrically(mesh& input_mesh, mesh& output_mesh);
+		void create_face_vertices_geometrically(const mesh& input_mesh, mesh_sink& output);
+		void create_face_vertices_parametrically(const mesh& input_mesh, mesh_sink& output);
 
-		void create_f_faces(mesh& input_mesh, mesh& output_mesh);
-		void create_e_faces(mesh& input_mesh, mesh& output_mesh);
-		void create_v_faces(mesh& input_mesh, mesh& output_mesh);
+		void create_f_faces(const mesh& input_mesh, mesh_sink& output);
+		void create_e_faces(const mesh& input_mesh, mesh_sink& output);
+		void create_v_faces(const mesh& input_mesh, mesh_sink& output);
 
-		std::vector<const vertex*> sort_vertices(face* f, const vertex* v);
-		std::vector<face*> sort_faces(vertex* v);
-		vertex* find_face_vertex(face* f, const vertex* v);
+		size_t find_face_vertex(const face* f, const vertex* v);
 
 		/*!
 			This pointer will be set to an appropriate predefined
@@ -70,6 +70,23 @@ class DooSabin : public BsplineSubdivisionAlgorithm
 		*/
 
 		weights_map custom_weights;
+
+		/*!
+			Face vertices of all faces of the input mesh. The face
+			vertices of a face are stored consecutively, in the
+			order of the vertices of the face; every entry is the
+			index of the face vertex in the output sink.
+		*/
+
+		std::vector<size_t> face_vertices;
+
+		/*!
+			Offset of the first face vertex of every face of the
+			input mesh in the face vertex array; indexed by the
+			slot of the face.
+		*/
+
+		std::vector<size_t> face_vertex_offsets;
 };
 
 /*!
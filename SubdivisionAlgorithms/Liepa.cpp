@@ -38,6 +38,24 @@ double Liepa::get_alpha()
 	return(alpha);
 }
 
+/*!
+*	Applies Liepa's subdivision scheme to a copy of the given mesh. In
+*	contrast to the default implementation, the copy is subdivided
+*	directly, so vertex IDs and properties are kept.
+*
+*	@param	input_mesh	Mesh on which the algorithm is applied; will not
+*				be modified
+*	@param	output_mesh	Mesh that will contain the subdivided mesh
+*
+*	@return	true on success, else false
+*/
+
+bool Liepa::apply_to(const mesh& input_mesh, mesh& output_mesh)
+{
+	input_mesh.clone(output_mesh);
+	return(apply_to(output_mesh));
+}
+
 /*!
 *	Applies Liepa's subdivision scheme to the given mesh. The mesh will be
 *	irreversibly _changed_ by this function.
@@ -48,6 +66,8 @@ double Liepa::get_alpha()
 
 bool Liepa::apply_to(mesh& input_mesh)
 {
+	input_mesh.compact();
+
 	/*
 		Compute scale attribute as the average length of the edges
 		adjacent to a vertex.
@@ -56,39 +76,35 @@ bool Liepa::apply_to(mesh& input_mesh)
 		_all_ vertices are boundary vertices.
 	*/
 
+	// Scale attributes may have been seeded when loading the mesh;
+	// otherwise, they are initialized with zero
+	property<double>& scale = input_mesh.add_vertex_property<double>("scale");
+
+	std::vector<double> attributes(input_mesh.num_vertices(), 0.0);
+
+	// Only the boundary edges contribute to the scale attributes; these
+	// are known to the mesh, so the edges of the vertices need not be
+	// searched.
+	for(size_t i = 0; i < input_mesh.num_boundary_edges(); i++)
+	{
+		edge* e = input_mesh.get_boundary_edge(i);
+		double length = 0.5*e->calc_length();
+
+		attributes[e->get_u()->get_slot()] += length;
+		attributes[e->get_v()->get_slot()] += length;
+	}
+
 	for(size_t i = 0; i < input_mesh.num_vertices(); i++)
 	{
-		vertex* v = input_mesh.get_vertex(i);
-		size_t n = v->valency();
-
-		double attribute		= 0.0;
-		bool found_first_boundary_edge	= false;	// in the triangulated mesh, there are
-								// only two boundary edges per vertex;
-								// if we have found those two, the search
-								// may be stopped.
-		for(size_t i = 0; i < n; i++)
-		{
-			edge* e = v->get_edge(i);
-			if(e->is_on_boundary())
-			{
-				attribute += 0.5*e->calc_length();
-
-				// break if we have already seen a boundary
-				// edge -- see discussion above
-				if(found_first_boundary_edge)
-					break;
-				else
-					found_first_boundary_edge = true;
-			}
-		}
+		double attribute = attributes[i];
 
 		// If the scale attributes have already been seeded, their
 		// average is taken to be the new scale attribute...
-		double old_attribute = v->get_scale_attribute();
+		double old_attribute = scale[i];
 		if(old_attribute != 0.0)
-			v->set_scale_attribute(0.5*(old_attribute + attribute));
+			scale[i] = 0.5*(old_attribute + attribute);
 		else
-			v->set_scale_attribute(attribute);
+			scale[i] = attribute;
 	}
 
 	bool created_new_triangle;
@@ -106,7 +122,11 @@ bool Liepa::apply_to(mesh& input_mesh)
 		// Compute scale attribute for each face of the mesh
 		for(size_t i = 0; i < num_faces; i++)
 		{
+			// Skip faces that have been removed by relaxing an edge
 			face* f = input_mesh.get_face(i);
+			if(f == NULL)
+				continue;
+
 			if(f->num_edges() != 3)
 			{
 				std::cerr << "psalm: Input mesh contains non-triangular face. Liepa's subdivision scheme is not applicable.\n";
@@ -127,7 +147,7 @@ bool Liepa::apply_to(mesh& input_mesh)
 			for(size_t j = 0; j < 3; j++)
 			{
 				centroid_pos += vertices[j]->get_position()/3.0;
-				centroid_scale_attribute += vertices[j]->get_scale_attribute()/3.0;
+				centroid_scale_attribute += scale[vertices[j]->get_slot()]/3.0;
 			}
 
 			size_t tests_failed = 0;
@@ -135,7 +155,7 @@ bool Liepa::apply_to(mesh& input_mesh)
 			{
 				double scaled_distance = alpha*(centroid_pos - vertices[j]->get_position()).length();
 				if(	scaled_distance > centroid_scale_attribute &&
-					scaled_distance > vertices[j]->get_scale_attribute())
+					scaled_distance > scale[vertices[j]->get_slot()])
 				{
 					// We will replace the triangle only if
 					// _all_ three tests failed
@@ -149,14 +169,15 @@ bool Liepa::apply_to(mesh& input_mesh)
 				created_new_triangle = true;
 
 				vertex* centroid_vertex = input_mesh.add_vertex(centroid_pos);
-				centroid_vertex->set_scale_attribute(centroid_scale_attribute);
+				scale[centroid_vertex->get_slot()] = centroid_scale_attribute;
 
 				// Remove old face and replace it by three new
 				// faces. Calling remove_face() will ensure
-				// that the edges are updated correctly.
+				// that the edges are updated correctly and
+				// release the memory of the face. Its slot
+				// remains empty until the mesh is compacted.
 
 				input_mesh.remove_face(f);
-				delete f;
 
 				face* new_face1 = input_mesh.add_face(vertices[0], vertices[1], centroid_vertex, true);
 				face* new_face2 = input_mesh.add_face(centroid_vertex, vertices[1], vertices[2], true);
@@ -168,9 +189,6 @@ bool Liepa::apply_to(mesh& input_mesh)
 					return(false);
 				}
 
-				num_faces--;
-				i--;
-
 				// Relax edges afterwards to maintain
 				// Delaunay-like mesh
 
@@ -181,7 +199,10 @@ bool Liepa::apply_to(mesh& input_mesh)
 		}
 
 		if(!created_new_triangle)
+		{
+			input_mesh.compact();
 			return(true);
+		}
 
 		// Relax interior edges
 		bool relaxed_edge;
@@ -190,12 +211,17 @@ bool Liepa::apply_to(mesh& input_mesh)
 			relaxed_edge = false;
 			for(size_t i = 0; i < input_mesh.num_edges(); i++)
 			{
-				if(input_mesh.relax_edge(input_mesh.get_edge(i)))
+				edge* e = input_mesh.get_edge(i);
+				if(e != NULL && input_mesh.relax_edge(e))
 					relaxed_edge = true;
 			}
 		}
 		while(relaxed_edge);
 
+		// Remove the slots of all faces and edges that have been
+		// replaced during this iteration
+		input_mesh.compact();
+
 		/*
 			XXX: This might lead to wrong results...
 
@@ -213,7 +239,7 @@ bool Liepa::apply_to(mesh& input_mesh)
 				for(size_t i = 0; i < n; i++)
 					attribute += v->get_edge(i)->calc_length()/static_cast<double>(n);
 
-				v->set_scale_attribute(attribute);
+				scale[i] = attribute;
 			}
 		*/
 
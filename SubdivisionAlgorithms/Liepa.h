@@ -21,7 +21,10 @@ class Liepa : public SubdivisionAlgorithm
 	public:
 		Liepa();
 
+		using SubdivisionAlgorithm::apply_to;
+
 		bool apply_to(mesh& input_mesh);
+		bool apply_to(const mesh& input_mesh, mesh& output_mesh);
 
 		/*!
 		* This subdivision algorithm does not use any weights, hence
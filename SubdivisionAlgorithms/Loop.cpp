@@ -6,31 +6,49 @@
 #include <cmath>
 
 #include "Loop.h"
+#include "circulator.h"
+#include "small_vector.h"
+#include "v3ctor_kernels.h"
 
 namespace psalm
 {
 
 /*!
-*	Applies Loop's subdivision algorithm to the given mesh. The mesh will
-*	be irreversibly _changed_ by this function.
+*	Applies Loop's subdivision algorithm to the given mesh.
+*
+*	@param	input_mesh	Mesh on which the algorithm is applied; will not
+*				be modified
+*	@param	output		Sink that receives the subdivided mesh
 *
-*	@param	input_mesh Mesh on which the algorithm is applied
 *	@return	true on success, else false
 */
 
-bool Loop::apply_to(mesh& input_mesh)
+bool Loop::apply_to(const mesh& input_mesh, mesh_sink& output)
 {
-	mesh output_mesh;
+	// Points are stored per slot of the input mesh, so a mesh with empty
+	// slots of removed elements is subdivided via a compact copy
+	if(!input_mesh.is_compact())
+	{
+		mesh compact_mesh;
+		input_mesh.clone(compact_mesh);
+
+		return(apply_to(static_cast<const mesh&>(compact_mesh), output));
+	}
 
-	create_vertex_points(input_mesh, output_mesh);
-	create_edge_points(input_mesh, output_mesh);
+	output.reserve(	input_mesh.num_vertices()+input_mesh.num_edges(),
+				4*input_mesh.num_faces());
+
+	reset_points(input_mesh);
+
+	create_vertex_points(input_mesh, output);
+	create_edge_points(input_mesh, output);
 
 	// Create topology for the new mesh
 	for(size_t i = 0; i < input_mesh.num_faces(); i++)
 	{
 		print_progress("Creating topology", i, input_mesh.num_faces()-1);
 
-		face* f = input_mesh.get_face(i);
+		const face* f = input_mesh.get_face(i);
 
 		// Check whether the face contains any boundary edges. In this
 		// case, normal subdivision rules are not applicable.
@@ -45,23 +63,25 @@ bool Loop::apply_to(mesh& input_mesh)
 			// a good thing. Otherwise, the subdivision process
 			// would be too static.
 
-			vertex* v1 = f->get_vertex(0)->vertex_point;
-			vertex* v2 = f->get_vertex(1)->vertex_point;
-			vertex* v3 = f->get_vertex(2)->vertex_point;
+			size_t v1 = vertex_points[f->get_vertex(0)->get_slot()];
+			size_t v2 = vertex_points[f->get_vertex(1)->get_slot()];
+			size_t v3 = vertex_points[f->get_vertex(2)->get_slot()];
 
-			v3ctor centroid = (	v1->get_position()+
-						v2->get_position()+
-						v3->get_position())*(1.0/3.0);
+			v3ctor centroid = (	output.get_position(v1)+
+						output.get_position(v2)+
+						output.get_position(v3))*(1.0/3.0);
 
-			vertex* v_centre = output_mesh.add_vertex(centroid);
+			// The centroid is the point of the face
+			face_points[i]	= output.add_vertex(centroid);
+			size_t v_centre	= face_points[i];
 
 			// Replace triangle by three smaller triangles. The
 			// order is correct because the vertices of the face
 			// are sorted correctly.
 
-			output_mesh.add_face(v_centre, v1, v2);
-			output_mesh.add_face(v_centre, v2, v3);
-			output_mesh.add_face(v_centre, v3, v1);
+			output.add_face(v_centre, v1, v2);
+			output.add_face(v_centre, v2, v3);
+			output.add_face(v_centre, v3, v1);
 
 			// Check whether an edge already has an edge point. In
 			// this case, a new triangle must be created -- else,
@@ -69,8 +89,10 @@ bool Loop::apply_to(mesh& input_mesh)
 
 			for(size_t j = 0; j < 3; j++)
 			{
-				edge* e = f->get_edge(j).e;
-				if(e->edge_point)
+				const edge* e		= f->get_edge(j).e;
+				size_t edge_point	= edge_points[e->get_slot()];
+
+				if(edge_point != mesh_sink::NO_VERTEX)
 				{
 					// For each of the edges, we need to
 					// check whether the _second_ adjacent
@@ -88,11 +110,11 @@ bool Loop::apply_to(mesh& input_mesh)
 					if(!on_boundary)
 					{
 						if(j == 0)
-							output_mesh.add_face(v2, v1, e->edge_point);
+							output.add_face(v2, v1, edge_point);
 						else if(j == 1)
-							output_mesh.add_face(v3, v2, e->edge_point);
+							output.add_face(v3, v2, edge_point);
 						else if(j == 2)
-							output_mesh.add_face(v1, v3, e->edge_point);
+							output.add_face(v1, v3, edge_point);
 					}
 				}
 			}
@@ -100,79 +122,30 @@ bool Loop::apply_to(mesh& input_mesh)
 			continue;
 		}
 
-		// ...go through all vertices of the face
-		for(size_t j = 0; j < f->num_vertices(); j++)
+		/*
+			Every vertex of the face yields one new triangle, which
+			connects its vertex point with the edge points of the
+			two edges of the face that are incident on the vertex.
+			The circulator provides the edge that starts at the
+			current vertex; the edge that ends at the vertex is the
+			edge of the previous vertex.
+
+			Since the edges of a face are stored in the order of its
+			vertices, connecting the vertex point, the point of the
+			outgoing edge, and the point of the incoming edge in
+			this order creates a face that is oriented like the
+			original one.
+		*/
+
+		const directed_edge* incoming_edge = &f->get_edge(f->num_edges()-1);
+		for(face_vertex_circulator it(f); it.valid(); it.next())
 		{
-			/*
-				Using the jth vertex of the ith face, we now
-				need to find the _two_ adjacent edges for the
-				face. This yields one new triangle.
-			*/
-
-			size_t n = f->num_edges(); // number of edges in face
-			bool assigned_first_edge = false;
-
-			directed_edge d_e1; // first adjacent edge (for vertex & face)
-			directed_edge d_e2; // second adjacent edge (for vertex & face)
-
-			// brute-force search for the two edges; could be
-			// optimized
-			for(size_t k = 0; k < n; k++)
-			{
-				// TODO: Optimization required.
-				directed_edge d_edge = f->get_edge(k);
-				if(	d_edge.e->get_u()->get_id() == f->get_vertex(j)->get_id() ||
-					d_edge.e->get_v()->get_id() == f->get_vertex(j)->get_id())
-				{
-					if(!assigned_first_edge)
-					{
-						d_e1 = d_edge;
-						assigned_first_edge = true;
-					}
-					else
-					{
-						d_e2 = d_edge;
-						break;
-					}
-				}
-			}
+			size_t v1 = vertex_points[it.get_vertex()->get_slot()];
+			size_t v2 = edge_points[it.get_edge().e->get_slot()];
+			size_t v3 = edge_points[incoming_edge->e->get_slot()];
 
-			vertex* v1 = f->get_vertex(j)->vertex_point;
-			vertex* v2 = d_e1.e->edge_point;
-			vertex* v3 = d_e2.e->edge_point;
-
-			/*
-				 Create vertices for the _new_ face. It is
-				 important to determine the proper order of the
-				 edges here. The new edges should run "along"
-				 the old ones.
-
-				 Hence, it is checked whether the current
-				 vertex is the _start_ vertex of the first
-				 edge. This is the case if _either_ the edge is
-				 not inverted and the current vertex is equal
-				 to the vertex u (start vertex) of the edge
-				 _or_ the edge is inverted and the current
-				 vertex is equal to the vertex v (end vertex)
-				 of the edge.
-
-				 If the current vertex is the start vertex of
-				 the first edge, connecting the new points in
-				 order v1, v2, v3 will create a face that is
-				 oriented counterclockwise. Else, order v1, v3,
-				 v2 will have to be used.
-
-				 v1 can remain fixed in all cases because of
-				 the symmetry.
-			*/
-
-			if((d_e1.e->get_u()->get_id() == f->get_vertex(j)->get_id() && d_e1.inverted == false) ||
-			   (d_e1.e->get_v()->get_id() == f->get_vertex(j)->get_id() && d_e1.inverted))
-				output_mesh.add_face(v1, v2, v3);
-
-			// Swap order
-			else
-				output_mesh.add_face(v1, v3, v2);
+			output.add_face(v1, v2, v3);
+			incoming_edge = &it.get_edge();
 		}
 
 		// Create face from all three edge points of the face; since
@@ -186,12 +159,11 @@ bool Loop::apply_to(mesh& input_mesh)
 			return(false);
 		}
 
-		output_mesh.add_face(	f->get_edge(0).e->edge_point,
-					f->get_edge(1).e->edge_point,
-					f->get_edge(2).e->edge_point);
+		output.add_face(edge_points[f->get_edge(0).e->get_slot()],
+				edge_points[f->get_edge(1).e->get_slot()],
+				edge_points[f->get_edge(2).e->get_slot()]);
 	}
 
-	input_mesh.replace_with(output_mesh);
 	return(true);
 }
 
@@ -200,45 +172,34 @@ bool Loop::apply_to(mesh& input_mesh)
 *	mesh.
 *
 *	@param input_mesh	Original input mesh, will not be modified
-*	@param output_mesh	Mesh that will contain the new vertex points
+*	@param output		Sink that receives the new vertex points
 */
 
-void Loop::create_vertex_points(mesh& input_mesh, mesh& output_mesh)
+void Loop::create_vertex_points(const mesh& input_mesh, mesh_sink& output)
 {
 	// The vertex points are created by using neighbourhood information of
 	// all vertices in the input mesh
 	for(size_t i = 0; i < input_mesh.num_vertices(); i++)
 	{
-		vertex* v = input_mesh.get_vertex(i);
+		const vertex* v = input_mesh.get_vertex(i);
 		print_progress("Creating vertex points", i, input_mesh.num_vertices()-1);
 
 		// Preserve boundary vertices if necessary
 		if(preserve_boundaries && v->is_on_boundary())
 		{
-			v->vertex_point = output_mesh.add_vertex(v->get_position());
-			v->vertex_point->set_on_boundary();
+			vertex_points[i] = output.add_vertex(v->get_position(), true);
 			continue;
 		}
 
 		// Find neighbours
 
 		size_t n = v->valency();
-		v3ctor vertex_point;
+		small_vector<const v3ctor*, 8> P;
 
-		// TODO: Iterators required.
-		for(size_t j = 0; j < n; j++)
-		{
-			const edge* e = v->get_edge(j);
-
-			/*
-				i is the index of the current vertex; if the
-				start vertex of the edge is _not_ the current
-				vertex, it must be the neighbouring vertex.
-			*/
+		for(vertex_edge_circulator it(v); it.valid(); it.next())
+			P.push_back(&it.get_vertex()->get_position());
 
-			const vertex* neighbour = (e->get_u()->get_id() != v->get_id()? e->get_u() : e->get_v());
-			vertex_point += neighbour->get_position();
-		}
+		v3ctor vertex_point = calc_sum(&P[0], n);
 
 		double s = 0.0;
 		if(n > 3)
@@ -249,7 +210,7 @@ void Loop::create_vertex_points(mesh& input_mesh, mesh& output_mesh)
 		vertex_point *= s;
 		vertex_point += v->get_position()*(1.0-n*s);
 
-		v->vertex_point = output_mesh.add_vertex(vertex_point);
+		vertex_points[i] = output.add_vertex(vertex_point);
 	}
 }
 
@@ -258,17 +219,17 @@ void Loop::create_vertex_points(mesh& input_mesh, mesh& output_mesh)
 *	mesh.
 *
 *	@param input_mesh	Original input mesh, will not be modified
-*	@param output_mesh	Mesh that will contain the new vertex points
+*	@param output		Sink that receives the new vertex points
 */
 
-void Loop::create_edge_points(mesh& input_mesh, mesh& output_mesh)
+void Loop::create_edge_points(const mesh& input_mesh, mesh_sink& output)
 {
 	for(size_t i = 0; i < input_mesh.num_edges(); i++)
 	{
 		print_progress("Creating edge points", i, input_mesh.num_edges()-1);
 
 		v3ctor edge_point;
-		edge* e = input_mesh.get_edge(i);
+		const edge* e = input_mesh.get_edge(i);
 
 		// Find remaining vertices of the adjacent faces of the edge
 		const vertex* v1 = find_remaining_vertex(e, e->get_f());
@@ -288,15 +249,83 @@ void Loop::create_edge_points(mesh& input_mesh, mesh& output_mesh)
 					(v1->get_position()+v2->get_position())*0.125;
 		}
 
+		// Boundary edges do not receive an edge point; their faces
+		// are handled separately when creating the topology.
 		if(v1 != NULL && v2 != NULL)
-			e->edge_point = output_mesh.add_vertex(edge_point);
+			edge_points[i] = output.add_vertex(edge_point);
+	}
+}
+
+/*!
+*	Adds the weights of a vertex point, an edge point, or the centroid of
+*	a boundary face that has been created during the last subdivision step
+*	to a stencil.
+*
+*	@param	input_mesh	Mesh on which the algorithm has been applied
+*	@param	source		Type of the element that created the point
+*	@param	slot		Slot of the element that created the point
+*	@param	weight		Factor for all weights that are added
+*	@param	S		Stencil that receives the weights
+*
+*	@return	true if the weights could be added, else false
+*/
+
+bool Loop::add_stencil(const mesh& input_mesh, point_source source, size_t slot, double weight, stencil& S)
+{
+	if(source == SOURCE_VERTEX)
+	{
+		const vertex* v = input_mesh.get_vertex(slot);
+		if(preserve_boundaries && v->is_on_boundary())
+		{
+			S.push_back(std::make_pair(slot, weight));
+			return(true);
+		}
+
+		size_t n = v->valency();
+
+		double s = 0.0;
+		if(n > 3)
+			s = (1.0/n*(0.625-pow(0.375+0.25*cos(2*M_PI/n), 2)));
+		else
+			s = 0.1875;
+
+		for(vertex_edge_circulator it(v); it.valid(); it.next())
+			S.push_back(std::make_pair(it.get_vertex()->get_slot(), weight*s));
+
+		S.push_back(std::make_pair(slot, weight*(1.0-n*s)));
+	}
+	else if(source == SOURCE_EDGE)
+	{
+		const edge* e = input_mesh.get_edge(slot);
+
+		const vertex* v1 = find_remaining_vertex(e, e->get_f());
+		const vertex* v2 = find_remaining_vertex(e, e->get_g());
+
+		if(v1 == NULL || v2 == NULL)
+		{
+			S.push_back(std::make_pair(e->get_u()->get_slot(), weight*0.5));
+			S.push_back(std::make_pair(e->get_v()->get_slot(), weight*0.5));
+		}
 		else
-			e->edge_point = NULL;
+		{
+			S.push_back(std::make_pair(e->get_u()->get_slot(), weight*0.375));
+			S.push_back(std::make_pair(e->get_v()->get_slot(), weight*0.375));
+			S.push_back(std::make_pair(v1->get_slot(), weight*0.125));
+			S.push_back(std::make_pair(v2->get_slot(), weight*0.125));
+		}
+	}
 
-		// XXX: Check whether this is correct
-		if(preserve_boundaries && (v1 == NULL || v2 == NULL))
-			e->edge_point->set_on_boundary();
+	// Centroid of the vertex points of a boundary face
+	else if(source == SOURCE_FACE)
+	{
+		const face* f = input_mesh.get_face(slot);
+		for(size_t j = 0; j < 3; j++)
+			add_stencil(input_mesh, SOURCE_VERTEX, f->get_vertex(j)->get_slot(), weight/3.0, S);
 	}
+	else
+		return(false);
+
+	return(true);
 }
 
 /*!
@@ -319,10 +348,10 @@ const vertex* Loop::find_remaining_vertex(const edge* e, const face* f)
 	const vertex* result = NULL;
 	for(size_t i = 0; i < 3; i++)
 	{
-		// The IDs of the start and end vertices of the edge
-		// differ from the ID of the remaining edge.
-		if(	f->get_vertex(i)->get_id() != e->get_u()->get_id() &&
-			f->get_vertex(i)->get_id() != e->get_v()->get_id())
+		// The start and end vertices of the edge differ from the
+		// remaining vertex.
+		if(	f->get_vertex(i) != e->get_u() &&
+			f->get_vertex(i) != e->get_v())
 		{
 			result = f->get_vertex(i);
 			break;
@@ -19,7 +19,9 @@ namespace psalm
 class Loop : public SubdivisionAlgorithm
 {
 	public:
-		bool apply_to(mesh& M);
+		using SubdivisionAlgorithm::apply_to;
+
+		bool apply_to(const mesh& input_mesh, mesh_sink& output);
 
 		/*!
 		* This subdivision algorithm does not use any weights, hence
@@ -31,9 +33,12 @@ class Loop : public SubdivisionAlgorithm
 			return(true);
 		};
 
+	protected:
+		bool add_stencil(const mesh& input_mesh, point_source source, size_t slot, double weight, stencil& S);
+
 	private:
-		void create_vertex_points(mesh& input_mesh, mesh& output_mesh);
-		void create_edge_points(mesh& input_mesh, mesh& output_mesh);
+		void create_vertex_points(const mesh& input_mesh, mesh_sink& output);
+		void create_edge_points(const mesh& input_mesh, mesh_sink& output);
 
 		const vertex* find_remaining_vertex(const edge* e, const face* f);
 };
@@ -3,6 +3,7 @@
 *	@brief	Functions for general subdivision algorithm class
 */
 
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 
@@ -20,6 +21,9 @@ SubdivisionAlgorithm::SubdivisionAlgorithm()
 	handle_creases		= false;
 	preserve_boundaries	= false;
 	print_statistics	= false;
+	last_percentage		= 0;
+
+	use_geometric_point_creation = false;
 }
 
 /*!
@@ -118,6 +122,339 @@ bool SubdivisionAlgorithm::get_statistics_flag()
 	return(print_statistics);
 }
 
+/*!
+*	Applies one step of the subdivision algorithm to the given mesh, which
+*	is replaced by the result. By default, the result is created by
+*	apply_to(const mesh&, mesh&). Algorithms that work in-place override
+*	this function instead. Empty slots of removed elements are removed
+*	from the mesh beforehand.
+*
+*	@param	input_mesh	Mesh on which the algorithm is applied
+*	@return	true on success, else false; apart from being compacted, the
+*	mesh is not changed on failure
+*/
+
+bool SubdivisionAlgorithm::apply_to(mesh& input_mesh)
+{
+	input_mesh.compact();
+
+	mesh output_mesh;
+	if(!apply_to(static_cast<const mesh&>(input_mesh), output_mesh))
+		return(false);
+
+	input_mesh.replace_with(output_mesh);
+	return(true);
+}
+
+/*!
+*	Applies one step of the subdivision algorithm to the given mesh and
+*	stores the result in another mesh. The input mesh is not changed, so
+*	it may be shared among several algorithms. By default, the result is
+*	created by apply_to(const mesh&, mesh_sink&), using a mesh_builder.
+*
+*	@param	input_mesh	Mesh on which the algorithm is applied
+*	@param	output_mesh	Mesh that will contain the result; any previous
+*				contents are removed
+*
+*	@return	true on success, else false
+*/
+
+bool SubdivisionAlgorithm::apply_to(const mesh& input_mesh, mesh& output_mesh)
+{
+	output_mesh.destroy();
+
+	mesh_builder builder(output_mesh);
+	return(apply_to(input_mesh, builder));
+}
+
+/*!
+*	Applies one step of the subdivision algorithm to the given mesh and
+*	passes the vertices and faces of the result to a sink. Depending on
+*	the sink, the topology of the result is never built. By default, the
+*	input mesh is copied, the copy is subdivided in-place via
+*	apply_to(mesh&), and the result is passed to the sink. Every algorithm
+*	has to override at least one of these two functions.
+*
+*	@param	input_mesh	Mesh on which the algorithm is applied
+*	@param	output		Sink that receives the result
+*
+*	@return	true on success, else false
+*/
+
+bool SubdivisionAlgorithm::apply_to(const mesh& input_mesh, mesh_sink& output)
+{
+	mesh output_mesh;
+	input_mesh.clone(output_mesh);
+
+	if(!apply_to(output_mesh))
+		return(false);
+
+	output_mesh.write_to(output);
+	return(true);
+}
+
+/*!
+*	Prepares the arrays of vertex, edge, and face points for a new
+*	subdivision step. All entries are set to mesh_sink::NO_VERTEX.
+*
+*	@param input_mesh Mesh on which the algorithm is applied
+*/
+
+void SubdivisionAlgorithm::reset_points(const mesh& input_mesh)
+{
+	vertex_points.assign(input_mesh.num_vertices(), mesh_sink::NO_VERTEX);
+	edge_points.assign(input_mesh.num_edges(), mesh_sink::NO_VERTEX);
+	face_points.assign(input_mesh.num_faces(), mesh_sink::NO_VERTEX);
+}
+
+/*!
+*	Resets the information an algorithm gathers about a mesh while it is
+*	subdivided, e.g. the types of faces. This function is called before
+*	the steps of apply_to(mesh&, size_t) are performed, so an algorithm
+*	instance may be used for several meshes one after another. By default,
+*	nothing is reset.
+*/
+
+void SubdivisionAlgorithm::reset_state()
+{
+}
+
+/*!
+*	Analyses the topology of a control mesh for a number of subdivision
+*	steps. The result is a table that maps the vertices of the control
+*	mesh to the vertices of the subdivided mesh. Since the weights of the
+*	subdivision rules only depend on the topology, the table may be used
+*	to subdivide the control mesh again for new vertex positions, without
+*	creating the topology of the subdivided mesh again.
+*
+*	Only algorithms that create every point of the subdivided mesh as a
+*	weighted sum of the vertices of the input mesh support stencil tables.
+*
+*	@param	control_mesh	Mesh on which the algorithm is applied; will
+*				not be modified
+*	@param	steps		Number of steps
+*	@param	stencils	Table that receives the weights; its columns
+*				and rows correspond to the slots of the
+*				vertices of the control mesh and the subdivided
+*				mesh, respectively
+*	@param	refined_mesh	Mesh that receives the subdivided mesh
+*
+*	@return	true on success, else false
+*/
+
+bool SubdivisionAlgorithm::create_stencil_table(const mesh& control_mesh, size_t steps, stencil_table& stencils, mesh& refined_mesh)
+{
+	// The copy of the control mesh is compact. If vertices have been
+	// removed, its vertices are thus mapped to the slots of the remaining
+	// vertices of the control mesh.
+
+	control_mesh.clone(refined_mesh);
+	if(refined_mesh.num_vertices() == control_mesh.num_vertices())
+		stencils.set_identity(control_mesh.num_vertices());
+	else
+	{
+		std::vector<size_t> offsets;
+		std::vector<size_t> columns;
+		std::vector<double> weights(refined_mesh.num_vertices(), 1.0);
+
+		offsets.reserve(refined_mesh.num_vertices()+1);
+		columns.reserve(refined_mesh.num_vertices());
+
+		for(size_t i = 0; i < control_mesh.num_vertices(); i++)
+		{
+			if(control_mesh.get_vertex(i) != NULL)
+			{
+				offsets.push_back(columns.size());
+				columns.push_back(i);
+			}
+		}
+
+		offsets.push_back(columns.size());
+		stencils.assign(control_mesh.num_vertices(), offsets, columns, weights);
+	}
+
+	reset_state();
+
+	mesh input_mesh;
+	stencil_table step_stencils;
+
+	for(size_t i = 0; i < steps; i++)
+	{
+		refined_mesh.swap(input_mesh);
+
+		if(!this->apply_to(static_cast<const mesh&>(input_mesh), refined_mesh))
+			return(false);
+
+		if(!compose_stencils(input_mesh, refined_mesh.num_vertices(), stencils, step_stencils))
+			return(false);
+
+		stencils.swap(step_stencils);
+	}
+
+	return(true);
+}
+
+/*!
+*	Adds the weights of a point that has been created during the last
+*	subdivision step to a stencil. The weights refer to the vertices of
+*	the input mesh. Algorithms that support stencil tables need to
+*	override this function; the parameters are the input mesh, the type
+*	and slot of the element that created the point, a factor for all
+*	weights, and the stencil that receives the weights. By default, no
+*	weights are added.
+*
+*	@return	true if the weights could be added, else false
+*/
+
+bool SubdivisionAlgorithm::add_stencil(const mesh&, point_source, size_t, double, stencil&)
+{
+	return(false);
+}
+
+/*!
+*	Combines the stencils of the last subdivision step with the stencils
+*	of all previous steps. Every point of the output mesh is a weighted
+*	sum of the vertices of the input mesh, which, in turn, are weighted
+*	sums of the control points. The rows of the result are created in
+*	parallel: The first pass counts the control points of every row, the
+*	second pass sums up their weights.
+*
+*	@param	input_mesh	Mesh on which the algorithm has been applied
+*	@param	num_points	Number of vertices of the output mesh
+*	@param	previous	Stencils of the vertices of the input mesh
+*	@param	result		Stencils of the vertices of the output mesh
+*
+*	@return	true on success, else false
+*/
+
+bool SubdivisionAlgorithm::compose_stencils(const mesh& input_mesh, size_t num_points, const stencil_table& previous, stencil_table& result)
+{
+	// Element of the input mesh that created every point
+	std::vector<unsigned char> sources(num_points, SOURCE_NONE);
+	std::vector<size_t> slots(num_points);
+
+	const std::vector<size_t>* points[3]	= { &vertex_points, &edge_points, &face_points };
+	const point_source types[3]		= { SOURCE_VERTEX, SOURCE_EDGE, SOURCE_FACE };
+
+	for(short k = 0; k < 3; k++)
+	{
+		for(size_t i = 0; i < points[k]->size(); i++)
+		{
+			size_t index = (*points[k])[i];
+			if(index != mesh_sink::NO_VERTEX && index < num_points)
+			{
+				sources[index]	= types[k];
+				slots[index]	= i;
+			}
+		}
+	}
+
+	if(std::find(sources.begin(), sources.end(), SOURCE_NONE) != sources.end())
+	{
+		std::cerr << "psalm: Unable to create stencil table: Not every point of the subdivided mesh belongs to an element of the input mesh\n";
+		return(false);
+	}
+
+	const size_t no_row	= static_cast<size_t>(-1);
+	long n			= static_cast<long>(num_points);
+	size_t num_columns	= previous.num_columns();
+
+	std::vector<size_t> offsets(num_points+1, 0);
+	bool supported = true;
+
+	#pragma omp parallel reduction(&&:supported)
+	{
+		std::vector<size_t> marker(num_columns, no_row);
+		stencil S;
+
+		#pragma omp for schedule(dynamic, 1024)
+		for(long i = 0; i < n; i++)
+		{
+			S.clear();
+			if(!add_stencil(input_mesh, static_cast<point_source>(sources[i]), slots[i], 1.0, S))
+			{
+				supported = false;
+				continue;
+			}
+
+			size_t count = 0;
+			for(size_t j = 0; j < S.size(); j++)
+			{
+				const size_t* C;
+				const double* W;
+				size_t m = previous.get_row(S[j].first, C, W);
+
+				for(size_t k = 0; k < m; k++)
+				{
+					if(marker[C[k]] != static_cast<size_t>(i))
+					{
+						marker[C[k]] = i;
+						count++;
+					}
+				}
+			}
+
+			offsets[i+1] = count;
+		}
+	}
+
+	if(!supported)
+	{
+		std::cerr << "psalm: Unable to create stencil table: The subdivision algorithm does not support stencils\n";
+		return(false);
+	}
+
+	for(size_t i = 0; i < num_points; i++)
+		offsets[i+1] += offsets[i];
+
+	std::vector<size_t> columns(offsets.back());
+	std::vector<double> weights(offsets.back());
+
+	#pragma omp parallel
+	{
+		std::vector<size_t> marker(num_columns, no_row);
+		std::vector<double> sums(num_columns);
+		stencil S;
+
+		#pragma omp for schedule(dynamic, 1024)
+		for(long i = 0; i < n; i++)
+		{
+			S.clear();
+			add_stencil(input_mesh, static_cast<point_source>(sources[i]), slots[i], 1.0, S);
+
+			size_t begin	= offsets[i];
+			size_t count	= 0;
+
+			for(size_t j = 0; j < S.size(); j++)
+			{
+				const size_t* C;
+				const double* W;
+				size_t m = previous.get_row(S[j].first, C, W);
+
+				for(size_t k = 0; k < m; k++)
+				{
+					if(marker[C[k]] != static_cast<size_t>(i))
+					{
+						marker[C[k]]		= i;
+						sums[C[k]]		= 0.0;
+						columns[begin+count]	= C[k];
+						count++;
+					}
+
+					sums[C[k]] += S[j].second*W[k];
+				}
+			}
+
+			std::sort(columns.begin()+begin, columns.begin()+begin+count);
+			for(size_t k = begin; k < begin+count; k++)
+				weights[k] = sums[columns[k]];
+		}
+	}
+
+	result.assign(num_columns, offsets, columns, weights);
+	return(true);
+}
+
 /*!
 *	Generic function for applying a subdivision algorithm a number of times
 *	to a certain mesh. The function is simply a wrapper for the virtual
@@ -133,11 +470,54 @@ bool SubdivisionAlgorithm::get_statistics_flag()
 
 bool SubdivisionAlgorithm::apply_to(mesh& input_mesh, size_t steps)
 {
+	return(apply_steps(input_mesh, steps, NULL));
+}
+
+/*!
+*	Applies a subdivision algorithm a number of times, but does not build
+*	the mesh of the last step: Its vertices and faces are passed to a sink
+*	instead, e.g. for writing them to a file via mesh_stream. Since the
+*	last step usually creates the largest mesh, this saves most of the
+*	memory that would be required for its topology.
+*
+*	@param	input_mesh	Mesh on which the algorithm is applied; contains
+*				the result of the penultimate step afterwards
+*	@param	steps		Number of steps; if no steps are to be
+*				performed, the input mesh is passed to the sink
+*	@param	output		Sink that receives the result of the last step
+*
+*	@return	true on success, else false
+*/
+
+bool SubdivisionAlgorithm::apply_to(mesh& input_mesh, size_t steps, mesh_sink& output)
+{
+	return(apply_steps(input_mesh, steps, &output));
+}
+
+/*!
+*	Performs the subdivision steps for both variants of apply_to() and
+*	prints the statistics.
+*
+*	@param	input_mesh	Mesh on which the algorithm is applied
+*	@param	steps		Number of steps
+*	@param	output		Sink for the result of the last step; if NULL,
+*				the input mesh is replaced by the result
+*
+*	@return	true on success, else false
+*/
+
+bool SubdivisionAlgorithm::apply_steps(mesh& input_mesh, size_t steps, mesh_sink* output)
+{
+	// Points are stored per slot, so empty slots of removed elements are
+	// removed once instead of in every step
+	input_mesh.compact();
+
 	size_t num_vertices	= input_mesh.num_vertices();
 	size_t num_edges	= input_mesh.num_edges();
 	size_t num_faces	= input_mesh.num_faces();
 
 	bool res = true;
+	reset_state();
 
 	clock_t start	= clock();
 	size_t width	= static_cast<unsigned int>(log10(steps))*2;
@@ -146,11 +526,18 @@ bool SubdivisionAlgorithm::apply_to(mesh& input_mesh, size_t steps)
 		if(print_statistics)
 			std::cerr << "[" << std::setw(width) << i << "]\n";
 
-		res = (res && this->apply_to(input_mesh));
+		if(output && i+1 == steps)
+			res = (res && this->apply_to(static_cast<const mesh&>(input_mesh), *output));
+		else
+			res = (res && this->apply_to(input_mesh));
 
 		if(print_statistics)
 			std::cerr << "\n";
 	}
+
+	if(output && steps == 0)
+		input_mesh.write_to(*output);
+
 	clock_t end = clock();
 
 	if(print_statistics)
@@ -164,11 +551,24 @@ bool SubdivisionAlgorithm::apply_to(mesh& input_mesh, size_t steps)
 				<< std::setw(30) << "\tNumber of vertices: " << num_vertices << "\n"
 				<< std::setw(30) << "\tNumber of edges: " << num_edges << "\n"
 				<< std::setw(30) << "\tNumber of faces: " << num_faces << "\n\n\n"
-				<< "AFTER:\n"
-				<< std::setw(30) << "\tNumber of vertices: "	<< input_mesh.num_vertices()	<< "\n"
-				<< std::setw(30) << "\tNumber of edges: "	<< input_mesh.num_edges()	<< "\n"
-				<< std::setw(30) << "\tNumber of faces: "	<< input_mesh.num_faces()	<< "\n\n\n"
-				<< "TOTAL CPU TIME: "
+				<< "AFTER:\n";
+
+		// Edges of the last step are only known if its mesh has been
+		// built
+		if(output)
+		{
+			std::cerr	<< std::setw(30) << "\tNumber of vertices: "	<< output->num_vertices()	<< "\n"
+					<< std::setw(30) << "\tNumber of faces: "	<< output->num_faces()		<< "\n\n\n";
+		}
+		else
+		{
+			std::cerr	<< std::setw(30) << "\tNumber of vertices: "	<< input_mesh.num_vertices()	<< "\n"
+					<< std::setw(30) << "\tNumber of edges: "	<< input_mesh.num_edges()	<< "\n"
+					<< std::setw(30) << "\tNumber of faces: "	<< input_mesh.num_faces()	<< "\n"
+					<< std::setw(30) << "\tNumber of slabs: "	<< input_mesh.num_slabs()	<< "\n\n\n";
+		}
+
+		std::cerr	<< "TOTAL CPU TIME: "
 				<< (static_cast<double>(end-start)/CLOCKS_PER_SEC)
 				<< "s\n\n";
 	}
@@ -9,8 +9,13 @@
 #include <iomanip>
 #include <string>
 #include <cmath>
+#include <utility>
+#include <vector>
 
 #include "mesh.h"
+#include "mesh_sink.h"
+#include "small_vector.h"
+#include "stencil_table.h"
 
 namespace psalm
 {
@@ -27,7 +32,13 @@ class SubdivisionAlgorithm
                 virtual ~SubdivisionAlgorithm();
 
 		bool apply_to(mesh& M, size_t steps);
-		virtual bool apply_to(mesh& M) = 0;
+		bool apply_to(mesh& M, size_t steps, mesh_sink& output);
+
+		virtual bool apply_to(mesh& M);
+		virtual bool apply_to(const mesh& input_mesh, mesh& output_mesh);
+		virtual bool apply_to(const mesh& input_mesh, mesh_sink& output);
+
+		bool create_stencil_table(const mesh& control_mesh, size_t steps, stencil_table& stencils, mesh& refined_mesh);
 
 		enum weights
 		{
@@ -54,6 +65,50 @@ class SubdivisionAlgorithm
 
 	protected:
 		void print_progress(std::string op, size_t cur_pos, size_t max_pos);
+		void reset_points(const mesh& input_mesh);
+
+		virtual void reset_state();
+
+		bool apply_steps(mesh& input_mesh, size_t steps, mesh_sink* output);
+
+		/*!
+			Elements of the input mesh that may receive a point in
+			the output mesh
+		*/
+
+		enum point_source
+		{
+			SOURCE_NONE,
+			SOURCE_VERTEX,
+			SOURCE_EDGE,
+			SOURCE_FACE
+		};
+
+		/*!
+			Weights of the vertices of the input mesh (indexed by
+			slot) that yield a point of the output mesh; the same
+			vertex may occur more than once.
+		*/
+
+		typedef small_vector<std::pair<size_t, double>, 32> stencil;
+
+		virtual bool add_stencil(const mesh& input_mesh, point_source source, size_t slot, double weight, stencil& S);
+		bool compose_stencils(const mesh& input_mesh, size_t num_points, const stencil_table& previous, stencil_table& result);
+
+		/*
+			Points of the output mesh that correspond to the
+			vertices, edges, and faces of the input mesh. The
+			arrays are indexed by the slot of an element and store
+			the index of the point in the output sink, or
+			mesh_sink::NO_VERTEX if there is no such point. They
+			are only valid during a single subdivision step.
+			Storing them here instead of in the elements keeps the
+			input mesh unchanged.
+		*/
+
+		std::vector<size_t> vertex_points;
+		std::vector<size_t> edge_points;
+		std::vector<size_t> face_points;
 
 		bool preserve_boundaries;	///< Flag signalling that boundaries of open meshes need to be preserved
 		bool handle_creases;		///< Flag signalling that creases should be handled instead of ignored
@@ -66,6 +121,8 @@ class SubdivisionAlgorithm
 		*/
 
 		bool use_geometric_point_creation;
+
+		size_t last_percentage;	///< Last percentage shown by print_progress()
 };
 
 /*!
@@ -82,9 +139,7 @@ inline void SubdivisionAlgorithm::print_progress(std::string message, size_t cur
 		return;
 
 	size_t percentage = (cur_pos*100)/max_pos;
-	static size_t last;
-
-	if(percentage - last < 5 && cur_pos != max_pos)
+	if(percentage - last_percentage < 5 && cur_pos != max_pos)
 		return;
 
 	std::cerr	<< "\r" << std::left << std::setw(50) << message << ": "
@@ -100,7 +155,7 @@ inline void SubdivisionAlgorithm::print_progress(std::string message, size_t cur
 	if(cur_pos == max_pos)
 		std::cerr << std::endl;
 
-	last = percentage;
+	last_percentage = percentage;
 }
 
 
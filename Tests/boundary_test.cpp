@@ -0,0 +1,245 @@
+/*!
+*	@file	boundary_test.cpp
+*	@brief	Checks the list of boundary edges and the boundary loops
+*
+*	For every mesh that is specified on the command line and for several
+*	synthetic meshes, the boundary edges that are tracked by the mesh are
+*	compared with the edges that have exactly one adjacent face. The loops
+*	returned by mesh::boundary_loops() have to consist of these edges, and
+*	they have to be closed and oriented like their faces. The program
+*	returns the number of failed checks.
+*/
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+
+#include "mesh.h"
+
+/*!
+*	Finds the boundary edge between two vertices.
+*
+*	@return Edge or NULL if the vertices are not connected by a boundary
+*	edge
+*/
+
+psalm::edge* find_boundary_edge(psalm::vertex* u, psalm::vertex* v)
+{
+	for(size_t i = 0; i < u->valency(); i++)
+	{
+		psalm::edge* e = u->get_edge(i);
+		if(	(e->get_u() == v || e->get_v() == v) &&
+			(e->get_f() == NULL) != (e->get_g() == NULL))
+			return(e);
+	}
+
+	return(NULL);
+}
+
+/*!
+*	@return true if the face traverses the edge from u to v
+*/
+
+bool traverses(const psalm::face* f, const psalm::vertex* u, const psalm::vertex* v)
+{
+	size_t n = f->num_vertices();
+	for(size_t i = 0; i < n; i++)
+	{
+		if(f->get_vertex(i) == u && f->get_vertex((i+1) % n) == v)
+			return(true);
+	}
+
+	return(false);
+}
+
+/*!
+*	Checks the boundary edges and the boundary loops of a mesh.
+*
+*	@param M		Mesh to check
+*	@param num_loops	Expected number of loops or -1 if the number is
+*				not known
+*
+*	@return Description of the first problem or an empty string if the
+*	boundary is correct
+*/
+
+std::string check_boundary(psalm::mesh& M, long num_loops)
+{
+	std::ostringstream out;
+
+	std::set<psalm::edge*> boundary_edges;
+	for(size_t i = 0; i < M.num_edges(); i++)
+	{
+		psalm::edge* e = M.get_edge(i);
+		if(e != NULL && (e->get_f() == NULL) != (e->get_g() == NULL))
+			boundary_edges.insert(e);
+	}
+
+	if(boundary_edges.size() != M.num_boundary_edges())
+	{
+		out << "number of boundary edges differs (" << boundary_edges.size() << " vs. " << M.num_boundary_edges() << ")";
+		return(out.str());
+	}
+
+	for(size_t i = 0; i < M.num_boundary_edges(); i++)
+	{
+		if(boundary_edges.count(M.get_boundary_edge(i)) == 0)
+		{
+			out << "boundary edge " << i << " has " << (M.get_boundary_edge(i)->get_f() ? "two" : "no") << " faces";
+			return(out.str());
+		}
+	}
+
+	std::vector< std::vector<psalm::vertex*> > loops = M.boundary_loops();
+	if(num_loops >= 0 && loops.size() != static_cast<size_t>(num_loops))
+	{
+		out << "number of loops differs (" << num_loops << " vs. " << loops.size() << ")";
+		return(out.str());
+	}
+
+	std::set<psalm::edge*> visited;
+	for(size_t i = 0; i < loops.size(); i++)
+	{
+		const std::vector<psalm::vertex*>& loop = loops[i];
+		for(size_t j = 0; j < loop.size(); j++)
+		{
+			psalm::vertex* u = loop[j];
+			psalm::vertex* v = loop[(j+1) % loop.size()];
+
+			psalm::edge* e = find_boundary_edge(u, v);
+			if(e == NULL)
+			{
+				out << "loop " << i << " is not connected at vertex " << j;
+				return(out.str());
+			}
+			else if(!visited.insert(e).second)
+			{
+				out << "loop " << i << " visits an edge twice at vertex " << j;
+				return(out.str());
+			}
+			else if(!traverses(e->get_f() ? e->get_f() : e->get_g(), u, v))
+			{
+				out << "loop " << i << " is oriented incorrectly at vertex " << j;
+				return(out.str());
+			}
+		}
+	}
+
+	if(visited.size() != boundary_edges.size())
+	{
+		out << "loops contain " << visited.size() << " of " << boundary_edges.size() << " boundary edges";
+		return(out.str());
+	}
+
+	return(out.str());
+}
+
+/*!
+*	Prints the result of a check.
+*
+*	@return 1 if the check failed, else 0
+*/
+
+int report(const std::string& name, const std::string& problem)
+{
+	std::cout << name << ": ";
+	if(problem.empty())
+	{
+		std::cout << "ok\n";
+		return(0);
+	}
+
+	std::cout << "FAILED (" << problem << ")\n";
+	return(1);
+}
+
+/*!
+*	Creates a planar grid of quadrangles with counterclockwise
+*	orientation.
+*
+*	@param M Mesh that will contain the grid; should be empty
+*	@param n Number of quadrangles along each side
+*/
+
+void create_grid(psalm::mesh& M, size_t n)
+{
+	for(size_t i = 0; i <= n; i++)
+	{
+		for(size_t j = 0; j <= n; j++)
+			M.add_vertex(static_cast<double>(j), static_cast<double>(i), 0.0);
+	}
+
+	for(size_t i = 0; i < n; i++)
+	{
+		for(size_t j = 0; j < n; j++)
+		{
+			size_t k = i*(n+1)+j;
+			M.add_face(	M.get_vertex(k),
+					M.get_vertex(k+1),
+					M.get_vertex(k+n+2),
+					M.get_vertex(k+n+1));
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	int failures = 0;
+
+	for(int i = 1; i < argc; i++)
+	{
+		psalm::mesh M;
+		if(!M.load(argv[i]))
+		{
+			std::cout << argv[i] << ": FAILED (unable to load mesh)\n";
+			failures++;
+			continue;
+		}
+
+		failures += report(argv[i], check_boundary(M, -1));
+	}
+
+	// A single loop around a grid
+
+	psalm::mesh grid;
+	create_grid(grid, 3);
+
+	failures += report("grid", check_boundary(grid, 1));
+
+	// Removing the central face creates a second loop; removing the
+	// remaining faces one by one finally leaves no boundary at all
+
+	grid.remove_face(grid.get_face(4));
+	failures += report("grid with hole", check_boundary(grid, 2));
+
+	grid.compact();
+	while(grid.num_faces() > 0)
+	{
+		grid.remove_face(grid.get_face(grid.num_faces()-1));
+		grid.compact();
+
+		std::ostringstream name;
+		name << "grid (remaining faces: " << grid.num_faces() << ")";
+
+		failures += report(name.str(), check_boundary(grid, grid.num_faces() > 0 ? -1 : 0));
+	}
+
+	// Two triangles that share a single vertex; the loops touch each other
+	// at this vertex
+
+	psalm::mesh bowtie;
+	psalm::vertex* v[5];
+	v[0] = bowtie.add_vertex( 0.0, 0.0, 0.0);
+	v[1] = bowtie.add_vertex( 1.0,-1.0, 0.0);
+	v[2] = bowtie.add_vertex( 1.0, 1.0, 0.0);
+	v[3] = bowtie.add_vertex(-1.0, 1.0, 0.0);
+	v[4] = bowtie.add_vertex(-1.0,-1.0, 0.0);
+
+	bowtie.add_face(v[0], v[1], v[2]);
+	bowtie.add_face(v[0], v[3], v[4]);
+
+	failures += report("bowtie", check_boundary(bowtie, -1));
+	return(failures);
+}
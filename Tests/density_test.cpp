@@ -38,6 +38,7 @@ std::pair<double, double> area_and_density(psalm::mesh& M, double initial_area =
 int main(int argc, char* argv[])
 {
 	psalm::mesh M;
+	psalm::mesh original;
 	psalm::Liepa liepa_scheme;
 
 	if(argc == 1)
@@ -45,8 +46,8 @@ int main(int argc, char* argv[])
 
 	for(int i = 2; i < argc; i++)
 	{
-		M.load(argv[i]);
-		std::pair<double, double> area_density = area_and_density(M);
+		original.load(argv[i]);
+		std::pair<double, double> area_density = area_and_density(original);
 
 		double initial_area = area_density.first;
 		double initial_density = area_density.second;
@@ -59,7 +60,8 @@ int main(int argc, char* argv[])
 		{
 			double alpha = j*0.1;
 
-			M.load(argv[i]);
+			// Cheaper than reloading the file for every value
+			original.clone(M);
 
 			liepa_scheme.set_alpha(alpha);
 			liepa_scheme.apply_to(M);
@@ -0,0 +1,191 @@
+/*!
+*	@file	edge_table_benchmark.cpp
+*	@brief	Compares the hash-based edge table with an std::map
+*
+*	For every mesh that is specified on the command line, the edge keys of
+*	all faces are inserted into both containers in the same order in which
+*	mesh::add_face() would insert them. Afterwards, all keys are looked up
+*	and erased again.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <map>
+#include <utility>
+#include <ctime>
+
+#include "mesh.h"
+#include "edge_table.h"
+
+typedef std::pair<size_t, size_t> key_type;
+
+const size_t num_repetitions = 50;
+
+/*!
+*	@return Seconds elapsed since the given start time
+*/
+
+double elapsed(std::clock_t start)
+{
+	return(static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC);
+}
+
+/*!
+*	Collects the edge keys of all faces of the mesh, including duplicates
+*	for edges that are shared by two faces.
+*/
+
+std::vector<key_type> collect_keys(psalm::mesh& M)
+{
+	std::vector<key_type> keys;
+	for(size_t i = 0; i < M.num_faces(); i++)
+	{
+		psalm::face* f = M.get_face(i);
+		for(size_t j = 0; j < f->num_vertices(); j++)
+		{
+			size_t u = f->get_vertex(j)->get_slot();
+			size_t v = f->get_vertex((j+1) % f->num_vertices())->get_slot();
+
+			keys.push_back(u < v ? key_type(u,v) : key_type(v,u));
+		}
+	}
+
+	return(keys);
+}
+
+/*!
+*	Runs the benchmark for std::map.
+*
+*	@return Checksum; prevents the compiler from removing the loops
+*/
+
+size_t benchmark_map(const std::vector<key_type>& keys, double times[3])
+{
+	size_t checksum = 0;
+	times[0] = times[1] = times[2] = 0.0;
+
+	for(size_t r = 0; r < num_repetitions; r++)
+	{
+		std::map<key_type, size_t> M;
+
+		std::clock_t start = std::clock();
+		for(size_t i = 0; i < keys.size(); i++)
+		{
+			if(M.find(keys[i]) == M.end())
+				M[keys[i]] = i;
+		}
+		times[0] += elapsed(start);
+
+		start = std::clock();
+		for(size_t i = 0; i < keys.size(); i++)
+			checksum += M.find(keys[i])->second;
+		times[1] += elapsed(start);
+
+		start = std::clock();
+		for(size_t i = 0; i < keys.size(); i++)
+			M.erase(keys[i]);
+		times[2] += elapsed(start);
+	}
+
+	return(checksum);
+}
+
+/*!
+*	Runs the benchmark for the edge table.
+*
+*	@return Checksum; prevents the compiler from removing the loops
+*/
+
+size_t benchmark_edge_table(const std::vector<key_type>& keys, double times[3], bool reserve)
+{
+	size_t checksum = 0;
+	times[0] = times[1] = times[2] = 0.0;
+
+	for(size_t r = 0; r < num_repetitions; r++)
+	{
+		psalm::edge_table<size_t> T;
+
+		std::clock_t start = std::clock();
+		if(reserve)
+			T.reserve(keys.size()/2);
+
+		for(size_t i = 0; i < keys.size(); i++)
+		{
+			if(T.find(keys[i]) == NULL)
+				T.insert(keys[i], i);
+		}
+		times[0] += elapsed(start);
+
+		start = std::clock();
+		for(size_t i = 0; i < keys.size(); i++)
+			checksum += *T.find(keys[i]);
+		times[1] += elapsed(start);
+
+		start = std::clock();
+		for(size_t i = 0; i < keys.size(); i++)
+			T.erase(keys[i]);
+		times[2] += elapsed(start);
+	}
+
+	return(checksum);
+}
+
+void print_times(const std::string& name, const double times[3])
+{
+	std::cout	<< std::setw(24) << std::left << name
+			<< std::fixed << std::setprecision(4)
+			<< std::setw(12) << std::right << times[0]
+			<< std::setw(12) << std::right << times[1]
+			<< std::setw(12) << std::right << times[2]
+			<< "\n";
+}
+
+int main(int argc, char* argv[])
+{
+	if(argc == 1)
+	{
+		std::cerr << "Usage: edge_table_benchmark FILE...\n";
+		return(-1);
+	}
+
+	for(int i = 1; i < argc; i++)
+	{
+		psalm::mesh M;
+		if(!M.load(argv[i]))
+			continue;
+
+		std::vector<key_type> keys = collect_keys(M);
+
+		std::cout	<< argv[i] << ": "
+				<< M.num_edges() << " edges, "
+				<< keys.size() << " lookups, "
+				<< num_repetitions << " repetitions\n";
+
+		std::cout	<< std::setw(24) << std::left << "container"
+				<< std::setw(12) << std::right << "insert [s]"
+				<< std::setw(12) << std::right << "find [s]"
+				<< std::setw(12) << std::right << "erase [s]"
+				<< "\n";
+
+		double times[3];
+		size_t checksum_map = benchmark_map(keys, times);
+		print_times("std::map", times);
+
+		size_t checksum_table = benchmark_edge_table(keys, times, false);
+		print_times("edge_table", times);
+
+		size_t checksum_reserved = benchmark_edge_table(keys, times, true);
+		print_times("edge_table (reserved)", times);
+
+		if(checksum_map != checksum_table || checksum_map != checksum_reserved)
+		{
+			std::cerr << "psalm: Error: Checksums do not match\n";
+			return(-1);
+		}
+
+		std::cout << "\n";
+	}
+
+	return(0);
+}
@@ -0,0 +1,340 @@
+/*!
+*	@file	half_edge_test.cpp
+*	@brief	Checks the conversion between mesh and half_edge_mesh
+*
+*	For every mesh that is specified on the command line, the half-edge
+*	mesh is compared with the original mesh: It has to contain the same
+*	vertices, edges and faces, its links have to be consistent, and the
+*	valency and boundary status of every vertex have to match. Converting
+*	back has to yield the original mesh. Finally, the mesh is converted
+*	after removing a vertex and some faces; the result has to match the
+*	conversion of the compacted mesh. The program returns the number of
+*	failed checks.
+*/
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+
+#include "mesh.h"
+#include "half_edge_mesh.h"
+
+using psalm::half_edge_mesh;
+
+/*!
+*	@return Number of edges of the vertex that have only one adjacent
+*	face. The boundary flag of the vertex cannot be used instead because it
+*	is only set by the subdivision algorithms.
+*/
+
+size_t num_boundary_edges(psalm::vertex* v)
+{
+	size_t n = 0;
+	for(size_t i = 0; i < v->valency(); i++)
+	{
+		const psalm::edge* e = v->get_edge(i);
+		if(e->get_f() == NULL || e->get_g() == NULL)
+			n++;
+	}
+
+	return(n);
+}
+
+/*!
+*	Counts the fans of faces around a vertex, i.e. groups of faces that are
+*	connected via the edges of the vertex. Manifold vertices have at most
+*	one fan.
+*/
+
+size_t num_fans(psalm::vertex* v)
+{
+	size_t n = v->num_adjacent_faces();
+
+	std::vector<size_t> fan(n);
+	for(size_t i = 0; i < n; i++)
+		fan[i] = i;
+
+	for(size_t i = 0; i < v->valency(); i++)
+	{
+		const psalm::edge* e = v->get_edge(i);
+		if(e->get_f() == NULL || e->get_g() == NULL)
+			continue;
+
+		size_t a = n;
+		size_t b = n;
+		for(size_t j = 0; j < n; j++)
+		{
+			if(v->get_face(j) == e->get_f())
+				a = fan[j];
+			else if(v->get_face(j) == e->get_g())
+				b = fan[j];
+		}
+
+		if(a == n || b == n)
+			continue;
+
+		for(size_t j = 0; j < n; j++)
+		{
+			if(fan[j] == b)
+				fan[j] = a;
+		}
+	}
+
+	return(std::set<size_t>(fan.begin(), fan.end()).size());
+}
+
+/*!
+*	Checks that a half-edge mesh contains the same elements as a mesh
+*	without removed elements and that all links are consistent.
+*
+*	@return Description of the first problem or an empty string if the
+*	meshes are equal
+*/
+
+std::string compare_with_mesh(const half_edge_mesh& H, psalm::mesh& M)
+{
+	std::ostringstream out;
+
+	if(H.num_vertices() != M.num_vertices() || H.num_faces() != M.num_faces() || H.num_edges() != M.num_edges())
+	{
+		out	<< "number of elements differs ("
+			<< H.num_vertices() << "/" << H.num_edges() << "/" << H.num_faces() << " vs. "
+			<< M.num_vertices() << "/" << M.num_edges() << "/" << M.num_faces() << ")";
+		return(out.str());
+	}
+
+	for(size_t i = 0; i < M.num_vertices(); i++)
+	{
+		psalm::vertex* v = M.get_vertex(i);
+		half_edge_mesh::index j = static_cast<half_edge_mesh::index>(i);
+
+		if((H.get_position(j) - v->get_position()).length() != 0.0)
+		{
+			out << "position of vertex " << i << " differs";
+			return(out.str());
+		}
+		// The half-edge mesh only traverses one fan of a non-manifold
+		// vertex
+
+		size_t n = num_boundary_edges(v);
+		if(num_fans(v) <= 1 && H.valency(j) != v->valency())
+		{
+			out << "valency of vertex " << i << " differs (" << H.valency(j) << " vs. " << v->valency() << ")";
+			return(out.str());
+		}
+		else if(H.is_vertex_on_boundary(j) != (v->valency() == 0 || n > 0))
+		{
+			out << "boundary status of vertex " << i << " differs";
+			return(out.str());
+		}
+	}
+
+	for(size_t i = 0; i < M.num_faces(); i++)
+	{
+		const psalm::face* f = M.get_face(i);
+		half_edge_mesh::index h = H.get_face(i);
+
+		if(H.num_face_vertices(static_cast<half_edge_mesh::index>(i)) != f->num_vertices())
+		{
+			out << "number of vertices of face " << i << " differs";
+			return(out.str());
+		}
+
+		for(size_t j = 0; j < f->num_vertices(); j++)
+		{
+			if(	H.get_origin(h) != f->get_vertex(j)->get_slot() ||
+				H.get_face_of(h) != i ||
+				H.get_origin(H.get_next(h)) != H.get_target(h) ||
+				H.get_prev(H.get_next(h)) != h)
+			{
+				out << "half-edges of face " << i << " are inconsistent at vertex " << j;
+				return(out.str());
+			}
+
+			h = H.get_next(h);
+		}
+
+		if(h != H.get_face(i))
+		{
+			out << "half-edges of face " << i << " do not form a cycle";
+			return(out.str());
+		}
+	}
+
+	for(size_t i = 0; i < M.num_edges(); i++)
+	{
+		const psalm::edge* e = M.get_edge(i);
+
+		half_edge_mesh::index u = static_cast<half_edge_mesh::index>(e->get_u()->get_slot());
+		half_edge_mesh::index v = static_cast<half_edge_mesh::index>(e->get_v()->get_slot());
+		half_edge_mesh::index h = H.find_half_edge(u, v);
+
+		if(	h == half_edge_mesh::invalid ||
+			H.get_origin(h) != u ||
+			H.get_target(h) != v ||
+			H.find_half_edge(v, u) != H.get_twin(h))
+		{
+			out << "edge " << i << " is missing";
+			return(out.str());
+		}
+		else if(H.is_on_boundary(h) && H.is_on_boundary(H.get_twin(h)))
+		{
+			out << "edge " << i << " has no faces";
+			return(out.str());
+		}
+	}
+
+	return(out.str());
+}
+
+/*!
+*	Checks that two half-edge meshes are equal.
+*
+*	@return Description of the first difference or an empty string if the
+*	meshes are equal
+*/
+
+std::string compare_half_edge_meshes(const half_edge_mesh& A, const half_edge_mesh& B)
+{
+	std::ostringstream out;
+
+	if(A.num_vertices() != B.num_vertices() || A.num_faces() != B.num_faces() || A.num_edges() != B.num_edges())
+	{
+		out	<< "number of elements differs ("
+			<< A.num_vertices() << "/" << A.num_edges() << "/" << A.num_faces() << " vs. "
+			<< B.num_vertices() << "/" << B.num_edges() << "/" << B.num_faces() << ")";
+		return(out.str());
+	}
+
+	for(size_t i = 0; i < A.num_vertices(); i++)
+	{
+		half_edge_mesh::index v = static_cast<half_edge_mesh::index>(i);
+		if((A.get_position(v) - B.get_position(v)).length() != 0.0)
+		{
+			out << "position of vertex " << i << " differs";
+			return(out.str());
+		}
+	}
+
+	for(size_t i = 0; i < A.num_faces(); i++)
+	{
+		half_edge_mesh::index g = A.get_face(i);
+		half_edge_mesh::index h = B.get_face(i);
+
+		do
+		{
+			if(A.get_origin(g) != B.get_origin(h))
+			{
+				out << "vertices of face " << i << " differ";
+				return(out.str());
+			}
+
+			g = A.get_next(g);
+			h = B.get_next(h);
+		}
+		while(g != A.get_face(i) && h != B.get_face(i));
+
+		if(g != A.get_face(i) || h != B.get_face(i))
+		{
+			out << "number of vertices of face " << i << " differs";
+			return(out.str());
+		}
+	}
+
+	return(out.str());
+}
+
+/*!
+*	Prints the result of a check.
+*
+*	@return 1 if the check failed, else 0
+*/
+
+int report(const std::string& name, const std::string& check, const std::string& problem)
+{
+	std::cout << name << ": " << check << ": ";
+	if(problem.empty())
+	{
+		std::cout << "ok\n";
+		return(0);
+	}
+
+	std::cout << "FAILED (" << problem << ")\n";
+	return(1);
+}
+
+int main(int argc, char* argv[])
+{
+	int failures = 0;
+
+	for(int i = 1; i < argc; i++)
+	{
+		psalm::mesh M;
+		if(!M.load(argv[i]))
+		{
+			std::cout << argv[i] << ": FAILED (unable to load mesh)\n";
+			failures++;
+			continue;
+		}
+
+		half_edge_mesh H;
+		if(!H.from_mesh(M))
+		{
+			failures += report(argv[i], "conversion", "unable to convert mesh");
+			continue;
+		}
+
+		failures += report(argv[i], "conversion", compare_with_mesh(H, M));
+
+		// Converting back has to yield the same mesh
+
+		psalm::mesh N;
+		if(!H.to_mesh(N))
+			failures += report(argv[i], "round trip", "unable to convert half-edge mesh");
+		else
+			failures += report(argv[i], "round trip", compare_with_mesh(H, N));
+
+		// Create a copy of the mesh with an additional vertex in the first
+		// slot, remove this vertex as well as some faces, and compare the
+		// conversion with the conversion of the compacted mesh
+
+		psalm::mesh T;
+		std::vector<psalm::vertex*> vertices;
+
+		psalm::vertex* isolated = T.add_vertex(0.0, 0.0, 0.0);
+		for(size_t j = 0; j < M.num_vertices(); j++)
+			vertices.push_back(T.add_vertex(M.get_vertex(j)->get_position()));
+
+		std::vector<psalm::vertex*> face_vertices;
+		for(size_t j = 0; j < M.num_faces(); j++)
+		{
+			const psalm::face* f = M.get_face(j);
+
+			face_vertices.clear();
+			for(size_t k = 0; k < f->num_vertices(); k++)
+				face_vertices.push_back(vertices[f->get_vertex(k)->get_slot()]);
+
+			T.add_face(face_vertices, true);
+		}
+
+		T.remove_vertex(isolated);
+		for(size_t j = 0; j < T.num_faces(); j += 3)
+			T.remove_face(T.get_face(j));
+
+		half_edge_mesh A;
+		half_edge_mesh B;
+
+		psalm::mesh C;
+		T.clone(C);
+		C.compact();
+
+		if(!A.from_mesh(T) || !B.from_mesh(C))
+			failures += report(argv[i], "removed elements", "unable to convert mesh");
+		else
+			failures += report(argv[i], "removed elements", compare_half_edge_meshes(A, B));
+	}
+
+	return(failures);
+}
@@ -0,0 +1,640 @@
+/*!
+*	@file	io_test.cpp
+*	@brief	Checks that meshes are unchanged after saving and loading them
+*
+*	Every mesh that is specified on the command line is saved in several
+*	formats and loaded again. The loaded mesh is compared with the
+*	original one. Furthermore, subdivided meshes that are written without
+*	building their topology are compared with the subdivided meshes. The
+*	program returns the number of failed checks.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <set>
+#include <algorithm>
+#include <cstdio>
+#include <cmath>
+
+#include <boost/cstdint.hpp>
+
+#include "mesh.h"
+#include "mesh_stream.h"
+#include "ply.h"
+#include "SubdivisionAlgorithms/CatmullClark.h"
+#include "SubdivisionAlgorithms/DooSabin.h"
+#include "SubdivisionAlgorithms/Loop.h"
+
+/*!
+*	@return true if the face is stored in the mesh, i.e. it has not been
+*	removed from the mesh
+*/
+
+bool is_stored_face(const psalm::mesh& M, const psalm::face* f)
+{
+	return(f == NULL || (f->get_slot() < M.num_faces() && M.get_face(f->get_slot()) == f));
+}
+
+/*!
+*	@return Slot of a face or -1 if the face is NULL
+*/
+
+long face_slot(const psalm::face* f)
+{
+	return(f ? static_cast<long>(f->get_slot()) : -1);
+}
+
+/*!
+*	Compares the vertex positions and the faces of two meshes. Faces are
+*	compared by the slots of their vertices.
+*
+*	@param A		First mesh
+*	@param B		Second mesh
+*	@param tolerance	Maximum difference of coordinates
+*
+*	@return Description of the first difference or an empty string if
+*	the meshes are equal
+*/
+
+std::string compare_geometry(psalm::mesh& A, psalm::mesh& B, double tolerance)
+{
+	std::ostringstream out;
+
+	if(A.num_vertices() != B.num_vertices())
+	{
+		out << "number of vertices differs (" << A.num_vertices() << " vs. " << B.num_vertices() << ")";
+		return(out.str());
+	}
+
+	for(size_t i = 0; i < A.num_vertices(); i++)
+	{
+		const v3ctor& p = A.get_vertex(i)->get_position();
+		const v3ctor& q = B.get_vertex(i)->get_position();
+
+		for(short k = 0; k < 3; k++)
+		{
+			if(std::fabs(p[k]-q[k]) > tolerance)
+			{
+				out << "position of vertex " << i << " differs";
+				return(out.str());
+			}
+		}
+	}
+
+	if(A.num_faces() != B.num_faces())
+	{
+		out << "number of faces differs (" << A.num_faces() << " vs. " << B.num_faces() << ")";
+		return(out.str());
+	}
+
+	for(size_t i = 0; i < A.num_faces(); i++)
+	{
+		const psalm::face* f = A.get_face(i);
+		const psalm::face* g = B.get_face(i);
+
+		bool equal = (f->num_vertices() == g->num_vertices());
+		for(size_t j = 0; equal && j < f->num_vertices(); j++)
+			equal = (f->get_vertex(j)->get_slot() == g->get_vertex(j)->get_slot());
+
+		if(!equal)
+		{
+			out << "vertices of face " << i << " differ";
+			return(out.str());
+		}
+	}
+
+	return(out.str());
+}
+
+/*!
+*	Compares two meshes including their adjacency information, i.e. the
+*	edges, the neighbours of all vertices, and the set of boundary edges.
+*	Elements are compared by their slots. The second mesh must not refer
+*	to faces that are not stored in it.
+*
+*	@return Description of the first difference or an empty string if
+*	the meshes are equal
+*/
+
+std::string compare_topology(psalm::mesh& A, psalm::mesh& B)
+{
+	std::string result = compare_geometry(A, B, 0.0);
+	if(!result.empty())
+		return(result);
+
+	std::ostringstream out;
+
+	for(size_t i = 0; i < A.num_vertices(); i++)
+	{
+		const psalm::vertex* v = A.get_vertex(i);
+		const psalm::vertex* w = B.get_vertex(i);
+
+		bool equal = (	v->get_id() == w->get_id() &&
+				v->is_on_boundary() == w->is_on_boundary() &&
+				v->valency() == w->valency() &&
+				v->num_adjacent_faces() == w->num_adjacent_faces());
+
+		for(size_t j = 0; equal && j < v->valency(); j++)
+			equal = (v->get_edge(j)->get_slot() == w->get_edge(j)->get_slot());
+
+		for(size_t j = 0; equal && j < v->num_adjacent_faces(); j++)
+		{
+			equal = (	v->get_face(j)->get_slot() == w->get_face(j)->get_slot() &&
+					is_stored_face(B, w->get_face(j)));
+		}
+
+		if(!equal)
+		{
+			out << "adjacency of vertex " << i << " differs";
+			return(out.str());
+		}
+	}
+
+	if(A.num_edges() != B.num_edges())
+	{
+		out << "number of edges differs (" << A.num_edges() << " vs. " << B.num_edges() << ")";
+		return(out.str());
+	}
+
+	for(size_t i = 0; i < A.num_edges(); i++)
+	{
+		const psalm::edge* e = A.get_edge(i);
+		const psalm::edge* d = B.get_edge(i);
+
+		if(	e->get_u()->get_slot() != d->get_u()->get_slot() ||
+			e->get_v()->get_slot() != d->get_v()->get_slot() ||
+			face_slot(e->get_f()) != face_slot(d->get_f()) ||
+			face_slot(e->get_g()) != face_slot(d->get_g()) ||
+			!is_stored_face(B, d->get_f()) ||
+			!is_stored_face(B, d->get_g()))
+		{
+			out << "edge " << i << " differs";
+			return(out.str());
+		}
+	}
+
+	if(A.num_boundary_edges() != B.num_boundary_edges())
+	{
+		out << "number of boundary edges differs (" << A.num_boundary_edges() << " vs. " << B.num_boundary_edges() << ")";
+		return(out.str());
+	}
+
+	// The order of the boundary edges is arbitrary
+
+	std::set<size_t> boundary_edges;
+	for(size_t i = 0; i < A.num_boundary_edges(); i++)
+		boundary_edges.insert(A.get_boundary_edge(i)->get_slot());
+
+	for(size_t i = 0; i < B.num_boundary_edges(); i++)
+	{
+		if(boundary_edges.count(B.get_boundary_edge(i)->get_slot()) == 0)
+		{
+			out << "boundary edge " << i << " differs";
+			return(out.str());
+		}
+	}
+
+	return(out.str());
+}
+
+/*!
+*	Prints the result of a check.
+*
+*	@return 1 if the check failed, else 0
+*/
+
+int report(const std::string& name, const std::string& check, const std::string& difference)
+{
+	std::cout << name << ": " << check << ": ";
+	if(difference.empty())
+	{
+		std::cout << "ok\n";
+		return(0);
+	}
+
+	std::cout << "FAILED (" << difference << ")\n";
+	return(1);
+}
+
+/*!
+*	Writes a mesh as a binary PLY file in the given byte order. psalm only
+*	writes files in little-endian byte order, so this function is used for
+*	creating big-endian files. The coordinates are stored as doubles, so
+*	the mesh is loaded without any loss of precision.
+*
+*	@param M		Mesh to write
+*	@param filename		Name of the file
+*	@param big_endian	Flag signalling that the data should be stored
+*				in big-endian byte order
+*
+*	@return true if the file could be written, else false
+*/
+
+bool write_binary_ply(psalm::mesh& M, const std::string& filename, bool big_endian)
+{
+	bool swap = (big_endian == psalm::ply_header::is_little_endian_host());
+
+	std::vector<char> data;
+	for(size_t i = 0; i < M.num_vertices(); i++)
+	{
+		const v3ctor& p = M.get_vertex(i)->get_position();
+		for(short k = 0; k < 3; k++)
+			psalm::ply_header::encode(data, p[k], swap);
+	}
+
+	for(size_t i = 0; i < M.num_faces(); i++)
+	{
+		const psalm::face* f = M.get_face(i);
+
+		psalm::ply_header::encode(data, static_cast<boost::uint8_t>(f->num_vertices()), swap);
+		for(size_t j = 0; j < f->num_vertices(); j++)
+			psalm::ply_header::encode(data, static_cast<boost::int32_t>(f->get_vertex(j)->get_slot()), swap);
+	}
+
+	std::ofstream out(filename.c_str(), std::ios::binary);
+	out	<< "ply\n"
+		<< "format " << (big_endian ? "binary_big_endian" : "binary_little_endian") << " 1.0\n"
+		<< "element vertex " << M.num_vertices() << "\n"
+		<< "property double x\n"
+		<< "property double y\n"
+		<< "property double z\n"
+		<< "element face " << M.num_faces() << "\n"
+		<< "property list uchar int vertex_indices\n"
+		<< "end_header\n";
+
+	if(!data.empty())
+		out.write(&data[0], data.size());
+
+	return(out.good());
+}
+
+/*!
+*	Loads a file, removes it, and compares the loaded mesh with the
+*	expected mesh.
+*
+*	@param filename		Name of the file
+*	@param expected		Expected result of loading the file
+*	@param tolerance	Maximum difference of coordinates
+*
+*	@return Description of the first difference or an empty string if
+*	the meshes are equal
+*/
+
+std::string compare_file(const std::string& filename, psalm::mesh& expected, double tolerance)
+{
+	psalm::mesh loaded;
+	bool result = loaded.load(filename);
+
+	std::remove(filename.c_str());
+
+	if(!result)
+		return("unable to load mesh");
+
+	return(compare_geometry(expected, loaded, tolerance));
+}
+
+/*!
+*	Checks binary PLY files of a mesh. Files in both byte orders are
+*	created by write_binary_ply() and have to be read exactly. Files that
+*	are written by psalm store single-precision coordinates, so their
+*	coordinates may differ slightly.
+*
+*	@return Number of failed checks
+*/
+
+int test_binary_ply(const std::string& name, psalm::mesh& M)
+{
+	const std::string filename = "io_test.ply";
+
+	int failures = 0;
+
+	if(!write_binary_ply(M, filename, false))
+		failures += report(name, "binary PLY (little endian)", "unable to save mesh");
+	else
+		failures += report(name, "binary PLY (little endian)", compare_file(filename, M, 0.0));
+
+	if(!write_binary_ply(M, filename, true))
+		failures += report(name, "binary PLY (big endian)", "unable to save mesh");
+	else
+		failures += report(name, "binary PLY (big endian)", compare_file(filename, M, 0.0));
+
+	// Relative precision of single-precision numbers is about 6e-8
+	double max_coordinate = 0.0;
+	for(size_t i = 0; i < M.num_vertices(); i++)
+	{
+		const v3ctor& p = M.get_vertex(i)->get_position();
+		for(short k = 0; k < 3; k++)
+			max_coordinate = std::max(max_coordinate, std::fabs(p[k]));
+	}
+
+	if(!M.save(filename, psalm::mesh::TYPE_PLY, true))
+		failures += report(name, "binary PLY (psalm)", "unable to save mesh");
+	else
+		failures += report(name, "binary PLY (psalm)", compare_file(filename, M, 1e-6*max_coordinate));
+
+	return(failures);
+}
+
+/*!
+*	Saves a mesh with and without compression and compares the results of
+*	loading both files.
+*
+*	@param M		Mesh to save
+*	@param extension	Extension of the file format
+*	@param binary		Flag signalling binary PLY files
+*	@param compression	Extension of the compression format
+*
+*	@return Description of the first difference or an empty string if
+*	the meshes are equal
+*/
+
+std::string round_trip_compressed(psalm::mesh& M, const std::string& extension, bool binary, const std::string& compression)
+{
+	const std::string filename		= "io_test" + extension;
+	const std::string compressed_filename	= filename + compression;
+
+	psalm::mesh expected;
+	psalm::mesh loaded;
+
+	bool saved	= (	M.save(filename, psalm::mesh::TYPE_EXT, binary, psalm::mesh::COMPRESSION_NONE) &&
+				M.save(compressed_filename, psalm::mesh::TYPE_EXT, binary));
+	bool result	= saved && expected.load(filename) && loaded.load(compressed_filename);
+
+	std::remove(filename.c_str());
+	std::remove(compressed_filename.c_str());
+
+	if(!saved)
+		return("unable to save mesh");
+	else if(!result)
+		return("unable to load mesh");
+
+	return(compare_geometry(expected, loaded, 0.0));
+}
+
+/*!
+*	Checks compressed files of a mesh in all supported file formats and
+*	compression formats. The compression format is selected by the
+*	extension of the files. The mesh is also checked after two steps of
+*	Catmull-Clark subdivision, so that the data of larger meshes spans
+*	several blocks of the compressed streams.
+*
+*	@return Number of failed checks
+*/
+
+int test_compression(const std::string& name, psalm::mesh& M)
+{
+	std::vector<std::string> compressions;
+
+#ifdef PSALM_HAVE_ZLIB
+	compressions.push_back(".gz");
+#endif
+
+#ifdef PSALM_HAVE_ZSTD
+	compressions.push_back(".zst");
+#endif
+
+	psalm::mesh subdivided;
+	M.clone(subdivided);
+
+	psalm::CatmullClark catmull_clark;
+	catmull_clark.apply_to(subdivided, 2);
+
+	int failures = 0;
+	for(size_t i = 0; i < compressions.size(); i++)
+	{
+		const std::string& c = compressions[i];
+
+		failures += report(name, c + " (PLY)",			round_trip_compressed(M, ".ply", false, c));
+		failures += report(name, c + " (binary PLY)",		round_trip_compressed(M, ".ply", true, c));
+		failures += report(name, c + " (OBJ)",			round_trip_compressed(M, ".obj", false, c));
+		failures += report(name, c + " (OFF)",			round_trip_compressed(M, ".off", false, c));
+		failures += report(name, c + " (PSM)",			round_trip_compressed(M, ".psm", false, c));
+		failures += report(name, c + " (subdivided, OBJ)",	round_trip_compressed(subdivided, ".obj", false, c));
+	}
+
+	return(failures);
+}
+
+/*!
+*	Saves a mesh in PSM format, loads it again, and compares the result
+*	with the expected mesh.
+*
+*	@param M	Mesh to save
+*	@param expected	Expected result of loading the mesh
+*
+*	@return Description of the first difference or an empty string if
+*	the meshes are equal
+*/
+
+std::string round_trip_psm(psalm::mesh& M, psalm::mesh& expected)
+{
+	const std::string filename = "io_test.psm";
+
+	psalm::mesh loaded;
+	bool saved	= M.save(filename, psalm::mesh::TYPE_PSM);
+	bool result	= saved && loaded.load(filename);
+
+	std::remove(filename.c_str());
+
+	if(!saved)
+		return("unable to save mesh");
+	else if(!result)
+		return("unable to load mesh");
+
+	return(compare_topology(expected, loaded));
+}
+
+/*!
+*	Checks PSM files of a mesh. Faces that have been removed from a mesh
+*	may still be referenced by its edges and vertices, e.g. after pruning
+*	or after adding a face has failed. These references must not be
+*	stored; the loaded mesh is thus compared with a copy of the mesh,
+*	which does not contain them either.
+*
+*	@return Number of failed checks
+*/
+
+int test_psm(const std::string& name, psalm::mesh& M)
+{
+	int failures = 0;
+
+	psalm::mesh expected;
+	M.clone(expected);
+
+	failures += report(name, "PSM", round_trip_psm(M, expected));
+
+	// Remove all faces of the most frequent type and some vertices. Doo
+	// and Sabin's scheme creates faces of different types for every mesh.
+
+	psalm::DooSabin doo_sabin;
+
+	psalm::mesh pruned;
+	M.clone(pruned);
+	doo_sabin.apply_to(pruned);
+
+	std::set<size_t> remove_faces;
+	std::set<size_t> remove_vertices;
+
+	remove_faces.insert(4);
+	remove_vertices.insert(3);
+
+	pruned.prune(remove_faces, remove_vertices);
+	pruned.clone(expected);
+
+	failures += report(name, "PSM after pruning", round_trip_psm(pruned, expected));
+	return(failures);
+}
+
+/*!
+*	Reads a file completely.
+*
+*	@param filename	Name of the file
+*	@param data	Contents of the file
+*
+*	@return true if the file could be read, else false
+*/
+
+bool read_file(const std::string& filename, std::string& data)
+{
+	std::ifstream in(filename.c_str(), std::ios::binary);
+	if(!in.good())
+		return(false);
+
+	std::ostringstream buffer;
+	buffer << in.rdbuf();
+
+	data = buffer.str();
+	return(true);
+}
+
+/*!
+*	Subdivides a mesh once and compares the mesh with the faces that are
+*	streamed by the subdivision algorithm. Both results are saved as OFF
+*	files, which have to be equal. The files are not loaded for the
+*	comparison because loading them would reject the same faces as
+*	building the mesh.
+*
+*	@return Description of the first difference or an empty string if
+*	the results are equal
+*/
+
+std::string compare_stream(psalm::SubdivisionAlgorithm& algorithm, psalm::mesh& M)
+{
+	const std::string mesh_filename		= "io_test_mesh.off";
+	const std::string stream_filename	= "io_test_stream.off";
+
+	psalm::mesh materialized;
+	psalm::mesh penultimate;
+	psalm::mesh_stream stream;
+
+	M.clone(materialized);
+	M.clone(penultimate);
+
+	if(!algorithm.apply_to(materialized, 1) || !algorithm.apply_to(penultimate, 1, stream))
+		return("unable to subdivide mesh");
+
+	std::string A;
+	std::string B;
+
+	bool saved	= (	materialized.save(mesh_filename, psalm::mesh::TYPE_OFF) &&
+				stream.save(stream_filename, psalm::mesh::TYPE_OFF));
+	bool result	= saved && read_file(mesh_filename, A) && read_file(stream_filename, B);
+
+	std::remove(mesh_filename.c_str());
+	std::remove(stream_filename.c_str());
+
+	if(!saved)
+		return("unable to save mesh");
+	else if(!result)
+		return("unable to read file");
+
+	std::ostringstream out;
+	if(materialized.num_faces() != stream.num_faces())
+		out << "number of faces differs (" << materialized.num_faces() << " vs. " << stream.num_faces() << ")";
+	else if(A != B)
+		out << "files differ";
+
+	return(out.str());
+}
+
+/*!
+*	Checks that streaming the result of a subdivision algorithm yields the
+*	same faces as building the subdivided mesh. This includes faces that
+*	are rejected by mesh::add_face() for non-manifold meshes.
+*
+*	@return Number of failed checks
+*/
+
+int test_stream(const std::string& name, psalm::mesh& M)
+{
+	int failures = 0;
+
+	psalm::CatmullClark catmull_clark;
+	failures += report(name, "Catmull-Clark stream", compare_stream(catmull_clark, M));
+
+	bool triangular = true;
+	for(size_t i = 0; i < M.num_faces() && triangular; i++)
+		triangular = (M.get_face(i)->num_vertices() == 3);
+
+	if(triangular)
+	{
+		psalm::Loop loop;
+		failures += report(name, "Loop stream", compare_stream(loop, M));
+	}
+
+	return(failures);
+}
+
+/*!
+*	Creates a mesh for which adding a face fails because the face would
+*	overwrite the faces of an edge. The face remains referenced by some of
+*	its edges.
+*
+*	@param M Mesh that will contain the faces
+*/
+
+void create_non_manifold_mesh(psalm::mesh& M)
+{
+	psalm::vertex* v[5];
+	v[0] = M.add_vertex(0.0, 0.0, 0.0);
+	v[1] = M.add_vertex(1.0, 0.0, 0.0);
+	v[2] = M.add_vertex(0.0, 1.0, 0.0);
+	v[3] = M.add_vertex(0.0,-1.0, 0.0);
+	v[4] = M.add_vertex(0.0, 0.0, 1.0);
+
+	M.add_face(v[0], v[1], v[2]);
+	M.add_face(v[1], v[0], v[3]);
+	M.add_face(v[4], v[0], v[1]);
+}
+
+int main(int argc, char* argv[])
+{
+	int failures = 0;
+
+	for(int i = 1; i < argc; i++)
+	{
+		psalm::mesh M;
+		if(!M.load(argv[i]))
+		{
+			std::cout << argv[i] << ": FAILED (unable to load mesh)\n";
+			failures++;
+			continue;
+		}
+
+		failures += test_binary_ply(argv[i], M);
+		failures += test_compression(argv[i], M);
+		failures += test_psm(argv[i], M);
+		failures += test_stream(argv[i], M);
+	}
+
+	psalm::mesh M;
+	create_non_manifold_mesh(M);
+
+	failures += test_binary_ply("non-manifold mesh", M);
+	failures += test_compression("non-manifold mesh", M);
+	failures += test_psm("non-manifold mesh", M);
+	failures += test_stream("non-manifold mesh", M);
+	return(failures);
+}
@@ -0,0 +1,157 @@
+/*!
+*	@file	load_benchmark.cpp
+*	@brief	Measures the throughput of the mesh loaders
+*
+*	Every mesh that is specified on the command line is converted to all
+*	supported formats (ASCII PLY, binary PLY, OBJ, OFF, and PSM).
+*	Afterwards, every converted file is loaded repeatedly. The throughput
+*	is reported in MB/s of file data, using the wall-clock time of
+*	mesh::load(), which includes building the adjacency information.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <cstdio>
+
+#include <sys/time.h>
+
+#ifdef _OPENMP
+	#include <omp.h>
+#endif
+
+#include "mesh.h"
+
+const size_t num_repetitions = 5;
+
+/*!
+*	@return Wall-clock time in seconds
+*/
+
+double now()
+{
+	timeval tv;
+	gettimeofday(&tv, NULL);
+
+	return(tv.tv_sec + tv.tv_usec*1e-6);
+}
+
+/*!
+*	@return Size of the file in bytes or 0 if the file cannot be opened
+*/
+
+size_t file_size(const std::string& filename)
+{
+	std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+	in.seekg(0, std::ios::end);
+
+	return(in.good() ? static_cast<size_t>(in.tellg()) : 0);
+}
+
+/*!
+*	Loads a file repeatedly and prints the throughput.
+*
+*	@return false if the file could not be loaded
+*/
+
+bool benchmark_file(const std::string& name, const std::string& filename)
+{
+	double size = file_size(filename)/(1024.0*1024.0);
+	double best = 0.0;
+
+	for(size_t r = 0; r < num_repetitions; r++)
+	{
+		psalm::mesh M;
+
+		double start = now();
+		if(!M.load(filename))
+			return(false);
+
+		double time = now() - start;
+		if(r == 0 || time < best)
+			best = time;
+	}
+
+	std::cout	<< std::setw(16) << std::left << name
+			<< std::fixed << std::setprecision(2)
+			<< std::setw(12) << std::right << size
+			<< std::setprecision(4)
+			<< std::setw(12) << std::right << best
+			<< std::setprecision(2)
+			<< std::setw(12) << std::right << (best > 0.0 ? size/best : 0.0)
+			<< "\n";
+
+	return(true);
+}
+
+int main(int argc, char* argv[])
+{
+	if(argc == 1)
+	{
+		std::cerr << "Usage: load_benchmark FILE...\n";
+		return(-1);
+	}
+
+#ifdef _OPENMP
+	std::cout << "Threads: " << omp_get_max_threads() << "\n\n";
+#else
+	std::cout << "Threads: 1 (OpenMP is not available)\n\n";
+#endif
+
+	const size_t num_formats = 5;
+
+	const std::string filenames[num_formats] =
+	{
+		"load_benchmark_ascii.ply",
+		"load_benchmark_binary.ply",
+		"load_benchmark.obj",
+		"load_benchmark.off",
+		"load_benchmark.psm"
+	};
+
+	const std::string names[num_formats] =
+	{
+		"PLY (ASCII)",
+		"PLY (binary)",
+		"OBJ",
+		"OFF",
+		"PSM"
+	};
+
+	for(int i = 1; i < argc; i++)
+	{
+		psalm::mesh M;
+		if(!M.load(argv[i]))
+			continue;
+
+		std::cout	<< argv[i] << ": "
+				<< M.num_vertices() << " vertices, "
+				<< M.num_faces() << " faces, "
+				<< num_repetitions << " repetitions (best time is reported)\n";
+
+		std::cout	<< std::setw(16) << std::left << "format"
+				<< std::setw(12) << std::right << "size [MB]"
+				<< std::setw(12) << std::right << "time [s]"
+				<< std::setw(12) << std::right << "MB/s"
+				<< "\n";
+
+		M.save(filenames[0], psalm::mesh::TYPE_PLY);
+		M.save(filenames[1], psalm::mesh::TYPE_PLY, true);
+		M.save(filenames[2], psalm::mesh::TYPE_OBJ);
+		M.save(filenames[3], psalm::mesh::TYPE_OFF);
+		M.save(filenames[4], psalm::mesh::TYPE_PSM);
+
+		for(size_t j = 0; j < num_formats; j++)
+		{
+			if(!benchmark_file(names[j], filenames[j]))
+				std::cerr << "psalm: Error: Unable to load \"" << filenames[j] << "\"\n";
+
+			std::remove(filenames[j].c_str());
+		}
+
+		std::cout << "\n";
+	}
+
+	return(0);
+}
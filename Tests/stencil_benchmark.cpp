@@ -0,0 +1,201 @@
+/*!
+*	@file	stencil_benchmark.cpp
+*	@brief	Compares stencil tables with repeated subdivision
+*
+*	For every mesh that is specified on the command line, stencil tables
+*	are created for Catmull-Clark and (for triangular meshes) Loop
+*	subdivision. The control points are then deformed, and the subdivided
+*	mesh is calculated both by evaluating the stencil table and by
+*	applying the subdivision algorithm to the deformed mesh. The benchmark
+*	reports the wall-clock times of both methods and the largest distance
+*	between their results.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+
+#include <sys/time.h>
+
+#ifdef _OPENMP
+	#include <omp.h>
+#endif
+
+#include "mesh.h"
+#include "stencil_table.h"
+#include "SubdivisionAlgorithms/CatmullClark.h"
+#include "SubdivisionAlgorithms/Loop.h"
+
+const size_t num_repetitions = 5;
+
+/*!
+*	@return Wall-clock time in seconds
+*/
+
+double now()
+{
+	timeval tv;
+	gettimeofday(&tv, NULL);
+
+	return(tv.tv_sec + tv.tv_usec*1e-6);
+}
+
+/*!
+*	Creates a stencil table for a mesh, deforms the mesh, and compares the
+*	evaluation of the table with the subdivided deformed mesh.
+*
+*	@return false if the stencil table could not be created
+*/
+
+bool benchmark_algorithm(const std::string& name, psalm::SubdivisionAlgorithm& algorithm, const psalm::mesh& M, size_t steps)
+{
+	psalm::stencil_table stencils;
+	psalm::mesh refined;
+
+	double start = now();
+	if(!algorithm.create_stencil_table(M, steps, stencils, refined))
+		return(false);
+
+	double analysis = now() - start;
+
+	// Deform the control points
+	psalm::mesh deformed;
+	M.clone(deformed);
+
+	std::vector<v3ctor> control_points(M.num_vertices());
+	for(size_t i = 0; i < control_points.size(); i++)
+	{
+		v3ctor p = M.get_vertex(i)->get_position();
+		p *= 1.0 + 0.1*sin(static_cast<double>(i));
+
+		control_points[i] = p;
+		deformed.get_vertex(i)->set_position(p);
+	}
+
+	std::vector<v3ctor> refined_points;
+	double evaluation = 0.0;
+
+	for(size_t r = 0; r < num_repetitions; r++)
+	{
+		start = now();
+		stencils.apply(control_points, refined_points);
+
+		double time = now() - start;
+		if(r == 0 || time < evaluation)
+			evaluation = time;
+	}
+
+	start = now();
+	algorithm.apply_to(deformed, steps);
+
+	double subdivision = now() - start;
+
+	double max_distance = 0.0;
+	if(deformed.num_vertices() != refined_points.size())
+		max_distance = std::numeric_limits<double>::infinity();
+	else
+	{
+		for(size_t i = 0; i < refined_points.size(); i++)
+		{
+			double distance = (deformed.get_vertex(i)->get_position() - refined_points[i]).length();
+			if(distance > max_distance)
+				max_distance = distance;
+		}
+	}
+
+	std::cout	<< std::setw(8) << std::left << name
+			<< std::setw(10) << std::right << stencils.num_rows()
+			<< std::setw(12) << std::right << stencils.num_entries()
+			<< std::fixed << std::setprecision(4)
+			<< std::setw(12) << std::right << analysis
+			<< std::setw(12) << std::right << evaluation
+			<< std::setw(12) << std::right << subdivision
+			<< std::scientific << std::setprecision(2)
+			<< std::setw(12) << std::right << max_distance
+			<< "\n";
+
+	return(true);
+}
+
+/*!
+*	Runs the benchmark for one algorithm and reports errors. Subdivision
+*	algorithms may throw exceptions for degenerate meshes; these are
+*	reported as well, so the remaining benchmarks are still run.
+*/
+
+void run_benchmark(const std::string& name, psalm::SubdivisionAlgorithm& algorithm, const psalm::mesh& M, size_t steps, const std::string& filename)
+{
+	try
+	{
+		if(!benchmark_algorithm(name, algorithm, M, steps))
+			std::cerr << "psalm: Error: Unable to create stencil table for \"" << filename << "\"\n";
+	}
+	catch(std::exception& e)
+	{
+		std::cerr << "psalm: Error: Unable to process \"" << filename << "\": " << e.what() << "\n";
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if(argc < 3)
+	{
+		std::cerr << "Usage: stencil_benchmark STEPS FILE...\n";
+		return(-1);
+	}
+
+	size_t steps = static_cast<size_t>(atoi(argv[1]));
+
+#ifdef _OPENMP
+	std::cout << "Threads: " << omp_get_max_threads() << "\n\n";
+#else
+	std::cout << "Threads: 1 (OpenMP is not available)\n\n";
+#endif
+
+	for(int i = 2; i < argc; i++)
+	{
+		psalm::mesh M;
+		if(!M.load(argv[i]))
+			continue;
+
+		std::cout	<< argv[i] << ": "
+				<< M.num_vertices() << " vertices, "
+				<< M.num_faces() << " faces, "
+				<< steps << " steps\n";
+
+		std::cout	<< std::setw(8) << std::left << "scheme"
+				<< std::setw(10) << std::right << "points"
+				<< std::setw(12) << std::right << "weights"
+				<< std::setw(12) << std::right << "analyse [s]"
+				<< std::setw(12) << std::right << "stencil [s]"
+				<< std::setw(12) << std::right << "subdiv. [s]"
+				<< std::setw(12) << std::right << "max. dist."
+				<< "\n";
+
+		psalm::CatmullClark catmull_clark;
+		run_benchmark("cc", catmull_clark, M, steps, argv[i]);
+
+		bool triangular = true;
+		for(size_t j = 0; j < M.num_faces(); j++)
+		{
+			if(M.get_face(j)->num_vertices() != 3)
+			{
+				triangular = false;
+				break;
+			}
+		}
+
+		psalm::Loop loop;
+		if(triangular)
+			run_benchmark("loop", loop, M, steps, argv[i]);
+
+		std::cout << "\n";
+	}
+
+	return(0);
+}
@@ -0,0 +1,354 @@
+/*!
+*	@file	stencil_test.cpp
+*	@brief	Checks stencil tables against repeated subdivision
+*
+*	For every mesh that is specified on the command line, stencil tables
+*	are created for one and two steps of Catmull-Clark and (for triangular
+*	meshes) Loop subdivision. The control points are then deformed, and
+*	the table is evaluated for the deformed points. The result has to
+*	match the deformed mesh after applying the subdivision algorithm, both
+*	in its vertex positions and in its faces. The program returns the
+*	number of failed checks.
+*
+*	If the subdivision algorithm itself fails for a mesh, the check is
+*	skipped because there is nothing to compare with.
+*
+*	Finally, a vertex and a face are removed from a copy of every mesh
+*	without compacting it. Subdividing this copy and evaluating its
+*	stencil table have to yield the same results as for the compacted
+*	copy.
+*/
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "mesh.h"
+#include "stencil_table.h"
+#include "SubdivisionAlgorithms/CatmullClark.h"
+#include "SubdivisionAlgorithms/Loop.h"
+
+/*!
+*	Compares a refined mesh that has been created via a stencil table with
+*	a subdivided mesh.
+*
+*	@param A		Refined mesh
+*	@param B		Subdivided mesh
+*	@param tolerance	Maximum distance of corresponding vertices
+*
+*	@return Description of the first difference or an empty string if the
+*	meshes are equal
+*/
+
+std::string compare_meshes(psalm::mesh& A, psalm::mesh& B, double tolerance)
+{
+	std::ostringstream out;
+
+	if(A.num_vertices() != B.num_vertices())
+	{
+		out << "number of vertices differs (" << A.num_vertices() << " vs. " << B.num_vertices() << ")";
+		return(out.str());
+	}
+
+	for(size_t i = 0; i < A.num_vertices(); i++)
+	{
+		double distance = (A.get_vertex(i)->get_position() - B.get_vertex(i)->get_position()).length();
+		if(!(distance <= tolerance))
+		{
+			out << "position of vertex " << i << " differs by " << distance;
+			return(out.str());
+		}
+	}
+
+	if(A.num_faces() != B.num_faces())
+	{
+		out << "number of faces differs (" << A.num_faces() << " vs. " << B.num_faces() << ")";
+		return(out.str());
+	}
+
+	for(size_t i = 0; i < A.num_faces(); i++)
+	{
+		const psalm::face* f = A.get_face(i);
+		const psalm::face* g = B.get_face(i);
+
+		bool equal = (f->num_vertices() == g->num_vertices());
+		for(size_t j = 0; equal && j < f->num_vertices(); j++)
+			equal = (f->get_vertex(j)->get_slot() == g->get_vertex(j)->get_slot());
+
+		if(!equal)
+		{
+			out << "vertices of face " << i << " differ";
+			return(out.str());
+		}
+	}
+
+	return(out.str());
+}
+
+/*!
+*	Creates a stencil table for a mesh and compares its evaluation for
+*	deformed control points with the subdivided deformed mesh.
+*
+*	@param algorithm	Subdivision algorithm
+*	@param M		Control mesh
+*	@param steps		Number of subdivision steps
+*	@param skipped		Set if the subdivision algorithm fails, so
+*				there is nothing to compare with
+*
+*	@return Description of the first difference or an empty string if the
+*	results are equal
+*/
+
+std::string check_stencils(psalm::SubdivisionAlgorithm& algorithm, const psalm::mesh& M, size_t steps, bool& skipped)
+{
+	skipped = false;
+
+	psalm::mesh deformed;
+	M.clone(deformed);
+
+	double size = 0.0;
+	for(size_t i = 0; i < deformed.num_vertices(); i++)
+	{
+		psalm::vertex* v = deformed.get_vertex(i);
+
+		v3ctor p = v->get_position();
+		p *= 1.0 + 0.1*sin(static_cast<double>(i));
+
+		v->set_position(p);
+		size = std::max(size, p.length());
+	}
+
+	psalm::mesh subdivided;
+	deformed.clone(subdivided);
+
+	try
+	{
+		if(!algorithm.apply_to(subdivided, steps))
+			skipped = true;
+	}
+	catch(std::exception&)
+	{
+		skipped = true;
+	}
+
+	if(skipped)
+		return(std::string());
+
+	psalm::stencil_table stencils;
+	psalm::mesh refined;
+
+	try
+	{
+		if(!algorithm.create_stencil_table(M, steps, stencils, refined))
+			return("unable to create stencil table");
+	}
+	catch(std::exception& e)
+	{
+		return(std::string("unable to create stencil table: ") + e.what());
+	}
+
+	if(stencils.num_columns() != M.num_vertices() || stencils.num_rows() != refined.num_vertices())
+		return("size of stencil table does not match the meshes");
+
+	if(!stencils.apply(deformed, refined))
+		return("unable to apply stencil table");
+
+	// The points are calculated in a different order, so they may differ
+	// by rounding errors
+	return(compare_meshes(refined, subdivided, 1e-12*std::max(size, 1.0)));
+}
+
+/*!
+*	Removes a vertex and a face from a copy of a mesh, leaving their slots
+*	empty, and checks that one step of the subdivision algorithm and its
+*	stencil table give the same results as for the compacted copy.
+*
+*	@param algorithm	Subdivision algorithm
+*	@param M		Mesh to copy
+*	@param skipped		Set if the subdivision algorithm fails, so
+*				there is nothing to compare with
+*
+*	@return Description of the first difference or an empty string if the
+*	results are equal
+*/
+
+std::string check_removed_elements(psalm::SubdivisionAlgorithm& algorithm, const psalm::mesh& M, bool& skipped)
+{
+	skipped = false;
+
+	// The copy contains an additional vertex in the first slot, so every
+	// other vertex is moved to another slot after compacting the copy
+
+	psalm::mesh T;
+	std::vector<psalm::vertex*> vertices;
+
+	psalm::vertex* isolated = T.add_vertex(0.0, 0.0, 0.0);
+	for(size_t i = 0; i < M.num_vertices(); i++)
+		vertices.push_back(T.add_vertex(M.get_vertex(i)->get_position()));
+
+	std::vector<psalm::vertex*> face_vertices;
+	for(size_t i = 0; i < M.num_faces(); i++)
+	{
+		const psalm::face* f = M.get_face(i);
+
+		face_vertices.clear();
+		for(size_t j = 0; j < f->num_vertices(); j++)
+			face_vertices.push_back(vertices[f->get_vertex(j)->get_slot()]);
+
+		T.add_face(face_vertices, true);
+	}
+
+	T.remove_vertex(isolated);
+	T.remove_face(T.get_face(T.num_faces()/2));
+
+	psalm::mesh compacted;
+	T.clone(compacted);
+
+	psalm::mesh subdivided;
+	compacted.clone(subdivided);
+
+	try
+	{
+		if(!algorithm.apply_to(subdivided, 1))
+			skipped = true;
+	}
+	catch(std::exception&)
+	{
+		skipped = true;
+	}
+
+	if(skipped)
+		return(std::string());
+
+	psalm::stencil_table stencils;
+	psalm::mesh refined;
+
+	try
+	{
+		if(!algorithm.create_stencil_table(T, 1, stencils, refined))
+			return("unable to create stencil table");
+	}
+	catch(std::exception& e)
+	{
+		return(std::string("unable to create stencil table: ") + e.what());
+	}
+
+	if(stencils.num_columns() != T.num_vertices())
+		return("size of stencil table does not match the mesh");
+
+	if(!stencils.apply(T, refined))
+		return("unable to apply stencil table");
+
+	double size = 1.0;
+	for(size_t i = 0; i < compacted.num_vertices(); i++)
+		size = std::max(size, compacted.get_vertex(i)->get_position().length());
+
+	std::string difference = compare_meshes(refined, subdivided, 1e-12*size);
+	if(!difference.empty())
+		return("stencil table: " + difference);
+
+	// Subdivide the copy with empty slots in-place
+
+	try
+	{
+		if(!algorithm.apply_to(T, 1))
+			return("unable to subdivide mesh with removed elements");
+	}
+	catch(std::exception& e)
+	{
+		return(std::string("unable to subdivide mesh with removed elements: ") + e.what());
+	}
+
+	difference = compare_meshes(T, subdivided, 0.0);
+	if(!difference.empty())
+		return("subdivision: " + difference);
+
+	return(std::string());
+}
+
+/*!
+*	Prints the result of a check.
+*
+*	@return 1 if the check failed, else 0
+*/
+
+int report(const std::string& name, const std::string& check, const std::string& difference, bool skipped)
+{
+	std::cout << name << ": " << check << ": ";
+	if(skipped)
+	{
+		std::cout << "skipped (subdivision fails)\n";
+		return(0);
+	}
+	else if(difference.empty())
+	{
+		std::cout << "ok\n";
+		return(0);
+	}
+
+	std::cout << "FAILED (" << difference << ")\n";
+	return(1);
+}
+
+int main(int argc, char* argv[])
+{
+	int failures = 0;
+
+	for(int i = 1; i < argc; i++)
+	{
+		psalm::mesh M;
+		if(!M.load(argv[i]))
+		{
+			std::cout << argv[i] << ": FAILED (unable to load mesh)\n";
+			failures++;
+			continue;
+		}
+
+		bool triangular = true;
+		for(size_t j = 0; j < M.num_faces() && triangular; j++)
+			triangular = (M.get_face(j)->num_vertices() == 3);
+
+		for(size_t steps = 1; steps <= 2; steps++)
+		{
+			bool skipped;
+			std::string difference;
+
+			std::ostringstream check;
+			check << "Catmull-Clark, " << steps << (steps == 1 ? " step" : " steps");
+
+			psalm::CatmullClark catmull_clark;
+			difference = check_stencils(catmull_clark, M, steps, skipped);
+			failures += report(argv[i], check.str(), difference, skipped);
+
+			if(triangular)
+			{
+				check.str("");
+				check << "Loop, " << steps << (steps == 1 ? " step" : " steps");
+
+				psalm::Loop loop;
+				difference = check_stencils(loop, M, steps, skipped);
+				failures += report(argv[i], check.str(), difference, skipped);
+			}
+		}
+
+		bool skipped;
+		std::string difference;
+
+		psalm::CatmullClark catmull_clark;
+		difference = check_removed_elements(catmull_clark, M, skipped);
+		failures += report(argv[i], "Catmull-Clark, removed elements", difference, skipped);
+
+		if(triangular)
+		{
+			psalm::Loop loop;
+			difference = check_removed_elements(loop, M, skipped);
+			failures += report(argv[i], "Loop, removed elements", difference, skipped);
+		}
+	}
+
+	return(failures);
+}
@@ -43,6 +43,11 @@ bool MinimumWeightTriangulation::apply_to(mesh& input_mesh)
 		return(false);
 	}
 
+	// If the mesh does not store any normals, the objective function uses
+	// the null vector. The property is not created here because the input
+	// mesh should not be changed just for reading it.
+	const property<v3ctor>* normals = input_mesh.get_vertex_property<v3ctor>("normal");
+
 	indices = new size_t*[n];		// store minimum indices (private member)
 	ktuple** weights = new ktuple*[n];	// store weights of triangulation (only required locally)
 
@@ -57,7 +62,8 @@ bool MinimumWeightTriangulation::apply_to(mesh& input_mesh)
 		if(i < n-2)
 			weights[i][i+2] = objective_function(	input_mesh.get_vertex(i),
 								input_mesh.get_vertex(i+1),
-								input_mesh.get_vertex(i+2));
+								input_mesh.get_vertex(i+2),
+								normals);
 	}
 
 	size_t j = 2;
@@ -75,7 +81,8 @@ bool MinimumWeightTriangulation::apply_to(mesh& input_mesh)
 			{
 				ktuple cur_weight = objective_function(	input_mesh.get_vertex(i),
 									input_mesh.get_vertex(m),
-									input_mesh.get_vertex(k));
+									input_mesh.get_vertex(k),
+									normals);
 
 				// The first component of the tuples can be
 				// added; for the second component, only the
@@ -41,11 +41,11 @@ class MinimumWeightTriangulation : public TriangulationAlgorithm
 
 		bool construct_triangulation(mesh& input_mesh, size_t i, size_t k);
 
-		ktuple (*objective_function)(const vertex* v1, const vertex* v2, const vertex* v3);
+		ktuple (*objective_function)(const vertex* v1, const vertex* v2, const vertex* v3, const property<v3ctor>* normals);
 
-		static ktuple minimum_area(const vertex* v1, const vertex* v2, const vertex* v3);
-		static ktuple minimum_area_and_angle(const vertex* v1, const vertex* v2, const vertex* v3);
-		static ktuple minimum_area_and_normal_angle(const vertex* v1, const vertex* v2, const vertex* v3);
+		static ktuple minimum_area(const vertex* v1, const vertex* v2, const vertex* v3, const property<v3ctor>* normals);
+		static ktuple minimum_area_and_angle(const vertex* v1, const vertex* v2, const vertex* v3, const property<v3ctor>* normals);
+		static ktuple minimum_area_and_normal_angle(const vertex* v1, const vertex* v2, const vertex* v3, const property<v3ctor>* normals);
 };
 
 /*!
@@ -55,12 +55,13 @@ class MinimumWeightTriangulation : public TriangulationAlgorithm
 *	@param v1	1st vertex of triangle
 *	@param v2	2nd vertex of triangle
 *	@param v3	3rd vertex of triangle
+*	@param normals	Normals of all vertices; not used by this function
 *
 *	@returns	Area of triangle[v1, v2, v3]. Second component of the
 *			tuple is set to 0.0.
 */
 
-inline ktuple MinimumWeightTriangulation::minimum_area(const vertex* v1, const vertex* v2, const vertex* v3)
+inline ktuple MinimumWeightTriangulation::minimum_area(const vertex* v1, const vertex* v2, const vertex* v3, const property<v3ctor>* /* normals */)
 {
 	if(v1 == NULL || v2 == NULL || v3 == NULL)
 		return(boost::tuple<double,double>(std::numeric_limits<double>::max(), 0.0));	// ensure that invalid data does not
@@ -103,13 +104,14 @@ inline ktuple MinimumWeightTriangulation::minimum_area(const vertex* v1, const v
 *	@param v1	1st vertex of triangle
 *	@param v2	2nd vertex of triangle
 *	@param v3	3rd vertex of triangle
+*	@param normals	Normals of all vertices; not used by this function
 *
 *	@returns	Area of triangle[v1, v2, v3] weighted with a penalty
 *			for skinny triangles. Second component of the tuple is
 *			set to 0.0.
 */
 
-inline ktuple MinimumWeightTriangulation::minimum_area_and_angle(const vertex* v1, const vertex* v2, const vertex* v3)
+inline ktuple MinimumWeightTriangulation::minimum_area_and_angle(const vertex* v1, const vertex* v2, const vertex* v3, const property<v3ctor>* /* normals */)
 {
 	if(v1 == NULL || v2 == NULL || v3 == NULL)
 		return(boost::tuple<double,double>(std::numeric_limits<double>::max(), 0.0));	// ensure that invalid data does not
@@ -152,13 +154,15 @@ inline ktuple MinimumWeightTriangulation::minimum_area_and_angle(const vertex* v
 *	@param v1	1st vertex of triangle
 *	@param v2	2nd vertex of triangle
 *	@param v3	3rd vertex of triangle
+*	@param normals	Normals of all vertices; if NULL, the null vector is
+*			used for every vertex
 *
 *	@returns	Area of triangle[v1, v2, v3]. Second component of the
 *			tuple is the maximum angle between the triangle normal
 *			and the normals of its vertices.
 */
 
-inline ktuple MinimumWeightTriangulation::minimum_area_and_normal_angle(const vertex* v1, const vertex* v2, const vertex* v3)
+inline ktuple MinimumWeightTriangulation::minimum_area_and_normal_angle(const vertex* v1, const vertex* v2, const vertex* v3, const property<v3ctor>* normals)
 {
 	if(v1 == NULL || v2 == NULL || v3 == NULL)
 		return(boost::tuple<double,double>(	std::numeric_limits<double>::max(),
@@ -175,11 +179,17 @@ inline ktuple MinimumWeightTriangulation::minimum_area_and_normal_angle(const ve
 
 	// Use _maximum_ angle between normal of the triangle and the normal of
 	// the triangle
+	const v3ctor null_vector;
+
+	v3ctor n1 = (normals ? (*normals)[v1->get_slot()] : null_vector);
+	v3ctor n2 = (normals ? (*normals)[v2->get_slot()] : null_vector);
+	v3ctor n3 = (normals ? (*normals)[v3->get_slot()] : null_vector);
+
 	double angle;
-	angle = std::max(acos(normal*v1->get_normal().normalize()), acos(normal*v2->get_normal().normalize()));
-	angle = std::max(acos(normal*v3->get_normal().normalize()), angle);
+	angle = std::max(acos(normal*n1.normalize()), acos(normal*n2.normalize()));
+	angle = std::max(acos(normal*n3.normalize()), angle);
 
-	double area	= minimum_area(v1, v2, v3).get<0>();
+	double area	= minimum_area(v1, v2, v3, normals).get<0>();
 
 	return(boost::tuple<double, double>(angle, area));
 }
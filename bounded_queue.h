@@ -0,0 +1,135 @@
+/*!
+*	@file	bounded_queue.h
+*	@brief	Queue of limited size for passing data between threads
+*/
+
+#ifndef __BOUNDED_QUEUE_H__
+#define __BOUNDED_QUEUE_H__
+
+#if __cplusplus >= 201103L
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+namespace psalm
+{
+
+/*!
+*	@class bounded_queue
+*	@brief Queue of limited size for passing data between threads
+*
+*	Producers that push into a full queue and consumers that pop from an
+*	empty queue are blocked. The size limit thus keeps a fast producer
+*	from running too far ahead of a slow consumer. After the producer has
+*	closed the queue, consumers receive the remaining items and are not
+*	blocked anymore.
+*/
+
+template <class T> class bounded_queue
+{
+	public:
+		bounded_queue(size_t capacity);
+
+		bool push(const T& item);
+		bool pop(T& item);
+		void close();
+
+	private:
+		std::deque<T> items;		///< Items in the order they have been pushed
+		size_t capacity;		///< Maximum number of items
+		bool closed;			///< Flag signalling that no more items will be pushed
+
+		std::mutex mutex;
+		std::condition_variable not_empty;
+		std::condition_variable not_full;
+
+		// Queues are shared between threads and must not be copied
+		bounded_queue(const bounded_queue<T>&);
+		bounded_queue<T>& operator=(const bounded_queue<T>&);
+};
+
+/*!
+*	Creates an empty queue.
+*
+*	@param capacity Maximum number of items; must be at least 1
+*/
+
+template <class T> bounded_queue<T>::bounded_queue(size_t capacity)
+	: capacity(capacity), closed(false)
+{
+}
+
+/*!
+*	Appends an item to the queue. Blocks while the queue is full.
+*
+*	@param item Item to append
+*	@return false if the queue has been closed, else true
+*/
+
+template <class T> bool bounded_queue<T>::push(const T& item)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while(!closed && items.size() >= capacity)
+		not_full.wait(lock);
+
+	if(closed)
+		return(false);
+
+	items.push_back(item);
+
+	lock.unlock();
+	not_empty.notify_one();
+
+	return(true);
+}
+
+/*!
+*	Removes the first item from the queue. Blocks while the queue is empty
+*	and has not been closed.
+*
+*	@param item Removed item
+*	@return false if the queue is empty and has been closed, else true
+*/
+
+template <class T> bool bounded_queue<T>::pop(T& item)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while(!closed && items.empty())
+		not_empty.wait(lock);
+
+	if(items.empty())
+		return(false);
+
+	item = items.front();
+	items.pop_front();
+
+	lock.unlock();
+	not_full.notify_one();
+
+	return(true);
+}
+
+/*!
+*	Closes the queue. Items that are still stored in the queue may be
+*	removed afterwards, but no new items may be added. All blocked threads
+*	are woken up.
+*/
+
+template <class T> void bounded_queue<T>::close()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		closed = true;
+	}
+
+	not_empty.notify_all();
+	not_full.notify_all();
+}
+
+} // end of namespace "psalm"
+
+#endif
+
+#endif
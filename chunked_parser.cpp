@@ -0,0 +1,416 @@
+/*!
+*	@file	chunked_parser.cpp
+*	@brief	Parallel parser for ASCII mesh data stored in memory
+*/
+
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <cstring>
+
+#include "chunked_parser.h"
+#include "text_scanner.h"
+
+namespace psalm
+{
+
+/*!
+*	@param in		Scanner; points to the beginning of a line
+*	@param skip_comments	Flag signalling that lines starting with '#'
+*				are comments
+*
+*	@return true if the current line does not contain any data
+*/
+
+static bool is_empty_line(text_scanner& in, bool skip_comments)
+{
+	return(in.eol() || (skip_comments && in.peek('#')));
+}
+
+/*!
+*	Splits the data into chunks. Every chunk, except for the last one,
+*	ends directly behind a line break.
+*
+*	@param begin		First character of the data
+*	@param end		End of the data
+*	@param chunk_size	Approximate size of a chunk in bytes
+*/
+
+chunked_parser::chunked_parser(const char* begin, const char* end, size_t chunk_size)
+{
+	const char* pos = begin;
+	while(pos < end)
+	{
+		const char* chunk_end = end;
+		if(static_cast<size_t>(end-pos) > chunk_size)
+		{
+			chunk_end = static_cast<const char*>(std::memchr(pos+chunk_size, '\n', end-pos-chunk_size));
+			chunk_end = (chunk_end ? chunk_end+1 : end);
+		}
+
+		chunk c;
+		c.begin		= pos;
+		c.end		= chunk_end;
+		c.first_line	= 0;
+		c.num_lines	= 0;
+
+		chunks.push_back(c);
+		pos = chunk_end;
+	}
+}
+
+/*!
+*	Parses Wavefront OBJ data. Only vertices and faces are parsed; all
+*	other lines are skipped. Face indices may contain texture coordinates
+*	and normals, which are ignored, and may refer to previous vertices via
+*	negative indices.
+*
+*	@param positions	Vertex positions
+*	@param face_offsets	Offsets of the faces in the face index buffer
+*	@param face_indices	Vertex indices of the faces
+*
+*	@return true if the data could be parsed, else false
+*/
+
+bool chunked_parser::parse_obj(	std::vector<double>& positions,
+				std::vector<size_t>& face_offsets,
+				std::vector<size_t>& face_indices)
+{
+	#pragma omp parallel for schedule(dynamic, 1)
+	for(long i = 0; i < static_cast<long>(chunks.size()); i++)
+		parse_obj_chunk(chunks[i]);
+
+	if(!report_errors())
+		return(false);
+
+	return(merge(positions, face_offsets, face_indices));
+}
+
+/*!
+*	Parses data whose lines are interpreted according to their position,
+*	e.g. OFF files or ASCII PLY files. Every data line stores exactly one
+*	instance of an element. Vertex positions are taken from the properties
+*	"x", "y", and "z" of the "vertex" element, the faces from the list
+*	property "vertex_indices" (or "vertex_index") of the "face" element.
+*	Additional values at the end of a line are ignored.
+*
+*	@param header		Description of the elements
+*	@param skip_comments	Flag signalling that lines starting with '#'
+*				are comments
+*	@param positions	Vertex positions
+*	@param face_offsets	Offsets of the faces in the face index buffer
+*	@param face_indices	Vertex indices of the faces
+*
+*	@return STATUS_OK if the data could be parsed. STATUS_MISMATCH is
+*	returned (without reporting an error) if the number of data lines
+*	differs from the number of instances, which happens if instances are
+*	spread over several lines. STATUS_ERROR signals a parsing error.
+*/
+
+chunked_parser::status chunked_parser::parse_elements(	const ply_header& header,
+							bool skip_comments,
+							std::vector<double>& positions,
+							std::vector<size_t>& face_offsets,
+							std::vector<size_t>& face_indices)
+{
+	// Number of instances before every element
+	std::vector<size_t> first_instances(header.num_elements()+1, 0);
+	for(size_t i = 0; i < header.num_elements(); i++)
+		first_instances[i+1] = first_instances[i] + header.get_element(i).count;
+
+	if(count_lines(skip_comments) != first_instances.back())
+		return(STATUS_MISMATCH);
+
+	#pragma omp parallel for schedule(dynamic, 1)
+	for(long i = 0; i < static_cast<long>(chunks.size()); i++)
+		parse_element_chunk(chunks[i], header, first_instances, skip_comments);
+
+	if(!report_errors())
+		return(STATUS_ERROR);
+
+	return(merge(positions, face_offsets, face_indices) ? STATUS_OK : STATUS_ERROR);
+}
+
+/*!
+*	Counts the data lines of all chunks and stores the number of data
+*	lines before every chunk.
+*
+*	@param skip_comments Flag signalling that lines starting with '#' are
+*	comments
+*
+*	@return Total number of data lines
+*/
+
+size_t chunked_parser::count_lines(bool skip_comments)
+{
+	#pragma omp parallel for schedule(dynamic, 1)
+	for(long i = 0; i < static_cast<long>(chunks.size()); i++)
+	{
+		chunk& c = chunks[i];
+		text_scanner in(c.begin, c.end);
+
+		c.num_lines = 0;
+		for(; !in.eof(); in.skip_line())
+		{
+			if(!is_empty_line(in, skip_comments))
+				c.num_lines++;
+		}
+	}
+
+	size_t num_lines = 0;
+	for(std::vector<chunk>::iterator it = chunks.begin(); it != chunks.end(); it++)
+	{
+		it->first_line	= num_lines;
+		num_lines	+= it->num_lines;
+	}
+
+	return(num_lines);
+}
+
+/*!
+*	Parses a chunk of OBJ data.
+*
+*	@param c Chunk to parse
+*/
+
+void chunked_parser::parse_obj_chunk(chunk& c)
+{
+	text_scanner in(c.begin, c.end);
+	for(; !in.eof(); in.skip_line())
+	{
+		if(in.match("v"))
+		{
+			double x, y, z;
+			if(!in.read_double(x) || !in.read_double(y) || !in.read_double(z))
+			{
+				c.error = "psalm: I tried to parse vertex coordinates from line \"" + in.get_line() + "\" and failed.\n";
+				return;
+			}
+
+			c.positions.push_back(x);
+			c.positions.push_back(y);
+			c.positions.push_back(z);
+		}
+		else if(in.match("f"))
+		{
+			size_t num_indices = c.face_indices.size();
+			while(!in.eol())
+			{
+				long index = 0;
+				if(!in.read_long(index) || index == 0)
+				{
+					c.error = "psalm: I cannot parse face data from line \"" + in.get_line() + "\".\n";
+					return;
+				}
+
+				// Remove texture coordinates and normals
+				in.skip_token();
+
+				// Backwards references are resolved when the
+				// chunks are merged
+				if(index < 0)
+				{
+					long num_vertices = static_cast<long>(c.positions.size()/3);
+
+					c.relative_indices.push_back(std::make_pair(c.face_indices.size(), num_vertices+index));
+					c.face_indices.push_back(0);
+				}
+				else
+					c.face_indices.push_back(index-1);
+			}
+
+			c.face_sizes.push_back(c.face_indices.size() - num_indices);
+		}
+	}
+}
+
+/*!
+*	Parses a chunk of data whose lines store instances of elements.
+*
+*	@param c		Chunk to parse
+*	@param header		Description of the elements
+*	@param first_instances	Number of instances before every element
+*	@param skip_comments	Flag signalling that lines starting with '#'
+*				are comments
+*/
+
+void chunked_parser::parse_element_chunk(	chunk& c,
+						const ply_header& header,
+						const std::vector<size_t>& first_instances,
+						bool skip_comments)
+{
+	// Find the element of the first line of the chunk
+	size_t i = std::upper_bound(first_instances.begin(), first_instances.end(), c.first_line) - first_instances.begin() - 1;
+
+	std::vector<size_t> coordinates;
+	size_t face_property	= 0;
+	bool is_vertex		= false;
+	bool is_face		= false;
+
+	size_t line = c.first_line;
+	size_t current_element = header.num_elements();
+
+	text_scanner in(c.begin, c.end);
+	for(; !in.eof(); in.skip_line())
+	{
+		if(is_empty_line(in, skip_comments))
+			continue;
+
+		// Skip elements without instances
+		while(line >= first_instances[i+1])
+			i++;
+
+		const ply_header::element& e = header.get_element(i);
+		if(i != current_element)
+		{
+			current_element	= i;
+			coordinates	= e.map_coordinates();
+			is_vertex	= (e.name == "vertex");
+			is_face		= (e.name == "face");
+			face_property	= (is_face ? e.find_face_property() : e.properties.size());
+		}
+
+		double value;
+		double position[3] = {0.0, 0.0, 0.0};
+
+		size_t num_indices	= c.face_indices.size();
+		bool complete		= true;
+
+		for(size_t k = 0; k < e.properties.size() && complete; k++)
+		{
+			if(e.properties[k].is_list)
+			{
+				size_t n = 0;
+				complete = in.read_size(n);
+
+				for(size_t l = 0; l < n && complete; l++)
+				{
+					if(k == face_property)
+					{
+						size_t v = 0;
+						complete = in.read_size(v);
+						c.face_indices.push_back(v);
+					}
+					else
+						complete = in.read_double(value);
+				}
+			}
+			else
+			{
+				complete = in.read_double(value);
+				if(coordinates[k] < 3)
+					position[coordinates[k]] = value;
+			}
+		}
+
+		if(!complete)
+		{
+			std::ostringstream message;
+			message	<< "psalm: Unable to parse instance " << (line - first_instances[i])
+				<< " of element \"" << e.name << "\" in line \""
+				<< in.get_line() << "\".\n";
+
+			c.error = message.str();
+			return;
+		}
+
+		if(is_vertex)
+			c.positions.insert(c.positions.end(), position, position+3);
+		else if(is_face)
+			c.face_sizes.push_back(c.face_indices.size() - num_indices);
+
+		line++;
+	}
+}
+
+/*!
+*	Concatenates the buffers of all chunks. The buffers of the chunks are
+*	released afterwards.
+*
+*	@param positions	Vertex positions
+*	@param face_offsets	Offsets of the faces in the face index buffer
+*	@param face_indices	Vertex indices of the faces
+*
+*	@return true if all backwards references could be resolved, else
+*	false
+*/
+
+bool chunked_parser::merge(	std::vector<double>& positions,
+				std::vector<size_t>& face_offsets,
+				std::vector<size_t>& face_indices)
+{
+	// Offsets of the chunks within the index buffers (prefix sums)
+	std::vector<size_t> vertex_offsets(chunks.size()+1, 0);
+	std::vector<size_t> face_counts(chunks.size()+1, 0);
+	std::vector<size_t> index_counts(chunks.size()+1, 0);
+
+	for(size_t i = 0; i < chunks.size(); i++)
+	{
+		vertex_offsets[i+1]	= vertex_offsets[i] + chunks[i].positions.size()/3;
+		face_counts[i+1]	= face_counts[i]    + chunks[i].face_sizes.size();
+		index_counts[i+1]	= index_counts[i]   + chunks[i].face_indices.size();
+	}
+
+	positions.resize(3*vertex_offsets.back());
+	face_offsets.resize(face_counts.back()+1);
+	face_indices.resize(index_counts.back());
+
+	face_offsets[0] = 0;
+
+	#pragma omp parallel for schedule(dynamic, 1)
+	for(long i = 0; i < static_cast<long>(chunks.size()); i++)
+	{
+		chunk& c = chunks[i];
+
+		std::copy(c.positions.begin(), c.positions.end(), positions.begin()+3*vertex_offsets[i]);
+		std::copy(c.face_indices.begin(), c.face_indices.end(), face_indices.begin()+index_counts[i]);
+
+		size_t offset = index_counts[i];
+		for(size_t j = 0; j < c.face_sizes.size(); j++)
+		{
+			offset += c.face_sizes[j];
+			face_offsets[face_counts[i]+j+1] = offset;
+		}
+
+		for(size_t j = 0; j < c.relative_indices.size(); j++)
+		{
+			long index = static_cast<long>(vertex_offsets[i]) + c.relative_indices[j].second;
+			if(index < 0)
+			{
+				c.error = "psalm: Invalid backwards vertex reference in face data.\n";
+				break;
+			}
+
+			face_indices[index_counts[i]+c.relative_indices[j].first] = static_cast<size_t>(index);
+		}
+
+		std::vector<double>().swap(c.positions);
+		std::vector<size_t>().swap(c.face_sizes);
+		std::vector<size_t>().swap(c.face_indices);
+		std::vector< std::pair<size_t, long> >().swap(c.relative_indices);
+	}
+
+	return(report_errors());
+}
+
+/*!
+*	Reports the first error that occurred while parsing the chunks.
+*
+*	@return true if no error occurred, else false
+*/
+
+bool chunked_parser::report_errors() const
+{
+	for(std::vector<chunk>::const_iterator it = chunks.begin(); it != chunks.end(); it++)
+	{
+		if(!it->error.empty())
+		{
+			std::cerr << it->error;
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+} // end of namespace "psalm"
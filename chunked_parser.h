@@ -0,0 +1,111 @@
+/*!
+*	@file	chunked_parser.h
+*	@brief	Parallel parser for ASCII mesh data stored in memory
+*/
+
+#ifndef __CHUNKED_PARSER_H__
+#define __CHUNKED_PARSER_H__
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ply.h"
+
+namespace psalm
+{
+
+/*!
+*	@class chunked_parser
+*	@brief Parses large ASCII files in parallel
+*
+*	The data is split into chunks of roughly equal size whose boundaries
+*	are aligned to line breaks. Every chunk is parsed independently into
+*	its own buffers; if OpenMP is available, the chunks are processed in
+*	parallel. Afterwards, the offsets of all chunks are determined by prefix
+*	sums and the buffers are concatenated into the index buffers that are
+*	expected by mesh::build_from_indices().
+*
+*	Formats whose lines are interpreted according to their position in the
+*	file (OFF and ASCII PLY) are described in terms of PLY elements. Every
+*	line that is not empty (and not a comment, if requested) stores exactly
+*	one instance. The number of such lines is counted in a first parallel
+*	pass, so every chunk knows which element it starts with.
+*/
+
+class chunked_parser
+{
+	public:
+		enum status
+		{
+			STATUS_OK,
+			STATUS_ERROR,
+			STATUS_MISMATCH		///< Number of lines does not match the elements
+		};
+
+		chunked_parser(const char* begin, const char* end, size_t chunk_size = (1 << 22));
+
+		bool parse_obj(	std::vector<double>& positions,
+				std::vector<size_t>& face_offsets,
+				std::vector<size_t>& face_indices);
+
+		status parse_elements(	const ply_header& header,
+					bool skip_comments,
+					std::vector<double>& positions,
+					std::vector<size_t>& face_offsets,
+					std::vector<size_t>& face_indices);
+
+	private:
+
+		/*!
+		*	@struct chunk
+		*	@brief Part of the data that is parsed by a single thread
+		*/
+
+		struct chunk
+		{
+			const char* begin;		///< First character of the chunk
+			const char* end;		///< End of the chunk; points behind a line break
+
+			size_t first_line;		///< Number of data lines before the chunk
+			size_t num_lines;		///< Number of data lines within the chunk
+
+			std::vector<double> positions;	///< Vertex positions of the chunk
+			std::vector<size_t> face_sizes;	///< Number of vertices of every face
+			std::vector<size_t> face_indices; ///< Vertex indices of the faces
+
+			/*!
+			*	Backwards references (OBJ only): Position of the
+			*	index in face_indices and the referenced vertex,
+			*	relative to the first vertex of the chunk. The
+			*	latter may be negative if the vertex belongs to a
+			*	previous chunk.
+			*/
+
+			std::vector< std::pair<size_t, long> > relative_indices;
+
+			std::string error;		///< Error message; empty if parsing succeeded
+		};
+
+		std::vector<chunk> chunks;
+
+		size_t count_lines(bool skip_comments);
+
+		static void parse_obj_chunk(chunk& c);
+
+		static void parse_element_chunk(chunk& c,
+						const ply_header& header,
+						const std::vector<size_t>& first_instances,
+						bool skip_comments);
+
+		bool merge(	std::vector<double>& positions,
+				std::vector<size_t>& face_offsets,
+				std::vector<size_t>& face_indices);
+
+		bool report_errors() const;
+};
+
+} // end of namespace "psalm"
+
+#endif
@@ -0,0 +1,284 @@
+/*!
+*	@file	circulator.cpp
+*	@brief	Functions for vertex and face circulators
+*/
+
+#include <stdexcept>
+
+#include "circulator.h"
+
+namespace psalm
+{
+
+/*!
+*	@param f Face
+*	@param v Vertex
+*
+*	@return Index of v within the vertices of f or the number of vertices
+*	of f if the vertex could not be found
+*/
+
+static size_t find_vertex_index(const face* f, const vertex* v)
+{
+	size_t n = f->num_vertices();
+	for(size_t i = 0; i < n; i++)
+	{
+		if(f->get_vertex(i) == v)
+			return(i);
+	}
+
+	return(n);
+}
+
+/*!
+*	@param f Face
+*	@param v Vertex of the face
+*	@param e Edge of the face that is incident to v
+*
+*	@return The other edge of f that is incident to v or NULL if e is not
+*	an edge of f that is incident to v
+*/
+
+static const edge* find_other_edge(const face* f, const vertex* v, const edge* e)
+{
+	size_t m = f->num_vertices();
+	size_t k = find_vertex_index(f, v);
+	if(k == m)
+		return(NULL);
+
+	const edge* a = f->get_edge(k).e;
+	const edge* b = f->get_edge((k+m-1) % m).e;
+
+	if(a == e)
+		return(b);
+	else if(b == e)
+		return(a);
+	else
+		return(NULL);
+}
+
+/*!
+*	@param e Edge
+*	@param f Face of the edge
+*
+*	@return The other face of the edge (may be NULL)
+*/
+
+static const face* find_other_face(const edge* e, const face* f)
+{
+	return(e->get_f() == f ? e->get_g() : e->get_f());
+}
+
+/*!
+*	Creates a circulator for the adjacent faces of a vertex. In order to
+*	decide whether the faces may be enumerated in order, the circulator
+*	walks around the vertex once.
+*
+*	@param v Centre vertex
+*/
+
+vertex_face_circulator::vertex_face_circulator(const vertex* v)
+{
+	this->v		= v;
+	n		= v->num_adjacent_faces();
+	num_visited	= 0;
+	ordered		= false;
+	closed		= false;
+
+	cur_face	= NULL;
+	cur_edge	= NULL;
+	next_edge	= NULL;
+
+	if(n == 0)
+		return;
+
+	// Use the orientation of the first face to decide which of its edges
+	// will be crossed when rotating counterclockwise
+
+	set_face(v->get_face(0));
+	if(cur_edge == NULL)
+		return;
+
+	const face* first	= cur_face;
+	const face* f		= first;
+	const edge* e		= cur_edge;	// crossed when rotating clockwise
+	bool found_boundary	= false;
+
+	// Rotate clockwise until either the first face is reached again
+	// (closed 1-ring) or the boundary is reached. In the latter case, the
+	// face at the boundary is the first one.
+
+	for(size_t i = 0; i < n; i++)
+	{
+		const face* g = find_other_face(e, f);
+		if(g == NULL)
+		{
+			found_boundary = true;
+			break;
+		}
+		else if(g == first)
+		{
+			// For non-manifold vertices, the 1-ring might be
+			// closed before all faces have been visited
+			closed	= (i+1 == n);
+			ordered	= closed;
+			break;
+		}
+
+		e = find_other_edge(g, v, e);
+		f = g;
+
+		if(e == NULL)
+			break;
+	}
+
+	// Check that all faces are reachable from the boundary face
+	if(found_boundary)
+	{
+		const edge* exit	= find_other_edge(f, v, e);
+		const face* g		= f;
+		size_t num_faces	= 1;
+
+		while(exit != NULL && num_faces <= n)
+		{
+			const face* h = find_other_face(exit, g);
+			if(h == NULL)
+				break;
+
+			exit = find_other_edge(h, v, exit);
+			g = h;
+
+			num_faces++;
+		}
+
+		ordered = (exit != NULL && num_faces == n);
+		if(ordered)
+		{
+			cur_face	= f;
+			cur_edge	= e;
+			next_edge	= find_other_edge(f, v, e);
+		}
+	}
+
+	// Only the fallback needs to restart; a closed 1-ring starts with the
+	// first face, which has already been set.
+	if(!ordered)
+		set_face(first);
+}
+
+/*!
+*	Advances the circulator to the next face.
+*/
+
+void vertex_face_circulator::next()
+{
+	num_visited++;
+	if(num_visited >= n)
+		set_face(NULL);
+	else if(ordered)
+	{
+		const face* g = find_other_face(next_edge, cur_face);
+
+		cur_edge	= next_edge;
+		next_edge	= find_other_edge(g, v, next_edge);
+		cur_face	= g;
+	}
+	else
+		set_face(v->get_face(num_visited));
+}
+
+/*!
+*	Sets the current face and uses its orientation to find the edges that
+*	are incident to the centre vertex.
+*
+*	@param f New face (may be NULL)
+*/
+
+void vertex_face_circulator::set_face(const face* f)
+{
+	cur_face	= f;
+	cur_edge	= NULL;
+	next_edge	= NULL;
+
+	if(f == NULL)
+		return;
+
+	size_t m = f->num_vertices();
+	size_t k = find_vertex_index(f, v);
+	if(k < m)
+	{
+		cur_edge	= f->get_edge(k).e;
+		next_edge	= f->get_edge((k+m-1) % m).e;
+	}
+}
+
+/*!
+*	Creates a circulator for the incident edges of a vertex.
+*
+*	@param v Centre vertex
+*/
+
+vertex_edge_circulator::vertex_edge_circulator(const vertex* v)
+	: faces(v)
+{
+	this->v		= v;
+	n		= v->valency();
+	num_visited	= 0;
+
+	// Interior vertices have as many spokes as faces, boundary vertices
+	// have one more
+	ordered	=	faces.is_ordered() &&
+			v->num_adjacent_faces() + (faces.is_closed() ? 0 : 1) == n;
+
+	if(n == 0)
+		cur_edge = NULL;
+	else if(ordered)
+		cur_edge = faces.get_edge();
+	else
+		cur_edge = v->get_edge(0);
+}
+
+/*!
+*	Advances the circulator to the next spoke.
+*/
+
+void vertex_edge_circulator::next()
+{
+	num_visited++;
+	if(num_visited >= n)
+		cur_edge = NULL;
+	else if(ordered)
+	{
+		cur_edge = faces.get_next_edge();
+		faces.next();
+	}
+	else
+		cur_edge = v->get_edge(num_visited);
+}
+
+/*!
+*	Creates a circulator for the vertices of a face.
+*
+*	@param f Face to enumerate
+*	@param v First vertex to visit (optional); if not specified, the
+*	enumeration starts with the first vertex of the face
+*
+*	@throws std::runtime_error if the vertex is not part of the face
+*/
+
+face_vertex_circulator::face_vertex_circulator(const face* f, const vertex* v)
+{
+	this->f		= f;
+	n		= f->num_vertices();
+	start		= 0;
+	num_visited	= 0;
+
+	if(v != NULL)
+	{
+		start = find_vertex_index(f, v);
+		if(start == n)
+			throw(std::runtime_error("face_vertex_circulator::face_vertex_circulator(): Unable to find vertex"));
+	}
+}
+
+} // end of namespace "psalm"
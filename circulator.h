@@ -0,0 +1,276 @@
+/*!
+*	@file	circulator.h
+*	@brief	Circulators for enumerating the neighbourhood of mesh elements
+*/
+
+#ifndef __CIRCULATOR_H__
+#define __CIRCULATOR_H__
+
+#include <cstddef>
+
+#include "vertex.h"
+#include "edge.h"
+#include "face.h"
+
+namespace psalm
+{
+
+/*!
+*	@class vertex_face_circulator
+*	@brief Enumerates the adjacent faces of a vertex
+*
+*	The circulator visits each adjacent face of a vertex exactly once. For
+*	every face, the two edges of the face that are incident to the vertex
+*	are available as well.
+*
+*	For manifold vertices, consecutive faces share an edge, i.e. the faces
+*	are visited in counterclockwise order for consistently oriented meshes.
+*	The faces are chained via their edges, so non-orientable meshes are
+*	handled as well. Boundary vertices start with the face at the boundary.
+*	If the faces cannot be ordered, e.g. for non-manifold vertices, the
+*	circulator falls back to the order in which the faces are stored in the
+*	vertex. No memory is allocated in either case.
+*
+*	Usage:
+*
+*		for(vertex_face_circulator it(v); it.valid(); it.next())
+*			do_something(it.get_face());
+*/
+
+class vertex_face_circulator
+{
+	public:
+		vertex_face_circulator(const vertex* v);
+
+		bool valid() const;
+		void next();
+
+		bool is_ordered() const;
+		bool is_closed() const;
+
+		const face* get_face() const;
+		const edge* get_edge() const;
+		const edge* get_next_edge() const;
+
+	private:
+		const vertex* v;	///< Centre of the 1-ring
+
+		const face* cur_face;	///< Current face
+		const edge* cur_edge;	///< Edge through which the face is entered
+		const edge* next_edge;	///< Edge through which the face is left
+
+		size_t n;		///< Number of adjacent faces
+		size_t num_visited;	///< Number of faces visited so far
+
+		bool ordered;		///< Signals that consecutive faces are adjacent
+		bool closed;		///< Signals that the 1-ring has no boundary
+
+		void set_face(const face* f);
+};
+
+/*!
+*	@class vertex_edge_circulator
+*	@brief Enumerates the incident edges and neighbours of a vertex
+*
+*	The circulator visits each incident edge ("spoke") of a vertex exactly
+*	once. Whenever the adjacent faces can be ordered (see
+*	vertex_face_circulator), the spokes are ordered as well: Each face is
+*	preceded by the spoke through which it is entered. Otherwise, the
+*	circulator falls back to the order in which the edges are stored in
+*	the vertex. No memory is allocated in either case.
+*
+*	Usage:
+*
+*		for(vertex_edge_circulator it(v); it.valid(); it.next())
+*			do_something(it.get_edge(), it.get_vertex());
+*/
+
+class vertex_edge_circulator
+{
+	public:
+		vertex_edge_circulator(const vertex* v);
+
+		bool valid() const;
+		void next();
+
+		bool is_ordered() const;
+
+		const edge* get_edge() const;
+		const vertex* get_vertex() const;
+
+	private:
+		const vertex* v;		///< Centre of the 1-ring
+		vertex_face_circulator faces;	///< Used for ordered enumeration
+
+		const edge* cur_edge;		///< Current spoke
+
+		size_t n;			///< Number of spokes, i.e. the valency
+		size_t num_visited;		///< Number of spokes visited so far
+
+		bool ordered;			///< Signals that consecutive spokes share a face
+};
+
+/*!
+*	@class face_vertex_circulator
+*	@brief Enumerates the vertices and edges of a face
+*
+*	The circulator visits the vertices of a face in the order in which
+*	they are stored, i.e. counterclockwise for properly oriented meshes,
+*	beginning with an arbitrary vertex of the face. For every vertex, the
+*	directed edge that starts at the vertex is available as well.
+*/
+
+class face_vertex_circulator
+{
+	public:
+		face_vertex_circulator(const face* f, const vertex* v = NULL);
+
+		bool valid() const;
+		void next();
+
+		const vertex* get_vertex() const;
+		const directed_edge& get_edge() const;
+
+	private:
+		const face* f;		///< Face to enumerate
+
+		size_t n;		///< Number of vertices of the face
+		size_t start;		///< Index of first vertex
+		size_t num_visited;	///< Number of vertices visited so far
+};
+
+/*!
+*	@return true as long as the circulator points to a spoke
+*/
+
+inline bool vertex_edge_circulator::valid() const
+{
+	return(cur_edge != NULL);
+}
+
+/*!
+*	@return true if consecutive spokes are edges of the same face
+*/
+
+inline bool vertex_edge_circulator::is_ordered() const
+{
+	return(ordered);
+}
+
+/*!
+*	@return Current spoke, i.e. an edge incident to the centre vertex
+*/
+
+inline const edge* vertex_edge_circulator::get_edge() const
+{
+	return(cur_edge);
+}
+
+/*!
+*	@return Neighbouring vertex, i.e. the end of the current spoke that is
+*	not the centre vertex
+*/
+
+inline const vertex* vertex_edge_circulator::get_vertex() const
+{
+	return(cur_edge->get_u() == v ? cur_edge->get_v() : cur_edge->get_u());
+}
+
+/*!
+*	@return true as long as the circulator points to a face
+*/
+
+inline bool vertex_face_circulator::valid() const
+{
+	return(cur_face != NULL);
+}
+
+/*!
+*	@return true if consecutive faces are adjacent
+*/
+
+inline bool vertex_face_circulator::is_ordered() const
+{
+	return(ordered);
+}
+
+/*!
+*	@return true if the faces are ordered and the last face is adjacent to
+*	the first one, i.e. the vertex is an interior vertex
+*/
+
+inline bool vertex_face_circulator::is_closed() const
+{
+	return(closed);
+}
+
+/*!
+*	@return Current face
+*/
+
+inline const face* vertex_face_circulator::get_face() const
+{
+	return(cur_face);
+}
+
+/*!
+*	@return Edge of the current face that is incident to the centre vertex
+*	and shared with the previous face. For consistently oriented meshes,
+*	this edge starts at the centre vertex.
+*/
+
+inline const edge* vertex_face_circulator::get_edge() const
+{
+	return(cur_edge);
+}
+
+/*!
+*	@return Edge of the current face that is incident to the centre vertex
+*	and shared with the next face. For consistently oriented meshes, this
+*	edge ends at the centre vertex.
+*/
+
+inline const edge* vertex_face_circulator::get_next_edge() const
+{
+	return(next_edge);
+}
+
+/*!
+*	@return true as long as the circulator points to a vertex
+*/
+
+inline bool face_vertex_circulator::valid() const
+{
+	return(num_visited < n);
+}
+
+/*!
+*	Advances the circulator to the next vertex of the face.
+*/
+
+inline void face_vertex_circulator::next()
+{
+	num_visited++;
+}
+
+/*!
+*	@return Current vertex of the face
+*/
+
+inline const vertex* face_vertex_circulator::get_vertex() const
+{
+	return(f->get_vertex((start+num_visited) % n));
+}
+
+/*!
+*	@return Directed edge that starts at the current vertex
+*/
+
+inline const directed_edge& face_vertex_circulator::get_edge() const
+{
+	return(f->get_edge((start+num_visited) % n));
+}
+
+} // end of namespace "psalm"
+
+#endif
@@ -0,0 +1,971 @@
+/*!
+*	@file	compressed_stream.cpp
+*	@brief	File streams with transparent gzip and zstd compression
+*/
+
+#include <deque>
+#include <vector>
+
+#include <cerrno>
+#include <cstring>
+
+#if __cplusplus >= 201103L && !defined(PSALM_NO_COMPRESSION)
+	#include <condition_variable>
+	#include <mutex>
+	#include <thread>
+
+	#define PSALM_USE_THREADS
+#endif
+
+// libpsalm must not depend on any other libraries
+#ifdef PSALM_NO_COMPRESSION
+	#undef PSALM_HAVE_ZLIB
+	#undef PSALM_HAVE_ZSTD
+#endif
+
+#ifdef PSALM_HAVE_ZLIB
+	#include <zlib.h>
+#endif
+
+#ifdef PSALM_HAVE_ZSTD
+	#include <zstd.h>
+#endif
+
+#include "compressed_stream.h"
+
+namespace psalm
+{
+
+/*!
+*	Size of the blocks of uncompressed data that are passed between the
+*	threads
+*/
+
+static const size_t block_size = 1 << 20;
+
+/*!
+*	Maximum number of blocks that may wait for being processed; this
+*	limits the memory that is used if one of the threads is faster than
+*	the other one.
+*/
+
+static const size_t max_queued_blocks = 4;
+
+/*!
+*	@class codec
+*	@brief Compresses or decompresses data of a single format
+*
+*	Data is processed incrementally: Every call of process() consumes as
+*	much input and produces as much output as possible.
+*/
+
+class codec
+{
+	public:
+		virtual ~codec() {}
+
+		/*!
+		*	@param in	Next input character; is advanced
+		*	@param in_end	End of the input
+		*	@param out	Next output character; is advanced
+		*	@param out_end	End of the output buffer
+		*	@param finish	Flag signalling that no more input follows
+		*	@param done	Set if all data has been processed
+		*
+		*	@return false if an error occurred; the message is stored
+		*	in `error`
+		*/
+
+		virtual bool process(const char*& in, const char* in_end, char*& out, char* out_end, bool finish, bool& done) = 0;
+
+		static codec* create(mesh::compression_type compression, bool compress);
+
+		std::string error;
+};
+
+#ifdef PSALM_HAVE_ZLIB
+
+/*!
+*	@class gzip_codec
+*	@brief Codec for gzip data, based on zlib
+*/
+
+class gzip_codec : public codec
+{
+	public:
+		gzip_codec(bool compress);
+		~gzip_codec();
+
+		bool process(const char*& in, const char* in_end, char*& out, char* out_end, bool finish, bool& done);
+
+	private:
+		z_stream stream;
+		bool compress;
+		bool initialized;
+		bool member_end;	///< Flag signalling that a complete gzip member has been decompressed
+};
+
+gzip_codec::gzip_codec(bool compress) : compress(compress), member_end(false)
+{
+	std::memset(&stream, 0, sizeof(stream));
+
+	// Adding 16 to the window size selects the gzip format; adding 32
+	// enables automatic detection of gzip and zlib headers.
+	if(compress)
+		initialized = (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15+16, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+	else
+		initialized = (inflateInit2(&stream, 15+32) == Z_OK);
+}
+
+gzip_codec::~gzip_codec()
+{
+	if(!initialized)
+		return;
+
+	if(compress)
+		deflateEnd(&stream);
+	else
+		inflateEnd(&stream);
+}
+
+bool gzip_codec::process(const char*& in, const char* in_end, char*& out, char* out_end, bool finish, bool& done)
+{
+	if(!initialized)
+	{
+		error = "Unable to initialize zlib";
+		return(false);
+	}
+
+	stream.next_in		= reinterpret_cast<Bytef*>(const_cast<char*>(in));
+	stream.avail_in		= static_cast<uInt>(in_end-in);
+	stream.next_out		= reinterpret_cast<Bytef*>(out);
+	stream.avail_out	= static_cast<uInt>(out_end-out);
+
+	int result = Z_OK;
+	if(compress)
+	{
+		result	= deflate(&stream, finish ? Z_FINISH : Z_NO_FLUSH);
+		done	= (result == Z_STREAM_END);
+	}
+	else
+	{
+		// Files may consist of several gzip members, e.g. if they have
+		// been concatenated or created by parallel compressors.
+		if(member_end && stream.avail_in > 0)
+		{
+			inflateReset(&stream);
+			member_end = false;
+		}
+
+		if(!member_end)
+		{
+			result = inflate(&stream, Z_NO_FLUSH);
+			if(result == Z_STREAM_END)
+			{
+				member_end	= true;
+				result		= Z_OK;
+			}
+		}
+
+		done = (member_end && finish && stream.avail_in == 0);
+	}
+
+	in	= in_end - stream.avail_in;
+	out	= out_end - stream.avail_out;
+
+	if(result != Z_OK && result != Z_BUF_ERROR && result != Z_STREAM_END)
+	{
+		error = (stream.msg ? stream.msg : "zlib error");
+		return(false);
+	}
+
+	return(true);
+}
+
+#endif
+
+#ifdef PSALM_HAVE_ZSTD
+
+/*!
+*	@class zstd_codec
+*	@brief Codec for Zstandard data
+*/
+
+class zstd_codec : public codec
+{
+	public:
+		zstd_codec(bool compress);
+		~zstd_codec();
+
+		bool process(const char*& in, const char* in_end, char*& out, char* out_end, bool finish, bool& done);
+
+	private:
+		ZSTD_CCtx* cctx;
+		ZSTD_DCtx* dctx;
+		bool frame_end;		///< Flag signalling that a complete frame has been decompressed
+};
+
+zstd_codec::zstd_codec(bool compress) : cctx(NULL), dctx(NULL), frame_end(false)
+{
+	if(compress)
+		cctx = ZSTD_createCCtx();
+	else
+		dctx = ZSTD_createDCtx();
+}
+
+zstd_codec::~zstd_codec()
+{
+	ZSTD_freeCCtx(cctx);
+	ZSTD_freeDCtx(dctx);
+}
+
+bool zstd_codec::process(const char*& in, const char* in_end, char*& out, char* out_end, bool finish, bool& done)
+{
+	if(cctx == NULL && dctx == NULL)
+	{
+		error = "Unable to initialize zstd";
+		return(false);
+	}
+
+	ZSTD_inBuffer input	= { in, static_cast<size_t>(in_end-in), 0 };
+	ZSTD_outBuffer output	= { out, static_cast<size_t>(out_end-out), 0 };
+
+	size_t result = 0;
+	if(cctx)
+	{
+		result	= ZSTD_compressStream2(cctx, &output, &input, finish ? ZSTD_e_end : ZSTD_e_continue);
+		done	= (finish && result == 0);
+	}
+	else
+	{
+		// Concatenated frames are decompressed one after another
+		result = ZSTD_decompressStream(dctx, &output, &input);
+		if(result == 0)
+			frame_end = true;
+		else if(input.pos > 0 || output.pos > 0)
+			frame_end = false;
+
+		done = (frame_end && finish && input.pos == input.size);
+	}
+
+	in	+= input.pos;
+	out	+= output.pos;
+
+	if(ZSTD_isError(result))
+	{
+		error = ZSTD_getErrorName(result);
+		return(false);
+	}
+
+	return(true);
+}
+
+#endif
+
+/*!
+*	Creates a codec for the given compression format.
+*
+*	@param compression	Compression format
+*	@param compress		Flag signalling that data should be compressed
+*				instead of decompressed
+*
+*	@return New codec or NULL if the format is not supported
+*/
+
+codec* codec::create(mesh::compression_type compression, bool compress)
+{
+	// Unused if psalm is built without any compression library
+	(void) compress;
+
+	switch(compression)
+	{
+#ifdef PSALM_HAVE_ZLIB
+		case mesh::COMPRESSION_GZIP:
+			return(new gzip_codec(compress));
+#endif
+
+#ifdef PSALM_HAVE_ZSTD
+		case mesh::COMPRESSION_ZSTD:
+			return(new zstd_codec(compress));
+#endif
+
+		default:
+			return(NULL);
+	}
+}
+
+/*!
+*	@class decompressor
+*	@brief Stream buffer that provides the decompressed contents of
+*	another stream
+*
+*	A worker thread reads and decompresses the data in blocks; the blocks
+*	are handed over to the stream buffer via a queue of limited size.
+*/
+
+class decompressor : public std::streambuf
+{
+	public:
+		decompressor(std::istream& in, codec* c);
+		~decompressor();
+
+	protected:
+		int_type underflow();
+
+	private:
+		std::istream& in;
+		codec* c;
+
+		std::vector<char> input;	///< Compressed data
+		const char* input_pos;		///< Next unprocessed character of the compressed data
+		const char* input_end;		///< End of the compressed data
+		bool input_finished;		///< Flag signalling that all compressed data has been read
+
+		bool finished;			///< Flag signalling that all data has been decompressed
+		std::string error;		///< Error message; empty if no error occurred
+
+		std::vector<char> current;	///< Block that is currently read from
+
+		bool decompress(std::vector<char>& block);
+
+#ifdef PSALM_USE_THREADS
+		std::deque< std::vector<char> > queue;
+		bool producer_done;
+		bool stop;
+
+		std::mutex mutex;
+		std::condition_variable changed;
+		std::thread worker;
+
+		void run();
+#endif
+};
+
+/*!
+*	Starts decompressing the stream.
+*
+*	@param in	Stream of compressed data
+*	@param c	Codec for decompressing the data; owned by the buffer
+*/
+
+decompressor::decompressor(std::istream& in, codec* c) : in(in), c(c)
+{
+	input.resize(block_size);
+	input_pos	= &input[0];
+	input_end	= &input[0];
+	input_finished	= false;
+	finished	= false;
+
+	setg(NULL, NULL, NULL);
+
+#ifdef PSALM_USE_THREADS
+	producer_done	= false;
+	stop		= false;
+	worker		= std::thread(&decompressor::run, this);
+#endif
+}
+
+/*!
+*	Stops the worker thread and releases the codec.
+*/
+
+decompressor::~decompressor()
+{
+#ifdef PSALM_USE_THREADS
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stop = true;
+	}
+
+	changed.notify_all();
+	worker.join();
+#endif
+
+	delete(c);
+}
+
+/*!
+*	Makes the next block of decompressed data available.
+*
+*	@return Next character or EOF if all data has been read
+*/
+
+decompressor::int_type decompressor::underflow()
+{
+	if(gptr() < egptr())
+		return(traits_type::to_int_type(*gptr()));
+
+#ifdef PSALM_USE_THREADS
+	std::unique_lock<std::mutex> lock(mutex);
+	while(queue.empty() && !producer_done)
+		changed.wait(lock);
+
+	bool available = !queue.empty();
+	if(available)
+	{
+		current.swap(queue.front());
+		queue.pop_front();
+	}
+
+	lock.unlock();
+	changed.notify_all();
+#else
+	bool available = decompress(current);
+#endif
+
+	if(!available)
+	{
+		if(!error.empty())
+		{
+			std::cerr << "psalm: Unable to decompress input: " << error << "\n";
+			error.clear();
+		}
+
+		return(traits_type::eof());
+	}
+
+	setg(&current[0], &current[0], &current[0]+current.size());
+	return(traits_type::to_int_type(*gptr()));
+}
+
+/*!
+*	Decompresses the next block of data.
+*
+*	@param block Decompressed data
+*	@return false if no more data is available
+*/
+
+bool decompressor::decompress(std::vector<char>& block)
+{
+	block.resize(block_size);
+
+	char* out	= &block[0];
+	char* out_end	= &block[0]+block.size();
+
+	while(out < out_end && !finished)
+	{
+		if(input_pos == input_end && !input_finished)
+		{
+			in.read(&input[0], input.size());
+			size_t n = static_cast<size_t>(in.gcount());
+
+			input_pos	= &input[0];
+			input_end	= &input[0]+n;
+			input_finished	= (n < input.size());
+		}
+
+		const char* previous_input	= input_pos;
+		char* previous_output		= out;
+
+		bool done = false;
+		if(!c->process(input_pos, input_end, out, out_end, input_finished, done))
+		{
+			error		= c->error;
+			finished	= true;
+		}
+		else if(done)
+			finished = true;
+		else if(input_finished && input_pos == previous_input && out == previous_output)
+		{
+			error		= "Unexpected end of compressed data";
+			finished	= true;
+		}
+	}
+
+	block.resize(out - &block[0]);
+	return(!block.empty());
+}
+
+#ifdef PSALM_USE_THREADS
+
+/*!
+*	Main function of the worker thread.
+*/
+
+void decompressor::run()
+{
+	for(;;)
+	{
+		std::vector<char> block;
+		bool available = decompress(block);
+
+		std::unique_lock<std::mutex> lock(mutex);
+		while(!stop && queue.size() >= max_queued_blocks)
+			changed.wait(lock);
+
+		if(stop)
+			return;
+
+		if(available)
+		{
+			queue.push_back(std::vector<char>());
+			queue.back().swap(block);
+		}
+		else
+			producer_done = true;
+
+		lock.unlock();
+		changed.notify_all();
+
+		if(!available)
+			return;
+	}
+}
+
+#endif
+
+/*!
+*	@class compressor
+*	@brief Stream buffer that compresses all data and writes it to another
+*	stream
+*
+*	Filled blocks are handed over to a worker thread via a queue of
+*	limited size. The worker thread compresses the blocks and writes the
+*	result.
+*/
+
+class compressor : public std::streambuf
+{
+	public:
+		compressor(std::ostream& out, codec* c);
+		~compressor();
+
+		bool close();
+
+	protected:
+		int_type overflow(int_type ch);
+
+	private:
+		std::ostream& out;
+		codec* c;
+
+		std::vector<char> current;	///< Block that is currently written to
+		std::vector<char> output;	///< Compressed data
+
+		bool closed;			///< Flag signalling that close() has been called
+		bool failed;			///< Flag signalling that an error occurred
+		std::string error;		///< Error message of the codec
+
+		void submit();
+		void compress(const std::vector<char>& block, bool finish);
+
+#ifdef PSALM_USE_THREADS
+		std::deque< std::vector<char> > queue;
+		bool finishing;
+
+		std::mutex mutex;
+		std::condition_variable changed;
+		std::thread worker;
+
+		void run();
+#endif
+};
+
+/*!
+*	Prepares compressing data.
+*
+*	@param out	Stream that receives the compressed data
+*	@param c	Codec for compressing the data; owned by the buffer
+*/
+
+compressor::compressor(std::ostream& out, codec* c) : out(out), c(c)
+{
+	current.resize(block_size);
+	output.resize(block_size);
+
+	closed	= false;
+	failed	= false;
+
+	setp(&current[0], &current[0]+current.size());
+
+#ifdef PSALM_USE_THREADS
+	finishing	= false;
+	worker		= std::thread(&compressor::run, this);
+#endif
+}
+
+/*!
+*	Writes any remaining data and releases the codec.
+*/
+
+compressor::~compressor()
+{
+	close();
+	delete(c);
+}
+
+/*!
+*	Compresses and writes all remaining data. Afterwards, no data may be
+*	written to the buffer.
+*
+*	@return true if all data could be written, else false
+*/
+
+bool compressor::close()
+{
+	if(closed)
+		return(!failed);
+
+	submit();
+
+#ifdef PSALM_USE_THREADS
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		finishing = true;
+	}
+
+	changed.notify_all();
+	worker.join();
+#else
+	compress(std::vector<char>(), true);
+#endif
+
+	closed = true;
+	setp(NULL, NULL);
+
+	out.flush();
+	if(!error.empty())
+		std::cerr << "psalm: Unable to compress output: " << error << "\n";
+
+	failed = (failed || !out.good());
+	return(!failed);
+}
+
+/*!
+*	Passes a full block to the worker thread.
+*
+*	@param ch Character that did not fit into the block
+*	@return EOF on error, else some other value
+*/
+
+compressor::int_type compressor::overflow(int_type ch)
+{
+	if(closed)
+		return(traits_type::eof());
+
+	submit();
+
+	if(!traits_type::eq_int_type(ch, traits_type::eof()))
+	{
+		*pptr() = traits_type::to_char_type(ch);
+		pbump(1);
+	}
+
+	return(traits_type::not_eof(ch));
+}
+
+/*!
+*	Hands the current block over to the worker thread (or compresses it
+*	directly) and starts a new block.
+*/
+
+void compressor::submit()
+{
+	current.resize(pptr() - pbase());
+
+	if(!current.empty())
+	{
+#ifdef PSALM_USE_THREADS
+		std::unique_lock<std::mutex> lock(mutex);
+		while(queue.size() >= max_queued_blocks)
+			changed.wait(lock);
+
+		queue.push_back(std::vector<char>());
+		queue.back().swap(current);
+
+		lock.unlock();
+		changed.notify_all();
+#else
+		compress(current, false);
+#endif
+	}
+
+	current.resize(block_size);
+	setp(&current[0], &current[0]+current.size());
+}
+
+/*!
+*	Compresses a block and writes the compressed data.
+*
+*	@param block	Uncompressed data
+*	@param finish	Flag signalling that this is the last block
+*/
+
+void compressor::compress(const std::vector<char>& block, bool finish)
+{
+	const char* in		= (block.empty() ? NULL : &block[0]);
+	const char* in_end	= in + block.size();
+
+	while(!failed)
+	{
+		char* out_begin	= &output[0];
+		char* out_pos	= out_begin;
+
+		bool done = false;
+		if(!c->process(in, in_end, out_pos, out_begin+output.size(), finish, done))
+		{
+			error	= c->error;
+			failed	= true;
+		}
+
+		if(out_pos > out_begin)
+		{
+			out.write(out_begin, out_pos-out_begin);
+			failed = (failed || !out.good());
+		}
+
+		// Without any more input, the codec may still need to write
+		// data that did not fit into the output buffer
+		if(finish ? done : (in == in_end && out_pos < out_begin+output.size()))
+			break;
+	}
+}
+
+#ifdef PSALM_USE_THREADS
+
+/*!
+*	Main function of the worker thread.
+*/
+
+void compressor::run()
+{
+	for(;;)
+	{
+		std::vector<char> block;
+
+		std::unique_lock<std::mutex> lock(mutex);
+		while(queue.empty() && !finishing)
+			changed.wait(lock);
+
+		bool finish = queue.empty();
+		if(!finish)
+		{
+			block.swap(queue.front());
+			queue.pop_front();
+		}
+
+		lock.unlock();
+		changed.notify_all();
+
+		compress(block, finish);
+		if(finish)
+			return;
+	}
+}
+
+#endif
+
+/*!
+*	Creates a stream that is not associated with any file.
+*/
+
+compressed_ifstream::compressed_ifstream() : std::istream(NULL)
+{
+	buffer = NULL;
+}
+
+/*!
+*	Closes the file, if any.
+*/
+
+compressed_ifstream::~compressed_ifstream()
+{
+	close();
+}
+
+/*!
+*	Opens a file for reading.
+*
+*	@param filename		Name of the file. If the name is empty, standard
+*				input is used.
+*	@param compression	Compression format of the data. If
+*				COMPRESSION_EXT is specified, the format is
+*				determined by the extension of the file.
+*
+*	@return true if the file could be opened, else false
+*/
+
+bool compressed_ifstream::open(const std::string& filename, mesh::compression_type compression)
+{
+	close();
+
+	if(compression == mesh::COMPRESSION_EXT)
+		compression = mesh::get_compression(filename);
+
+	if(!is_supported(compression))
+	{
+		std::cerr << "psalm: Compressed input of this type is not supported by this version of psalm.\n";
+		return(false);
+	}
+
+	std::istream* source = &std::cin;
+	if(filename.length() > 0)
+	{
+		errno = 0;
+		file.open(filename.c_str(), std::ios::in | std::ios::binary);
+		if(errno)
+		{
+			std::string error = strerror(errno);
+			std::cerr	<< "psalm: Could not load input file \""
+					<< filename << "\": "
+					<< error << "\n";
+
+			return(false);
+		}
+
+		source = &file;
+	}
+
+	if(compression == mesh::COMPRESSION_NONE)
+		rdbuf(source->rdbuf());
+	else
+	{
+		buffer = new decompressor(*source, codec::create(compression, false));
+		rdbuf(buffer);
+	}
+
+	return(true);
+}
+
+/*!
+*	Stops decompressing and closes the file, if any.
+*/
+
+void compressed_ifstream::close()
+{
+	rdbuf(NULL);
+
+	delete(buffer);
+	buffer = NULL;
+
+	if(file.is_open())
+		file.close();
+}
+
+/*!
+*	@param compression Compression format
+*	@return true if the format can be read and written by this build
+*/
+
+bool compressed_ifstream::is_supported(mesh::compression_type compression)
+{
+	switch(compression)
+	{
+		case mesh::COMPRESSION_NONE:
+		case mesh::COMPRESSION_EXT:
+			return(true);
+
+		default:
+		{
+			codec* c = codec::create(compression, false);
+			delete(c);
+
+			return(c != NULL);
+		}
+	}
+}
+
+/*!
+*	Creates a stream that is not associated with any file.
+*/
+
+compressed_ofstream::compressed_ofstream() : std::ostream(NULL)
+{
+	buffer = NULL;
+}
+
+/*!
+*	Writes all remaining data and closes the file, if any.
+*/
+
+compressed_ofstream::~compressed_ofstream()
+{
+	close();
+}
+
+/*!
+*	Opens a file for writing. The file is overwritten if it exists.
+*
+*	@param filename		Name of the file. If the name is empty, standard
+*				output is used.
+*	@param compression	Compression format of the data. If
+*				COMPRESSION_EXT is specified, the format is
+*				determined by the extension of the file.
+*
+*	@return true if the file could be opened, else false
+*/
+
+bool compressed_ofstream::open(const std::string& filename, mesh::compression_type compression)
+{
+	close();
+
+	if(compression == mesh::COMPRESSION_EXT)
+		compression = mesh::get_compression(filename);
+
+	if(!compressed_ifstream::is_supported(compression))
+	{
+		std::cerr << "psalm: Compressed output of this type is not supported by this version of psalm.\n";
+		return(false);
+	}
+
+	std::ostream* sink = &std::cout;
+	if(filename.length() > 0)
+	{
+		errno = 0;
+		file.open(filename.c_str(), std::ios::out | std::ios::binary);
+		if(errno)
+		{
+			std::string error = strerror(errno);
+			std::cerr	<< "psalm: Could not save to file \""
+					<< filename << "\": "
+					<< error << "\n";
+
+			return(false);
+		}
+
+		sink = &file;
+	}
+
+	if(compression == mesh::COMPRESSION_NONE)
+		rdbuf(sink->rdbuf());
+	else
+	{
+		buffer = new compressor(*sink, codec::create(compression, true));
+		rdbuf(buffer);
+	}
+
+	return(true);
+}
+
+/*!
+*	Writes all remaining data and closes the file, if any.
+*
+*	@return true if all data could be written, else false
+*/
+
+bool compressed_ofstream::close()
+{
+	if(rdbuf() == NULL)
+		return(false);
+
+	bool result = good();
+	if(buffer)
+		result = (buffer->close() && result);
+	else
+		result = (rdbuf()->pubsync() == 0 && result);
+
+	rdbuf(NULL);
+
+	delete(buffer);
+	buffer = NULL;
+
+	if(file.is_open())
+	{
+		file.close();
+		result = (result && !file.fail());
+	}
+
+	return(result);
+}
+
+} // end of namespace "psalm"
@@ -0,0 +1,79 @@
+/*!
+*	@file	compressed_stream.h
+*	@brief	File streams with transparent gzip and zstd compression
+*/
+
+#ifndef __COMPRESSED_STREAM_H__
+#define __COMPRESSED_STREAM_H__
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "mesh.h"
+
+namespace psalm
+{
+
+class compressor;
+class decompressor;
+
+/*!
+*	@class compressed_ifstream
+*	@brief Input stream that decompresses a file or standard input
+*
+*	The data is decompressed in blocks by a separate thread (if the
+*	compiler supports C++11), so the parsers that read from the stream
+*	work in parallel to the decompression. Uncompressed data is read
+*	directly from the file.
+*/
+
+class compressed_ifstream : public std::istream
+{
+	public:
+		compressed_ifstream();
+		~compressed_ifstream();
+
+		bool open(const std::string& filename, mesh::compression_type compression = mesh::COMPRESSION_EXT);
+		void close();
+
+		static bool is_supported(mesh::compression_type compression);
+
+	private:
+		std::ifstream file;		///< Input file, if a file name has been specified
+		decompressor* buffer;		///< Buffer for decompressed data; NULL for uncompressed data
+
+		compressed_ifstream(const compressed_ifstream&);
+		compressed_ifstream& operator=(const compressed_ifstream&);
+};
+
+/*!
+*	@class compressed_ofstream
+*	@brief Output stream that compresses data written to a file or to
+*	standard output
+*
+*	The data is collected in blocks, which are compressed and written by a
+*	separate thread (if the compiler supports C++11). close() has to be
+*	called in order to find out whether all data could be written.
+*/
+
+class compressed_ofstream : public std::ostream
+{
+	public:
+		compressed_ofstream();
+		~compressed_ofstream();
+
+		bool open(const std::string& filename, mesh::compression_type compression = mesh::COMPRESSION_EXT);
+		bool close();
+
+	private:
+		std::ofstream file;		///< Output file, if a file name has been specified
+		compressor* buffer;		///< Buffer for uncompressed data; NULL if no compression is used
+
+		compressed_ofstream(const compressed_ofstream&);
+		compressed_ofstream& operator=(const compressed_ofstream&);
+};
+
+} // end of namespace "psalm"
+
+#endif
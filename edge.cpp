@@ -5,6 +5,11 @@
 
 #include <iostream>
 #include <cmath>
+#include <limits>
+
+#if __cplusplus >= 201103L
+	#include <atomic>
+#endif
 
 #include "edge.h"
 
@@ -18,6 +23,8 @@ namespace psalm
 edge::edge()
 {
 	set(NULL, NULL);
+	slot		= std::numeric_limits<size_t>::max();
+	boundary_slot	= std::numeric_limits<size_t>::max();
 }
 
 /*!
@@ -30,6 +37,8 @@ edge::edge()
 edge::edge(vertex* u, vertex* v)
 {
 	set(u,v);
+	slot		= std::numeric_limits<size_t>::max();
+	boundary_slot	= std::numeric_limits<size_t>::max();
 }
 
 /*!
@@ -48,7 +57,6 @@ void edge::set(vertex* u, vertex* v)
 		this->u = this->v = NULL;
 
 	f = g		= NULL;
-	edge_point	= NULL;
 	boundary	= boost::logic::indeterminate;
 }
 
@@ -135,15 +143,26 @@ void edge::set_f(face* f)
 
 void edge::set_g(face* g)
 {
+	// Edges do not know their mesh, so the warning is only shown once
+	// per process. Several meshes may be built concurrently, though.
+#if __cplusplus >= 201103L
+	static std::atomic<bool> warning_shown(false);
+#else
 	static bool warning_shown = false;
+#endif
+
 	if(	f != NULL && this->g != NULL &&
 		g != NULL) // warning is not shown if the second face is _reset_
 	{
-		if(!warning_shown)
-		{
+#if __cplusplus >= 201103L
+		bool shown	= warning_shown.exchange(true);
+#else
+		bool shown	= warning_shown;
+		warning_shown	= true;
+#endif
+
+		if(!shown)
 			std::cerr << "psalm: Warning: Mesh might be non-manifold.\n";
-			warning_shown = true;
-		}
 
 		return;
 	}
@@ -199,10 +218,10 @@ const face* edge::get_g() const
 *	@return true if the edge is a boundary edge, else false
 */
 
-bool edge::is_on_boundary()
+bool edge::is_on_boundary() const
 {
 	if(boost::logic::indeterminate(boundary))
-		boundary = (f == NULL) || (g == NULL);
+		return((f == NULL) || (g == NULL));
 
 	return(bool(boundary) == true);
 }
@@ -43,23 +43,18 @@ class edge
 		face*		get_g();
 		const face*	get_g() const;
 
-		/*!
-		*	@brief Pointer to edge point.
-		*
-		*	Pointer to edge point that corresponds to the current
-		*	edge.  This pointer is only set and read during
-		*	subdivision algorithms and must \e not be relied on
-		*	within other functions.
-		*/
-
-		vertex* edge_point;
-
-		bool is_on_boundary();
+		bool is_on_boundary() const;
 		void set_on_boundary(bool boundary = true);
 
 		double calc_length() const;
 		double calc_angle(const edge* e) const;
 
+		size_t get_slot() const;
+		void set_slot(size_t slot);
+
+		size_t get_boundary_slot() const;
+		void set_boundary_slot(size_t slot);
+
 	private:
 
 		vertex* u;			///< Pointer to start vertex
@@ -70,6 +65,12 @@ class edge
 
 		boost::logic::tribool boundary;	///< Flag signalling that the edge is a
 						///< boundary edge
+
+		size_t slot;			///< Position of the edge in the edge
+						///< vector of the mesh
+
+		size_t boundary_slot;		///< Position of the edge in the list
+						///< of boundary edges of the mesh
 };
 
 /*!
@@ -83,6 +84,49 @@ inline double edge::calc_length() const
 	return(d.length()); // XXX: Optimization?
 }
 
+/*!
+*	@return Position of the edge in the edge vector of the mesh
+*/
+
+inline size_t edge::get_slot() const
+{
+	return(slot);
+}
+
+/*!
+*	Sets the position of the edge in the edge vector of the mesh. This
+*	function is only supposed to be called by the mesh.
+*
+*	@param slot New position of the edge
+*/
+
+inline void edge::set_slot(size_t slot)
+{
+	this->slot = slot;
+}
+
+/*!
+*	@return Position of the edge in the list of boundary edges of the mesh
+*	or std::numeric_limits<size_t>::max() if the edge is not stored there
+*/
+
+inline size_t edge::get_boundary_slot() const
+{
+	return(boundary_slot);
+}
+
+/*!
+*	Sets the position of the edge in the list of boundary edges of the
+*	mesh. This function is only supposed to be called by the mesh.
+*
+*	@param slot New position of the edge
+*/
+
+inline void edge::set_boundary_slot(size_t slot)
+{
+	this->boundary_slot = slot;
+}
+
 } // end of namespace "psalm"
 
 #endif
@@ -0,0 +1,372 @@
+/*!
+*	@file	edge_table.h
+*	@brief	Hash table for looking up edges by their vertex indices
+*/
+
+#ifndef __EDGE_TABLE_H__
+#define __EDGE_TABLE_H__
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstddef>
+
+#include <boost/cstdint.hpp>
+
+namespace psalm
+{
+
+/*!
+*	@class edge_table
+*	@brief Open-addressing hash table for edges
+*
+*	Maps the (sorted) pair of vertex indices of an edge to an arbitrary
+*	value, e.g. a pointer or an index of the edge. The table uses linear
+*	probing in a single contiguous array of slots. Removals are handled by
+*	shifting subsequent entries backwards, so no tombstones are required
+*	and lookups never degrade after many removals.
+*
+*	The largest number that fits into a size_t is reserved for marking
+*	empty slots and must not be used as the first vertex index of a key.
+*	The hash function works best for dense indices below 2^32, such as the
+*	slots of the vertices.
+*/
+
+template <class T> class edge_table
+{
+	public:
+		typedef std::pair<size_t, size_t> key_type;
+
+		edge_table();
+
+		void reserve(size_t n);
+		void clear();
+		void swap(edge_table<T>& other);
+
+		size_t size() const;
+		bool empty() const;
+
+		T* find(const key_type& key);
+		const T* find(const key_type& key) const;
+
+		bool insert(const key_type& key, const T& value);
+		size_t insert(const std::vector<key_type>& keys, const std::vector<T>& values);
+		bool erase(const key_type& key);
+
+	private:
+
+		/*!
+		*	@struct slot
+		*	@brief Single entry of the table
+		*/
+
+		struct slot
+		{
+			key_type key;
+			T value;
+		};
+
+		std::vector<slot> slots;	///< Storage; size is always 0 or a power of 2
+		size_t mask;			///< Number of slots minus 1
+		size_t count;			///< Number of occupied slots
+
+		static const size_t empty_key = static_cast<size_t>(-1);
+
+		static size_t hash(const key_type& key);
+		size_t locate(const key_type& key) const;
+		void rehash(size_t capacity);
+};
+
+/*!
+*	Creates an empty table. Memory is allocated upon the first insertion
+*	or by calling reserve().
+*/
+
+template <class T> edge_table<T>::edge_table()
+{
+	mask = 0;
+	count = 0;
+}
+
+/*!
+*	Ensures that the table is able to store the given number of entries
+*	without growing.
+*
+*	@param n Expected number of entries
+*/
+
+template <class T> void edge_table<T>::reserve(size_t n)
+{
+	// Keep the load factor below 0.75
+	size_t capacity = 16;
+	while(capacity*3 < n*4)
+		capacity *= 2;
+
+	if(capacity > slots.size())
+		rehash(capacity);
+}
+
+/*!
+*	Removes all entries from the table. The allocated memory is kept.
+*/
+
+template <class T> void edge_table<T>::clear()
+{
+	for(size_t i = 0; i < slots.size(); i++)
+		slots[i].key.first = empty_key;
+
+	count = 0;
+}
+
+/*!
+*	Exchanges the contents of two tables in constant time.
+*
+*	@param other Table to swap with
+*/
+
+template <class T> void edge_table<T>::swap(edge_table<T>& other)
+{
+	slots.swap(other.slots);
+
+	std::swap(mask, other.mask);
+	std::swap(count, other.count);
+}
+
+/*!
+*	@return Number of entries stored in the table
+*/
+
+template <class T> inline size_t edge_table<T>::size() const
+{
+	return(count);
+}
+
+/*!
+*	@return true if the table does not contain any entries
+*/
+
+template <class T> inline bool edge_table<T>::empty() const
+{
+	return(count == 0);
+}
+
+/*!
+*	Combines both vertex indices into one hash value. The indices are
+*	packed into a single 64-bit word, which is then scrambled using the
+*	finalizer of the MurmurHash3 function.
+*/
+
+template <class T> inline size_t edge_table<T>::hash(const key_type& key)
+{
+	boost::uint64_t h = (static_cast<boost::uint64_t>(key.first) << 32) ^ static_cast<boost::uint64_t>(key.second);
+
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+
+	return(static_cast<size_t>(h));
+}
+
+/*!
+*	@return Index of the slot containing the key or, if the key is not
+*	stored in the table, index of the empty slot where the key would be
+*	inserted. The table must not be empty.
+*/
+
+template <class T> inline size_t edge_table<T>::locate(const key_type& key) const
+{
+	size_t i = hash(key) & mask;
+	while(slots[i].key.first != empty_key && slots[i].key != key)
+		i = (i+1) & mask;
+
+	return(i);
+}
+
+/*!
+*	@param key Sorted pair of vertex indices
+*	@return Pointer to the value stored for the key or NULL if the key
+*	could not be found. The pointer is invalidated by subsequent
+*	insertions and removals.
+*/
+
+template <class T> inline T* edge_table<T>::find(const key_type& key)
+{
+	if(count == 0)
+		return(NULL);
+
+	size_t i = locate(key);
+	if(slots[i].key.first == empty_key)
+		return(NULL);
+
+	return(&slots[i].value);
+}
+
+/*!
+*	@overload
+*/
+
+template <class T> inline const T* edge_table<T>::find(const key_type& key) const
+{
+	return(const_cast<edge_table<T>*>(this)->find(key));
+}
+
+/*!
+*	Inserts a new entry into the table.
+*
+*	@param key	Sorted pair of vertex indices
+*	@param value	Value to store for the key
+*
+*	@return true if the entry has been inserted, false if the key was
+*	already present. In the latter case, the stored value is not changed.
+*/
+
+template <class T> bool edge_table<T>::insert(const key_type& key, const T& value)
+{
+	if((count+1)*4 > slots.size()*3)
+		rehash(slots.empty() ? 16 : 2*slots.size());
+
+	size_t i = locate(key);
+	if(slots[i].key.first != empty_key)
+		return(false);
+
+	slots[i].key = key;
+	slots[i].value = value;
+
+	count++;
+	return(true);
+}
+
+/*!
+*	Inserts many entries at once. The entries are inserted in the order of
+*	their slots in the table instead of their order in the input. Thus,
+*	consecutive insertions access neighbouring slots, which is a lot
+*	friendlier to the cache than inserting the entries one after another
+*	into a large table.
+*
+*	@param keys	Sorted pairs of vertex IDs
+*	@param values	Values to store for the keys; must have the same size
+*			as `keys`
+*
+*	@return Number of entries that have been inserted. Keys that were
+*	already present (or that appear more than once) are only inserted
+*	once.
+*/
+
+template <class T> size_t edge_table<T>::insert(const std::vector<key_type>& keys, const std::vector<T>& values)
+{
+	size_t n = keys.size();
+	reserve(count+n);
+
+	// Distribute the entries into buckets of neighbouring slots using a
+	// counting sort over the upper bits of their ideal positions
+
+	size_t shift = 0;
+	while((slots.size() >> shift) > 65536)
+		shift++;
+
+	size_t num_buckets = slots.size() >> shift;
+
+	std::vector<size_t> homes(n);
+	std::vector<size_t> offsets(num_buckets+1, 0);
+
+	for(size_t i = 0; i < n; i++)
+	{
+		homes[i] = (hash(keys[i]) & mask) >> shift;
+		offsets[homes[i]+1]++;
+	}
+
+	for(size_t i = 0; i < num_buckets; i++)
+		offsets[i+1] += offsets[i];
+
+	std::vector<size_t> order(n);
+	for(size_t i = 0; i < n; i++)
+		order[offsets[homes[i]]++] = i;
+
+	size_t num_inserted = 0;
+	for(size_t i = 0; i < n; i++)
+	{
+		const key_type& key = keys[order[i]];
+
+		size_t j = locate(key);
+		if(slots[j].key.first != empty_key)
+			continue;
+
+		slots[j].key	= key;
+		slots[j].value	= values[order[i]];
+
+		num_inserted++;
+	}
+
+	count += num_inserted;
+	return(num_inserted);
+}
+
+/*!
+*	Removes an entry from the table. Subsequent entries of the same probe
+*	sequence are shifted backwards in order to close the gap.
+*
+*	@param key Sorted pair of vertex indices
+*	@return true if the entry has been removed, false if the key could not
+*	be found.
+*/
+
+template <class T> bool edge_table<T>::erase(const key_type& key)
+{
+	if(count == 0)
+		return(false);
+
+	size_t i = locate(key);
+	if(slots[i].key.first == empty_key)
+		return(false);
+
+	size_t j = i;
+	while(true)
+	{
+		j = (j+1) & mask;
+		if(slots[j].key.first == empty_key)
+			break;
+
+		// An entry may only be moved to the gap if its ideal
+		// position does not lie cyclically within (i,j].
+		size_t k = hash(slots[j].key) & mask;
+		if(	(i <= j && (k <= i || k > j)) ||
+			(i > j && (k <= i && k > j)))
+		{
+			slots[i] = slots[j];
+			i = j;
+		}
+	}
+
+	slots[i].key.first = empty_key;
+	count--;
+
+	return(true);
+}
+
+/*!
+*	Moves all entries into a new array of slots.
+*
+*	@param capacity New number of slots; must be a power of 2
+*/
+
+template <class T> void edge_table<T>::rehash(size_t capacity)
+{
+	std::vector<slot> old_slots(capacity);
+	old_slots.swap(slots);
+
+	for(size_t i = 0; i < slots.size(); i++)
+		slots[i].key.first = empty_key;
+
+	mask = capacity-1;
+	for(size_t i = 0; i < old_slots.size(); i++)
+	{
+		if(old_slots[i].key.first != empty_key)
+			slots[locate(old_slots[i].key)] = old_slots[i];
+	}
+}
+
+} // end of namespace "psalm"
+
+#endif
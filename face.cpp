@@ -20,10 +20,25 @@ namespace psalm
 
 face::face()
 {
-	face_point	= NULL;
 	id		= std::numeric_limits<size_t>::max();
+	slot		= std::numeric_limits<size_t>::max();
 	boundary	= false;
-	obtuse		= boost::logic::indeterminate;
+	obtuse		= false;
+	obtuse_known	= false;
+}
+
+/*!
+*	Reserves storage for the vertices and edges of the face. This is only
+*	required for faces with more than four vertices, which would otherwise
+*	need to reallocate their storage while being built.
+*
+*	@param n Number of vertices of the face
+*/
+
+void face::reserve(size_t n)
+{
+	V.reserve(n);
+	E.reserve(n);
 }
 
 /*!
@@ -121,34 +136,6 @@ size_t face::num_edges() const
 	return(E.size());
 }
 
-/*!
-*	Stores a new face vertex that corresponds to a vertex in the mesh.
-*
-*	@param v Pointer to new vertex.
-*	@warning The new vertex cannot be checked for consistency, i.e., there
-*	is no way of finding out whether the new vertex corresponds to a vertex
-*	of the face.
-*/
-
-void face::add_face_vertex(vertex* v)
-{
-	V_F.push_back(v);
-}
-
-/*!
-*	@param i Index of face vertex.
-*	@return Face vertex that corresponds to a vertex in the mesh or NULL if
-*	the index is out of range.
-*/
-
-vertex* face::get_face_vertex(size_t i)
-{
-	if(i >= V_F.size())
-		return(NULL);
-	else
-		return(V_F[i]);
-}
-
 /*!
 *	Returns value of flag signalling whether the face is a boundary face.
 *	Value of flag is supposed to be set by the user.
@@ -200,16 +187,17 @@ double face::calc_area() const
 
 bool face::is_obtuse()
 {
-	if(boost::logic::indeterminate(obtuse))
+	if(!obtuse_known)
 	{
 		double a = E[0].e->calc_length();
 		double b = E[1].e->calc_length();
 		double c = E[2].e->calc_length();
 
-		obtuse = (a*a+b*b < c*c) || (b*b* + c*c < a*a) || (c*c + a*a < b*b);
+		obtuse		= (a*a+b*b < c*c) || (b*b* + c*c < a*a) || (c*c + a*a < b*b);
+		obtuse_known	= true;
 	}
 
-	return(bool(obtuse) == true);
+	return(obtuse);
 }
 
 } // end of namespace "psalm"
@@ -6,10 +6,9 @@
 #ifndef __FACE_H__
 #define __FACE_H__
 
-#include <boost/logic/tribool.hpp>
-
 #include "vertex.h"
 #include "directed_edge.h"
+#include "small_vector.h"
 
 namespace psalm
 {
@@ -17,6 +16,9 @@ namespace psalm
 /*!
 *	@class face
 *	@brief Data for a face of the mesh
+*
+*	Vertices and edges of triangles and quadrangles are stored within the
+*	face itself. Only faces with more vertices need to allocate memory.
 */
 
 class face
@@ -24,31 +26,20 @@ class face
 	public:
 		face();
 
+		void reserve(size_t n);
+
 		void add_edge(const directed_edge& edge);
 		void add_vertex(vertex* v);
-		void add_face_vertex(vertex* v);
 
 		size_t num_edges() const;
 		size_t num_vertices() const;
 
 		vertex* get_vertex(size_t i);
 		const vertex* get_vertex(size_t i) const;
-		vertex* get_face_vertex(size_t i);
 
 		directed_edge& get_edge(size_t i);
 		const directed_edge& get_edge(size_t i) const;
 
-		/*!
-		*	@brief Pointer to face point.
-		*
-		*	Pointer to face point that corresponds to the current
-		*	face. This pointer is only set and read during
-		*	subdivision algorithms and must \e not be relied on
-		*	within other functions.
-		*/
-
-		vertex* face_point;
-
 		bool is_on_boundary() const;
 		void set_on_boundary(bool boundary = true);
 
@@ -58,28 +49,54 @@ class face
 
 		double calc_area() const;
 
-	private:
-		std::vector<directed_edge> E;
-		std::vector<vertex*> V;
+		size_t get_slot() const;
+		void set_slot(size_t slot);
 
-		std::vector<vertex*> V_F;
+	private:
+		small_vector<directed_edge, 4> E;
+		small_vector<vertex*, 4> V;
 
 		size_t id;
+		size_t slot;	///< Position of the face in the face vector of
+				///< the mesh; maintained by the mesh
 
 		bool boundary;	///< Flag signalling that the face is a
 				///< boundary face.
 
 		/*!
 		*	Flag signalling that the face is an obtuse triangle.
-		*	This makes only sense for triangles, of course. By
-		*	using the tribool, the function `is_obtuse()` may
-		*	decide whether it is required to _calculate_ the value
-		*	of the flag or can simply return it.
+		*	This makes only sense for triangles, of course. The
+		*	flag is only valid if `obtuse_known` is set, so the
+		*	function `is_obtuse()` may decide whether it is
+		*	required to _calculate_ the value of the flag or can
+		*	simply return it.
 		*/
 
-		boost::logic::tribool obtuse;
+		bool obtuse;
+		bool obtuse_known;	///< Signals that `obtuse` is valid
 };
 
+/*!
+*	@return Position of the face in the face vector of the mesh
+*/
+
+inline size_t face::get_slot() const
+{
+	return(slot);
+}
+
+/*!
+*	Sets the position of the face in the face vector of the mesh. This
+*	function is only supposed to be called by the mesh.
+*
+*	@param slot New position of the face
+*/
+
+inline void face::set_slot(size_t slot)
+{
+	this->slot = slot;
+}
+
 } // end of namespace "psalm"
 
 #endif
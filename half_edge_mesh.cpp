@@ -0,0 +1,432 @@
+/*!
+*	@file	half_edge_mesh.cpp
+*	@brief	Functions for the index-based half-edge mesh
+*/
+
+#include <iostream>
+#include <limits>
+
+#include "half_edge_mesh.h"
+#include "mesh.h"
+
+namespace psalm
+{
+
+const half_edge_mesh::index half_edge_mesh::invalid = std::numeric_limits<half_edge_mesh::index>::max();
+
+/*!
+*	Creates an empty half-edge mesh.
+*/
+
+half_edge_mesh::half_edge_mesh()
+{
+}
+
+/*!
+*	Reserves memory for the given number of elements. Calling this function
+*	prior to adding vertices and faces avoids repeated reallocations of the
+*	internal arrays.
+*
+*	@param num_vertices	Expected number of vertices
+*	@param num_faces	Expected number of faces
+*	@param num_edges	Expected number of edges. If this parameter is
+*				not specified, the number of edges is estimated
+*				from the number of vertices and faces by means
+*				of the Euler characteristic.
+*/
+
+void half_edge_mesh::reserve(size_t num_vertices, size_t num_faces, size_t num_edges)
+{
+	if(num_edges == 0)
+		num_edges = num_vertices + num_faces;
+
+	P.reserve(num_vertices);
+	V_H.reserve(num_vertices);
+	H.reserve(2*num_edges);
+	F_H.reserve(num_faces);
+
+	E_M.reserve(num_edges);
+}
+
+/*!
+*	Removes all elements from the mesh.
+*/
+
+void half_edge_mesh::destroy()
+{
+	P.clear();
+	V_H.clear();
+	H.clear();
+	F_H.clear();
+
+	E_M.clear();
+}
+
+/*!
+*	Replaces the current data with the data of a pointer-based mesh. The
+*	vertices of the half-edge mesh are numbered in the order of the vertex
+*	vector of the original mesh. Slots of removed vertices and faces are
+*	skipped, so the result matches the mesh after calling compact().
+*
+*	@param M Mesh to convert
+*
+*	@return true if the mesh could be converted, else false. The conversion
+*	fails for non-manifold meshes and meshes with inconsistently oriented
+*	faces. In this case, the half-edge mesh will be empty.
+*/
+
+bool half_edge_mesh::from_mesh(const mesh& M)
+{
+	destroy();
+	reserve(M.num_vertices(), M.num_faces(), M.num_edges());
+
+	// Maps the slot of a vertex to its index in the half-edge mesh; this
+	// only differs from the slot if vertices have been removed
+
+	std::vector<index> vertex_indices(M.num_vertices(), invalid);
+	for(size_t i = 0; i < M.num_vertices(); i++)
+	{
+		const vertex* v = M.get_vertex(i);
+		if(v != NULL)
+			vertex_indices[i] = add_vertex(v->get_position());
+	}
+
+	std::vector<index> vertices;
+	for(size_t i = 0; i < M.num_faces(); i++)
+	{
+		const face* f = M.get_face(i);
+		if(f == NULL)
+			continue;
+
+		vertices.clear();
+		for(size_t j = 0; j < f->num_vertices(); j++)
+			vertices.push_back(vertex_indices[f->get_vertex(j)->get_slot()]);
+
+		if(add_face(vertices) == invalid)
+		{
+			std::cerr << "psalm: Error: half_edge_mesh::from_mesh(): Unable to convert face " << i << "\n";
+
+			destroy();
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/*!
+*	Replaces the data of a pointer-based mesh with the data of the current
+*	mesh. Since all elements are stored contiguously, the mesh is created
+*	in bulk via mesh::build_from_indices(). The slot of every vertex of
+*	the new mesh corresponds to its index in the half-edge mesh, and faces
+*	keep their order.
+*
+*	@param M Mesh that will be overwritten
+*
+*	@return true if the mesh could be converted, else false
+*/
+
+bool half_edge_mesh::to_mesh(mesh& M) const
+{
+	std::vector<double> positions;
+	positions.reserve(3*P.size());
+
+	for(size_t i = 0; i < P.size(); i++)
+	{
+		positions.push_back(P[i][0]);
+		positions.push_back(P[i][1]);
+		positions.push_back(P[i][2]);
+	}
+
+	std::vector<size_t> face_offsets;
+	std::vector<size_t> face_indices;
+
+	face_offsets.reserve(F_H.size()+1);
+	face_indices.reserve(H.size()/2 + F_H.size());
+
+	face_offsets.push_back(0);
+	for(size_t i = 0; i < F_H.size(); i++)
+	{
+		index h = F_H[i];
+		do
+		{
+			face_indices.push_back(H[h].origin);
+			h = H[h].next;
+		}
+		while(h != F_H[i]);
+
+		face_offsets.push_back(face_indices.size());
+	}
+
+	if(!M.build_from_indices(positions, face_offsets, face_indices))
+	{
+		std::cerr << "psalm: Error: half_edge_mesh::to_mesh(): Unable to convert mesh\n";
+		return(false);
+	}
+
+	return(true);
+}
+
+/*!
+*	Adds a new face to the mesh. Edges that do not yet exist are created
+*	automatically. The vertices need to be specified in counterclockwise
+*	order. In contrast to mesh::add_face(), wrongly oriented faces are
+*	rejected because they cannot be represented with half-edges.
+*
+*	@param vertices Vector of vertex indices
+*
+*	@return Index of the new face or `invalid` if the face could not be
+*	added. In this case, the mesh remains unchanged.
+*/
+
+half_edge_mesh::index half_edge_mesh::add_face(const std::vector<index>& vertices)
+{
+	size_t n = vertices.size();
+	if(n < 3)
+	{
+		std::cerr << "psalm: Error: half_edge_mesh::add_face(): Face requires at least 3 vertices\n";
+		return(invalid);
+	}
+
+	// Check all edges before modifying the mesh; this ensures that the
+	// mesh remains consistent if the face cannot be added.
+
+	std::vector<index> half_edges(n, invalid);
+	for(size_t i = 0; i < n; i++)
+	{
+		index u = vertices[i];
+		index v = vertices[(i+1) % n];
+
+		if(u >= P.size() || v >= P.size() || u == v)
+		{
+			std::cerr << "psalm: Error: half_edge_mesh::add_face(): Invalid vertex indices\n";
+			return(invalid);
+		}
+
+		const index* e = E_M.find(calc_edge_id(u,v));
+		if(e != NULL)
+		{
+			index h = *e;
+			if(H[h].origin != u)
+				h = h ^ 1;
+
+			if(H[h].face != invalid)
+			{
+				std::cerr << "psalm: Error: half_edge_mesh::add_face(): Non-manifold edge or wrong orientation\n";
+				return(invalid);
+			}
+
+			half_edges[i] = h;
+		}
+	}
+
+	for(size_t i = 0; i < n; i++)
+	{
+		if(half_edges[i] == invalid)
+			half_edges[i] = add_edge(vertices[i], vertices[(i+1) % n]);
+	}
+
+	index f = static_cast<index>(F_H.size());
+	for(size_t i = 0; i < n; i++)
+	{
+		H[half_edges[i]].next = half_edges[(i+1) % n];
+		H[half_edges[i]].face = f;
+	}
+
+	F_H.push_back(half_edges[0]);
+
+	// Update outgoing half-edges of the vertices: Boundary half-edges are
+	// preferred because this permits a complete traversal of the 1-ring
+	// of boundary vertices. If the new face has been attached to the
+	// boundary half-edge of a vertex, the vertex may still have another
+	// one, which is found by rotating backwards around the vertex. The
+	// rotation stops at its start if the fan of faces is closed.
+
+	for(size_t i = 0; i < n; i++)
+	{
+		index u = vertices[i];
+		if(V_H[u] != invalid && H[V_H[u]].face == invalid)
+			continue;
+
+		index h = half_edges[i];
+		do
+		{
+			h = get_prev(h) ^ 1;
+		}
+		while(H[h].face != invalid && h != half_edges[i]);
+
+		V_H[u] = h;
+	}
+
+	return(f);
+}
+
+/*!
+*	Adds a triangular face to the mesh.
+*
+*	@param v1 Index of 1st vertex of new face
+*	@param v2 Index of 2nd vertex of new face
+*	@param v3 Index of 3rd vertex of new face
+*
+*	@return Index of new face or `invalid`
+*/
+
+half_edge_mesh::index half_edge_mesh::add_face(index v1, index v2, index v3)
+{
+	std::vector<index> vertices(3);
+
+	vertices[0] = v1;
+	vertices[1] = v2;
+	vertices[2] = v3;
+
+	return(add_face(vertices));
+}
+
+/*!
+*	Adds a quadrangular face to the mesh.
+*
+*	@param v1 Index of 1st vertex of new face
+*	@param v2 Index of 2nd vertex of new face
+*	@param v3 Index of 3rd vertex of new face
+*	@param v4 Index of 4th vertex of new face
+*
+*	@return Index of new face or `invalid`
+*/
+
+half_edge_mesh::index half_edge_mesh::add_face(index v1, index v2, index v3, index v4)
+{
+	std::vector<index> vertices(4);
+
+	vertices[0] = v1;
+	vertices[1] = v2;
+	vertices[2] = v3;
+	vertices[3] = v4;
+
+	return(add_face(vertices));
+}
+
+/*!
+*	Adds a new pair of half-edges to the mesh. Both half-edges are boundary
+*	half-edges until a face is assigned to them.
+*
+*	@param u Start vertex
+*	@param v End vertex
+*
+*	@return Index of the half-edge from u to v. Its twin points from v to u.
+*/
+
+half_edge_mesh::index half_edge_mesh::add_edge(index u, index v)
+{
+	index h = static_cast<index>(H.size());
+
+	half_edge h_uv = { u, invalid, invalid };
+	half_edge h_vu = { v, invalid, invalid };
+
+	H.push_back(h_uv);
+	H.push_back(h_vu);
+
+	E_M.insert(calc_edge_id(u,v), h);
+	return(h);
+}
+
+/*!
+*	@param u Start vertex
+*	@param v End vertex
+*
+*	@return Half-edge from u to v or `invalid` if the vertices are not
+*	connected by an edge.
+*/
+
+half_edge_mesh::index half_edge_mesh::find_half_edge(index u, index v) const
+{
+	const index* e = E_M.find(calc_edge_id(u,v));
+	if(e == NULL)
+		return(invalid);
+
+	index h = *e;
+	if(H[h].origin != u)
+		h = h ^ 1;
+
+	return(h);
+}
+
+/*!
+*	@return Previous half-edge within the same face or `invalid` for
+*	boundary half-edges. Since the previous half-edge is not stored, the
+*	function traverses the face.
+*/
+
+half_edge_mesh::index half_edge_mesh::get_prev(index h) const
+{
+	if(H[h].face == invalid)
+		return(invalid);
+
+	index p = h;
+	while(H[p].next != h)
+		p = H[p].next;
+
+	return(p);
+}
+
+/*!
+*	@return true if the vertex is isolated or if it has an outgoing
+*	boundary half-edge.
+*/
+
+bool half_edge_mesh::is_vertex_on_boundary(index v) const
+{
+	return(V_H[v] == invalid || H[V_H[v]].face == invalid);
+}
+
+/*!
+*	Calculates the valency of a vertex by traversing its 1-ring. At a
+*	non-manifold vertex, where several fans of faces meet, only the fan of
+*	the outgoing half-edge of the vertex is traversed.
+*
+*	@param v Vertex index
+*	@return Number of edges incident on the vertex
+*/
+
+size_t half_edge_mesh::valency(index v) const
+{
+	index h0 = V_H[v];
+	if(h0 == invalid)
+		return(0);
+
+	size_t n = 0;
+	index h = h0;
+	do
+	{
+		n++;
+
+		index t = h ^ 1;
+		if(H[t].face == invalid)
+			break;
+
+		h = H[t].next;
+	}
+	while(h != h0);
+
+	return(n);
+}
+
+/*!
+*	@param f Face index
+*	@return Number of vertices of the face
+*/
+
+size_t half_edge_mesh::num_face_vertices(index f) const
+{
+	size_t n = 0;
+	index h = F_H[f];
+	do
+	{
+		n++;
+		h = H[h].next;
+	}
+	while(h != F_H[f]);
+
+	return(n);
+}
+
+} // end of namespace "psalm"
@@ -0,0 +1,307 @@
+/*!
+*	@file	half_edge_mesh.h
+*	@brief	Index-based half-edge data structure for representing a mesh
+*/
+
+#ifndef __HALF_EDGE_MESH_H__
+#define __HALF_EDGE_MESH_H__
+
+#include <vector>
+#include <utility>
+
+#include <boost/cstdint.hpp>
+
+#include "v3ctor.h"
+#include "edge_table.h"
+
+namespace psalm
+{
+
+class mesh; // forward declaration; only required for conversion functions
+
+/*!
+*	@class half_edge_mesh
+*	@brief Compact half-edge representation of a mesh
+*
+*	In contrast to the pointer-based mesh class, all elements of this mesh
+*	are stored in contiguous arrays and refer to each other using 32-bit
+*	indices. Half-edges are always allocated in pairs: The half-edges 2i
+*	and 2i+1 form the ith edge of the mesh. Hence, the twin of a half-edge
+*	is implicit and need not be stored.
+*
+*	Half-edges on the boundary of the mesh do not belong to any face. For
+*	these half-edges, the face and the next half-edge are set to `invalid`.
+*
+*	The interface of this class mirrors the interface of the mesh class so
+*	that algorithms may be ported gradually. Use from_mesh() and to_mesh()
+*	for converting between both representations.
+*/
+
+class half_edge_mesh
+{
+	public:
+		typedef boost::uint32_t index;
+
+		static const index invalid;
+
+		half_edge_mesh();
+
+		void reserve(size_t num_vertices, size_t num_faces, size_t num_edges = 0);
+		void destroy();
+
+		bool from_mesh(const mesh& M);
+		bool to_mesh(mesh& M) const;
+
+		// Functions for modifying the topology of the mesh
+
+		index add_vertex(double x, double y, double z);
+		index add_vertex(const v3ctor& pos);
+
+		index add_face(const std::vector<index>& vertices);
+		index add_face(index v1, index v2, index v3);
+		index add_face(index v1, index v2, index v3, index v4);
+
+		size_t num_vertices() const;
+		size_t num_half_edges() const;
+		size_t num_edges() const;
+		size_t num_faces() const;
+
+		const v3ctor& get_position(index v) const;
+		void set_position(index v, const v3ctor& pos);
+
+		index get_edge(size_t i) const;
+		index get_face(size_t i) const;
+		index get_vertex_half_edge(index v) const;
+
+		index find_half_edge(index u, index v) const;
+
+		// Navigation
+
+		index get_origin(index h) const;
+		index get_target(index h) const;
+		index get_next(index h) const;
+		index get_prev(index h) const;
+		index get_twin(index h) const;
+		index get_face_of(index h) const;
+
+		bool is_on_boundary(index h) const;
+		bool is_vertex_on_boundary(index v) const;
+
+		size_t valency(index v) const;
+		size_t num_face_vertices(index f) const;
+
+	private:
+
+		/*!
+		*	@struct half_edge
+		*	@brief Directed half of an edge
+		*/
+
+		struct half_edge
+		{
+			index origin;	///< Index of start vertex
+			index next;	///< Next half-edge in the same face
+			index face;	///< Adjacent face (or `invalid` for boundary)
+		};
+
+		std::vector<v3ctor>	P;	///< Vertex positions
+		std::vector<index>	V_H;	///< Outgoing half-edge of each vertex
+		std::vector<half_edge>	H;	///< Half-edges, stored as pairs
+		std::vector<index>	F_H;	///< First half-edge of each face
+
+		edge_table<index> E_M;	///< Maps sorted vertex pairs to edges
+
+		index add_edge(index u, index v);
+		edge_table<index>::key_type calc_edge_id(index u, index v) const;
+};
+
+/*!
+*	@return Number of vertices currently stored in the mesh.
+*/
+
+inline size_t half_edge_mesh::num_vertices() const
+{
+	return(P.size());
+}
+
+/*!
+*	@return Number of half-edges currently stored in the mesh. This is
+*	always twice the number of edges.
+*/
+
+inline size_t half_edge_mesh::num_half_edges() const
+{
+	return(H.size());
+}
+
+/*!
+*	@return Number of edges currently stored in the mesh.
+*/
+
+inline size_t half_edge_mesh::num_edges() const
+{
+	return(H.size() / 2);
+}
+
+/*!
+*	@return Number of faces currently stored in the mesh.
+*/
+
+inline size_t half_edge_mesh::num_faces() const
+{
+	return(F_H.size());
+}
+
+/*!
+*	@param v Vertex index
+*	@return Position of the vertex. Caller has to ensure that the index is
+*	valid.
+*/
+
+inline const v3ctor& half_edge_mesh::get_position(index v) const
+{
+	return(P[v]);
+}
+
+/*!
+*	Sets a new position for a vertex.
+*
+*	@param v	Vertex index
+*	@param pos	New position
+*/
+
+inline void half_edge_mesh::set_position(index v, const v3ctor& pos)
+{
+	P[v] = pos;
+}
+
+/*!
+*	@param i Index of desired edge
+*	@return First half-edge of the ith edge. The second half-edge can be
+*	obtained via get_twin().
+*/
+
+inline half_edge_mesh::index half_edge_mesh::get_edge(size_t i) const
+{
+	return(static_cast<index>(2*i));
+}
+
+/*!
+*	@param i Index of desired face
+*	@return First half-edge of the ith face.
+*/
+
+inline half_edge_mesh::index half_edge_mesh::get_face(size_t i) const
+{
+	return(F_H[i]);
+}
+
+/*!
+*	@param v Vertex index
+*	@return An outgoing half-edge of the vertex or `invalid` if the vertex
+*	is isolated. For boundary vertices, the half-edge is guaranteed to be a
+*	boundary half-edge if one exists.
+*/
+
+inline half_edge_mesh::index half_edge_mesh::get_vertex_half_edge(index v) const
+{
+	return(V_H[v]);
+}
+
+/*!
+*	@return Start vertex of the half-edge.
+*/
+
+inline half_edge_mesh::index half_edge_mesh::get_origin(index h) const
+{
+	return(H[h].origin);
+}
+
+/*!
+*	@return End vertex of the half-edge.
+*/
+
+inline half_edge_mesh::index half_edge_mesh::get_target(index h) const
+{
+	return(H[h ^ 1].origin);
+}
+
+/*!
+*	@return Next half-edge within the same face or `invalid` for boundary
+*	half-edges.
+*/
+
+inline half_edge_mesh::index half_edge_mesh::get_next(index h) const
+{
+	return(H[h].next);
+}
+
+/*!
+*	@return Oppositely oriented half-edge of the same edge.
+*/
+
+inline half_edge_mesh::index half_edge_mesh::get_twin(index h) const
+{
+	return(h ^ 1);
+}
+
+/*!
+*	@return Face the half-edge belongs to or `invalid` for boundary
+*	half-edges.
+*/
+
+inline half_edge_mesh::index half_edge_mesh::get_face_of(index h) const
+{
+	return(H[h].face);
+}
+
+/*!
+*	@return true if the half-edge is a boundary half-edge, i.e. if it does
+*	not belong to any face.
+*/
+
+inline bool half_edge_mesh::is_on_boundary(index h) const
+{
+	return(H[h].face == invalid);
+}
+
+/*!
+*	Adds a vertex to the mesh.
+*
+*	@param pos Position of the new vertex
+*	@return Index of the new vertex
+*/
+
+inline half_edge_mesh::index half_edge_mesh::add_vertex(const v3ctor& pos)
+{
+	P.push_back(pos);
+	V_H.push_back(invalid);
+
+	return(static_cast<index>(P.size()-1));
+}
+
+/*!
+*	@overload
+*/
+
+inline half_edge_mesh::index half_edge_mesh::add_vertex(double x, double y, double z)
+{
+	return(add_vertex(v3ctor(x,y,z)));
+}
+
+/*!
+*	@returns ID of the edge described by vertices u and v, which is given
+*	as an std::pair sorted by vertex indices.
+*/
+
+inline edge_table<half_edge_mesh::index>::key_type half_edge_mesh::calc_edge_id(index u, index v) const
+{
+	if(u < v)
+		return(edge_table<index>::key_type(u, v));
+	else
+		return(edge_table<index>::key_type(v, u));
+}
+
+} // end of namespace "psalm"
+
+#endif
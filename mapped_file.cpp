@@ -0,0 +1,127 @@
+/*!
+*	@file	mapped_file.cpp
+*	@brief	Read-only access to the contents of a file via memory mapping
+*/
+
+#if defined(__unix__) || defined(__APPLE__)
+	#define PSALM_USE_MMAP
+#endif
+
+#ifdef PSALM_USE_MMAP
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#else
+	#include <fstream>
+#endif
+
+#include "mapped_file.h"
+
+namespace psalm
+{
+
+/*!
+*	Creates an empty mapping.
+*/
+
+mapped_file::mapped_file()
+{
+	data	= NULL;
+	length	= 0;
+}
+
+/*!
+*	Unmaps the file, if any.
+*/
+
+mapped_file::~mapped_file()
+{
+	close();
+}
+
+/*!
+*	Maps a file into memory. A file that is currently mapped is unmapped
+*	first.
+*
+*	@param filename Name of the file
+*
+*	@return true if the file could be mapped, else false. In particular,
+*	false is returned for empty files and for files that are not regular
+*	files.
+*/
+
+bool mapped_file::open(const std::string& filename)
+{
+	close();
+
+#ifdef PSALM_USE_MMAP
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if(fd < 0)
+		return(false);
+
+	struct stat info;
+	if(fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size <= 0)
+	{
+		::close(fd);
+		return(false);
+	}
+
+	void* address = mmap(NULL, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+
+	if(address == MAP_FAILED)
+		return(false);
+
+	// The parsers read the file front to back exactly once
+	madvise(address, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+
+	data	= static_cast<const char*>(address);
+	length	= static_cast<size_t>(info.st_size);
+#else
+	std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+	if(!in.good())
+		return(false);
+
+	in.seekg(0, std::ios::end);
+	std::streamoff size = in.tellg();
+	in.seekg(0, std::ios::beg);
+
+	if(size <= 0)
+		return(false);
+
+	buffer.resize(static_cast<size_t>(size));
+	in.read(&buffer[0], size);
+	if(in.gcount() != size)
+	{
+		buffer.clear();
+		return(false);
+	}
+
+	data	= &buffer[0];
+	length	= buffer.size();
+#endif
+
+	return(true);
+}
+
+/*!
+*	Unmaps the current file. Afterwards, the mapping is empty.
+*/
+
+void mapped_file::close()
+{
+	if(data == NULL)
+		return;
+
+#ifdef PSALM_USE_MMAP
+	munmap(const_cast<char*>(data), length);
+#else
+	std::vector<char>().swap(buffer);
+#endif
+
+	data	= NULL;
+	length	= 0;
+}
+
+} // end of namespace "psalm"
@@ -0,0 +1,93 @@
+/*!
+*	@file	mapped_file.h
+*	@brief	Read-only access to the contents of a file via memory mapping
+*/
+
+#ifndef __MAPPED_FILE_H__
+#define __MAPPED_FILE_H__
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace psalm
+{
+
+/*!
+*	@class mapped_file
+*	@brief Maps a file into memory for reading
+*
+*	The contents of the file are made available as a contiguous range of
+*	characters, so parsers may operate on the data directly instead of
+*	copying it through a stream. On systems without mmap(), the file is
+*	read into a buffer instead. Empty files and files that cannot be
+*	mapped (e.g. pipes) cause open() to fail; callers are expected to fall
+*	back to reading the file via a stream.
+*/
+
+class mapped_file
+{
+	public:
+		mapped_file();
+		~mapped_file();
+
+		bool open(const std::string& filename);
+		void close();
+
+		bool is_open() const;
+
+		const char* begin() const;
+		const char* end() const;
+		size_t size() const;
+
+	private:
+		const char* data;		///< First character of the file
+		size_t length;			///< Size of the file in bytes
+		std::vector<char> buffer;	///< Contents of the file if mmap() is not available
+
+		// Mappings must not be copied; the copy would unmap the data of
+		// the original when it is destroyed.
+
+		mapped_file(const mapped_file&);
+		mapped_file& operator=(const mapped_file&);
+};
+
+/*!
+*	@return true if a file is currently mapped
+*/
+
+inline bool mapped_file::is_open() const
+{
+	return(data != NULL);
+}
+
+/*!
+*	@return Pointer to the first character of the file
+*/
+
+inline const char* mapped_file::begin() const
+{
+	return(data);
+}
+
+/*!
+*	@return Pointer behind the last character of the file
+*/
+
+inline const char* mapped_file::end() const
+{
+	return(data+length);
+}
+
+/*!
+*	@return Size of the file in bytes
+*/
+
+inline size_t mapped_file::size() const
+{
+	return(length);
+}
+
+} // end of namespace "psalm"
+
+#endif
@@ -19,980 +19,2886 @@
 #include <cstring>
 
 #include "mesh.h"
+#include "compressed_stream.h"
+#include "mesh_sink.h"
+#include "mesh_writer.h"
+#include "ply.h"
+#include "mapped_file.h"
+#include "text_scanner.h"
+#include "chunked_parser.h"
+#include "v3ctor_kernels.h"
 
 namespace psalm
 {
 
 /*!
-*	Sets some default values.
+*	Maps an edge of one mesh to the corresponding edge of its copy.
+*
+*	@param e	Edge of the original mesh (may be NULL)
+*	@param E	Edges of the original mesh
+*	@param edge_map	Maps slots of the original mesh to edges of the copy
+*
+*	@return Edge of the copy or NULL if the edge is not stored in the
+*	original mesh
 */
 
-mesh::mesh()
+static edge* map_edge(const edge* e, const std::vector<edge*>& E, const std::vector<edge*>& edge_map)
 {
-	id_offset = 0;
+	if(e == NULL || e->get_slot() >= E.size() || E[e->get_slot()] != e)
+		return(NULL);
+
+	return(edge_map[e->get_slot()]);
 }
 
 /*!
-*	Destructor for mesh. Calls destroy() function (if the user did not
-*	already delete data).
+*	@param f Face (may be NULL)
+*	@param F Faces of a mesh
+*
+*	@return true if the face is stored in the mesh, i.e. it has not been
+*	removed from the mesh
 */
 
-mesh::~mesh()
+static bool is_stored_face(const face* f, const std::vector<face*>& F)
 {
-	destroy();
+	return(f != NULL && f->get_slot() < F.size() && F[f->get_slot()] == f);
 }
 
 /*!
-*	Tries to load data (presumably mesh data) that from an input source the
-*	user specified. The type of the data is determined by the following
-*	process:
-*
-*	1)	If the user did not specify a type:
-*
-*		1.1)	If the user specified a filename, the function tries to
-*		identify the file by its extension.
-*
-*			1.1.1)	If this identification fails, the function
-*			tries to load a PLY file.
-*
-*		1.2)	If the user did not specify a filename, the function
-*		tries to load PLY data from standard input.
-*
-*	2)	If the user specified a type:
-*
-*		2.1)	If the user specified a filename, the function tries to
-*		load the file with the appropriate type set, regardless of its
-*		extension.
-*
-*		2.2)	If the user did not specify a filename, the function
-*		tries to load data with the specified type from standard input.
-*
-*	@param filename Filename of data file. An empty filename signals that
-*	the function tries to read data from standard input.
+*	Maps a face of one mesh to the corresponding face of its copy. Faces
+*	that have been removed from the original mesh but are still referenced
+*	by its vertices or edges are mapped to NULL.
 *
-*	@param type Type of mesh data to load. By default, the function tries
-*	to guess the data type using filename extensions (if the user specified
-*	a filename).
+*	@param f	Face of the original mesh (may be NULL)
+*	@param F	Faces of the original mesh
+*	@param face_map	Maps slots of the original mesh to faces of the copy
 *
-*	@return	true if the mesh could be loaded, else false
+*	@return Face of the copy or NULL if the face is not stored in the
+*	original mesh
 */
 
-bool mesh::load(const std::string& filename, file_type type)
+static face* map_face(const face* f, const std::vector<face*>& F, const std::vector<face*>& face_map)
 {
-	status result = STATUS_UNDEFINED;
-
-	std::ifstream in;
-	if(filename.length() > 0)
-	{
-		errno = 0;
-		in.open(filename.c_str());
-		if(errno)
-		{
-			std::string error = strerror(errno);
-			std::cerr	<< "psalm: Could not load input file \""
-					<< filename << "\": "
-					<< error << "\n";
+	if(!is_stored_face(f, F))
+		return(NULL);
 
-			return(false);
-		}
-	}
+	return(face_map[f->get_slot()]);
+}
 
-	this->destroy();
+/*!
+*	@param e Boundary edge
+*
+*	@return Vertex at which the adjacent face of the edge enters the edge
+*/
 
-	// Filename given, data type identification by extension
-	if(filename.length() >= 4 && type == TYPE_EXT)
+static vertex* find_boundary_source(edge* e)
+{
+	face* f = e->get_f() ? e->get_f() : e->get_g();
+	for(size_t i = 0; i < f->num_edges(); i++)
 	{
-		std::string extension = filename.substr(filename.find_last_of('.')); // TODO: Handle errors
-		std::transform(extension.begin(), extension.end(), extension.begin(), (int(*)(int)) tolower);
+		if(f->get_edge(i).e == e)
+			return(f->get_vertex(i));
+	}
 
-		if(extension == ".ply")
-			result = (load_ply(in) ? STATUS_OK : STATUS_ERROR);
-		else if(extension == ".obj")
-			result = (load_obj(in) ? STATUS_OK : STATUS_ERROR);
-		else if(extension == ".off")
-			result = (load_off(in) ? STATUS_OK : STATUS_ERROR);
+	return(e->get_u());
+}
 
-		// Unknown extension, so we fall back to PLY files (see below)
-	}
+/*!
+*	Finds the boundary edge that continues a boundary loop at a vertex.
+*	Edges whose adjacent face enters them at the vertex are preferred, so
+*	loops that touch each other are not mixed up.
+*
+*	@param v	Vertex at which the loop continues
+*	@param visited	Marks boundary edges that already belong to a loop
+*
+*	@return Unvisited boundary edge or NULL if there is none
+*/
 
-	// Data type specified
-	else if(type != TYPE_EXT)
+static edge* find_next_boundary_edge(vertex* v, const std::vector<bool>& visited)
+{
+	edge* candidate = NULL;
+	for(size_t i = 0; i < v->valency(); i++)
 	{
-		// Check whether file name has been specified. If no file name
-		// has been specified, use standard input to read data.
+		edge* e = v->get_edge(i);
 
-		std::istream& input_stream = ((filename.length() > 0) ? in : std::cin);
-		switch(type)
-		{
-			case TYPE_PLY:
-				result = (load_ply(input_stream) ? STATUS_OK : STATUS_ERROR);
-				break;
+		size_t slot = e->get_boundary_slot();
+		if(slot == std::numeric_limits<size_t>::max() || visited[slot])
+			continue;
 
-			case TYPE_OBJ:
-				result = (load_obj(input_stream) ? STATUS_OK : STATUS_ERROR);
-				break;
+		if(find_boundary_source(e) == v)
+			return(e);
+		else if(candidate == NULL)
+			candidate = e;
+	}
 
-			case TYPE_OFF:
-				result = (load_off(input_stream) ? STATUS_OK : STATUS_ERROR);
-				break;
+	return(candidate);
+}
 
-			case TYPE_EXT: // to shut up the compiler
-				break;
-		}
-	}
+/*!
+*	@param filename Name of a file
+*	@return Extension of the file in lower case, including the dot, or an
+*	empty string if the file name has no extension
+*/
 
-	// Last resort: If a nonempty file name has been specified, try to
-	// parse a PLY file. Else, try to read a PLY file from standard input.
-	if(result == STATUS_UNDEFINED)
-	{
-		if(filename.length() > 0)
-			result = (load_ply(in) ? STATUS_OK : STATUS_ERROR);
-		else
-			result = (load_ply(std::cin) ? STATUS_OK : STATUS_ERROR);
-	}
+static std::string get_last_extension(const std::string& filename)
+{
+	size_t pos = filename.find_last_of("./");
+	if(pos == std::string::npos || filename[pos] != '.')
+		return(std::string());
 
-	in.close();
-	return(result);
+	std::string extension = filename.substr(pos);
+	std::transform(extension.begin(), extension.end(), extension.begin(), (int(*)(int)) tolower);
+
+	return(extension);
 }
 
 /*!
-*	Tries to save the current mesh data to a user-specified output (a file
-*	or an output stream).  The format of the mesh data is determined by the
-*	following process:
-*
-*	1)	If the user did not specify a type:
-*
-*		1.1)	If the user specified a filename, the function tries to
-*		identify the file by its extension.
-*
-*			1.1.1)	If this identification fails, the function
-*			tries to save a PLY file.
-*
-*		1.2)	If the user did not specify a filename, the function
-*		tries to save PLY data to standard output.
+*	Checks whether a PLY file contains the properties that are required
+*	for building a mesh and reserves memory for the index buffers.
 *
-*	2)	If the user specified a type:
-*
-*		2.1)	If the user specified a filename, the function tries to
-*		save the file with the appropriate type set, regardless of its
-*		extension.
-*
-*		2.2)	If the user did not specify a filename, the function
-*		tries to save data with the specified type to standard output.
-*
-*	@param filename Filename for storing the current mesh. An empty
-*	filename signals that standard output is to be used.
-*
-*	@param type Format in which to save the mesh data. By default, the
-*	function tries to guess the data type using filename extensions (if the
-*	user specified a filename).
-*
-*	@warning The data file will be overwritten if it exists. The user will
-*	not be notified of this.
+*	@param header		Header of the file
+*	@param positions	Vertex positions
+*	@param face_offsets	Offsets of the faces in the face index buffer
+*	@param face_indices	Vertex indices of the faces
 *
-*	@return	true if the mesh could be stored, else false.
+*	@return true if the mesh may be built from the file, else false
 */
 
-bool mesh::save(const std::string& filename, file_type type)
+static bool prepare_ply_buffers(const ply_header& header,
+				std::vector<double>& positions,
+				std::vector<size_t>& face_offsets,
+				std::vector<size_t>& face_indices)
 {
-	status result = STATUS_UNDEFINED;
+	face_offsets.push_back(0);
 
-	std::ofstream out;
-	if(filename.length() > 0)
+	for(size_t i = 0; i < header.num_elements(); i++)
 	{
-		errno = 0;
-		out.open(filename.c_str());
-		if(errno)
+		const ply_header::element& e = header.get_element(i);
+		if(e.name == "vertex")
 		{
-			std::string error = strerror(errno);
-			std::cerr	<< "psalm: Could not save to file \""
-					<< filename << "\": "
-					<< error << "\n";
+			if(	e.find_property("x") == e.properties.size() ||
+				e.find_property("y") == e.properties.size() ||
+				e.find_property("z") == e.properties.size())
+			{
+				std::cerr << "psalm: Vertex element lacks one of the properties \"x\", \"y\", or \"z\".\n";
+				return(false);
+			}
 
-			return(false);
+			positions.reserve(3*e.count);
 		}
-	}
-
-	// Filename given, data type identification by extension
-	if(filename.length() >= 4 && type == TYPE_EXT)
-	{
-		std::string extension = filename.substr(filename.find_last_of('.')); // TODO: Handle errors
-		std::transform(extension.begin(), extension.end(), extension.begin(), (int(*)(int)) tolower);
-
-		if(extension == ".ply")
-			result = (save_ply(out) ? STATUS_OK : STATUS_ERROR);
-		else if(extension == ".obj")
-			result = (save_obj(out) ? STATUS_OK : STATUS_ERROR);
-		else if(extension == ".off")
-			result = (save_off(out) ? STATUS_OK : STATUS_ERROR);
-		else if(extension == ".hole")
-			result = (save_hole(out) ? STATUS_OK : STATUS_ERROR);
-
-		// Unknown extension, so we fall back to PLY files (see below)
-	}
-
-	// Data type specified
-	else if(type != TYPE_EXT)
-	{
-		// Check whether file name has been specified. If no file name
-		// has been specified, use standard output to write data.
-
-		std::ostream& output_stream = ((filename.length() > 0) ? out : std::cout);
-
-		switch(type)
+		else if(e.name == "face")
 		{
-			case TYPE_PLY:
-				result = (save_ply(output_stream) ? STATUS_OK : STATUS_ERROR);
-				break;
-
-			case TYPE_OBJ:
-				result = (save_obj(output_stream) ? STATUS_OK : STATUS_ERROR);
-				break;
-
-			case TYPE_OFF:
-				result = (save_off(output_stream) ? STATUS_OK : STATUS_ERROR);
-				break;
+			if(e.find_face_property() == e.properties.size())
+			{
+				std::cerr << "psalm: Face element lacks the property \"vertex_indices\".\n";
+				return(false);
+			}
 
-			case TYPE_EXT: // to shut up the compiler
-				break;
+			face_offsets.reserve(e.count+1);
+			face_indices.reserve(3*e.count);
 		}
 	}
 
-	// Last resort: If a nonempty filename has been specified, try to
-	// write a PLY file. Else, try to write a PLY file to standard output.
-	if(result == STATUS_UNDEFINED)
-	{
-		if(filename.length() > 0)
-			result = (save_ply(out) ? STATUS_OK : STATUS_ERROR);
-		else
-			result = (save_ply(std::cout) ? STATUS_OK : STATUS_ERROR);
-	}
-
-	out.close();
-	return(result);
+	return(true);
 }
 
 /*!
-*	Tries to load mesh data in PLY format from an input stream.
+*	Reads the data of an ASCII PLY file into index buffers. Elements other
+*	than vertices and faces are skipped.
 *
-*	@param	in Input stream (file, standard input)
-*	@return	true if the mesh could be loaded, else false
+*	@param in		Input stream; points to the data of the file
+*	@param header		Header of the file
+*	@param positions	Vertex positions
+*	@param face_offsets	Offsets of the faces in the face index buffer
+*	@param face_indices	Vertex indices of the faces
+*
+*	@return true if the data could be read, else false
 */
 
-bool mesh::load_ply(std::istream& in)
+static bool read_ply_ascii(	std::istream& in,
+				const ply_header& header,
+				std::vector<double>& positions,
+				std::vector<size_t>& face_offsets,
+				std::vector<size_t>& face_indices)
 {
-	if(!in.good())
-		return(false);
-
-	std::string data;
-
-	// Read the headers: Only ASCII format is accepted, but the version is
-	// ignored
-
-	std::getline(in, data);
-	if(data != "ply")
-	{
-		std::cerr << "psalm: I am missing a \"ply\" header for the input data.\n";
-		return(false);
-	}
-
-	std::getline(in, data);
-	if(data.find("format ascii") == std::string::npos)
+	for(size_t i = 0; i < header.num_elements(); i++)
 	{
-		std::cerr << "psalm: Expected \"format ascii\", got \"" << data << "\" instead.\n";
-		return(false);
-	}
+		const ply_header::element& e = header.get_element(i);
 
-	/*
-		Parsing further element properties is quick and dirty: It is
-		assumed that face data is declared _after_ the vertex data.
-		Properties are assumed to come in the natural order, i.e.:
-
-			x
-			y
-			z
-
-		for vertex data.
-	*/
-
-	size_t num_vertices	= 0;
-	size_t num_faces	= 0;
-
-	enum modes
-	{
-		PARSE_HEADER,
-		PARSE_VERTEX_PROPERTIES,
-		PARSE_FACE_PROPERTIES
-	};
+		bool is_vertex	= (e.name == "vertex");
+		bool is_face	= (e.name == "face");
 
-	modes mode = PARSE_HEADER;
-	while(!in.eof())
-	{
-		getline(in, data);
+		std::vector<size_t> coordinates	= e.map_coordinates();
+		size_t face_property		= (is_face ? e.find_face_property() : e.properties.size());
 
-		/*
-			Lines contaning "comment" or "obj_info" are skipped.
-			Not sure whether obj_info is allowed to appear at all.
-		*/
-		if(	data.find("comment")  != std::string::npos ||
-			data.find("obj_info") != std::string::npos)
-			continue;
-		else if(data.find("end_header") != std::string::npos)
-			break;
+		double value;
+		double position[3];
 
-		switch(mode)
+		for(size_t j = 0; j < e.count; j++)
 		{
-			case PARSE_VERTEX_PROPERTIES:
-
-				if(data.find("property") != std::string::npos)
-				{
-					/*
-						Ignore. Some special handlings
-						for more properties could be
-						added here.
-					*/
-
-					continue;
-				}
-				else if(data.find("element face") != std::string::npos)
+			for(size_t k = 0; k < e.properties.size(); k++)
+			{
+				if(e.properties[k].is_list)
 				{
-					mode = PARSE_FACE_PROPERTIES;
+					size_t n = 0;
+					in >> n;
 
-					std::string dummy; // not necessary, but more readable
-					std::istringstream converter(data);
-					converter >> dummy >> dummy >> num_faces;
-
-					if(num_faces == 0)
+					for(size_t l = 0; l < n; l++)
 					{
-						std::cerr	<< "psalm: Can't parse number of faces from \""
-								<< data
-								<< "\".\n";
-						return(false);
+						if(k == face_property)
+						{
+							size_t v = 0;
+							in >> v;
+							face_indices.push_back(v);
+						}
+						else
+							in >> value;
 					}
-
-					mode = PARSE_FACE_PROPERTIES;
 				}
 				else
 				{
-					std::cerr << "psalm: Expected \"property\", but got \"" << data << "\" instead.\n";
-					return(false);
+					in >> value;
+					if(coordinates[k] < 3)
+						position[coordinates[k]] = value;
 				}
+			}
 
-				break;
+			if(in.fail())
+			{
+				std::cerr	<< "psalm: Unable to parse instance " << j
+						<< " of element \"" << e.name << "\".\n";
+				return(false);
+			}
+
+			if(is_vertex)
+				positions.insert(positions.end(), position, position+3);
+			else if(is_face)
+				face_offsets.push_back(face_indices.size());
+		}
+	}
 
-			case PARSE_FACE_PROPERTIES:
+	return(true);
+}
 
-				if(data.find("property list") == std::string::npos)
-				{
-					std::cerr << "Warning: Got \"" << data << "\". "
-					<< "This property is unknown and might lead "
-					<< "to problems when parsing the file.\n";
-				}
+/*!
+*	Reads the data of an ASCII PLY file that is stored in memory into
+*	index buffers. Elements other than vertices and faces are skipped.
+*
+*	@param in		Scanner for the data of the file
+*	@param header		Header of the file
+*	@param positions	Vertex positions
+*	@param face_offsets	Offsets of the faces in the face index buffer
+*	@param face_indices	Vertex indices of the faces
+*
+*	@return true if the data could be read, else false
+*/
 
-				break;
+static bool read_ply_ascii(	text_scanner& in,
+				const ply_header& header,
+				std::vector<double>& positions,
+				std::vector<size_t>& face_offsets,
+				std::vector<size_t>& face_indices)
+{
+	for(size_t i = 0; i < header.num_elements(); i++)
+	{
+		const ply_header::element& e = header.get_element(i);
 
-			// Expect "element vertex" line
-			case PARSE_HEADER:
+		bool is_vertex	= (e.name == "vertex");
+		bool is_face	= (e.name == "face");
 
-				if(data.find("element vertex") != std::string::npos)
-				{
-					mode = PARSE_VERTEX_PROPERTIES;
+		std::vector<size_t> coordinates	= e.map_coordinates();
+		size_t face_property		= (is_face ? e.find_face_property() : e.properties.size());
 
-					std::string dummy; // not necessary, but more readable
-					std::istringstream converter(data);
-					converter >> dummy >> dummy >> num_vertices;
+		double value;
+		double position[3];
 
-					if(num_vertices == 0)
-					{
-						std::cerr	<< "psalm: Can't parse number of vertices from \""
-								<< data
-								<< "\".\n";
+		for(size_t j = 0; j < e.count; j++)
+		{
+			bool complete = true;
+			for(size_t k = 0; k < e.properties.size() && complete; k++)
+			{
+				// Instances are usually stored on separate lines,
+				// but this is not required
+				in.skip_whitespace();
 
-						return(false);
-					}
+				if(e.properties[k].is_list)
+				{
+					size_t n = 0;
+					complete = in.read_size(n);
 
-					mode = PARSE_VERTEX_PROPERTIES;
+					for(size_t l = 0; l < n && complete; l++)
+					{
+						in.skip_whitespace();
+						if(k == face_property)
+						{
+							size_t v = 0;
+							complete = in.read_size(v);
+							face_indices.push_back(v);
+						}
+						else
+							complete = in.read_double(value);
+					}
 				}
 				else
 				{
-					std::cerr	<< "psalm: Got \""
-							<< data
-							<< "\", but expected \"element vertex\" "
-							<< "or \"element face\" instead. I cannot continue.\n";
-					return(false);
+					complete = in.read_double(value);
+					if(coordinates[k] < 3)
+						position[coordinates[k]] = value;
 				}
+			}
 
-				break;
-
-			default:
-				break;
-		}
-	}
-
-	size_t cur_line	= 0;
-	size_t k	= 0; // number of vertices for face
-
-	double x, y, z;
-	std::string line;
-	while(std::getline(in, line))
-	{
-		std::istringstream parser(line);
-		if(cur_line < num_vertices)
-		{
-			parser >> x >> y >> z;
-			add_vertex(x, y, z);
-		}
-		else
-		{
-			k = 0;
-			parser >> k;
-			if(k == 0)
-				break;
-
-			// Store vertices of face in proper order and add a new
-			// face.
-
-			std::vector<vertex*> vertices;
-			size_t v = 0;
-			for(size_t i = 0; i < k; i++)
+			if(!complete)
 			{
-				parser >> v;
-				vertices.push_back(get_vertex(v));
+				std::cerr	<< "psalm: Unable to parse instance " << j
+						<< " of element \"" << e.name << "\" in line \""
+						<< in.get_line() << "\".\n";
+				return(false);
 			}
 
-			add_face(vertices);
+			if(is_vertex)
+				positions.insert(positions.end(), position, position+3);
+			else if(is_face)
+				face_offsets.push_back(face_indices.size());
 		}
-
-		cur_line++;
 	}
 
-	/*
-	   FIXME
-
-	// Mark boundary vertices if the user has chosen to preserve them.
-	// Else, we do not need the additional information.
-	if(preserve_boundaries)
-		mark_boundaries();
-
-	*/
-
 	return(true);
 }
 
 /*!
-*	Saves the currently loaded mesh in PLY format.
-*
-*	@param	out Stream for data output
-*	@return	true if the mesh could be stored, else false.
+*	Header of PSM files, the native binary format of psalm. The header is
+*	followed by the arrays that are described in mesh::save_psm(). All
+*	values are stored in the byte order of the machine that wrote the
+*	file. Every array starts at an offset that is a multiple of 8, so the
+*	arrays of a mapped file can be used without copying or parsing them.
 */
 
-bool mesh::save_ply(std::ostream& out)
+struct psm_header
 {
-	if(!out.good())
-		return(false);
+	char magic[8];				///< Always "PSALMPSM"
+	boost::uint32_t version;		///< Version of the format
+	boost::uint32_t byte_order;		///< psm_byte_order, as stored by the writer
+
+	boost::uint64_t num_vertices;
+	boost::uint64_t num_edges;
+	boost::uint64_t num_faces;
+	boost::uint64_t num_corners;		///< Sum of the number of vertices of all faces
+	boost::uint64_t num_vertex_edges;	///< Sum of the valencies of all vertices
+	boost::uint64_t num_vertex_faces;	///< Sum of the number of adjacent faces of all vertices
+	boost::uint64_t num_boundary_edges;
+	boost::uint64_t id_offset;		///< Offset for the IDs of new vertices
+};
+
+static const char psm_magic[8]			= { 'P', 'S', 'A', 'L', 'M', 'P', 'S', 'M' };
+static const boost::uint32_t psm_version	= 1;
+static const boost::uint32_t psm_byte_order	= 0x01020304;
 
-	// header information
-	out	<< "ply\n"
-		<< "format ascii 1.0\n"
-		<< "element vertex " << V.size() << "\n"
-		<< "property float x\n"
-		<< "property float y\n"
-		<< "property float z\n"
-		<< "property uchar red\n"
-		<< "property uchar green\n"
-		<< "property uchar blue\n"
-		<< "element face " << F.size() << "\n"
-		<< "property list uchar int vertex_indices\n"
-		<< "end_header\n";
-
-	// write vertex list (separated by spaces)
-	for(size_t i = 0; i < V.size(); i++)
-	{
-		out << std::fixed << std::setprecision(8) << V[i]->get_position()[0] << " "
-						<< V[i]->get_position()[1] << " "
-						<< V[i]->get_position()[2];
+/*!
+*	Marks a missing face of an edge in PSM files
+*/
 
-		// XXX
-		if(V[i]->is_on_boundary())
-			out << " 255 0 0\n";
-		else
-			out << " 0 255 0\n";
+static const boost::uint64_t psm_none = ~static_cast<boost::uint64_t>(0);
+
+/*!
+*	@return true if the edge is one of the edges of the face
+*/
+
+static bool face_contains_edge(const face* f, const edge* e)
+{
+	for(size_t i = 0; i < f->num_edges(); i++)
+	{
+		if(f->get_edge(i).e == e)
+			return(true);
 	}
 
-	// write face list (separated by spaces)
-	for(size_t i = 0; i < F.size(); i++)
+	return(false);
+}
+
+/*!
+*	@return true if the vertex is one of the vertices of the face
+*/
+
+static bool face_contains_vertex(const face* f, const vertex* v)
+{
+	for(size_t i = 0; i < f->num_vertices(); i++)
 	{
-		out << F[i]->num_vertices() << " ";
-		for(size_t j = 0; j < F[i]->num_vertices(); j++)
-		{
-			out << F[i]->get_vertex(j)->get_id();
-			if(j < F[i]->num_vertices()-1)
-				out << " ";
-		}
+		if(f->get_vertex(i) == v)
+			return(true);
+	}
 
-		out << "\n";
+	return(false);
+}
+
+/*!
+*	Writes an array of a PSM file.
+*
+*	@param out	Stream for data output
+*	@param data	Values to write
+*/
+
+template <class T> static void write_psm_array(std::ostream& out, const std::vector<T>& data)
+{
+	if(!data.empty())
+		out.write(reinterpret_cast<const char*>(&data[0]), data.size()*sizeof(T));
+}
+
+/*!
+*	Checks the offsets of an adjacency list in a PSM file.
+*
+*	@param offsets	Offsets; the list contains n+1 entries
+*	@param n	Number of elements that own a list
+*	@param total	Total length of all lists
+*
+*	@return true if the offsets start with 0, are ascending, and end with
+*	the total length
+*/
+
+static bool check_psm_offsets(const boost::uint64_t* offsets, size_t n, boost::uint64_t total)
+{
+	if(offsets[0] != 0 || offsets[n] != total)
+		return(false);
+
+	for(size_t i = 0; i < n; i++)
+	{
+		if(offsets[i] > offsets[i+1])
+			return(false);
 	}
 
 	return(true);
 }
 
 /*!
-*	Loads a mesh in Wavefront OBJ format from an input stream. Almost all
-*	possible information from the input stream will be ignored gracefully
-*	because the program is only interested in the raw geometrical data.
+*	Checks indices that are stored in a PSM file.
 *
-*	@param	in Input stream (file, standard input)
-*	@return	true if the mesh could be loaded, else false
+*	@param indices		Indices
+*	@param n		Number of indices
+*	@param bound		Upper bound (exclusive) for valid indices
+*	@param allow_none	Flag signalling that psm_none is valid as well
+*
+*	@return true if all indices are valid
 */
 
-bool mesh::load_obj(std::istream &in)
+static bool check_psm_indices(const boost::uint64_t* indices, size_t n, boost::uint64_t bound, bool allow_none = false)
 {
-	if(!in.good())
-		return(false);
+	for(size_t i = 0; i < n; i++)
+	{
+		if(indices[i] >= bound && !(allow_none && indices[i] == psm_none))
+			return(false);
+	}
 
-	std::string line;
-	std::string keyword;
-	std::istringstream converter;
+	return(true);
+}
 
-	// These are specify the only keywords of the .OBJ file that the parse
-	// is going to understand
+/*!
+*	Reads the data of a binary PLY file into index buffers. Elements other
+*	than vertices and faces are skipped. Values are converted from the byte
+*	order of the file if necessary.
+*
+*	@param reader		Reader for the data of the file
+*	@param header		Header of the file
+*	@param positions	Vertex positions
+*	@param face_offsets	Offsets of the faces in the face index buffer
+*	@param face_indices	Vertex indices of the faces
+*
+*	@return true if the data could be read, else false
+*/
 
-	const std::string OBJ_KEY_VERTEX	= "v";
-	const std::string OBJ_KEY_FACE		= "f";
+static bool read_ply_binary(	ply_binary_reader& reader,
+				const ply_header& header,
+				std::vector<double>& positions,
+				std::vector<size_t>& face_offsets,
+				std::vector<size_t>& face_indices)
+{
+	bool swap = header.needs_swap();
 
-	while(!std::getline(in, line).eof())
+	for(size_t i = 0; i < header.num_elements(); i++)
 	{
-		converter.str(line);
-		converter >> keyword;
+		const ply_header::element& e = header.get_element(i);
 
-		if(keyword == OBJ_KEY_VERTEX)
+		// Elements without lists are read as a whole record; the
+		// coordinates are then accessed via their offsets
+		if(e.stride != 0)
 		{
-			double x, y, z;
-			converter >> x >> y >> z;
+			const ply_header::property* P[3] = {NULL, NULL, NULL};
+			if(e.name == "vertex")
+			{
+				P[0] = &e.properties[e.find_property("x")];
+				P[1] = &e.properties[e.find_property("y")];
+				P[2] = &e.properties[e.find_property("z")];
+			}
 
-			if(converter.fail())
+			for(size_t j = 0; j < e.count; j++)
 			{
-				std::cerr	<< "psalm: I tried to parse vertex coordinates from line \""
-						<< line
-						<<" \" and failed.\n";
-				return(false);
+				const char* record = reader.get(e.stride);
+				if(record == NULL)
+				{
+					std::cerr	<< "psalm: Unexpected end of data in instance " << j
+							<< " of element \"" << e.name << "\".\n";
+					return(false);
+				}
+
+				if(P[0])
+				{
+					for(size_t k = 0; k < 3; k++)
+						positions.push_back(ply_header::decode(record+P[k]->offset, P[k]->value_type, swap));
+				}
 			}
 
-			add_vertex(x,y,z);
+			continue;
 		}
-		else if(keyword == OBJ_KEY_FACE)
-		{
-			std::vector<vertex*> vertices;
 
-			// Check whether it is a triplet data string
-			if(line.find_first_of('/') != std::string::npos)
-			{
-				while(!converter.eof())
-				{
-					std::string index_str;
-					converter >> index_str;
+		// Elements with lists are read property by property
+		bool is_vertex		= (e.name == "vertex");
+		bool is_face		= (e.name == "face");
 
-					if(index_str.length() == 0)
-						continue;
+		std::vector<size_t> coordinates	= e.map_coordinates();
+		size_t face_property		= (is_face ? e.find_face_property() : e.properties.size());
 
-					size_t slash_pos = index_str.find_first_of('/'); // only interested in first occurrence
+		double position[3];
 
-					// Contains the index as a string (not
-					// including the '/'). The other
-					// attributes (normals, textures
-					// coordinates) are _removed_ here.
-					std::istringstream index_conv(index_str.substr(0, slash_pos));
+		for(size_t j = 0; j < e.count; j++)
+		{
+			bool complete = true;
+			for(size_t k = 0; k < e.properties.size(); k++)
+			{
+				const ply_header::property& p = e.properties[k];
+				size_t value_size = ply_header::get_size(p.value_type);
 
-					long index = 0;
-					index_conv >> index;
+				const char* data = NULL;
+				size_t n = 1;
 
-					if(index < 0)
+				if(p.is_list)
+				{
+					data = reader.get(ply_header::get_size(p.count_type));
+					if(data == NULL)
 					{
-						std::cerr << "psalm: Handling of negative indices not yet implemented.\n";
-						return(false);
+						complete = false;
+						break;
 					}
-					else
-						vertices.push_back(get_vertex(index-1));
+
+					n = static_cast<size_t>(ply_header::decode(data, p.count_type, swap));
 				}
 
-				add_face(vertices);
-			}
-			else
-			{
-				long index = 0;
-				while(!converter.eof())
+				data = reader.get(n*value_size);
+				if(data == NULL)
 				{
-					index = 0;
-					converter >> index;
-
-					if(index == 0)
-					{
-						std::cerr	<< "psalm: I cannot parse face data from line \""
-								<< line
-								<< "\".\n";
-						return(false);
-					}
+					complete = false;
+					break;
+				}
 
-					// Handle backwards references...
-					else if(index < 0)
-					{
-						// ...and check the range
-						if((V.size()+index) >= 0)
-							vertices.push_back(get_vertex(V.size()+index));
-						else
-						{
-							std::cerr	<< "psalm: Invalid backwards vertex reference "
-									<< "in line \""
-									<< line
-									<< "\".\n";
-							return(false);
-						}
-					}
-					else
-						vertices.push_back(get_vertex(index-1)); // Real men 0-index their variables.
+				if(k == face_property)
+				{
+					for(size_t l = 0; l < n; l++)
+						face_indices.push_back(static_cast<size_t>(ply_header::decode(data+l*value_size, p.value_type, swap)));
 				}
+				else if(!p.is_list && coordinates[k] < 3)
+					position[coordinates[k]] = ply_header::decode(data, p.value_type, swap);
+			}
 
-				add_face(vertices);
+			if(!complete)
+			{
+				std::cerr	<< "psalm: Unexpected end of data in instance " << j
+						<< " of element \"" << e.name << "\".\n";
+				return(false);
 			}
-		}
 
-		keyword.clear();
-		line.clear();
-		converter.clear();
+			if(is_vertex)
+				positions.insert(positions.end(), position, position+3);
+			else if(is_face)
+				face_offsets.push_back(face_indices.size());
+		}
 	}
 
 	return(true);
 }
 
 /*!
-*	Saves the currently loaded mesh in Wavefront OBJ format. Only raw
-*	geometrical data will be output.
+*	Sets some default values.
+*/
+
+mesh::mesh()
+{
+	id_offset			= 0;
+	num_removed_vertices		= 0;
+	num_removed_edges		= 0;
+	num_removed_faces		= 0;
+	orientation_warning_shown	= false;
+}
+
+/*!
+*	Destructor for mesh. Calls destroy() function (if the user did not
+*	already delete data).
+*/
+
+mesh::~mesh()
+{
+	destroy();
+}
+
+#if __cplusplus >= 201103L
+
+/*!
+*	Move constructor. The new mesh takes over all elements of the other
+*	mesh, which is empty afterwards. No elements are copied.
 *
-*	@param	out Stream for data output
-*	@return	true if the mesh could be stored, else false.
+*	@param M Mesh to move from
 */
 
-bool mesh::save_obj(std::ostream& out)
+mesh::mesh(mesh&& M)
 {
-	if(!out.good())
-		return(false);
+	id_offset			= 0;
+	num_removed_vertices		= 0;
+	num_removed_edges		= 0;
+	num_removed_faces		= 0;
+	orientation_warning_shown	= false;
 
-	for(std::vector<vertex*>::const_iterator it = V.begin(); it != V.end(); it++)
-	{
-		v3ctor position = (*it)->get_position();
-		out << "v "	<< position[0] << " "
-				<< position[1] << " "
-				<< position[2] << "\n";
-	}
+	swap(M);
+}
+
+/*!
+*	Move assignment operator. The current mesh is destroyed and takes
+*	over all elements of the other mesh, which is empty afterwards.
+*
+*	@param M Mesh to move from
+*	@return Reference to the current mesh
+*/
 
-	for(std::vector<face*>::const_iterator it = F.begin(); it != F.end(); it++)
+mesh& mesh::operator=(mesh&& M)
+{
+	if(this != &M)
 	{
-		out << "f ";
-		for(size_t i = 0; i < (*it)->num_vertices(); i++)
-		{
-			out << ((*it)->get_vertex(i)->get_id()+1); // OBJ is 1-indexed, not 0-indexed
-			if(i < (*it)->num_vertices()-1)
-				out << " ";
-		}
-		out << "\n";
+		destroy();
+		swap(M);
 	}
 
-	return(true);
+	return(*this);
 }
 
+#endif
+
 /*!
-*	Loads a mesh in ASCII Geomview format from an input stream.
+*	Exchanges the contents of two meshes in constant time. Pointers to
+*	elements remain valid, but the elements belong to the other mesh
+*	afterwards.
 *
-*	@param	in Input stream (file, standard input)
-*	@return	true if the mesh could be loaded, else false
+*	@param M Mesh to swap with
 */
 
-bool mesh::load_off(std::istream& in)
+void mesh::swap(mesh& M)
 {
-	if(!in.good())
-		return(false);
+	V.swap(M.V);
+	E.swap(M.E);
+	F.swap(M.F);
 
-	std::string line;
-	std::istringstream converter;
+	E_M.swap(M.E_M);
+	E_B.swap(M.E_B);
 
-	/*
-		Read "header", i.e.,
+	vertex_properties.swap(M.vertex_properties);
 
-			OFF
-			num_vertices num_faces num_edges
+	vertex_pool.swap(M.vertex_pool);
+	edge_pool.swap(M.edge_pool);
+	face_pool.swap(M.face_pool);
 
-		where num_edges is ignored.
-	*/
+	std::swap(num_removed_vertices, M.num_removed_vertices);
+	std::swap(num_removed_edges, M.num_removed_edges);
+	std::swap(num_removed_faces, M.num_removed_faces);
+	std::swap(id_offset, M.id_offset);
+	std::swap(orientation_warning_shown, M.orientation_warning_shown);
+}
 
-	std::getline(in, line);
-	if(line != "OFF")
-	{
-		std::cerr << "psalm: I am missing a \"OFF\" header for the input data.\n";
-		return(false);
-	}
+/*!
+*	Creates a deep copy of the current mesh. The copy contains new
+*	vertices, edges, and faces with the same positions, IDs, boundary
+*	flags, and adjacency information as the current ones, as well as
+*	copies of all vertex properties and of the list of boundary edges.
+*	The elements are stored in the same order as in the current mesh, but
+*	empty slots of removed vertices, edges, and faces are not copied, i.e.
+*	the copy is always compact. References to faces that have been removed
+*	are not copied either, and edges whose first face has been removed are
+*	changed as in compact().
+*
+*	Every element pool of the copy uses a single slab and every vector of
+*	the copy is allocated exactly once.
+*
+*	@param M Mesh that will contain the copy; any data stored in this mesh
+*	is destroyed.
+*/
 
-	size_t num_vertices, num_faces, num_edges;
-	size_t cur_line_num = 0; // count line numbers (after header)
+void mesh::clone(mesh& M) const
+{
+	if(&M == this)
+		return;
 
-	std::getline(in, line);
-	converter.str(line);
-	converter >> num_vertices >> num_faces >> num_edges;
+	M.destroy();
+	M.id_offset			= id_offset;
+	M.orientation_warning_shown	= orientation_warning_shown;
 
-	if(converter.fail())
-	{
-		std::cerr << "psalm: I cannot parse vertex, face, and edge numbers from \"" << line << "\"\n";
-		return(false);
-	}
+	size_t num_vertices	= V.size()-num_removed_vertices;
+	size_t num_edges	= E.size()-num_removed_edges;
+	size_t num_faces	= F.size()-num_removed_faces;
 
-	converter.clear();
-	line.clear();
+	M.V.reserve(num_vertices);
+	M.E.reserve(num_edges);
+	M.F.reserve(num_faces);
 
-	// These are specify the only keywords of the .OBJ file that the parse
-	// is going to understand
+	M.vertex_pool.reserve(num_vertices);
+	M.edge_pool.reserve(num_edges);
+	M.face_pool.reserve(num_faces);
 
-	while(!std::getline(in, line).eof())
+	// Maps slots of the current mesh to the elements of the copy
+
+	std::vector<vertex*> vertex_map(V.size(), NULL);
+	std::vector<edge*> edge_map(E.size(), NULL);
+	std::vector<face*> face_map(F.size(), NULL);
+
+	for(size_t i = 0; i < V.size(); i++)
 	{
-		converter.str(line);
+		const vertex* v = V[i];
+		if(v == NULL)
+			continue;
 
-		if(cur_line_num < num_vertices)
-		{
-			double x, y, z;
-			converter >> x >> y >> z;
+		const v3ctor& p = v->get_position();
 
-			if(converter.fail())
-			{
-				std::cerr	<< "psalm: I tried to parse vertex coordinates from line \""
-						<< line
-						<<" \" and failed.\n";
-				return(false);
-			}
+		vertex* w = new(M.vertex_pool.allocate()) vertex(p[0], p[1], p[2], v->get_id());
 
-			add_vertex(x,y,z);
-		}
-		else if((cur_line_num-num_vertices) < num_faces)
-		{
+		w->set_on_boundary(v->is_on_boundary());
+
+		w->set_slot(M.V.size());
+		M.V.push_back(w);
+
+		vertex_map[i] = w;
+	}
+
+	M.vertex_properties.reserve(vertex_properties.size());
+	for(size_t i = 0; i < vertex_properties.size(); i++)
+	{
+		property_base* p = vertex_properties[i]->clone();
+		if(num_removed_vertices > 0)
+		{
+			for(size_t j = 0; j < V.size(); j++)
+			{
+				if(vertex_map[j])
+					p->move(j, vertex_map[j]->get_slot());
+			}
+
+			p->resize(num_vertices);
+		}
+
+		M.vertex_properties.push_back(p);
+	}
+
+	for(size_t i = 0; i < E.size(); i++)
+	{
+		if(E[i] == NULL)
+			continue;
+
+		// Copying the edge retains its boundary flag, which may still
+		// be indeterminate
+		edge* e = new(M.edge_pool.allocate()) edge(*E[i]);
+
+		if(e->get_u())
+			e->set_u(vertex_map[e->get_u()->get_slot()]);
+		if(e->get_v())
+			e->set_v(vertex_map[e->get_v()->get_slot()]);
+
+		e->set_boundary_slot(std::numeric_limits<size_t>::max());
+
+		e->set_slot(M.E.size());
+		M.E.push_back(e);
+
+		edge_map[i] = e;
+	}
+
+	for(size_t i = 0; i < F.size(); i++)
+	{
+		const face* f = F[i];
+		if(f == NULL)
+			continue;
+
+		face* g = new(M.face_pool.allocate()) face;
+		g->reserve(f->num_vertices());
+
+		for(size_t j = 0; j < f->num_vertices(); j++)
+			g->add_vertex(vertex_map[f->get_vertex(j)->get_slot()]);
+
+		for(size_t j = 0; j < f->num_edges(); j++)
+		{
+			directed_edge d_e = f->get_edge(j);
+			d_e.e = map_edge(d_e.e, E, edge_map);
+
+			g->add_edge(d_e);
+		}
+
+		g->set_on_boundary(f->is_on_boundary());
+
+		g->set_slot(M.F.size());
+		M.F.push_back(g);
+
+		face_map[i] = g;
+	}
+
+	// Adjacency information that refers to faces
+
+	for(size_t i = 0; i < M.E.size(); i++)
+	{
+		edge* e = M.E[i];
+
+		face* f = map_face(e->get_f(), F, face_map);
+		face* g = map_face(e->get_g(), F, face_map);
+
+		// As in compact(), the remaining face of an edge whose first
+		// face has been removed becomes its first face
+		if(f == NULL)
+			std::swap(f, g);
+
+		// The second face needs to be reset first because set_g()
+		// refuses to overwrite it
+		e->set_g(NULL);
+
+		e->set_f(f);
+		e->set_g(g);
+
+		M.update_boundary(e);
+	}
+
+	for(size_t i = 0; i < V.size(); i++)
+	{
+		const vertex* v = V[i];
+		vertex* w = vertex_map[i];
+
+		if(v == NULL)
+			continue;
+
+		w->reserve(v->valency(), v->num_adjacent_faces());
+
+		for(size_t j = 0; j < v->valency(); j++)
+		{
+			edge* e = map_edge(v->get_edge(j), E, edge_map);
+			if(e)
+				w->add_edge(e);
+		}
+
+		for(size_t j = 0; j < v->num_adjacent_faces(); j++)
+		{
+			face* f = map_face(v->get_face(j), F, face_map);
+			if(f)
+				w->add_face(f);
+		}
+	}
+
+	// The edge table is rebuilt instead of copied because its values
+	// refer to the edges of the current mesh
+	M.rebuild_edge_table();
+}
+
+/*!
+*	Tries to load data (presumably mesh data) that from an input source the
+*	user specified. The type of the data is determined by the following
+*	process:
+*
+*	1)	If the user did not specify a type:
+*
+*		1.1)	If the user specified a filename, the function tries to
+*		identify the file by its extension.
+*
+*			1.1.1)	If this identification fails, the function
+*			tries to load a PLY file.
+*
+*		1.2)	If the user did not specify a filename, the function
+*		tries to load PLY data from standard input.
+*
+*	2)	If the user specified a type:
+*
+*		2.1)	If the user specified a filename, the function tries to
+*		load the file with the appropriate type set, regardless of its
+*		extension.
+*
+*		2.2)	If the user did not specify a filename, the function
+*		tries to load data with the specified type from standard input.
+*
+*	@param filename Filename of data file. An empty filename signals that
+*	the function tries to read data from standard input.
+*
+*	@param type Type of mesh data to load. By default, the function tries
+*	to guess the data type using filename extensions (if the user specified
+*	a filename).
+*
+*	@param compression Compression format of the data. By default, the
+*	format is determined by the extension of the file (".gz" or ".zst");
+*	data read from standard input is assumed to be uncompressed.
+*
+*	@return	true if the mesh could be loaded, else false
+*/
+
+bool mesh::load(const std::string& filename, file_type type, compression_type compression)
+{
+	// Regular files are mapped into memory and parsed directly. If this
+	// is not possible, e.g. for pipes or compressed files, the file is
+	// read as a stream.
+
+	if(compression == COMPRESSION_EXT)
+		compression = get_compression(filename);
+
+	mapped_file file;
+	compressed_ifstream in;
+
+	if(filename.length() == 0 || compression != COMPRESSION_NONE || !file.open(filename))
+	{
+		if(!in.open(filename, compression))
+			return(false);
+	}
+
+	this->destroy();
+
+	// Filename given, data type identification by extension. Unknown
+	// extensions result in a fallback to PLY files (see below).
+	if(type == TYPE_EXT)
+	{
+		std::string extension = get_extension(filename);
+		if(extension == ".obj")
+			type = TYPE_OBJ;
+		else if(extension == ".off")
+			type = TYPE_OFF;
+		else if(extension == ".psm")
+			type = TYPE_PSM;
+	}
+
+	// Last resort: If no type could be determined, try to parse a PLY
+	// file.
+	if(type == TYPE_EXT)
+		type = TYPE_PLY;
+
+	bool result = false;
+	switch(type)
+	{
+		case TYPE_PLY:
+			result = (file.is_open() ? load_ply(file.begin(), file.end()) : load_ply(in));
+			break;
+
+		case TYPE_OBJ:
+			result = (file.is_open() ? load_obj(file.begin(), file.end()) : load_obj(in));
+			break;
+
+		case TYPE_OFF:
+			result = (file.is_open() ? load_off(file.begin(), file.end()) : load_off(in));
+			break;
+
+		case TYPE_PSM:
+			result = (file.is_open() ? load_psm(file.begin(), file.end()) : load_psm(in));
+			break;
+
+		case TYPE_EXT: // to shut up the compiler
+			break;
+	}
+
+	return(result);
+}
+
+/*!
+*	Tries to save the current mesh data to a user-specified output (a file
+*	or an output stream).  The format of the mesh data is determined by the
+*	following process:
+*
+*	1)	If the user did not specify a type:
+*
+*		1.1)	If the user specified a filename, the function tries to
+*		identify the file by its extension.
+*
+*			1.1.1)	If this identification fails, the function
+*			tries to save a PLY file.
+*
+*		1.2)	If the user did not specify a filename, the function
+*		tries to save PLY data to standard output.
+*
+*	2)	If the user specified a type:
+*
+*		2.1)	If the user specified a filename, the function tries to
+*		save the file with the appropriate type set, regardless of its
+*		extension.
+*
+*		2.2)	If the user did not specify a filename, the function
+*		tries to save data with the specified type to standard output.
+*
+*	@param filename Filename for storing the current mesh. An empty
+*	filename signals that standard output is to be used.
+*
+*	@param type Format in which to save the mesh data. By default, the
+*	function tries to guess the data type using filename extensions (if the
+*	user specified a filename).
+*
+*	@param binary Flag signalling that PLY files should be written in
+*	binary format. The flag is ignored for all other formats.
+*
+*	@param compression Compression format of the file. By default, the
+*	format is determined by the extension of the file (".gz" or ".zst");
+*	data written to standard output is not compressed.
+*
+*	@param precision Number of decimal places of the coordinates in ASCII
+*	files, or PRECISION_SHORTEST for the shortest representation that is
+*	read back exactly. PRECISION_DEFAULT keeps the traditional format of
+*	every file type. Holes and binary files are not affected.
+*
+*	@warning The data file will be overwritten if it exists. The user will
+*	not be notified of this.
+*
+*	@return	true if the mesh could be stored, else false.
+*/
+
+bool mesh::save(const std::string& filename, file_type type, bool binary, compression_type compression, int precision)
+{
+	// Removed elements must not be written
+	compact();
+
+	// Holes are stored in a special format that requires the topology of
+	// the mesh, so they are not handled by mesh_writer
+	if(type == TYPE_EXT && get_extension(filename) == ".hole")
+	{
+		compressed_ofstream out;
+		if(!out.open(filename, compression))
+			return(false);
+
+		bool result = save_hole(out);
+		return(out.close() && result);
+	}
+
+	// PSM files store the topology of the mesh as well
+	if(type == TYPE_PSM || (type == TYPE_EXT && get_extension(filename) == ".psm"))
+	{
+		compressed_ofstream out;
+		if(!out.open(filename, compression))
+			return(false);
+
+		bool result = save_psm(out);
+		return(out.close() && result);
+	}
+
+	mesh_writer writer;
+	if(!writer.open(filename, type, binary, compression))
+		return(false);
+
+	writer.set_precision(precision);
+	return(save(writer));
+}
+
+/*!
+*	Determines the extension that identifies the format of a file. The
+*	extension of a compression format is skipped, i.e. "mesh.ply.gz"
+*	yields ".ply".
+*
+*	@param filename Name of a file
+*	@return Extension of the file in lower case, including the dot, or an
+*	empty string if the file name has no extension
+*/
+
+std::string mesh::get_extension(const std::string& filename)
+{
+	std::string extension = get_last_extension(filename);
+	if(get_compression(filename) != COMPRESSION_NONE)
+		extension = get_last_extension(filename.substr(0, filename.length()-extension.length()));
+
+	return(extension);
+}
+
+/*!
+*	@param filename Name of a file
+*	@return Compression format that belongs to the extension of the file;
+*	COMPRESSION_NONE for unknown extensions
+*/
+
+mesh::compression_type mesh::get_compression(const std::string& filename)
+{
+	std::string extension = get_last_extension(filename);
+	if(extension == ".gz")
+		return(COMPRESSION_GZIP);
+	else if(extension == ".zst")
+		return(COMPRESSION_ZSTD);
+
+	return(COMPRESSION_NONE);
+}
+
+/*!
+*	Tries to load mesh data in PLY format from an input stream. ASCII as
+*	well as binary (little endian and big endian) files are supported. The
+*	vertex positions are taken from the properties "x", "y", and "z" of the
+*	"vertex" element, the faces from the list property "vertex_indices"
+*	(or "vertex_index") of the "face" element. All other elements and
+*	properties are skipped.
+*
+*	@param	in Input stream (file, standard input)
+*	@return	true if the mesh could be loaded, else false
+*/
+
+bool mesh::load_ply(std::istream& in)
+{
+	if(!in.good())
+		return(false);
+
+	ply_header header;
+	if(!header.read(in))
+		return(false);
+
+	// Collect the data in index buffers first; the mesh is built
+	// afterwards
+
+	std::vector<double> positions;
+	std::vector<size_t> face_offsets;
+	std::vector<size_t> face_indices;
+
+	if(!prepare_ply_buffers(header, positions, face_offsets, face_indices))
+		return(false);
+
+	bool result;
+	if(header.is_binary())
+	{
+		ply_binary_reader reader(in);
+		result = read_ply_binary(reader, header, positions, face_offsets, face_indices);
+	}
+	else
+		result = read_ply_ascii(in, header, positions, face_offsets, face_indices);
+
+	if(!result)
+		return(false);
+
+	if(!build_from_indices(positions, face_offsets, face_indices))
+		return(false);
+
+	/*
+	   FIXME
+
+	// Mark boundary vertices if the user has chosen to preserve them.
+	// Else, we do not need the additional information.
+	if(preserve_boundaries)
+		mark_boundaries();
+
+	*/
+
+	return(true);
+}
+
+/*!
+*	Loads mesh data in PLY format from memory, e.g. from a mapped file.
+*	This function supports the same formats as the stream-based variant.
+*
+*	@param begin	First character of the data
+*	@param end	End of the data
+*
+*	@return	true if the mesh could be loaded, else false
+*/
+
+bool mesh::load_ply(const char* begin, const char* end)
+{
+	// The header is short, so it is parsed by the stream-based parser.
+	// If it is not terminated, only the first line is passed so that the
+	// parser reports a sensible error.
+
+	const char marker[] = "\nend_header";
+	const char* header_end = std::search(begin, end, marker, marker+sizeof(marker)-1);
+
+	if(header_end != end)
+		header_end += sizeof(marker)-1;
+
+	header_end = std::find(header_end == end ? begin : header_end, end, '\n');
+	if(header_end != end)
+		header_end++;
+
+	std::istringstream header_stream(std::string(begin, header_end));
+
+	ply_header header;
+	if(!header.read(header_stream))
+		return(false);
+
+	std::vector<double> positions;
+	std::vector<size_t> face_offsets;
+	std::vector<size_t> face_indices;
+
+	if(!prepare_ply_buffers(header, positions, face_offsets, face_indices))
+		return(false);
+
+	bool result;
+	if(header.is_binary())
+	{
+		ply_binary_reader reader(header_end, end);
+		result = read_ply_binary(reader, header, positions, face_offsets, face_indices);
+	}
+	else
+	{
+		// Instances are usually stored on separate lines, which
+		// permits parsing them in parallel. Otherwise, the data is
+		// parsed sequentially.
+
+		chunked_parser parser(header_end, end);
+		chunked_parser::status status = parser.parse_elements(header, false, positions, face_offsets, face_indices);
+
+		result = (status == chunked_parser::STATUS_OK);
+		if(status == chunked_parser::STATUS_MISMATCH)
+		{
+			positions.clear();
+			face_offsets.assign(1, 0);
+			face_indices.clear();
+
+			text_scanner scanner(header_end, end);
+			result = read_ply_ascii(scanner, header, positions, face_offsets, face_indices);
+		}
+	}
+
+	if(!result)
+		return(false);
+
+	return(build_from_indices(positions, face_offsets, face_indices));
+}
+
+/*!
+*	Saves the currently loaded mesh in PLY format. Binary files are
+*	always written in little endian byte order, with coordinates stored
+*	as single-precision floats.
+*
+*	@param	out	Stream for data output
+*	@param	binary	Flag signalling that the data should be written in
+*			binary format instead of ASCII
+*
+*	@return	true if the mesh could be stored, else false.
+*/
+
+bool mesh::save_ply(std::ostream& out, bool binary)
+{
+	mesh_writer writer;
+	return(writer.open(out, TYPE_PLY, binary) && save(writer));
+}
+
+/*!
+*	Loads a mesh in Wavefront OBJ format from an input stream. Almost all
+*	possible information from the input stream will be ignored gracefully
+*	because the program is only interested in the raw geometrical data.
+*
+*	@param	in Input stream (file, standard input)
+*	@return	true if the mesh could be loaded, else false
+*/
+
+bool mesh::load_obj(std::istream &in)
+{
+	if(!in.good())
+		return(false);
+
+	std::string line;
+	std::string keyword;
+	std::istringstream converter;
+
+	// These are specify the only keywords of the .OBJ file that the parse
+	// is going to understand
+
+	const std::string OBJ_KEY_VERTEX	= "v";
+	const std::string OBJ_KEY_FACE		= "f";
+
+	// The mesh is built from these buffers after the whole file has been
+	// parsed
+
+	std::vector<double> positions;
+	std::vector<size_t> face_offsets(1, 0);
+	std::vector<size_t> face_indices;
+
+	while(!std::getline(in, line).eof())
+	{
+		converter.str(line);
+		converter >> keyword;
+
+		if(keyword == OBJ_KEY_VERTEX)
+		{
+			double x, y, z;
+			converter >> x >> y >> z;
+
+			if(converter.fail())
+			{
+				std::cerr	<< "psalm: I tried to parse vertex coordinates from line \""
+						<< line
+						<<" \" and failed.\n";
+				return(false);
+			}
+
+			positions.push_back(x);
+			positions.push_back(y);
+			positions.push_back(z);
+		}
+		else if(keyword == OBJ_KEY_FACE)
+		{
+
+			// Check whether it is a triplet data string
+			if(line.find_first_of('/') != std::string::npos)
+			{
+				while(!converter.eof())
+				{
+					std::string index_str;
+					converter >> index_str;
+
+					if(index_str.length() == 0)
+						continue;
+
+					size_t slash_pos = index_str.find_first_of('/'); // only interested in first occurrence
+
+					// Contains the index as a string (not
+					// including the '/'). The other
+					// attributes (normals, textures
+					// coordinates) are _removed_ here.
+					std::istringstream index_conv(index_str.substr(0, slash_pos));
+
+					long index = 0;
+					index_conv >> index;
+
+					if(index < 0)
+					{
+						std::cerr << "psalm: Handling of negative indices not yet implemented.\n";
+						return(false);
+					}
+					else
+						face_indices.push_back(index-1);
+				}
+
+				face_offsets.push_back(face_indices.size());
+			}
+			else
+			{
+				long index = 0;
+				while(!converter.eof())
+				{
+					index = 0;
+					converter >> index;
+
+					if(index == 0)
+					{
+						std::cerr	<< "psalm: I cannot parse face data from line \""
+								<< line
+								<< "\".\n";
+						return(false);
+					}
+
+					// Handle backwards references...
+					else if(index < 0)
+					{
+						// ...and check the range
+						long num_vertices = static_cast<long>(positions.size()/3);
+						if((num_vertices+index) >= 0)
+							face_indices.push_back(num_vertices+index);
+						else
+						{
+							std::cerr	<< "psalm: Invalid backwards vertex reference "
+									<< "in line \""
+									<< line
+									<< "\".\n";
+							return(false);
+						}
+					}
+					else
+						face_indices.push_back(index-1); // Real men 0-index their variables.
+				}
+
+				face_offsets.push_back(face_indices.size());
+			}
+		}
+
+		keyword.clear();
+		line.clear();
+		converter.clear();
+	}
+
+	return(build_from_indices(positions, face_offsets, face_indices));
+}
+
+/*!
+*	Loads a mesh in Wavefront OBJ format from memory, e.g. from a mapped
+*	file. Only vertices and faces are parsed; all other lines are skipped.
+*	Face indices may contain texture coordinates and normals, which are
+*	ignored, and may refer to previous vertices via negative indices.
+*	Large files are split into chunks that are parsed in parallel.
+*
+*	@param begin	First character of the data
+*	@param end	End of the data
+*
+*	@return	true if the mesh could be loaded, else false
+*/
+
+bool mesh::load_obj(const char* begin, const char* end)
+{
+	std::vector<double> positions;
+	std::vector<size_t> face_offsets;
+	std::vector<size_t> face_indices;
+
+	chunked_parser parser(begin, end);
+	if(!parser.parse_obj(positions, face_offsets, face_indices))
+		return(false);
+
+	return(build_from_indices(positions, face_offsets, face_indices));
+}
+
+/*!
+*	Saves the currently loaded mesh in Wavefront OBJ format. Only raw
+*	geometrical data will be output.
+*
+*	@param	out Stream for data output
+*	@return	true if the mesh could be stored, else false.
+*/
+
+bool mesh::save_obj(std::ostream& out)
+{
+	mesh_writer writer;
+	return(writer.open(out, TYPE_OBJ) && save(writer));
+}
+
+/*!
+*	Loads a mesh in ASCII Geomview format from an input stream.
+*
+*	@param	in Input stream (file, standard input)
+*	@return	true if the mesh could be loaded, else false
+*/
+
+bool mesh::load_off(std::istream& in)
+{
+	if(!in.good())
+		return(false);
+
+	std::string line;
+	std::istringstream converter;
+
+	/*
+		Read "header", i.e.,
+
+			OFF
+			num_vertices num_faces num_edges
+
+		where num_edges is ignored.
+	*/
+
+	std::getline(in, line);
+	if(line != "OFF")
+	{
+		std::cerr << "psalm: I am missing a \"OFF\" header for the input data.\n";
+		return(false);
+	}
+
+	size_t num_vertices, num_faces, num_edges;
+	size_t cur_line_num = 0; // count line numbers (after header)
+
+	std::getline(in, line);
+	converter.str(line);
+	converter >> num_vertices >> num_faces >> num_edges;
+
+	if(converter.fail())
+	{
+		std::cerr << "psalm: I cannot parse vertex, face, and edge numbers from \"" << line << "\"\n";
+		return(false);
+	}
+
+	converter.clear();
+	line.clear();
+
+	// The mesh is built from these buffers after the whole file has been
+	// parsed
+
+	std::vector<double> positions;
+	std::vector<size_t> face_offsets;
+	std::vector<size_t> face_indices;
+
+	positions.reserve(3*num_vertices);
+	face_offsets.reserve(num_faces+1);
+	face_indices.reserve(3*num_faces);
+
+	face_offsets.push_back(0);
+
+	while(!std::getline(in, line).eof())
+	{
+		converter.str(line);
+
+		if(cur_line_num < num_vertices)
+		{
+			double x, y, z;
+			converter >> x >> y >> z;
+
+			if(converter.fail())
+			{
+				std::cerr	<< "psalm: I tried to parse vertex coordinates from line \""
+						<< line
+						<<" \" and failed.\n";
+				return(false);
+			}
+
+			positions.push_back(x);
+			positions.push_back(y);
+			positions.push_back(z);
+		}
+		else if((cur_line_num-num_vertices) < num_faces)
+		{
 			size_t k	= 0;
 			size_t index	= 0;
 
-			converter >> k;
+			converter >> k;
+
+			for(size_t i = 0; i < k; i++)
+			{
+				converter >> index;
+				if(converter.fail())
+				{
+					std::cerr	<< "psalm: Tried to parse face data in line \""
+							<< line
+							<< "\", but failed.\n";
+					return(false);
+				}
+
+				if(index >= num_vertices)
+				{
+					std::cerr	<< "psalm: Index " << index << "in line \""
+							<< line
+						<< "\" is out of bounds.\n";
+					return(false);
+				}
+
+				face_indices.push_back(index);
+			}
+
+			face_offsets.push_back(face_indices.size());
+		}
+		else
+		{
+			std::cerr << "psalm: Got an unexpected data line \"" << line << "\".\n";
+			return(false);
+		}
+
+		cur_line_num++;
+
+		converter.clear();
+		line.clear();
+	}
+
+	return(build_from_indices(positions, face_offsets, face_indices));
+}
+
+/*!
+*	Loads a mesh in ASCII Geomview format from memory, e.g. from a mapped
+*	file. Empty lines and comments are skipped. Large files are split into
+*	chunks that are parsed in parallel.
+*
+*	@param begin	First character of the data
+*	@param end	End of the data
+*
+*	@return	true if the mesh could be loaded, else false
+*/
+
+bool mesh::load_off(const char* begin, const char* end)
+{
+	text_scanner in(begin, end);
+
+	if(!in.match("OFF") || !in.eol())
+	{
+		std::cerr << "psalm: I am missing a \"OFF\" header for the input data.\n";
+		return(false);
+	}
+
+	in.skip_line();
+
+	size_t num_vertices, num_faces, num_edges;
+	if(!in.read_size(num_vertices) || !in.read_size(num_faces) || !in.read_size(num_edges))
+	{
+		std::cerr << "psalm: I cannot parse vertex, face, and edge numbers from \"" << in.get_line() << "\"\n";
+		return(false);
+	}
+
+	in.skip_line();
+
+	// The data lines are described in terms of PLY elements, which
+	// permits parsing them in parallel
+
+	ply_header layout;
+
+	layout.add_element("vertex", num_vertices);
+	layout.add_property("x", ply_header::TYPE_FLOAT64);
+	layout.add_property("y", ply_header::TYPE_FLOAT64);
+	layout.add_property("z", ply_header::TYPE_FLOAT64);
+
+	layout.add_element("face", num_faces);
+	layout.add_list_property("vertex_indices", ply_header::TYPE_UINT32, ply_header::TYPE_UINT32);
+
+	std::vector<double> positions;
+	std::vector<size_t> face_offsets;
+	std::vector<size_t> face_indices;
+
+	chunked_parser parser(in.get_position(), end);
+	switch(parser.parse_elements(layout, true, positions, face_offsets, face_indices))
+	{
+		case chunked_parser::STATUS_OK:
+			break;
+
+		case chunked_parser::STATUS_MISMATCH:
+			std::cerr	<< "psalm: Expected " << num_vertices << " vertices and "
+					<< num_faces << " faces, but the number of data lines differs.\n";
+			return(false);
+
+		case chunked_parser::STATUS_ERROR:
+			return(false);
+	}
+
+	return(build_from_indices(positions, face_offsets, face_indices));
+}
+
+/*!
+*	Saves the currently loaded mesh in ASCII Geomview object file format
+*	(OFF).
+*
+*	@param	out Stream for data output
+*	@return	true if the mesh could be stored, else false.
+*/
+
+bool mesh::save_off(std::ostream& out)
+{
+	mesh_writer writer;
+	return(writer.open(out, TYPE_OFF) && save(writer));
+}
+
+/*!
+*	Loads mesh data in PSM format from an input stream. The data is read
+*	into memory completely and loaded via load_psm(const char*, const
+*	char*).
+*
+*	@param	in Input stream (file, standard input)
+*	@return	true if the mesh could be loaded, else false
+*/
+
+bool mesh::load_psm(std::istream& in)
+{
+	if(!in.good())
+		return(false);
+
+	const size_t block_size = 1 << 20;
+
+	std::vector<char> data;
+	while(in.good())
+	{
+		size_t size = data.size();
+		data.resize(size+block_size);
+
+		in.read(&data[size], block_size);
+		data.resize(size+static_cast<size_t>(in.gcount()));
+	}
+
+	if(data.empty())
+		data.push_back('\0');
+
+	return(load_psm(&data[0], &data[0]+data.size()));
+}
+
+/*!
+*	Loads mesh data in PSM format from memory, e.g. from a mapped file.
+*	In contrast to the other formats, nothing is parsed: The arrays of the
+*	file contain the complete adjacency information, so the elements of
+*	the mesh are created from them directly. The arrays are only checked
+*	for indices that are out of bounds.
+*
+*	@param begin	First character of the data
+*	@param end	End of the data
+*
+*	@return	true if the mesh could be loaded, else false
+*/
+
+bool mesh::load_psm(const char* begin, const char* end)
+{
+	size_t size = static_cast<size_t>(end-begin);
+
+	// The arrays are accessed directly, which requires the data to be
+	// aligned. Mapped files always are, but buffers need not be.
+	if(reinterpret_cast<size_t>(begin) % sizeof(boost::uint64_t) != 0)
+	{
+		std::vector<boost::uint64_t> buffer(size/sizeof(boost::uint64_t)+1);
+		std::memcpy(&buffer[0], begin, size);
+
+		const char* data = reinterpret_cast<const char*>(&buffer[0]);
+		return(load_psm(data, data+size));
+	}
+
+	psm_header header;
+	if(size < sizeof(header) || std::memcmp(begin, psm_magic, sizeof(psm_magic)) != 0)
+	{
+		std::cerr << "psalm: Input data is not in PSM format.\n";
+		return(false);
+	}
+
+	std::memcpy(&header, begin, sizeof(header));
+	if(header.byte_order != psm_byte_order)
+	{
+		std::cerr << "psalm: PSM data has been written by a machine with a different byte order.\n";
+		return(false);
+	}
+	else if(header.version != psm_version)
+	{
+		std::cerr << "psalm: Version " << header.version << " of the PSM format is not supported.\n";
+		return(false);
+	}
+
+	// Every count is bounded by the size of the data, so computing the
+	// expected size cannot overflow
+	const boost::uint64_t counts[] =
+	{
+		header.num_vertices,
+		header.num_edges,
+		header.num_faces,
+		header.num_corners,
+		header.num_vertex_edges,
+		header.num_vertex_faces,
+		header.num_boundary_edges
+	};
+
+	for(size_t i = 0; i < sizeof(counts)/sizeof(counts[0]); i++)
+	{
+		if(counts[i] > size)
+		{
+			std::cerr << "psalm: PSM data is truncated.\n";
+			return(false);
+		}
+	}
+
+	size_t num_vertices		= static_cast<size_t>(header.num_vertices);
+	size_t num_edges		= static_cast<size_t>(header.num_edges);
+	size_t num_faces		= static_cast<size_t>(header.num_faces);
+	size_t num_corners		= static_cast<size_t>(header.num_corners);
+	size_t num_vertex_edges		= static_cast<size_t>(header.num_vertex_edges);
+	size_t num_vertex_faces		= static_cast<size_t>(header.num_vertex_faces);
+	size_t num_boundary_edges	= static_cast<size_t>(header.num_boundary_edges);
+
+	size_t num_values	=	3*num_vertices + num_vertices +
+					(num_vertices+1) + num_vertex_edges +
+					(num_vertices+1) + num_vertex_faces +
+					4*num_edges +
+					(num_faces+1) + 2*num_corners +
+					num_boundary_edges;
+
+	size_t num_flags	= num_vertices + num_faces;
+
+	if(size < sizeof(header) + num_values*sizeof(boost::uint64_t) + num_flags)
+	{
+		std::cerr << "psalm: PSM data is truncated.\n";
+		return(false);
+	}
+
+	const double* positions			= reinterpret_cast<const double*>(begin+sizeof(header));
+	const boost::uint64_t* vertex_ids	= reinterpret_cast<const boost::uint64_t*>(positions+3*num_vertices);
+	const boost::uint64_t* vertex_edge_offsets	= vertex_ids + num_vertices;
+	const boost::uint64_t* vertex_edges		= vertex_edge_offsets + num_vertices+1;
+	const boost::uint64_t* vertex_face_offsets	= vertex_edges + num_vertex_edges;
+	const boost::uint64_t* vertex_faces		= vertex_face_offsets + num_vertices+1;
+	const boost::uint64_t* edges			= vertex_faces + num_vertex_faces;
+	const boost::uint64_t* face_offsets		= edges + 4*num_edges;
+	const boost::uint64_t* face_vertices		= face_offsets + num_faces+1;
+	const boost::uint64_t* face_edges		= face_vertices + num_corners;
+	const boost::uint64_t* boundary_edges		= face_edges + num_corners;
+	const boost::uint8_t* vertex_flags		= reinterpret_cast<const boost::uint8_t*>(boundary_edges + num_boundary_edges);
+	const boost::uint8_t* face_flags		= vertex_flags + num_vertices;
+
+	bool valid =	check_psm_offsets(vertex_edge_offsets, num_vertices, num_vertex_edges) &&
+			check_psm_offsets(vertex_face_offsets, num_vertices, num_vertex_faces) &&
+			check_psm_offsets(face_offsets, num_faces, num_corners) &&
+			check_psm_indices(vertex_edges, num_vertex_edges, num_edges) &&
+			check_psm_indices(vertex_faces, num_vertex_faces, num_faces) &&
+			check_psm_indices(face_vertices, num_corners, num_vertices) &&
+			check_psm_indices(boundary_edges, num_boundary_edges, num_edges);
+
+	for(size_t i = 0; i < num_edges && valid; i++)
+	{
+		valid =	check_psm_indices(edges+4*i, 2, num_vertices) &&
+			check_psm_indices(edges+4*i+2, 2, num_faces, true);
+	}
+
+	// Directed edges of the faces store the flags in the lowest bits
+	for(size_t i = 0; i < num_corners && valid; i++)
+		valid = ((face_edges[i] >> 2) < num_edges);
+
+	if(!valid)
+	{
+		std::cerr << "psalm: PSM data contains invalid indices.\n";
+		return(false);
+	}
+
+	destroy();
+	id_offset = static_cast<size_t>(header.id_offset);
+
+	V.reserve(num_vertices);
+	E.reserve(num_edges);
+	F.reserve(num_faces);
+
+	vertex_pool.reserve(num_vertices);
+	edge_pool.reserve(num_edges);
+	face_pool.reserve(num_faces);
+
+	for(size_t i = 0; i < num_vertices; i++)
+	{
+		vertex* v = new(vertex_pool.allocate()) vertex(	positions[3*i],
+								positions[3*i+1],
+								positions[3*i+2],
+								static_cast<size_t>(vertex_ids[i]));
+
+		v->set_on_boundary(vertex_flags[i] != 0);
+
+		v->set_slot(V.size());
+		V.push_back(v);
+	}
+
+	for(size_t i = 0; i < num_edges; i++)
+	{
+		edge* e = new(edge_pool.allocate()) edge(V[edges[4*i]], V[edges[4*i+1]]);
+
+		e->set_slot(E.size());
+		E.push_back(e);
+	}
+
+	for(size_t i = 0; i < num_faces; i++)
+	{
+		face* f = new(face_pool.allocate()) face;
+		f->reserve(static_cast<size_t>(face_offsets[i+1]-face_offsets[i]));
+
+		for(size_t c = static_cast<size_t>(face_offsets[i]); c < face_offsets[i+1]; c++)
+		{
+			directed_edge d_e;
+			d_e.e		= E[static_cast<size_t>(face_edges[c] >> 2)];
+			d_e.inverted	= ((face_edges[c] & 1) != 0);
+			d_e.new_edge	= ((face_edges[c] & 2) != 0);
+
+			f->add_vertex(V[face_vertices[c]]);
+			f->add_edge(d_e);
+		}
+
+		f->set_on_boundary(face_flags[i] != 0);
+
+		f->set_slot(F.size());
+		F.push_back(f);
+	}
+
+	// Edges refer to the faces, which have not existed before. The list
+	// of boundary edges is restored in its original order.
+
+	std::vector<edge_table<edge*>::key_type> edge_ids;
+	edge_ids.reserve(num_edges);
+
+	for(size_t i = 0; i < num_edges; i++)
+	{
+		edge* e = E[i];
+
+		if(edges[4*i+2] != psm_none)
+			e->set_f(F[edges[4*i+2]]);
+		if(edges[4*i+3] != psm_none)
+			e->set_g(F[edges[4*i+3]]);
+
+		if(	(e->get_f() && !face_contains_edge(e->get_f(), e)) ||
+			(e->get_g() && !face_contains_edge(e->get_g(), e)))
+		{
+			std::cerr << "psalm: PSM data contains edges that refer to wrong faces.\n";
+
+			destroy();
+			return(false);
+		}
+
+		e->set_on_boundary(e->get_f() == NULL || e->get_g() == NULL);
+		edge_ids.push_back(calc_edge_id(e->get_u(), e->get_v()));
+	}
+
+	E_B.reserve(num_boundary_edges);
+	for(size_t i = 0; i < num_boundary_edges; i++)
+	{
+		edge* e = E[boundary_edges[i]];
+		if(	e->get_boundary_slot() != std::numeric_limits<size_t>::max() ||
+			(e->get_f() == NULL) == (e->get_g() == NULL))
+		{
+			std::cerr << "psalm: PSM data contains an invalid list of boundary edges.\n";
+
+			destroy();
+			return(false);
+		}
+
+		e->set_boundary_slot(E_B.size());
+		E_B.push_back(e);
+	}
+
+	for(size_t i = 0; i < num_vertices; i++)
+	{
+		vertex* v = V[i];
+		v->reserve(	static_cast<size_t>(vertex_edge_offsets[i+1]-vertex_edge_offsets[i]),
+				static_cast<size_t>(vertex_face_offsets[i+1]-vertex_face_offsets[i]));
+
+		for(size_t j = static_cast<size_t>(vertex_edge_offsets[i]); j < vertex_edge_offsets[i+1]; j++)
+			v->add_edge(E[vertex_edges[j]]);
+
+		for(size_t j = static_cast<size_t>(vertex_face_offsets[i]); j < vertex_face_offsets[i+1]; j++)
+		{
+			face* f = F[vertex_faces[j]];
+			if(!face_contains_vertex(f, v))
+			{
+				std::cerr << "psalm: PSM data contains vertices that refer to wrong faces.\n";
+
+				destroy();
+				return(false);
+			}
+
+			v->add_face(f);
+		}
+	}
+
+	E_M.insert(edge_ids, E);
+	return(true);
+}
+
+/*!
+*	@return true if an edge or a vertex of the mesh refers to a face that
+*	is not stored in the mesh anymore
+*/
+
+bool mesh::references_removed_faces() const
+{
+	for(size_t i = 0; i < E.size(); i++)
+	{
+		if(	(E[i]->get_f() && !is_stored_face(E[i]->get_f(), F)) ||
+			(E[i]->get_g() && !is_stored_face(E[i]->get_g(), F)))
+			return(true);
+	}
+
+	for(size_t i = 0; i < V.size(); i++)
+	{
+		for(size_t j = 0; j < V[i]->num_adjacent_faces(); j++)
+		{
+			if(!is_stored_face(V[i]->get_face(j), F))
+				return(true);
+		}
+	}
+
+	return(false);
+}
+
+/*!
+*	Saves the mesh in PSM format, the native binary format of psalm. The
+*	file stores the complete adjacency information of the mesh, so it can
+*	be loaded without rebuilding it. After the header (see psm_header),
+*	the following arrays are written; unless noted otherwise, every entry
+*	is an unsigned 64-bit integer:
+*
+*	-	Vertex positions (3 doubles per vertex)
+*	-	Vertex IDs
+*	-	Offsets (one per vertex, plus one) and slots of the edges of
+*		every vertex
+*	-	Offsets (one per vertex, plus one) and slots of the faces of
+*		every vertex
+*	-	Edges, stored as the slots of their start vertex, end vertex,
+*		first face, and second face (psm_none if missing)
+*	-	Offsets (one per face, plus one) and slots of the vertices of
+*		every face
+*	-	Directed edges of every face, stored as the edge slot shifted
+*		left by 2, combined with 2 for new edges and 1 for inverted
+*		edges
+*	-	Slots of the boundary edges in the order of the boundary list
+*	-	Boundary flags of the vertices and faces (1 byte each), padded
+*		to a multiple of 8 bytes
+*
+*	The mesh must not contain removed elements, i.e. compact() has to be
+*	called before. References to faces that have been removed are not
+*	stored.
+*
+*	@param	out Stream for data output
+*	@return	true if the mesh could be stored, else false.
+*/
+
+bool mesh::save_psm(std::ostream& out)
+{
+	// Faces that have been removed from the mesh, e.g. by prune() or by a
+	// call of add_face() that failed, may still be referenced by edges or
+	// vertices. Their slots are invalid, so a copy of the mesh, which
+	// does not contain these references, is stored instead.
+	if(references_removed_faces())
+	{
+		mesh M;
+		clone(M);
+
+		return(M.save_psm(out));
+	}
+
+	psm_header header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, psm_magic, sizeof(psm_magic));
+
+	header.version		= psm_version;
+	header.byte_order	= psm_byte_order;
+
+	header.num_vertices		= V.size();
+	header.num_edges		= E.size();
+	header.num_faces		= F.size();
+	header.num_boundary_edges	= E_B.size();
+	header.id_offset		= id_offset;
+
+	for(size_t i = 0; i < V.size(); i++)
+	{
+		header.num_vertex_edges	+= V[i]->valency();
+		header.num_vertex_faces	+= V[i]->num_adjacent_faces();
+	}
+
+	for(size_t i = 0; i < F.size(); i++)
+		header.num_corners += F[i]->num_vertices();
+
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	{
+		std::vector<double> positions;
+		positions.reserve(3*V.size());
+
+		for(size_t i = 0; i < V.size(); i++)
+		{
+			const v3ctor& p = V[i]->get_position();
+			positions.push_back(p[0]);
+			positions.push_back(p[1]);
+			positions.push_back(p[2]);
+		}
+
+		write_psm_array(out, positions);
+	}
+
+	std::vector<boost::uint64_t> data;
+
+	data.reserve(V.size());
+	for(size_t i = 0; i < V.size(); i++)
+		data.push_back(V[i]->get_id());
+
+	write_psm_array(out, data);
+
+	data.clear();
+	data.push_back(0);
+	for(size_t i = 0; i < V.size(); i++)
+		data.push_back(data.back() + V[i]->valency());
+
+	write_psm_array(out, data);
+
+	data.clear();
+	for(size_t i = 0; i < V.size(); i++)
+	{
+		for(size_t j = 0; j < V[i]->valency(); j++)
+			data.push_back(V[i]->get_edge(j)->get_slot());
+	}
+
+	write_psm_array(out, data);
+
+	data.clear();
+	data.push_back(0);
+	for(size_t i = 0; i < V.size(); i++)
+		data.push_back(data.back() + V[i]->num_adjacent_faces());
+
+	write_psm_array(out, data);
+
+	data.clear();
+	for(size_t i = 0; i < V.size(); i++)
+	{
+		for(size_t j = 0; j < V[i]->num_adjacent_faces(); j++)
+			data.push_back(V[i]->get_face(j)->get_slot());
+	}
+
+	write_psm_array(out, data);
+
+	data.clear();
+	for(size_t i = 0; i < E.size(); i++)
+	{
+		const edge* e = E[i];
+
+		data.push_back(e->get_u()->get_slot());
+		data.push_back(e->get_v()->get_slot());
+		data.push_back(e->get_f() ? e->get_f()->get_slot() : psm_none);
+		data.push_back(e->get_g() ? e->get_g()->get_slot() : psm_none);
+	}
+
+	write_psm_array(out, data);
+
+	data.clear();
+	data.push_back(0);
+	for(size_t i = 0; i < F.size(); i++)
+		data.push_back(data.back() + F[i]->num_vertices());
+
+	write_psm_array(out, data);
+
+	data.clear();
+	for(size_t i = 0; i < F.size(); i++)
+	{
+		for(size_t j = 0; j < F[i]->num_vertices(); j++)
+			data.push_back(F[i]->get_vertex(j)->get_slot());
+	}
+
+	write_psm_array(out, data);
+
+	// Every face has as many edges as vertices
+	data.clear();
+	for(size_t i = 0; i < F.size(); i++)
+	{
+		for(size_t j = 0; j < F[i]->num_vertices(); j++)
+		{
+			const directed_edge& d_e = F[i]->get_edge(j);
+			data.push_back(	(static_cast<boost::uint64_t>(d_e.e->get_slot()) << 2) |
+					(d_e.new_edge ? 2 : 0) |
+					(d_e.inverted ? 1 : 0));
+		}
+	}
 
-			std::vector<vertex*> vertices;
-			for(size_t i = 0; i < k; i++)
-			{
-				converter >> index;
-				if(converter.fail())
-				{
-					std::cerr	<< "psalm: Tried to parse face data in line \""
-							<< line
-							<< "\", but failed.\n";
-					return(false);
-				}
+	write_psm_array(out, data);
 
-				if(index >= V.size())
-				{
-					std::cerr	<< "psalm: Index " << index << "in line \""
-							<< line
-						<< "\" is out of bounds.\n";
-					return(false);
-				}
+	data.clear();
+	for(size_t i = 0; i < E_B.size(); i++)
+		data.push_back(E_B[i]->get_slot());
+
+	write_psm_array(out, data);
+	std::vector<boost::uint64_t>().swap(data);
+
+	std::vector<boost::uint8_t> flags;
+	flags.reserve(V.size()+F.size()+sizeof(boost::uint64_t));
+
+	for(size_t i = 0; i < V.size(); i++)
+		flags.push_back(V[i]->is_on_boundary() ? 1 : 0);
+	for(size_t i = 0; i < F.size(); i++)
+		flags.push_back(F[i]->is_on_boundary() ? 1 : 0);
+
+	// Padding; this keeps the size of the file a multiple of 8 bytes
+	while(flags.size() % sizeof(boost::uint64_t) != 0)
+		flags.push_back(0);
+
+	write_psm_array(out, flags);
+	return(out.good());
+}
+
+/*!
+*	Writes the vertices and faces of the mesh via a writer, which is
+*	closed afterwards. Vertices are referred to by their slots.
+*
+*	@param	writer Writer whose output has been opened
+*	@return	true if the mesh could be stored, else false.
+*/
+
+bool mesh::save(mesh_writer& writer) const
+{
+	writer.write_header(V.size(), F.size());
+
+	for(size_t i = 0; i < V.size(); i++)
+		writer.write_vertex(V[i]->get_position(), V[i]->is_on_boundary());
+
+	std::vector<size_t> vertices;
+	for(size_t i = 0; i < F.size(); i++)
+	{
+		vertices.resize(F[i]->num_vertices());
+		for(size_t j = 0; j < vertices.size(); j++)
+			vertices[j] = F[i]->get_vertex(j)->get_slot();
+
+		writer.write_face(&vertices[0], vertices.size());
+	}
+
+	return(writer.close());
+}
+
+/*!
+*	Passes all vertices and faces of the mesh to a sink, e.g. for storing
+*	them via mesh_stream. Vertices are added in the order of their slots;
+*	empty slots of removed vertices and faces are skipped. Boundary flags
+*	of the vertices are preserved; vertex properties and IDs are not.
+*
+*	@param output Sink that receives the vertices and faces
+*/
+
+void mesh::write_to(mesh_sink& output) const
+{
+	output.reserve(V.size(), F.size());
+
+	std::vector<size_t> indices(V.size(), mesh_sink::NO_VERTEX);
+	for(size_t i = 0; i < V.size(); i++)
+	{
+		if(V[i] != NULL)
+			indices[i] = output.add_vertex(V[i]->get_position(), V[i]->is_on_boundary());
+	}
+
+	std::vector<size_t> vertices;
+	for(size_t i = 0; i < F.size(); i++)
+	{
+		if(F[i] == NULL)
+			continue;
+
+		vertices.resize(F[i]->num_vertices());
+		for(size_t j = 0; j < vertices.size(); j++)
+			vertices[j] = indices[F[i]->get_vertex(j)->get_slot()];
+
+		output.add_face(vertices);
+	}
+}
+
+/*!
+*	Saves the mesh in a special format for holes. The file format is
+*	reminiscent of Wavefront OBJ: First, a list of non-boundary vertices is
+*	written in the form "v x y z". Afterwards, faces are written out as "f
+*	i j k", where i,j,k refers to the vertices that form the face. A
+*	negative vertex index indicates a boundary vertex that has been left
+*	out of the vertex list. A positive vertex index, starting at 0, refers
+*	to the vertices that were written to the file.
+*
+*	@param	out Stream for data output
+*	@return	true if the mesh could be stored, else false.
+*/
+
+bool mesh::save_hole(std::ostream& out)
+{
+	// Maps the slot of every non-boundary vertex to its index in the
+	// vertex list
+	std::vector<size_t> indices(V.size());
+	size_t num_new_vertices = 0;
+
+	for(std::vector<vertex*>::const_iterator v_it = V.begin(); v_it < V.end(); v_it++)
+	{
+		vertex* v = *v_it;
+		if(!v->is_on_boundary())
+		{
+			indices[v->get_slot()] = num_new_vertices++;
+			out << "v " << v->get_position();
+		}
+	}
+
+	// Boundary vertices are identified by their (external) IDs, all other
+	// vertices by their index in the vertex list
+	for(std::vector<face*>::const_iterator f_it = F.begin(); f_it < F.end(); f_it++)
+	{
+		out << "f ";
+		for(size_t i = 0; i < (*f_it)->num_vertices(); i++)
+		{
+			vertex* v = (*f_it)->get_vertex(i);
+			if(v->is_on_boundary())
+				out << "-" << v->get_id();
+			else
+				out << indices[v->get_slot()];
+
+			// No trailing spaces for the last entry
+			if(i < (*f_it)->num_vertices()-1)
+				out << " ";
+		}
+		out << "\n";
+	}
+
+	return(true);
+}
+
+/*!
+*	Destroys the mesh and all related data structures and frees up used
+*	memory.
+*/
+
+void mesh::destroy()
+{
+	vertex_pool.clear();
+	edge_pool.clear();
+	face_pool.clear();
+
+	V.clear();
+	E.clear();
+	F.clear();
+
+	E_M.clear();
+	E_B.clear();
+
+	for(size_t i = 0; i < vertex_properties.size(); i++)
+		delete vertex_properties[i];
+
+	vertex_properties.clear();
+
+	num_removed_vertices	= 0;
+	num_removed_edges	= 0;
+	num_removed_faces	= 0;
+}
+
+/*!
+*	Replaces the current mesh with another one in constant time. The other
+*	mesh will be deleted/cleared by this operation.
+*
+*	@param	M Mesh to replace current mesh with
+*/
+
+void mesh::replace_with(mesh& M)
+{
+	// Options will _not_ be overwritten by this operation; previously this
+	// was the case.
+	size_t id_offset = this->id_offset;
+
+	// The elements are owned by the pools of the other mesh, so exchanging
+	// the meshes suffices; no element is copied.
+	swap(M);
+	M.destroy();
+
+	this->id_offset = id_offset;
+}
+
+/*!
+*	Reserves memory for the given number of elements. Calling this function
+*	prior to adding vertices and faces avoids repeated reallocations of the
+*	internal arrays and of the edge table. The number of edges is estimated
+*	using the Euler characteristic.
+*
+*	@param num_vertices	Expected number of vertices
+*	@param num_faces	Expected number of faces
+*/
+
+void mesh::reserve(size_t num_vertices, size_t num_faces)
+{
+	size_t num_edges = num_vertices + num_faces;
+
+	V.reserve(num_vertices);
+	E.reserve(num_edges);
+	F.reserve(num_faces);
+
+	vertex_pool.reserve(num_vertices);
+	edge_pool.reserve(num_edges);
+	face_pool.reserve(num_faces);
+
+	E_M.reserve(num_edges);
+
+	for(size_t i = 0; i < vertex_properties.size(); i++)
+		vertex_properties[i]->reserve(num_vertices);
+}
+
+/*!
+*	Removes the empty slots that are left behind by remove_vertex(),
+*	remove_edge(), and remove_face(). Afterwards, the vectors of the mesh
+*	are dense again and every index in [0, num_vertices()),
+*	[0, num_edges()), and [0, num_faces()) refers to an existing element.
+*	The relative order of the remaining elements is preserved. If vertices
+*	have been removed, the edge table is rebuilt because its keys consist
+*	of vertex slots.
+*
+*	If faces have been removed, edges that only have a second adjacent
+*	face are changed so that this face becomes their first one. Thus,
+*	boundary edges of a compact mesh never lack their first face, which
+*	the subdivision algorithms rely on.
+*/
+
+void mesh::compact()
+{
+	if(num_removed_edges > 0)
+	{
+		size_t n = 0;
+		for(size_t i = 0; i < E.size(); i++)
+		{
+			if(E[i] == NULL)
+				continue;
+
+			E[i]->set_slot(n);
+			E[n++] = E[i];
+		}
+
+		E.resize(n);
+		num_removed_edges = 0;
+	}
+
+	if(num_removed_faces > 0)
+	{
+		size_t n = 0;
+		for(size_t i = 0; i < F.size(); i++)
+		{
+			if(F[i] == NULL)
+				continue;
+
+			F[i]->set_slot(n);
+			F[n++] = F[i];
+		}
 
-				vertices.push_back(get_vertex(index));
+		F.resize(n);
+		num_removed_faces = 0;
+
+		for(size_t i = 0; i < E.size(); i++)
+		{
+			if(E[i]->get_f() == NULL && E[i]->get_g() != NULL)
+			{
+				E[i]->set_f(E[i]->get_g());
+				E[i]->set_g(NULL);
 			}
+		}
+	}
 
-			add_face(vertices);
+	if(num_removed_vertices > 0)
+	{
+		size_t n = 0;
+		for(size_t i = 0; i < V.size(); i++)
+		{
+			if(V[i] == NULL)
+				continue;
+
+			for(size_t j = 0; j < vertex_properties.size(); j++)
+				vertex_properties[j]->move(i, n);
+
+			V[i]->set_slot(n);
+			V[n++] = V[i];
+		}
+
+		V.resize(n);
+		for(size_t i = 0; i < vertex_properties.size(); i++)
+			vertex_properties[i]->resize(n);
+
+		num_removed_vertices = 0;
+		rebuild_edge_table();
+	}
+}
+
+/*!
+*	Fills the edge table with all edges of the mesh. Any previous contents
+*	of the table are discarded. The edge vector must not contain any empty
+*	slots.
+*/
+
+void mesh::rebuild_edge_table()
+{
+	std::vector<edge_table<edge*>::key_type> edge_ids;
+	edge_ids.reserve(E.size());
+
+	for(size_t i = 0; i < E.size(); i++)
+		edge_ids.push_back(calc_edge_id(E[i]->get_u(), E[i]->get_v()));
+
+	E_M.clear();
+	E_M.insert(edge_ids, E);
+}
+
+/*!
+*	Calculates the density of a triangular mesh by dividing the number of
+*	vertices by the area of the mesh.
+*
+*	@return	density = num_vertices / area or 0.0 if the area of the mesh is
+*		zero
+*/
+
+double mesh::get_density() // XXX: Should be a `const` function
+{
+	// Triangles are processed in blocks so that the areas may be
+	// calculated by a batch operation
+	const size_t block_size = 256;
+	const v3ctor* T[3*block_size];
+
+	double area	= 0.0;
+	size_t n	= 0;
+
+	for(size_t i = 0; i < num_faces(); i++)
+	{
+		const face* f = get_face(i);
+		if(f == NULL)
+			continue;
+
+		T[3*n]		= &f->get_vertex(0)->get_position();
+		T[3*n+1]	= &f->get_vertex(1)->get_position();
+		T[3*n+2]	= &f->get_vertex(2)->get_position();
+
+		if(++n == block_size)
+		{
+			area += calc_total_area(T, n);
+			n = 0;
 		}
+	}
+
+	area += calc_total_area(T, n);
+
+	if(area != 0.0)
+		return(num_vertices()/area);
+	else
+		return(0.0);
+}
+
+/*!
+*	@struct corner_order
+*	@brief Orders corners by the end vertex of their edge
+*
+*	Used by mesh::build_from_indices() for sorting all corners whose edges
+*	share the same start vertex. Ties are broken by the index of the
+*	corner, so the first corner of every edge is the corner that would
+*	have created the edge when adding the faces one after another.
+*/
+
+struct corner_order
+{
+	corner_order(const std::vector<size_t>& end_vertices)
+		: end_vertices(end_vertices)
+	{
+	}
+
+	bool operator()(size_t c1, size_t c2) const
+	{
+		if(end_vertices[c1] != end_vertices[c2])
+			return(end_vertices[c1] < end_vertices[c2]);
 		else
+			return(c1 < c2);
+	}
+
+	const std::vector<size_t>& end_vertices;
+};
+
+/*!
+*	Creates the mesh from index buffers. In contrast to adding the faces
+*	one after another, the adjacency information of all faces is created
+*	at once: The corners of all faces are sorted by their (undirected)
+*	edges using a counting sort, so that corners sharing an edge become
+*	neighbours. If OpenMP is available, the buckets of the sort are
+*	processed in parallel. Afterwards, every edge is created exactly once
+*	and inserted into the edge table without any further lookups.
+*
+*	The resulting mesh is exactly the same as if the faces had been added
+*	using add_face(). If an edge is shared by more than two faces, the
+*	function falls back to add_face() for handling this degenerate case.
+*
+*	Any data stored in the mesh is destroyed first.
+*
+*	@param positions	Vertex coordinates; the coordinates of the i-th
+*				vertex are stored at 3*i, 3*i+1, 3*i+2
+*
+*	@param face_offsets	Offsets of the faces in `face_indices`; the
+*				i-th face uses the indices in the range
+*				[face_offsets[i], face_offsets[i+1]), so the
+*				buffer contains one more entry than there are
+*				faces
+*
+*	@param face_indices	Vertex indices of all faces, with the vertices
+*				of every face in counterclockwise order
+*
+*	@param find_boundaries	If set, boundary edges and their faces and
+*				vertices are marked while building the mesh
+*
+*	@returns true if the mesh could be created, else false
+*/
+
+bool mesh::build_from_indices(	const std::vector<double>& positions,
+				const std::vector<size_t>& face_offsets,
+				const std::vector<size_t>& face_indices,
+				bool find_boundaries)
+{
+	if(	positions.size() % 3 != 0 ||
+		face_offsets.empty() ||
+		face_offsets.front() != 0 ||
+		face_offsets.back() != face_indices.size())
+	{
+		std::cerr << "psalm: mesh::build_from_indices(): Sizes of index buffers do not match\n";
+		return(false);
+	}
+
+	size_t num_vertices	= positions.size()/3;
+	size_t num_faces	= face_offsets.size()-1;
+	size_t num_corners	= face_indices.size();
+
+	for(size_t i = 0; i < num_faces; i++)
+	{
+		if(face_offsets[i] > face_offsets[i+1])
+		{
+			std::cerr << "psalm: mesh::build_from_indices(): Face offsets are not ascending\n";
+			return(false);
+		}
+	}
+
+	for(size_t i = 0; i < num_corners; i++)
+	{
+		if(face_indices[i] >= num_vertices)
 		{
-			std::cerr << "psalm: Got an unexpected data line \"" << line << "\".\n";
+			std::cerr	<< "psalm: mesh::build_from_indices(): Vertex index "
+					<< face_indices[i]
+					<< " is out of bounds\n";
 			return(false);
 		}
-
-		cur_line_num++;
-
-		converter.clear();
-		line.clear();
 	}
 
-	return(true);
-}
+	destroy();
+	reserve(num_vertices, num_faces);
 
-/*!
-*	Saves the currently loaded mesh in ASCII Geomview object file format
-*	(OFF).
-*
-*	@param	out Stream for data output
-*	@return	true if the mesh could be stored, else false.
-*/
+	for(size_t i = 0; i < num_vertices; i++)
+		add_vertex(positions[3*i], positions[3*i+1], positions[3*i+2]);
 
-bool mesh::save_off(std::ostream& out)
-{
-	if(!out.good())
-		return(false);
+	// Undirected edges of all corners: The edge of corner c is stored as
+	// a pair of vertices (start_vertices[c], end_vertices[c]) with
+	// start_vertices[c] <= end_vertices[c].
 
-	out	<< "OFF\n"
-		<< V.size() << " " << F.size() << " " << "0\n"; // For programs that actually interpret edge data,
-								// the last parameter should be changed
+	std::vector<size_t> start_vertices(num_corners);
+	std::vector<size_t> end_vertices(num_corners);
 
-	for(std::vector<vertex*>::const_iterator it = V.begin(); it != V.end(); it++)
+	#pragma omp parallel for
+	for(long i = 0; i < static_cast<long>(num_faces); i++)
 	{
-		v3ctor position = (*it)->get_position();
-		out	<< position[0] << " "
-			<< position[1] << " "
-			<< position[2] << "\n";
+		size_t begin	= face_offsets[i];
+		size_t end	= face_offsets[i+1];
+
+		for(size_t c = begin; c < end; c++)
+		{
+			size_t u = face_indices[c];
+			size_t v = face_indices[(c+1 < end) ? c+1 : begin];
+
+			start_vertices[c]	= std::min(u, v);
+			end_vertices[c]		= std::max(u, v);
+		}
 	}
 
-	for(std::vector<face*>::const_iterator it = F.begin(); it != F.end(); it++)
+	// Distribute the corners into buckets according to their start
+	// vertices (counting sort). Within a bucket, corners are ordered by
+	// their index.
+
+	std::vector<size_t> bucket_offsets(num_vertices+1, 0);
+	for(size_t c = 0; c < num_corners; c++)
+		bucket_offsets[start_vertices[c]+1]++;
+
+	for(size_t i = 0; i < num_vertices; i++)
+		bucket_offsets[i+1] += bucket_offsets[i];
+
+	std::vector<size_t> buckets(num_corners);
+	for(size_t c = 0; c < num_corners; c++)
+		buckets[bucket_offsets[start_vertices[c]]++] = c;
+
+	// Restore the offsets, which have been shifted by one bucket
+	for(size_t i = num_vertices; i > 0; i--)
+		bucket_offsets[i] = bucket_offsets[i-1];
+	bucket_offsets[0] = 0;
+
+	std::vector<size_t>().swap(start_vertices);
+
+	// Sort every bucket by the end vertices, which makes corners that
+	// share an edge adjacent. Every corner is then assigned to the first
+	// corner that uses the same edge. This corner is responsible for
+	// creating the edge.
+
+	std::vector<size_t> first_corner(num_corners);
+	long num_overused_edges = 0;
+
+	#pragma omp parallel for reduction(+:num_overused_edges) schedule(dynamic, 1024)
+	for(long i = 0; i < static_cast<long>(num_vertices); i++)
 	{
-		out	<< (*it)->num_vertices()
-			<< " ";
+		std::vector<size_t>::iterator begin	= buckets.begin()+bucket_offsets[i];
+		std::vector<size_t>::iterator end	= buckets.begin()+bucket_offsets[i+1];
+
+		std::sort(begin, end, corner_order(end_vertices));
 
-		for(size_t i = 0; i < (*it)->num_vertices(); i++)
+		for(std::vector<size_t>::iterator it = begin; it != end; )
 		{
-			out << (*it)->get_vertex(i)->get_id();
-			if(i < (*it)->num_vertices()-1)
-				out << " ";
+			std::vector<size_t>::iterator group_end = it+1;
+			while(group_end != end && end_vertices[*group_end] == end_vertices[*it])
+				first_corner[*group_end++] = *it;
+
+			first_corner[*it] = *it;
+
+			if(group_end - it > 2)
+				num_overused_edges++;
+
+			it = group_end;
 		}
-		out << "\n";
 	}
 
+	std::vector<size_t>().swap(end_vertices);
+	std::vector<size_t>().swap(buckets);
+	std::vector<size_t>().swap(bucket_offsets);
+
+	create_faces(face_offsets, face_indices, first_corner, num_overused_edges == 0);
+
+	if(find_boundaries)
+		mark_boundaries();
+
 	return(true);
 }
 
 /*!
-*	Saves the mesh in a special format for holes. The file format is
-*	reminiscent of Wavefront OBJ: First, a list of non-boundary vertices is
-*	written in the form "v x y z". Afterwards, faces are written out as "f
-*	i j k", where i,j,k refers to the vertices that form the face. A
-*	negative vertex index indicates a boundary vertex that has been left
-*	out of the vertex list. A positive vertex index, starting at 0, refers
-*	to the vertices that were written to the file.
+*	Creates the faces and edges of a mesh whose vertices have already been
+*	added. In contrast to build_from_indices(), the caller specifies which
+*	corners share an edge, so no edges need to be searched at all. This is
+*	used by subdivision algorithms, where the edges of the new mesh follow
+*	from the elements of the old mesh.
 *
-*	@param	out Stream for data output
-*	@return	true if the mesh could be stored, else false.
+*	The resulting mesh is exactly the same as if the faces had been added
+*	using add_face(). If the mesh already contains faces or if an edge is
+*	shared by more than two corners, the function falls back to
+*	add_face().
+*
+*	@param face_offsets	Offsets of the faces in `face_indices` (see
+*				build_from_indices())
+*
+*	@param face_indices	Vertex slots of all faces, with the vertices
+*				of every face in counterclockwise order
+*
+*	@param corner_edges	Edge of every corner, i.e. of the edge from the
+*				vertex of the corner to the next vertex of the
+*				face. Corners of the same edge have the same
+*				number; the numbers must be less than the
+*				number of corners.
+*
+*	@returns true if the faces could be created, else false
 */
 
-bool mesh::save_hole(std::ostream& out)
+bool mesh::build_topology(	const std::vector<size_t>& face_offsets,
+				const std::vector<size_t>& face_indices,
+				const std::vector<size_t>& corner_edges)
 {
-	size_t num_boundary_vertices = 0;
-	for(std::vector<vertex*>::const_iterator v_it = V.begin(); v_it < V.end(); v_it++)
+	size_t num_corners = face_indices.size();
+
+	if(	face_offsets.empty() ||
+		face_offsets.front() != 0 ||
+		face_offsets.back() != num_corners ||
+		corner_edges.size() != num_corners)
 	{
-		vertex* v = *v_it;
-		if(v->is_on_boundary())
-			num_boundary_vertices++;
-		else
-			out << "v " << v->get_position();
+		std::cerr << "psalm: mesh::build_topology(): Sizes of index buffers do not match\n";
+		return(false);
 	}
 
-	// num_boundary_vertices is used to adjust the offsets of vertices when
-	// writing the indexed faces
-	for(std::vector<face*>::const_iterator f_it = F.begin(); f_it < F.end(); f_it++)
+	for(size_t c = 0; c < num_corners; c++)
 	{
-		out << "f ";
-		for(size_t i = 0; i < (*f_it)->num_vertices(); i++)
+		if(face_indices[c] >= V.size() || corner_edges[c] >= num_corners)
 		{
-			vertex* v = (*f_it)->get_vertex(i);
-			if(v->is_on_boundary())
-				out << "-" << v->get_id();
-			else
-				// If the offset is subtracted, all new vertices are in
-				// the range of [num_boundary_vertices, ...]. Hence, the
-				// range is adjusted by subtracting num_boundary_vertices
-				// again.
-				out << (v->get_id() - id_offset - num_boundary_vertices);
-
-			// No trailing spaces for the last entry
-			if(i < (*f_it)->num_vertices()-1)
-				out << " ";
+			std::cerr << "psalm: mesh::build_topology(): Index of corner " << c << " is out of bounds\n";
+			return(false);
 		}
-		out << "\n";
 	}
 
+	// Every corner is assigned to the first corner that uses the same
+	// edge. This corner is responsible for creating the edge.
+
+	const size_t no_corner = std::numeric_limits<size_t>::max();
+
+	std::vector<size_t> edge_corners(num_corners, no_corner);
+	std::vector<unsigned char> edge_uses(num_corners, 0);
+	std::vector<size_t> first_corner(num_corners);
+
+	bool manifold = (E.empty() && F.empty());
+	for(size_t c = 0; c < num_corners; c++)
+	{
+		size_t id = corner_edges[c];
+		if(edge_corners[id] == no_corner)
+			edge_corners[id] = c;
+
+		first_corner[c] = edge_corners[id];
+		if(++edge_uses[id] > 2)
+			manifold = false;
+	}
+
+	std::vector<size_t>().swap(edge_corners);
+	std::vector<unsigned char>().swap(edge_uses);
+
+	create_faces(face_offsets, face_indices, first_corner, manifold);
 	return(true);
 }
 
 /*!
-*	Destroys the mesh and all related data structures and frees up used
-*	memory.
+*	Creates faces and edges for the vertices of the mesh. Used by
+*	build_from_indices() and build_topology() after the corners that share
+*	an edge have been identified.
+*
+*	@param face_offsets	Offsets of the faces in `face_indices`
+*	@param face_indices	Vertex slots of all faces
+*	@param first_corner	First corner of the edge of every corner; this
+*				corner creates the edge
+*	@param manifold		If not set, an edge is shared by more than two
+*				faces or the mesh is not empty, so the faces
+*				are added using add_face()
 */
 
-void mesh::destroy()
+void mesh::create_faces(const std::vector<size_t>& face_offsets,
+			const std::vector<size_t>& face_indices,
+			const std::vector<size_t>& first_corner,
+			bool manifold)
 {
-	for(std::vector<vertex*>::iterator it = V.begin(); it != V.end(); it++)
+	size_t num_vertices	= V.size();
+	size_t num_faces	= face_offsets.size()-1;
+	size_t num_corners	= face_indices.size();
+
+	if(!manifold)
 	{
-		if(*it != NULL)
-			delete(*it);
+		std::vector<vertex*> vertices;
+		for(size_t i = 0; i < num_faces; i++)
+		{
+			vertices.clear();
+			for(size_t c = face_offsets[i]; c < face_offsets[i+1]; c++)
+				vertices.push_back(V[face_indices[c]]);
+
+			add_face(vertices);
+		}
+
+		return;
 	}
 
-	for(std::vector<edge*>::iterator it = E.begin(); it != E.end(); it++)
+	// Every vertex knows its number of edges and faces in advance
+
 	{
-		if(*it != NULL)
-			delete(*it);
+		std::vector<size_t> num_vertex_edges(num_vertices, 0);
+		std::vector<size_t> num_vertex_faces(num_vertices, 0);
+
+		for(size_t i = 0; i < num_faces; i++)
+		{
+			size_t begin	= face_offsets[i];
+			size_t end	= face_offsets[i+1];
+
+			for(size_t c = begin; c < end; c++)
+			{
+				num_vertex_faces[face_indices[c]]++;
+				if(first_corner[c] == c)
+				{
+					num_vertex_edges[face_indices[c]]++;
+					num_vertex_edges[face_indices[(c+1 < end) ? c+1 : begin]]++;
+				}
+			}
+		}
+
+		for(size_t i = 0; i < num_vertices; i++)
+			V[i]->reserve(num_vertex_edges[i], num_vertex_faces[i]);
 	}
 
-	for(std::vector<face*>::iterator it = F.begin(); it != F.end(); it++)
+	// Create faces and edges in the same order as add_face() would do
+
+	std::vector<edge*> corner_edges(num_corners, NULL);
+
+	// The edges are inserted into the edge table en bloc afterwards
+	std::vector<edge_table<edge*>::key_type> edge_ids;
+	edge_ids.reserve(E.capacity());
+
+	for(size_t i = 0; i < num_faces; i++)
 	{
-		if(*it != NULL)
-			delete(*it);
-	}
+		size_t begin	= face_offsets[i];
+		size_t end	= face_offsets[i+1];
 
-	V.clear();
-	E.clear();
-	F.clear();
+		if(begin == end)
+			continue;
 
-	E_M.clear();
-}
+		face* f = new(face_pool.allocate()) face;
+		f->reserve(end-begin);
 
-/*!
-*	Replaces the current mesh with another one. The other mesh will
-*	be deleted/cleared by this operation.
-*
-*	@param	M Mesh to replace current mesh with
-*/
+		for(size_t c = begin; c < end; c++)
+		{
+			vertex* u = V[face_indices[c]];
+			vertex* v = V[face_indices[(c+1 < end) ? c+1 : begin]];
 
-void mesh::replace_with(mesh& M)
-{
-	this->destroy();
+			directed_edge d_e;
+			if(first_corner[c] == c)
+			{
+				edge* e = new(edge_pool.allocate()) edge(u, v);
+				e->set_slot(E.size());
+				e->set_f(f);
 
-	this->V		= M.V;
-	this->F		= M.F;
-	this->E		= M.E;
-	this->E_M	= M.E_M;
+				E.push_back(e);
+				edge_ids.push_back(calc_edge_id(u, v));
 
-	// Options will _not_ be overwritten by this operation; previously this
-	// was the case.
+				u->add_edge(e);
+				v->add_edge(e);
 
-	// Clear old mesh
-	M.V.clear();
-	M.F.clear();
-	M.E.clear();
-	M.E_M.clear();
-}
+				corner_edges[c] = e;
 
-/*!
-*	Calculates the density of a triangular mesh by dividing the number of
-*	vertices by the area of the mesh.
-*
-*	@return	density = num_vertices / area or 0.0 if the area of the mesh is
-*		zero
-*/
+				d_e.e		= e;
+				d_e.inverted	= false;
+				d_e.new_edge	= true;
+			}
+			else
+			{
+				edge* e = corner_edges[first_corner[c]];
+				e->set_g(f);
 
-double mesh::get_density() // XXX: Should be a `const` function
-{
-	double area = 0.0;
-	for(size_t i = 0; i < num_faces(); i++)
-	{
-		const face* f = get_face(i);
+				d_e.e		= e;
+				d_e.inverted	= (e->get_u() != u);
+				d_e.new_edge	= false;
+
+				if(!d_e.inverted && !orientation_warning_shown)
+				{
+					std::cerr << "psalm: Warning: Wrong orientation in mesh--results may be inconsistent.\n";
+					orientation_warning_shown = true;
+				}
+			}
 
-		v3ctor a = f->get_vertex(1)->get_position() - f->get_vertex(0)->get_position();
-		v3ctor b = f->get_vertex(2)->get_position() - f->get_vertex(0)->get_position();
+			f->add_vertex(u);
+			f->add_edge(d_e);
+			u->add_face(f);
+		}
 
-		area += 0.5*(a|b).length();
+		f->set_slot(F.size());
+		F.push_back(f);
 	}
 
-	if(area != 0.0)
-		return(num_vertices()/area);
-	else
-		return(0.0);
+	E_M.insert(edge_ids, E);
+
+	for(size_t i = 0; i < E.size(); i++)
+		update_boundary(E[i]);
 }
 
 /*!
@@ -1020,9 +2926,8 @@ double mesh::get_density() // XXX: Should be a `const` function
 
 face* mesh::add_face(std::vector<vertex*> vertices, bool ignore_orientiation_warning)
 {
-	static bool warning_shown = false;
 	if(ignore_orientiation_warning)
-		warning_shown = true;
+		orientation_warning_shown = true;
 
 	vertex* u = NULL;
 	vertex* v = NULL;
@@ -1030,7 +2935,8 @@ face* mesh::add_face(std::vector<vertex*> vertices, bool ignore_orientiation_war
 	if(vertices.size() == 0)
 		return(NULL);
 
-	face* f = new face;
+	face* f = new(face_pool.allocate()) face;
+	f->reserve(vertices.size());
 
 	std::vector<vertex*>::iterator it = vertices.begin();
 	u = *it;
@@ -1097,10 +3003,10 @@ face* mesh::add_face(std::vector<vertex*> vertices, bool ignore_orientiation_war
 			}
 			else
 			{
-				if(!warning_shown)
+				if(!orientation_warning_shown)
 				{
 					std::cerr << "psalm: Warning: Wrong orientation in mesh--results may be inconsistent.\n";
-					warning_shown = true;
+					orientation_warning_shown = true;
 				}
 
 				if(edge.e->get_f())
@@ -1115,19 +3021,27 @@ face* mesh::add_face(std::vector<vertex*> vertices, bool ignore_orientiation_war
 			u->add_face(f);
 		}
 
+		update_boundary(edge.e);
+
 		// Set next start vertex; the orientation should be correct
 		// here
 		u = v;
 	}
 
+	f->set_slot(F.size());
 	F.push_back(f);
 	return(f);
 }
 
 /*!
 *	Removes a given face from the mesh. This deletes _all_ pointers to the
-*	face from adjacent vertices or adjacent faces. As a last step, the face
-*	is removed from the face vector of the mesh.
+*	face from adjacent vertices or adjacent faces. As a last step, the slot
+*	of the face in the face vector of the mesh is cleared and its memory is
+*	released. The pointer must not be used afterwards.
+*
+*	The face vector keeps its size, so indices of other faces remain valid.
+*	Call compact() to remove the empty slot. The subdivision algorithms do
+*	this themselves before subdividing the mesh.
 *
 *	@param	f Face that is going to be removed from the mesh
 *
@@ -1137,13 +3051,16 @@ face* mesh::add_face(std::vector<vertex*> vertices, bool ignore_orientiation_war
 
 void mesh::remove_face(face* f)
 {
-	// Remove face from face vector
+	// Clear slot of face in face vector
 
-	std::vector<face*>::iterator face_pos = std::find(F.begin(), F.end(), f);
-	if(face_pos == F.end())
+	size_t slot = f->get_slot();
+	if(slot >= F.size() || F[slot] != f)
 		throw(std::runtime_error("mesh::remove_face(): Unable to find face in face vector"));
 	else
-		F.erase(face_pos);
+	{
+		F[slot] = NULL;
+		num_removed_faces++;
+	}
 
 	// Remove references to face from edges
 
@@ -1156,11 +3073,15 @@ void mesh::remove_face(face* f)
 			d_e.e->set_g(NULL);
 		else
 			throw(std::runtime_error("mesh::remove_face(): Unable to find reference to face in edge vector"));
+
+		update_boundary(d_e.e);
 	}
 
 	// Remove references to face from vertices
 	for(size_t i = 0; i < f->num_vertices(); i++)
 		f->get_vertex(i)->remove_face(f);
+
+	face_pool.release(f);
 }
 
 /*!
@@ -1183,26 +3104,27 @@ directed_edge mesh::add_edge(vertex* u, vertex* v)
 	directed_edge result;
 
 	/*
-		The vertex IDs are combined into an std::pair. These pairs are
-		then stored in an std::map container.
+		The vertex slots are combined into an std::pair. These pairs
+		are then stored in a hash table (see edge_table.h).
 
 		Previously, the Cantor pairing function had been used, but this
-		yielded integer overflows with normal 32bit integers. Hence,
-		the std::string attempt is better suited to this task, although
-		it requires a conversion step.
+		yielded integer overflows with normal 32bit integers. An
+		std::map had been used afterwards, which turned out to be the
+		bottleneck for large meshes.
 	*/
 
 	std::pair<size_t, size_t> id = calc_edge_id(u, v);
 
 	// Check whether edge exists
-	std::map<std::pair<size_t, size_t>, edge*>::iterator edge_it;
-	if((edge_it = E_M.find(id)) == E_M.end())
+	edge** edge_it = E_M.find(id);
+	if(edge_it == NULL)
 	{
 		// Edge not found, create an edge from the _original_ edge and
 		// add it to the map
-		edge* new_edge = new edge(u, v);
+		edge* new_edge = new(edge_pool.allocate()) edge(u, v);
+		new_edge->set_slot(E.size());
 		E.push_back(new_edge);
-		E_M[id] = new_edge;
+		E_M.insert(id, new_edge);
 
 		result.e = new_edge;
 		result.inverted = false;
@@ -1212,13 +3134,13 @@ directed_edge mesh::add_edge(vertex* u, vertex* v)
 	{
 		// Edge has been found, check whether the proper direction has
 		// been stored.
-		if(edge_it->second->get_u() != u)
+		if((*edge_it)->get_u() != u)
 			result.inverted = true;
 		else
 			result.inverted = false;
 
 		result.new_edge = false;
-		result.e = edge_it->second;
+		result.e = *edge_it;
 	}
 
 	return(result);
@@ -1227,7 +3149,11 @@ directed_edge mesh::add_edge(vertex* u, vertex* v)
 /*!
 *	Removes a given edge from the mesh. This deletes _all_ pointers to the
 *	edge from adjacent vertices. As a last step, the edge is removed from
-*	the edge map of the mesh.
+*	the edge map of the mesh and its memory is released. The pointer must
+*	not be used afterwards.
+*
+*	As for remove_face(), the slot of the edge is only cleared. Call
+*	compact() to remove it from the edge vector.
 *
 *	@param	e Edge that is going to be removed from the mesh
 *
@@ -1248,13 +3174,16 @@ void mesh::remove_edge(edge* e)
 	if(e->get_f() || e->get_g())
 		throw(std::runtime_error("mesh::remove_edge(): Edge is still referenced in faces"));
 
-	// Remove edge from edge vector
+	// Clear slot of edge in edge vector
 
-	std::vector<edge*>::iterator edge_pos = std::find(E.begin(), E.end(), e);
-	if(edge_pos == E.end())
+	size_t slot = e->get_slot();
+	if(slot >= E.size() || E[slot] != e)
 		throw(std::runtime_error("mesh::remove_edge(): Unable to find edge in edge vector"));
 	else
-		E.erase(edge_pos);
+	{
+		E[slot] = NULL;
+		num_removed_edges++;
+	}
 
 	// Remove edge from edge map
 
@@ -1263,17 +3192,16 @@ void mesh::remove_edge(edge* e)
 
 	std::pair<size_t, size_t> edge_id = calc_edge_id(u, v);
 
-	std::map<std::pair<size_t,size_t>, edge*>::iterator edge_map_pos = E_M.find(edge_id);
-	if(edge_map_pos == E_M.end())
+	if(!E_M.erase(edge_id))
 		throw(std::runtime_error("mesh::remove_edge(): Unable to find edge in edge map"));
-	else
-		E_M.erase(edge_id);
 
 	// Remove reference of edge from start and end vertex. This is
 	// necessary to avoid stale pointers.
 
 	u->remove_edge(e);
 	v->remove_edge(e);
+
+	edge_pool.release(e);
 }
 
 /*!
@@ -1295,10 +3223,16 @@ void mesh::prune(const std::set<size_t>& remove_faces, const std::set<size_t>& r
 	if(remove_faces.size() == 0 && remove_vertices.size() == 0)
 		return;
 
+	// Faces are only taken out of the face vector; references to them
+	// are kept so that the topology of the mesh remains intact.
+
 	for(std::vector<face*>::iterator it = F.begin(); it != F.end(); it++)
 	{
-		if(remove_faces.find((*it)->num_edges()) != remove_faces.end())
-			it = F.erase(it);
+		if(*it != NULL && remove_faces.find((*it)->num_edges()) != remove_faces.end())
+		{
+			*it = NULL;
+			num_removed_faces++;
+		}
 	}
 
 	for(std::vector<vertex*>:: iterator it = V.begin(); it != V.end(); it++)
@@ -1309,15 +3243,21 @@ void mesh::prune(const std::set<size_t>& remove_faces, const std::set<size_t>& r
 			for(size_t i = 0; i < (*it)->num_adjacent_faces(); i++)
 			{
 				const face* f = (*it)->get_face(i);
-				std::vector<face*>::iterator it_f = std::find(F.begin(), F.end(), f);
-				if(it_f != F.end())
-					it_f = F.erase(it_f);
+				size_t slot = f->get_slot();
+
+				if(F[slot] == f)
+				{
+					F[slot] = NULL;
+					num_removed_faces++;
+				}
 			}
 
 			// Do not remove vertex; otherwise all vertex IDs would
 			// need to be changed
 		}
 	}
+
+	compact();
 }
 
 /*!
@@ -1427,33 +3367,31 @@ bool mesh::relax_edge(edge* e)
 	// Check whether the edge that is going to be swapped already exists.
 	// In this case, the edge swap is also denied, as it would overwrite
 	// existing faces
-	if(E_M.find(calc_edge_id(v1, v2)) != E_M.end()) // TODO: Optimize
+	if(E_M.find(calc_edge_id(v1, v2)) != NULL)
 		return(false);
 
-	// Remove both of the old faces and the corresponding edge...
+	// Find the remaining pair of vertices of both faces. This has to be
+	// done before the faces are removed because their memory is released
+	// upon removal...
 
 	face* old_face_1 = e->get_f();
 	face* old_face_2 = e->get_g();
 
+	std::pair<vertex*, vertex*> vertices_1st_face = find_remaining_vertices(e->get_v(), old_face_1);
+	std::pair<vertex*, vertex*> vertices_2nd_face = find_remaining_vertices(e->get_u(), old_face_2);
+
+	// ...remove both of the old faces and the corresponding edge...
+
 	remove_face(old_face_1);
 	remove_face(old_face_2);
 
 	remove_edge(e);
 
-	// ...find the remaining pair of vertices and create the new faces...
-
-	std::pair<vertex*, vertex*> vertices_1st_face = find_remaining_vertices(e->get_v(), old_face_1);
-	std::pair<vertex*, vertex*> vertices_2nd_face = find_remaining_vertices(e->get_u(), old_face_2);
+	// ...and create the new faces.
 
 	add_face(vertices_1st_face.first, vertices_1st_face.second, v1, true);
 	add_face(vertices_2nd_face.first, vertices_2nd_face.second, v2, true);
 
-	// ...and free some memory.
-
-	delete(old_face_1);
-	delete(old_face_2);
-	delete(e);
-
 	return(true);
 }
 
@@ -1512,31 +3450,147 @@ std::pair<vertex*, vertex*> mesh::find_remaining_vertices(const vertex* v, const
 }
 
 /*!
-*	Marks all boundary vertices and edges in the mesh.
+*	Marks all boundary vertices, edges, and faces in the mesh. Since the
+*	boundary edges are tracked by the mesh, only these edges are visited.
 */
 
 void mesh::mark_boundaries()
 {
-	for(size_t i = 0; i < V.size(); i++)
+	for(size_t i = 0; i < E_B.size(); i++)
 	{
-		for(size_t j = 0; j < V[i]->valency(); j++)
+		edge* e = E_B[i];
+
+		e->set_on_boundary();
+		(e->get_f() ? e->get_f() : e->get_g())->set_on_boundary();
+
+		e->get_u()->set_on_boundary();
+		e->get_v()->set_on_boundary();
+	}
+}
+
+/*!
+*	Updates the boundary information of an edge after one of its adjacent
+*	faces has changed. Edges with exactly one adjacent face are stored in
+*	the list of boundary edges; removing an edge from this list swaps it
+*	with the last one, so both operations require constant time.
+*
+*	@param e Edge whose adjacent faces have changed
+*/
+
+void mesh::update_boundary(edge* e)
+{
+	bool has_f = (e->get_f() != NULL);
+	bool has_g = (e->get_g() != NULL);
+
+	e->set_on_boundary(!has_f || !has_g);
+
+	bool boundary	= (has_f != has_g);
+	size_t slot	= e->get_boundary_slot();
+
+	if(boundary && slot == std::numeric_limits<size_t>::max())
+	{
+		e->set_boundary_slot(E_B.size());
+		E_B.push_back(e);
+	}
+	else if(!boundary && slot != std::numeric_limits<size_t>::max())
+	{
+		edge* last = E_B.back();
+
+		E_B[slot] = last;
+		last->set_boundary_slot(slot);
+
+		E_B.pop_back();
+		e->set_boundary_slot(std::numeric_limits<size_t>::max());
+	}
+}
+
+/*!
+*	Extracts all boundary loops of the mesh. Each loop is traversed in the
+*	same direction as its edges are traversed by their adjacent faces,
+*	i.e. counterclockwise for properly oriented meshes (the faces lie to
+*	the left of the loop). Only boundary edges are visited, so the running
+*	time depends on the size of the boundary and the valencies of the
+*	boundary vertices, but not on the size of the mesh.
+*
+*	Vertices at which several loops touch are visited once per loop. If a
+*	loop cannot be closed, e.g. for inconsistently oriented meshes, the
+*	corresponding chain of vertices is returned as it is.
+*
+*	@return Boundary loops of the mesh; every loop contains its vertices in
+*	order. The last vertex of a loop is connected to the first one.
+*/
+
+std::vector< std::vector<vertex*> > mesh::boundary_loops()
+{
+	std::vector< std::vector<vertex*> > loops;
+	std::vector<bool> visited(E_B.size(), false);
+
+	for(size_t i = 0; i < E_B.size(); i++)
+	{
+		if(visited[i])
+			continue;
+
+		loops.push_back(std::vector<vertex*>());
+		std::vector<vertex*>& loop = loops.back();
+
+		edge* e		= E_B[i];
+		vertex* start	= find_boundary_source(e);
+		vertex* u	= start;
+
+		while(e != NULL)
 		{
-			edge* e = V[i]->get_edge(j);
+			visited[e->get_boundary_slot()] = true;
+			loop.push_back(u);
 
-			// checking using get_g() is sufficient as get_f()
-			// returns the _first_ face an edge is part of, and all
-			// edges are assumed to be part of at least one face.
-			if(e->get_g() == NULL)
-			{
-				e->set_on_boundary();
-				e->get_f()->set_on_boundary();
+			vertex* v = (e->get_u() == u) ? e->get_v() : e->get_u();
+			if(v == start)
+				break;
 
-				V[i]->set_on_boundary();
-			}
+			e = find_next_boundary_edge(v, visited);
+			u = v;
+		}
+	}
+
+	return(loops);
+}
+
+/*!
+*	Removes a property from the vertices of the mesh. References to the
+*	property must not be used afterwards.
+*
+*	@param name Name of the property; if the mesh does not contain such a
+*	property, nothing happens
+*/
+
+void mesh::remove_vertex_property(const std::string& name)
+{
+	for(size_t i = 0; i < vertex_properties.size(); i++)
+	{
+		if(vertex_properties[i]->get_name() == name)
+		{
+			delete vertex_properties[i];
+			vertex_properties.erase(vertex_properties.begin()+i);
+			return;
 		}
 	}
 }
 
+/*!
+*	@param name Name of the property
+*	@return Property with the given name or NULL if there is none
+*/
+
+property_base* mesh::find_vertex_property(const std::string& name)
+{
+	for(size_t i = 0; i < vertex_properties.size(); i++)
+	{
+		if(vertex_properties[i]->get_name() == name)
+			return(vertex_properties[i]);
+	}
+
+	return(NULL);
+}
+
 /*!
 *	Creates a mesh from raw input data. This means that all coordinates and
 *	vertex IDs are stored in arrays instead of files. If the `coordinates`
@@ -1572,19 +3626,21 @@ bool mesh::load_raw_data(int num_vertices, long* vertex_IDs, double* coordinates
 		return(false);
 
 	destroy();
+
+	// Normals and scale attributes are only stored if they are present;
+	// algorithms that require them create the properties otherwise.
+
+	property<v3ctor>* N = NULL;
+	if(normals)
+		N = &add_vertex_property<v3ctor>("normal");
+
+	property<double>* S = NULL;
+	if(scale_attributes)
+		S = &add_vertex_property<double>("scale");
+
 	long max_id = 0;
 	for(int i = 0; i < num_vertices; i++)
 	{
-		double nx, ny, nz;
-		if(normals)
-		{
-			nx = normals[3*i];
-			ny = normals[3*i+1];
-			nz = normals[3*i+2];
-		}
-		else
-			nx = ny = nz = 0.0; // set default values if no normals are available
-
 		long id;
 		if(vertex_IDs)
 		{
@@ -1603,15 +3659,15 @@ bool mesh::load_raw_data(int num_vertices, long* vertex_IDs, double* coordinates
 		vertex * v = add_vertex(	coordinates[3*i],
 						coordinates[3*i+1],
 						coordinates[3*i+2],
-						nx,
-						ny,
-						nz,
 						id);
 
+		if(N)
+			(*N)[v->get_slot()] = v3ctor(normals[3*i], normals[3*i+1], normals[3*i+2]);
+
 		// Set scale attributes if present. Otherwise, the scale
 		// attributes will be calculated by the subdivision algorithm.
-		if(scale_attributes)
-			v->set_scale_attribute(scale_attributes[i]);
+		if(S)
+			(*S)[v->get_slot()] = scale_attributes[i];
 
 		// Only update vertex IDs if the user explicitly specified an
 		// array. Otherwise, IDs will be assigned sequentially.
@@ -1656,23 +3712,23 @@ bool mesh::load_raw_data(int num_vertices, long* vertex_IDs, double* coordinates
 
 bool mesh::save_raw_data(int* num_new_vertices, double** new_coordinates, int* num_faces, long** vertex_IDs)
 {
-	size_t num_boundary_vertices = 0;		// count boundary vertices to obtain correct IDs
+	// Removed faces must not be reported to the caller
+	compact();
+
 	std::vector<const vertex*> new_vertices;	// stores new vertices
+	std::vector<size_t> indices(V.size());		// maps slots of new vertices to their index
 
-	// Count new vertices and store them
+	// Store new vertices; boundary vertices are _old_ vertices, i.e. ones
+	// that are already known by the caller
 
 	for(std::vector<vertex*>::const_iterator v_it = V.begin(); v_it < V.end(); v_it++)
 	{
 		vertex* v = *v_it;
-
-		// Boundary vertex, hence an _old_ vertex, i.e. one that is
-		// already known by the caller
-		if(v->is_on_boundary())
-			num_boundary_vertices++;
-
-		// New vertex
-		else
+		if(!v->is_on_boundary())
+		{
+			indices[v->get_slot()] = new_vertices.size();
 			new_vertices.push_back(v);
+		}
 	}
 
 	*num_new_vertices = new_vertices.size();
@@ -1707,20 +3763,13 @@ bool mesh::save_raw_data(int* num_new_vertices, double** new_coordinates, int* n
 		{
 			vertex* v = f->get_vertex(i);
 
-			// Store negative IDs for old vertices
+			// Store negative IDs for old vertices and zero-indexed
+			// positions in the array of new coordinates for new
+			// vertices
 			if(v->is_on_boundary())
 				(*vertex_IDs)[3*face_index+i] = static_cast<long>(-1*v->get_id());
 			else
-			{
-				// Store zero-indexed IDs for new vertices. For
-				// this purpose, the offset needs to be
-				// subtracted. This yields vertex IDs in the
-				// range of [num_boundary, ...]. Hence, the
-				// range needs to be adjusted by subtracting
-				// num_boundary_vertices
-
-				(*vertex_IDs)[3*face_index+i] = static_cast<long>(v->get_id() - id_offset - num_boundary_vertices);
-			}
+				(*vertex_IDs)[3*face_index+i] = static_cast<long>(indices[v->get_slot()]);
 		}
 	}
 
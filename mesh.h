@@ -13,15 +13,22 @@
 #include <set>
 #include <map>
 #include <limits>
+#include <stdexcept>
 
 #include "vertex.h"
 #include "directed_edge.h"
 #include "edge.h"
 #include "face.h"
+#include "edge_table.h"
+#include "object_pool.h"
+#include "property.h"
 
 namespace psalm
 {
 
+class mesh_sink;
+class mesh_writer;
+
 /*!
 *	@class mesh
 *	@brief Represents a mesh
@@ -37,9 +44,27 @@ class mesh
 			TYPE_PLY,
 			TYPE_OBJ,
 			TYPE_OFF,
+			TYPE_PSM,
 			TYPE_EXT
 		};
 
+		// Enumerating the supported compression formats of files
+		enum compression_type
+		{
+			COMPRESSION_NONE,
+			COMPRESSION_GZIP,
+			COMPRESSION_ZSTD,
+			COMPRESSION_EXT
+		};
+
+		// Special values for the precision of coordinates in ASCII
+		// files. Positive values specify the number of decimal places.
+		enum precision_type
+		{
+			PRECISION_SHORTEST	= 0,	///< Shortest representation that is read back exactly
+			PRECISION_DEFAULT	= -1	///< 8 decimal places for PLY, 6 significant digits for OBJ and OFF
+		};
+
 		// Status flags for mesh::load() and mesh::save(). By using a
 		// three-valued status the function is able to check whether
 		// all other means of loading and saving have failed. If this
@@ -55,31 +80,59 @@ class mesh
 		mesh();
 		~mesh();
 
-		bool load(const std::string& filename, file_type type = TYPE_EXT);
-		bool save(const std::string& filename, file_type type = TYPE_EXT);
+#if __cplusplus >= 201103L
+		mesh(mesh&& M);
+		mesh& operator=(mesh&& M);
+#endif
+
+		void swap(mesh& M);
+		void clone(mesh& M) const;
+
+		bool load(const std::string& filename, file_type type = TYPE_EXT, compression_type compression = COMPRESSION_EXT);
+		bool save(const std::string& filename, file_type type = TYPE_EXT, bool binary = false, compression_type compression = COMPRESSION_EXT, int precision = PRECISION_DEFAULT);
+
+		static std::string get_extension(const std::string& filename);
+		static compression_type get_compression(const std::string& filename);
 
 		bool load_raw_data(int num_vertices, long* vertex_IDs, double* coordinates, double* scale_attributes = NULL, double* normals = NULL);
 		bool save_raw_data(int* num_new_vertices, double** new_coordinates, int* num_faces, long** vertex_IDs);
 
+		bool build_from_indices(const std::vector<double>& positions,
+					const std::vector<size_t>& face_offsets,
+					const std::vector<size_t>& face_indices,
+					bool find_boundaries = false);
+
+		bool build_topology(	const std::vector<size_t>& face_offsets,
+					const std::vector<size_t>& face_indices,
+					const std::vector<size_t>& corner_edges);
+
+		void write_to(mesh_sink& output) const;
+
 		void prune(	const std::set<size_t>& remove_faces,
 				const std::set<size_t>& remove_vertices);
 		void destroy();
 		void replace_with(mesh& M);
+		void reserve(size_t num_vertices, size_t num_faces);
+		void compact();
+		bool is_compact() const;
 
 		double get_density();
 
+		size_t num_slabs() const;
+
 		// Functions for modifying the topology of the mesh
 
 		vertex* add_vertex(double x, double y, double z, size_t id = std::numeric_limits<size_t>::max());
-		vertex* add_vertex(double x, double y, double z, double nx, double ny, double nz, size_t id = std::numeric_limits<size_t>::max());
 		vertex* add_vertex(const v3ctor& pos, size_t id = std::numeric_limits<size_t>::max());
 		void remove_vertex(vertex* v);
 
 		size_t num_vertices() const;
 		vertex* get_vertex(size_t i);
+		const vertex* get_vertex(size_t i) const;
 
 		size_t num_edges() const;
 		edge* get_edge(size_t i);
+		const edge* get_edge(size_t i) const;
 
 		bool relax_edge(edge* e);
 
@@ -90,6 +143,20 @@ class mesh
 
 		size_t num_faces() const;
 		face* get_face(size_t i);
+		const face* get_face(size_t i) const;
+
+		// Functions for managing per-vertex properties
+
+		template <class T> property<T>& add_vertex_property(const std::string& name, const T& default_value = T());
+		template <class T> property<T>* get_vertex_property(const std::string& name);
+		void remove_vertex_property(const std::string& name);
+
+		// Functions for querying the boundary of the mesh
+
+		size_t num_boundary_edges() const;
+		edge* get_boundary_edge(size_t i);
+
+		std::vector< std::vector<vertex*> > boundary_loops();
 
 	protected:
 
@@ -99,10 +166,46 @@ class mesh
 		std::vector<edge*>	E;
 		std::vector<face*>	F;
 
-		std::map<std::pair<size_t,size_t>, edge*> E_M;
+		edge_table<edge*> E_M;
+
+		// Edges with exactly one adjacent face. This list is updated
+		// whenever faces are added or removed; its order is arbitrary.
+
+		std::vector<edge*> E_B;
+
+		// Optional per-vertex data; every property stores one value
+		// for every vertex slot.
+
+		std::vector<property_base*> vertex_properties;
+
+		// Removed vertices, edges, and faces leave an empty slot (NULL)
+		// in their vector until compact() is called.
+
+		size_t num_removed_vertices;
+		size_t num_removed_edges;
+		size_t num_removed_faces;
+
+		// Memory for all elements of the mesh is provided by these
+		// pools. Elements may thus not be freed using `delete`. The
+		// adjacency lists of the elements still use the heap.
+
+		object_pool<vertex>	vertex_pool;
+		object_pool<edge>	edge_pool;
+		object_pool<face>	face_pool;
+
+		// Offset for the IDs of new vertices. Vertex IDs are external
+		// identifiers that are only used when writing the mesh; all
+		// internal lookups use the slots of the vertices.
 
 		size_t id_offset;
 
+		// Set once the warning about a wrong orientation has been
+		// shown or if an algorithm asked add_face() to ignore it. The
+		// flag belongs to the mesh, so meshes may be built in
+		// different threads.
+
+		bool orientation_warning_shown;
+
 		// Internal functions
 
 		directed_edge add_edge(vertex* u, vertex* v);
@@ -111,45 +214,43 @@ class mesh
 		std::pair<size_t, size_t> calc_edge_id(const vertex* u, const vertex* v);
 		std::pair<vertex*, vertex*> find_remaining_vertices(const vertex* v, const face* f);
 
+		void create_faces(	const std::vector<size_t>& face_offsets,
+					const std::vector<size_t>& face_indices,
+					const std::vector<size_t>& first_corner,
+					bool manifold);
+
 		void mark_boundaries();
+		void update_boundary(edge* e);
+		void rebuild_edge_table();
+
+		property_base* find_vertex_property(const std::string& name);
 
 		bool load_ply(std::istream& in);
 		bool load_obj(std::istream& in);
 		bool load_off(std::istream& in);
 
-		bool save_ply(std::ostream& out);
+		bool load_ply(const char* begin, const char* end);
+		bool load_obj(const char* begin, const char* end);
+		bool load_off(const char* begin, const char* end);
+
+		bool load_psm(std::istream& in);
+		bool load_psm(const char* begin, const char* end);
+
+		bool save(mesh_writer& writer) const;
+		bool save_ply(std::ostream& out, bool binary = false);
 		bool save_obj(std::ostream& out);
 		bool save_off(std::ostream& out);
 		bool save_hole(std::ostream& out);
-};
+		bool save_psm(std::ostream& out);
+		bool references_removed_faces() const;
 
-/*!
-*	Adds a vertex to the mesh. If not specified by the user, the vertex ID
-*	is assigned automatically.
-*
-*	@param x	x position of vertex
-*	@param y	y position of vertex
-*	@param z	z position of vertex
-*	@param id	Vertex ID (by default, this is set to the largest
-*			number fitting into a size_t and thus will be ignored)
-*
-*	@warning The vertices are not checked for duplicates because this
-*	function is assumed to be called from internal methods only.
-*
-*	@return Pointer to new vertex. The pointer remains valid during the
-*	lifecycle of the mesh.
-*/
+	private:
 
-inline vertex* mesh::add_vertex(double x, double y, double z, size_t id)
-{
-	return(add_vertex(	x,
-				y,
-				z,
-				0.0, // default normal vector
-				0.0,
-				0.0,
-				id));
-}
+		// Meshes own their elements and may only be copied by using
+		// clone()
+		mesh(const mesh&);
+		mesh& operator=(const mesh&);
+};
 
 /*!
 *	Adds a vertex to the mesh. If not specified by the user, the vertex ID
@@ -158,9 +259,6 @@ inline vertex* mesh::add_vertex(double x, double y, double z, size_t id)
 *	@param x	x position of vertex
 *	@param y	y position of vertex
 *	@param z	z position of vertex
-*	@param nx	x position of normal vector
-*	@param ny	y position of normal vector
-*	@param nz	z position of normal vector
 *	@param id	Vertex ID (by default, this is set to the largest
 *			number fitting into a size_t and thus will be ignored)
 *
@@ -171,15 +269,20 @@ inline vertex* mesh::add_vertex(double x, double y, double z, size_t id)
 *	lifecycle of the mesh.
 */
 
-inline vertex* mesh::add_vertex(double x, double y, double z, double nx, double ny, double nz, size_t id)
+inline vertex* mesh::add_vertex(double x, double y, double z, size_t id)
 {
 	vertex* v;
 	if(id != std::numeric_limits<size_t>::max())
-		v = new vertex(x,y,z, nx, ny, nz, id);
+		v = new(vertex_pool.allocate()) vertex(x,y,z, id);
 	else
-		v = new vertex(x,y,z, nx, ny, nz, V.size()+id_offset);
+		v = new(vertex_pool.allocate()) vertex(x,y,z, V.size()+id_offset);
 
+	v->set_slot(V.size());
 	V.push_back(v);
+
+	for(size_t i = 0; i < vertex_properties.size(); i++)
+		vertex_properties[i]->resize(V.size());
+
 	return(v);
 }
 
@@ -204,21 +307,57 @@ inline vertex* mesh::add_vertex(const v3ctor& pos, size_t id)
 }
 
 /*!
-*	Removes a vertex from the list of vertices and frees allocated memory.
-*	This function invalidates the integrity of the list of edges, so it
-*	should _only_ be used if all edges have already been processed.
+*	Removes a vertex from the mesh and frees its memory. The slot of the
+*	vertex in the vertex vector is cleared, so the slots of all other
+*	vertices, and thus the keys of the edge table, remain valid. Call
+*	compact() to remove the empty slot.
+*
+*	The edges and faces of the vertex are not removed by this function;
+*	this has to be done beforehand.
 *
 *	@param v Vertex to remove from the mesh
 */
 
 inline void mesh::remove_vertex(vertex* v)
 {
-	std::remove(V.begin(), V.end(), v);
-	delete v;
+	size_t slot = v->get_slot();
+	if(slot < V.size() && V[slot] == v)
+	{
+		V[slot] = NULL;
+		num_removed_vertices++;
+	}
+
+	vertex_pool.release(v);
+}
+
+/*!
+*	@return Number of slabs that have been allocated for the elements of
+*	the mesh. Each slab provides memory for many elements. Memory for the
+*	adjacency lists of the elements is allocated separately and is not
+*	counted.
+*/
+
+inline size_t mesh::num_slabs() const
+{
+	return(	vertex_pool.num_slabs()	+
+		edge_pool.num_slabs()	+
+		face_pool.num_slabs());
 }
 
 /*!
-*	@return Number of vertices currently stored in the mesh.
+*	@return true if no vertices, edges, or faces have been removed since
+*	the last call to compact(), i.e. if there are no empty slots.
+*/
+
+inline bool mesh::is_compact() const
+{
+	return(num_removed_vertices == 0 && num_removed_edges == 0 && num_removed_faces == 0);
+}
+
+/*!
+*	@return Number of vertex slots currently used by the mesh. Unless
+*	compact() has been called, this includes vertices that have been
+*	removed.
 */
 
 inline size_t mesh::num_vertices() const
@@ -229,8 +368,8 @@ inline size_t mesh::num_vertices() const
 /*!
 *	@param i Index of desired vertex
 *
-*	@return ith vertex of the mesh. Caller has to ensure that vertex index
-*	is correct.
+*	@return ith vertex of the mesh or NULL if the vertex has been removed.
+*	Caller has to ensure that vertex index is correct.
 */
 
 inline vertex* mesh::get_vertex(size_t i)
@@ -239,7 +378,20 @@ inline vertex* mesh::get_vertex(size_t i)
 }
 
 /*!
-*	@return Number of edges currently stored in the mesh.
+*	@param i Index of desired vertex
+*
+*	@return Const pointer to ith vertex of the mesh or NULL if the vertex
+*	has been removed. Caller has to ensure that vertex index is correct.
+*/
+
+inline const vertex* mesh::get_vertex(size_t i) const
+{
+	return(V[i]);
+}
+
+/*!
+*	@return Number of edge slots currently used by the mesh. Unless
+*	compact() has been called, this includes edges that have been removed.
 */
 
 inline size_t mesh::num_edges() const
@@ -250,8 +402,8 @@ inline size_t mesh::num_edges() const
 /*!
 *	@param i Index of desired edge
 *
-*	@return ith edge in the mesh. Caller has to ensure that the edge index
-*	is valid.
+*	@return ith edge in the mesh or NULL if the edge has been removed.
+*	Caller has to ensure that the edge index is valid.
 */
 
 inline edge* mesh::get_edge(size_t i)
@@ -260,7 +412,90 @@ inline edge* mesh::get_edge(size_t i)
 }
 
 /*!
-*	@return Number of faces currently stored in the mesh.
+*	@param i Index of desired edge
+*
+*	@return Const pointer to ith edge in the mesh or NULL if the edge has
+*	been removed. Caller has to ensure that the edge index is valid.
+*/
+
+inline const edge* mesh::get_edge(size_t i) const
+{
+	return(E[i]);
+}
+
+/*!
+*	Adds a property to the vertices of the mesh. Every vertex, including
+*	vertices that are added later on, is assigned the default value. If a
+*	property with the same name and type exists already, it is returned
+*	unchanged.
+*
+*	@param name		Name of the property
+*	@param default_value	Value for all vertices
+*
+*	@throws std::runtime_error if a property with the same name but a
+*	different type exists
+*
+*	@return Reference to the property, which is indexed by the slot of a
+*	vertex, i.e. vertex::get_slot()
+*/
+
+template <class T> property<T>& mesh::add_vertex_property(const std::string& name, const T& default_value)
+{
+	property_base* p = find_vertex_property(name);
+	if(p != NULL)
+	{
+		property<T>* q = dynamic_cast<property<T>*>(p);
+		if(q == NULL)
+			throw(std::runtime_error("mesh::add_vertex_property(): Property \"" + name + "\" exists with a different type"));
+
+		return(*q);
+	}
+
+	property<T>* q = new property<T>(name, default_value, V.size());
+	vertex_properties.push_back(q);
+
+	return(*q);
+}
+
+/*!
+*	@param name Name of the property
+*
+*	@return Pointer to the property or NULL if the mesh does not contain a
+*	property with the given name and type
+*/
+
+template <class T> property<T>* mesh::get_vertex_property(const std::string& name)
+{
+	return(dynamic_cast<property<T>*>(find_vertex_property(name)));
+}
+
+/*!
+*	@return Number of boundary edges, i.e. edges with exactly one adjacent
+*	face
+*/
+
+inline size_t mesh::num_boundary_edges() const
+{
+	return(E_B.size());
+}
+
+/*!
+*	@param i Index of desired boundary edge
+*
+*	@return ith boundary edge of the mesh. Caller has to ensure that the
+*	index is valid. The order of boundary edges changes whenever faces are
+*	added or removed.
+*/
+
+inline edge* mesh::get_boundary_edge(size_t i)
+{
+	return(E_B[i]);
+}
+
+/*!
+*	@return Number of face slots currently used by the mesh. Unless
+*	compact() has been called, this includes faces that have been removed,
+*	i.e. empty slots for which get_face() returns NULL.
 */
 
 inline size_t mesh::num_faces() const
@@ -271,8 +506,9 @@ inline size_t mesh::num_faces() const
 /*!
 *	@param i Index of desired face
 *
-*	@return ith face in the mesh. Caller has to ensure that the face index
-*	is valid.
+*	@return ith face in the mesh or NULL if the face has been removed and
+*	compact() has not been called yet. Caller has to ensure that the face
+*	index is valid.
 */
 
 inline face* mesh::get_face(size_t i)
@@ -280,6 +516,19 @@ inline face* mesh::get_face(size_t i)
 	return(F[i]);
 }
 
+/*!
+*	@param i Index of desired face
+*
+*	@return Const pointer to ith face in the mesh or NULL if the face has
+*	been removed and compact() has not been called yet. Caller has to
+*	ensure that the face index is valid.
+*/
+
+inline const face* mesh::get_face(size_t i) const
+{
+	return(F[i]);
+}
+
 /*!
 *	Adds a triangular face to the mesh. This function allows the caller to
 *	specify 3 vertices that will form the new triangle. Thus, specifying a
@@ -341,15 +590,17 @@ inline face* mesh::add_face(vertex* v1, vertex* v2, vertex* v3, vertex* v4, bool
 
 /*!
 *	@returns ID of the edge described by vertices u and v, which is given
-*	as an std::pair sorted by vertex IDs.
+*	as an std::pair sorted by vertex slots. Slots are used instead of
+*	vertex IDs because they are always dense, regardless of the IDs that
+*	have been assigned by the caller.
 */
 
 inline std::pair<size_t, size_t> mesh::calc_edge_id(const vertex* u, const vertex* v)
 {
 	std::pair<size_t, size_t> id;
 
-	size_t u_id = u->get_id();
-	size_t v_id = v->get_id();
+	size_t u_id = u->get_slot();
+	size_t v_id = v->get_slot();
 
 	if(u_id < v_id)
 	{
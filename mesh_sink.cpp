@@ -0,0 +1,155 @@
+/*!
+*	@file	mesh_sink.cpp
+*	@brief	Receivers for vertices and faces that are created one by one
+*/
+
+#include <algorithm>
+
+#include "mesh_sink.h"
+
+namespace psalm
+{
+
+const size_t mesh_sink::NO_VERTEX = static_cast<size_t>(-1);
+
+/*!
+*	Empty destructor
+*/
+
+mesh_sink::~mesh_sink()
+{
+}
+
+/*!
+*	Adds several faces at once. Besides the vertices, the edges of the
+*	faces are known: Corners with the same edge number share an edge.
+*	Sinks that build the topology of a mesh may use this information for
+*	avoiding edge lookups. By default, the faces are added one after
+*	another.
+*
+*	@param face_offsets	Offsets of the faces in `face_indices`; contains
+*				one more entry than there are faces
+*	@param face_indices	Vertex indices of all faces
+*	@param corner_edges	Edge number of every corner, i.e. of the edge
+*				from the vertex of the corner to the next
+*				vertex of the face; the numbers must be less
+*				than the number of corners
+*/
+
+void mesh_sink::add_faces(	const std::vector<size_t>& face_offsets,
+				const std::vector<size_t>& face_indices,
+				const std::vector<size_t>& /* corner_edges */)
+{
+	if(face_indices.empty())
+		return;
+
+	for(size_t i = 0; i+1 < face_offsets.size(); i++)
+		add_face(&face_indices[0]+face_offsets[i], face_offsets[i+1]-face_offsets[i]);
+}
+
+/*!
+*	Creates a builder for the given mesh.
+*
+*	@param M Mesh that receives the vertices and faces; should be empty
+*/
+
+mesh_builder::mesh_builder(mesh& M) : M(M)
+{
+}
+
+/*!
+*	Reserves memory for the given number of vertices and faces.
+*
+*	@param num_vertices	Expected number of vertices
+*	@param num_faces	Expected number of faces
+*/
+
+void mesh_builder::reserve(size_t num_vertices, size_t num_faces)
+{
+	M.reserve(num_vertices, num_faces);
+}
+
+/*!
+*	Adds a vertex to the mesh.
+*
+*	@param position		Position of the vertex
+*	@param on_boundary	Flag signalling that the vertex is a boundary
+*				vertex
+*
+*	@return Slot of the new vertex
+*/
+
+size_t mesh_builder::add_vertex(const v3ctor& position, bool on_boundary)
+{
+	vertex* v = M.add_vertex(position);
+	if(on_boundary)
+		v->set_on_boundary();
+
+	return(v->get_slot());
+}
+
+/*!
+*	Adds a face to the mesh. Like in mesh_stream::add_face(), faces with
+*	missing vertices (NO_VERTEX) are skipped.
+*
+*	@param vertices	Slots of the vertices of the face
+*	@param n	Number of vertices
+*/
+
+void mesh_builder::add_face(const size_t* vertices, size_t n)
+{
+	if(n == 0 || std::find(vertices, vertices+n, NO_VERTEX) != vertices+n)
+		return;
+
+	std::vector<vertex*> face_vertices(n);
+	for(size_t i = 0; i < n; i++)
+		face_vertices[i] = M.get_vertex(vertices[i]);
+
+	M.add_face(face_vertices);
+}
+
+/*!
+*	Adds several faces at once, using mesh::build_topology(), which does
+*	not need to search for any edges.
+*
+*	@param face_offsets	Offsets of the faces in `face_indices`
+*	@param face_indices	Slots of the vertices of all faces
+*	@param corner_edges	Edge number of every corner
+*/
+
+void mesh_builder::add_faces(	const std::vector<size_t>& face_offsets,
+				const std::vector<size_t>& face_indices,
+				const std::vector<size_t>& corner_edges)
+{
+	M.build_topology(face_offsets, face_indices, corner_edges);
+}
+
+/*!
+*	@param i Slot of the vertex
+*	@return Position of the vertex
+*/
+
+const v3ctor& mesh_builder::get_position(size_t i) const
+{
+	return(static_cast<const mesh&>(M).get_vertex(i)->get_position());
+}
+
+/*!
+*	@return Number of vertices of the mesh
+*/
+
+size_t mesh_builder::num_vertices() const
+{
+	return(M.num_vertices());
+}
+
+/*!
+*	@return Number of faces of the mesh
+*/
+
+size_t mesh_builder::num_faces() const
+{
+	return(M.num_faces());
+}
+
+} // end of namespace "psalm"
@@ -0,0 +1,132 @@
+/*!
+*	@file	mesh_sink.h
+*	@brief	Receivers for vertices and faces that are created one by one
+*/
+
+#ifndef __MESH_SINK_H__
+#define __MESH_SINK_H__
+
+#include <cstddef>
+#include <vector>
+
+#include "mesh.h"
+
+namespace psalm
+{
+
+/*!
+*	@class mesh_sink
+*	@brief Abstract receiver for the vertices and faces of a mesh
+*
+*	Subdivision algorithms write their results to a sink instead of a
+*	mesh. Vertices are referred to by their index, i.e. by the number of
+*	vertices that have been added before. Whether the sink builds the
+*	topology of a mesh (mesh_builder) or just stores the data for writing
+*	it to a file (mesh_stream) is up to the implementation.
+*/
+
+class mesh_sink
+{
+	public:
+		virtual ~mesh_sink();
+
+		virtual void reserve(size_t num_vertices, size_t num_faces) = 0;
+
+		virtual size_t add_vertex(const v3ctor& position, bool on_boundary = false) = 0;
+		virtual void add_face(const size_t* vertices, size_t n) = 0;
+
+		virtual void add_faces(	const std::vector<size_t>& face_offsets,
+					const std::vector<size_t>& face_indices,
+					const std::vector<size_t>& corner_edges);
+
+		virtual const v3ctor& get_position(size_t i) const = 0;
+
+		virtual size_t num_vertices() const = 0;
+		virtual size_t num_faces() const = 0;
+
+		void add_face(const std::vector<size_t>& vertices);
+		void add_face(size_t v1, size_t v2, size_t v3);
+		void add_face(size_t v1, size_t v2, size_t v3, size_t v4);
+
+		static const size_t NO_VERTEX;	///< Index signalling a missing vertex
+};
+
+/*!
+*	@class mesh_builder
+*	@brief Sink that adds all vertices and faces to a mesh
+*
+*	The vertex indices of the sink are the slots of the vertices in the
+*	mesh, so the mesh is supposed to be empty when the builder is created.
+*	Faces are added via mesh::add_face(), i.e. the complete topology of the
+*	mesh is created.
+*/
+
+class mesh_builder : public mesh_sink
+{
+	public:
+		mesh_builder(mesh& M);
+
+		using mesh_sink::add_face;
+
+		void reserve(size_t num_vertices, size_t num_faces);
+
+		size_t add_vertex(const v3ctor& position, bool on_boundary = false);
+		void add_face(const size_t* vertices, size_t n);
+
+		void add_faces(	const std::vector<size_t>& face_offsets,
+				const std::vector<size_t>& face_indices,
+				const std::vector<size_t>& corner_edges);
+
+		const v3ctor& get_position(size_t i) const;
+
+		size_t num_vertices() const;
+		size_t num_faces() const;
+
+	private:
+		mesh& M;
+};
+
+/*!
+*	Adds a face with an arbitrary number of vertices.
+*
+*	@param vertices Indices of the vertices of the face
+*/
+
+inline void mesh_sink::add_face(const std::vector<size_t>& vertices)
+{
+	if(!vertices.empty())
+		add_face(&vertices[0], vertices.size());
+}
+
+/*!
+*	Adds a triangular face.
+*
+*	@param v1 Index of first vertex
+*	@param v2 Index of second vertex
+*	@param v3 Index of third vertex
+*/
+
+inline void mesh_sink::add_face(size_t v1, size_t v2, size_t v3)
+{
+	size_t vertices[3] = {v1, v2, v3};
+	add_face(vertices, 3);
+}
+
+/*!
+*	Adds a quadrangular face.
+*
+*	@param v1 Index of first vertex
+*	@param v2 Index of second vertex
+*	@param v3 Index of third vertex
+*	@param v4 Index of fourth vertex
+*/
+
+inline void mesh_sink::add_face(size_t v1, size_t v2, size_t v3, size_t v4)
+{
+	size_t vertices[4] = {v1, v2, v3, v4};
+	add_face(vertices, 4);
+}
+
+} // end of namespace "psalm"
+
+#endif
@@ -0,0 +1,211 @@
+/*!
+*	@file	mesh_stream.cpp
+*	@brief	Stores vertices and faces for writing them without a mesh
+*/
+
+#include <algorithm>
+
+#include "mesh_stream.h"
+#include "mesh_writer.h"
+
+namespace psalm
+{
+
+/*!
+*	Creates an empty stream.
+*/
+
+mesh_stream::mesh_stream()
+{
+	face_offsets.push_back(0);
+}
+
+/*!
+*	Reserves memory for the given number of vertices and faces. Faces are
+*	assumed to have four vertices on average.
+*
+*	@param num_vertices	Expected number of vertices
+*	@param num_faces	Expected number of faces
+*/
+
+void mesh_stream::reserve(size_t num_vertices, size_t num_faces)
+{
+	positions.reserve(num_vertices);
+	boundary.reserve(num_vertices);
+	face_offsets.reserve(num_faces+1);
+	face_indices.reserve(4*num_faces);
+	edges.reserve(2*num_faces);
+}
+
+/*!
+*	Stores a vertex.
+*
+*	@param position		Position of the vertex
+*	@param on_boundary	Flag signalling that the vertex is a boundary
+*				vertex
+*
+*	@return Index of the new vertex
+*/
+
+size_t mesh_stream::add_vertex(const v3ctor& position, bool on_boundary)
+{
+	positions.push_back(position);
+	boundary.push_back(on_boundary);
+
+	return(positions.size()-1);
+}
+
+/*!
+*	Stores a face. Faces with missing vertices are skipped. Faces that
+*	would overwrite the faces of an edge are skipped, too. Like in
+*	mesh::add_face(), the edges of the face that precede the offending
+*	edge keep their references to the skipped face.
+*
+*	@param vertices	Indices of the vertices of the face
+*	@param n	Number of vertices
+*/
+
+void mesh_stream::add_face(const size_t* vertices, size_t n)
+{
+	if(n == 0 || std::find(vertices, vertices+n, NO_VERTEX) != vertices+n)
+		return;
+
+	for(size_t i = 0; i < n; i++)
+	{
+		if(!add_edge(vertices[i], vertices[(i+1) % n]))
+			return;
+	}
+
+	face_indices.insert(face_indices.end(), vertices, vertices+n);
+	face_offsets.push_back(face_indices.size());
+}
+
+/*!
+*	Adds a face to an edge, following the rules of mesh::add_face(): If
+*	the edge is traversed in the direction in which it has been created,
+*	the face becomes its first face or, if that one exists, its second
+*	face; an existing second face is kept. If the edge is traversed in the
+*	opposite direction and already has two faces, the face is rejected.
+*
+*	@param u First vertex of the edge in the face
+*	@param v Second vertex of the edge in the face
+*
+*	@return false if the face has to be rejected, else true
+*/
+
+bool mesh_stream::add_edge(size_t u, size_t v)
+{
+	edge_table<unsigned char>::key_type id(std::min(u, v), std::max(u, v));
+
+	unsigned char* flags = edges.find(id);
+	if(flags == NULL)
+	{
+		edges.insert(id, static_cast<unsigned char>(EDGE_HAS_F | (u > v ? EDGE_INVERTED : 0)));
+		return(true);
+	}
+
+	bool inverted	= (((*flags & EDGE_INVERTED) != 0) != (u > v));
+	bool has_f	= (*flags & EDGE_HAS_F) != 0;
+	bool has_g	= (*flags & EDGE_HAS_G) != 0;
+
+	if(inverted)
+	{
+		if(!has_g && has_f)
+			*flags |= EDGE_HAS_G;
+		else if(!has_f)
+			*flags |= EDGE_HAS_F;
+		else
+			return(false);
+	}
+	else
+	{
+		if(has_f)
+			*flags |= EDGE_HAS_G;
+		else
+			*flags |= EDGE_HAS_F;
+	}
+
+	return(true);
+}
+
+/*!
+*	@param i Index of the vertex
+*	@return Position of the vertex
+*/
+
+const v3ctor& mesh_stream::get_position(size_t i) const
+{
+	return(positions[i]);
+}
+
+/*!
+*	@return Number of stored vertices
+*/
+
+size_t mesh_stream::num_vertices() const
+{
+	return(positions.size());
+}
+
+/*!
+*	@return Number of stored faces
+*/
+
+size_t mesh_stream::num_faces() const
+{
+	return(face_offsets.size()-1);
+}
+
+/*!
+*	Writes the stored vertices and faces to a file. The output is the same
+*	as if the data had been added to a mesh that is saved via mesh::save().
+*
+*	@param filename	Name of the output file; if the name is empty, the
+*			data is written to standard output
+*	@param type	Format of the data; TYPE_EXT selects the format by the
+*			extension of the file
+*	@param binary	Flag signalling that PLY data should be written in
+*			binary format
+*	@param compression
+*			Compression format; COMPRESSION_EXT selects the format
+*			by the extension of the file
+*	@param precision
+*			Number of decimal places of coordinates in ASCII files
+*			or one of the special values of mesh::precision_type
+*
+*	@return true if the data could be written, else false
+*/
+
+bool mesh_stream::save(const std::string& filename, mesh::file_type type, bool binary, mesh::compression_type compression, int precision) const
+{
+	mesh_writer writer;
+	if(!writer.open(filename, type, binary, compression))
+		return(false);
+
+	writer.set_precision(precision);
+
+	writer.write_header(num_vertices(), num_faces());
+
+	for(size_t i = 0; i < positions.size(); i++)
+		writer.write_vertex(positions[i], boundary[i]);
+
+	for(size_t i = 0; i < num_faces(); i++)
+		writer.write_face(&face_indices[face_offsets[i]], face_offsets[i+1]-face_offsets[i]);
+
+	return(writer.close());
+}
+
+/*!
+*	Removes all vertices and faces and releases their memory.
+*/
+
+void mesh_stream::clear()
+{
+	std::vector<v3ctor>().swap(positions);
+	std::vector<bool>().swap(boundary);
+	std::vector<size_t>(1, 0).swap(face_offsets);
+	std::vector<size_t>().swap(face_indices);
+	edge_table<unsigned char>().swap(edges);
+}
+
+} // end of namespace "psalm"
@@ -0,0 +1,81 @@
+/*!
+*	@file	mesh_stream.h
+*	@brief	Stores vertices and faces for writing them without a mesh
+*/
+
+#ifndef __MESH_STREAM_H__
+#define __MESH_STREAM_H__
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "mesh_sink.h"
+#include "edge_table.h"
+
+namespace psalm
+{
+
+/*!
+*	@class mesh_stream
+*	@brief Sink that collects vertices and faces for writing them to a file
+*
+*	In contrast to mesh_builder, no topology is created: Only the vertex
+*	positions, their boundary flags, and the vertex indices of the faces
+*	are stored in flat arrays. This suffices for writing the data, but
+*	requires only a fraction of the memory of a mesh. The data has to be
+*	stored until all faces are known because PLY and OFF files start with
+*	the number of vertices and faces.
+*
+*	Faces that refer to a missing vertex (NO_VERTEX) are skipped. Faces
+*	that mesh::add_face() would reject because they overwrite the faces
+*	of an edge are skipped as well, so the stream contains the same faces
+*	as a mesh built from the same data. For this purpose, the stream
+*	stores the direction and the number of faces of every edge.
+*/
+
+class mesh_stream : public mesh_sink
+{
+	public:
+		mesh_stream();
+
+		using mesh_sink::add_face;
+
+		void reserve(size_t num_vertices, size_t num_faces);
+
+		size_t add_vertex(const v3ctor& position, bool on_boundary = false);
+		void add_face(const size_t* vertices, size_t n);
+
+		const v3ctor& get_position(size_t i) const;
+
+		size_t num_vertices() const;
+		size_t num_faces() const;
+
+		bool save(const std::string& filename, mesh::file_type type = mesh::TYPE_EXT, bool binary = false, mesh::compression_type compression = mesh::COMPRESSION_EXT, int precision = mesh::PRECISION_DEFAULT) const;
+		void clear();
+
+	private:
+		bool add_edge(size_t u, size_t v);
+
+		/*!
+		*	Flags that describe the state of an edge
+		*/
+
+		enum edge_flags
+		{
+			EDGE_INVERTED	= 1,	///< Edge has been created from the second to the first vertex of its key
+			EDGE_HAS_F	= 2,	///< Edge has a first adjacent face
+			EDGE_HAS_G	= 4	///< Edge has a second adjacent face
+		};
+
+		edge_table<unsigned char> edges;	///< Flags of all edges
+
+		std::vector<v3ctor> positions;		///< Vertex positions
+		std::vector<bool> boundary;		///< Flags signalling boundary vertices
+		std::vector<size_t> face_offsets;	///< Offsets of the faces in face_indices; starts with 0
+		std::vector<size_t> face_indices;	///< Vertex indices of all faces
+};
+
+} // end of namespace "psalm"
+
+#endif
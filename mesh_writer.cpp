@@ -0,0 +1,401 @@
+/*!
+*	@file	mesh_writer.cpp
+*	@brief	Writes vertices and faces in one of the supported file formats
+*/
+
+#include <algorithm>
+#include <iostream>
+#include <clocale>
+#include <cstdio>
+
+#if __cplusplus >= 201703L
+	#include <charconv>
+#endif
+
+#include "mesh_writer.h"
+#include "ply.h"
+
+namespace psalm
+{
+
+/*!
+*	Size of the blocks in which data is written
+*/
+
+static const size_t block_size = 1 << 20;
+
+/*!
+*	Largest number of decimal places for coordinates. Together with the
+*	largest exponent of a double, this limits the length of a number.
+*/
+
+static const int max_precision = 64;
+
+/*!
+*	Appends the decimal representation of an unsigned number to a buffer.
+*
+*	@param buffer	Buffer for the output
+*	@param value	Number to append
+*/
+
+static void append_size(std::vector<char>& buffer, size_t value)
+{
+	char digits[24];
+	char* end	= digits+sizeof(digits);
+	char* begin	= end;
+
+	do
+	{
+		*--begin = static_cast<char>('0' + value % 10);
+		value /= 10;
+	}
+	while(value != 0);
+
+	buffer.insert(buffer.end(), begin, end);
+}
+
+/*!
+*	Appends the decimal representation of a floating point number to a
+*	buffer. The representation is the same as for printf(), using the C
+*	locale.
+*
+*	@param buffer		Buffer for the output
+*	@param value		Number to append
+*	@param format		'f' for a fixed number of decimal places, 'g'
+*				for a fixed number of significant digits, or
+*				's' for the shortest representation that is
+*				read back exactly
+*	@param precision	Number of decimal places or significant digits;
+*				ignored for the shortest representation
+*/
+
+static void append_double(std::vector<char>& buffer, double value, char format, int precision)
+{
+	char digits[max_precision+384];
+	char* end = digits;
+
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+	std::to_chars_result result;
+	if(format == 'f')
+		result = std::to_chars(digits, digits+sizeof(digits), value, std::chars_format::fixed, precision);
+	else if(format == 'g')
+		result = std::to_chars(digits, digits+sizeof(digits), value, std::chars_format::general, precision);
+	else
+		result = std::to_chars(digits, digits+sizeof(digits), value);
+
+	end = result.ptr;
+#else
+	// Without std::to_chars(), 17 significant digits are required for
+	// reading a double back exactly
+	int length;
+	if(format == 'f')
+		length = snprintf(digits, sizeof(digits), "%.*f", precision, value);
+	else if(format == 'g')
+		length = snprintf(digits, sizeof(digits), "%.*g", precision, value);
+	else
+		length = snprintf(digits, sizeof(digits), "%.17g", value);
+
+	end = digits + std::max(0, std::min(length, static_cast<int>(sizeof(digits))-1));
+
+	// The decimal separator of printf() depends on the locale
+	char separator = *localeconv()->decimal_point;
+	if(separator != '.')
+		std::replace(digits, end, separator, '.');
+#endif
+
+	buffer.insert(buffer.end(), digits, end);
+}
+
+/*!
+*	Creates a writer that is not associated with any output.
+*/
+
+mesh_writer::mesh_writer()
+{
+	out	= NULL;
+	type	= mesh::TYPE_PLY;
+	binary	= false;
+	swap	= false;
+
+	set_precision(mesh::PRECISION_DEFAULT);
+}
+
+/*!
+*	Prepares writing to a file or to standard output.
+*
+*	@param filename	Name of the output file. If the name is empty, the
+*			data is written to standard output.
+*	@param type	Format of the data. If TYPE_EXT is specified, the
+*			format is determined by the extension of the file;
+*			PLY is used for unknown extensions.
+*	@param binary	Flag signalling that PLY data should be written in
+*			binary format; ignored for other formats
+*	@param compression
+*			Compression format of the file. If COMPRESSION_EXT is
+*			specified, the format is determined by the extension of
+*			the file.
+*
+*	@return true if the output could be opened, else false
+*/
+
+bool mesh_writer::open(const std::string& filename, mesh::file_type type, bool binary, mesh::compression_type compression)
+{
+	if(type == mesh::TYPE_EXT)
+	{
+		std::string extension = mesh::get_extension(filename);
+		if(extension == ".obj")
+			type = mesh::TYPE_OBJ;
+		else if(extension == ".off")
+			type = mesh::TYPE_OFF;
+		else if(extension == ".psm")
+			type = mesh::TYPE_PSM;
+		else
+			type = mesh::TYPE_PLY;
+	}
+
+	// Unsupported formats are rejected before the file is overwritten
+	if(type != mesh::TYPE_PSM && !file.open(filename, compression))
+		return(false);
+
+	return(open(file, type, binary));
+}
+
+/*!
+*	Prepares writing to a stream.
+*
+*	@param out	Stream for data output
+*	@param type	Format of the data; TYPE_EXT is treated as PLY and
+*			TYPE_PSM is not supported
+*	@param binary	Flag signalling that PLY data should be written in
+*			binary format; ignored for other formats
+*
+*	@return true if the stream is ready for writing, else false
+*/
+
+bool mesh_writer::open(std::ostream& out, mesh::file_type type, bool binary)
+{
+	// PSM files contain the adjacency information of a mesh, which is
+	// not available to the writer
+	if(type == mesh::TYPE_PSM)
+	{
+		std::cerr << "psalm: PSM files can only be written by mesh::save().\n";
+		return(false);
+	}
+
+	if(!out.good())
+		return(false);
+
+	this->out	= &out;
+	this->type	= (type == mesh::TYPE_EXT ? mesh::TYPE_PLY : type);
+	this->binary	= (binary && this->type == mesh::TYPE_PLY);
+	this->swap	= !ply_header::is_little_endian_host();
+
+	buffer.clear();
+	buffer.reserve(block_size+4*max_precision+1024);
+
+	return(true);
+}
+
+/*!
+*	Writes any pending data and closes the output file, if any.
+*
+*	@return true if all data could be written, else false
+*/
+
+bool mesh_writer::close()
+{
+	if(out == NULL)
+		return(false);
+
+	flush(0);
+
+	bool result = out->good();
+	if(out == &file)
+		result = (file.close() && result);
+
+	out = NULL;
+	return(result);
+}
+
+/*!
+*	Sets the precision of the coordinates in ASCII files. By default, PLY
+*	files use 8 decimal places, while OBJ and OFF files use 6 significant
+*	digits.
+*
+*	@param precision	Number of decimal places (at most 64), or one
+*				of the special values of mesh::precision_type
+*/
+
+void mesh_writer::set_precision(int precision)
+{
+	if(precision == mesh::PRECISION_DEFAULT)
+	{
+		number_format		= 'd';
+		number_precision	= 0;
+	}
+	else if(precision == mesh::PRECISION_SHORTEST)
+	{
+		number_format		= 's';
+		number_precision	= 0;
+	}
+	else
+	{
+		number_format		= 'f';
+		number_precision	= std::max(1, std::min(precision, max_precision));
+	}
+}
+
+/*!
+*	Writes the header of the file. Must be called before writing any
+*	vertices. For OBJ files, nothing is written.
+*
+*	@param num_vertices	Number of vertices that will be written
+*	@param num_faces	Number of faces that will be written
+*/
+
+void mesh_writer::write_header(size_t num_vertices, size_t num_faces)
+{
+	switch(type)
+	{
+		case mesh::TYPE_PLY:
+			*out	<< "ply\n"
+				<< (binary ? "format binary_little_endian 1.0\n" : "format ascii 1.0\n")
+				<< "element vertex " << num_vertices << "\n"
+				<< "property float x\n"
+				<< "property float y\n"
+				<< "property float z\n"
+				<< "property uchar red\n"
+				<< "property uchar green\n"
+				<< "property uchar blue\n"
+				<< "element face " << num_faces << "\n"
+				<< "property list uchar int vertex_indices\n"
+				<< "end_header\n";
+			break;
+
+		case mesh::TYPE_OFF:
+			*out	<< "OFF\n"
+				<< num_vertices << " " << num_faces << " " << "0\n";	// For programs that actually interpret edge data,
+											// the last parameter should be changed
+			break;
+
+		default:
+			break;
+	}
+}
+
+/*!
+*	Writes a single vertex. In PLY files, boundary vertices are coloured
+*	red and all other vertices green.
+*
+*	@param position		Position of the vertex
+*	@param on_boundary	Flag signalling a boundary vertex
+*/
+
+void mesh_writer::write_vertex(const v3ctor& position, bool on_boundary)
+{
+	if(binary)
+	{
+		ply_header::encode(buffer, static_cast<float>(position[0]), swap);
+		ply_header::encode(buffer, static_cast<float>(position[1]), swap);
+		ply_header::encode(buffer, static_cast<float>(position[2]), swap);
+
+		// XXX
+		boost::uint8_t red = (on_boundary ? 255 : 0);
+
+		ply_header::encode(buffer, red, swap);
+		ply_header::encode(buffer, static_cast<boost::uint8_t>(255-red), swap);
+		ply_header::encode(buffer, static_cast<boost::uint8_t>(0), swap);
+
+		flush(block_size);
+		return;
+	}
+
+	// The default format depends on the type of the file; it is the same
+	// as for writing the coordinates to a stream
+	char format	= number_format;
+	int precision	= number_precision;
+
+	if(format == 'd')
+	{
+		format		= (type == mesh::TYPE_PLY ? 'f' : 'g');
+		precision	= (type == mesh::TYPE_PLY ?  8  :  6 );
+	}
+
+	if(type == mesh::TYPE_OBJ)
+	{
+		buffer.push_back('v');
+		buffer.push_back(' ');
+	}
+
+	append_double(buffer, position[0], format, precision);
+	buffer.push_back(' ');
+	append_double(buffer, position[1], format, precision);
+	buffer.push_back(' ');
+	append_double(buffer, position[2], format, precision);
+
+	// XXX
+	if(type == mesh::TYPE_PLY)
+	{
+		const char* colour = (on_boundary ? " 255 0 0" : " 0 255 0");
+		buffer.insert(buffer.end(), colour, colour+8);
+	}
+
+	buffer.push_back('\n');
+	flush(block_size);
+}
+
+/*!
+*	Writes a single face.
+*
+*	@param vertices	Indices of the vertices of the face
+*	@param n	Number of vertices
+*/
+
+void mesh_writer::write_face(const size_t* vertices, size_t n)
+{
+	if(binary)
+	{
+		ply_header::encode(buffer, static_cast<boost::uint8_t>(n), swap);
+		for(size_t i = 0; i < n; i++)
+			ply_header::encode(buffer, static_cast<boost::int32_t>(vertices[i]), swap);
+
+		flush(block_size);
+		return;
+	}
+
+	// OBJ is 1-indexed, not 0-indexed
+	size_t offset = 0;
+	if(type == mesh::TYPE_OBJ)
+	{
+		buffer.push_back('f');
+		offset = 1;
+	}
+	else
+		append_size(buffer, n);
+
+	for(size_t i = 0; i < n; i++)
+	{
+		buffer.push_back(' ');
+		append_size(buffer, vertices[i]+offset);
+	}
+
+	buffer.push_back('\n');
+	flush(block_size);
+}
+
+/*!
+*	Writes the buffered data if it exceeds a given size.
+*
+*	@param min_size Minimum size of the data that is written
+*/
+
+void mesh_writer::flush(size_t min_size)
+{
+	if(buffer.empty() || buffer.size() < min_size)
+		return;
+
+	out->write(&buffer[0], buffer.size());
+	buffer.clear();
+}
+
+} // end of namespace "psalm"
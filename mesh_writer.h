@@ -0,0 +1,72 @@
+/*!
+*	@file	mesh_writer.h
+*	@brief	Writes vertices and faces in one of the supported file formats
+*/
+
+#ifndef __MESH_WRITER_H__
+#define __MESH_WRITER_H__
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "mesh.h"
+#include "compressed_stream.h"
+
+namespace psalm
+{
+
+/*!
+*	@class mesh_writer
+*	@brief Formats mesh data as PLY, OBJ, or OFF
+*
+*	The writer does not require a mesh: After the header has been written,
+*	vertices and faces are written one after another. Faces refer to the
+*	vertices by their index. The writer is used by mesh::save() as well as
+*	by mesh_stream, which stores subdivided meshes without building their
+*	topology.
+*
+*	Numbers are formatted into a buffer that is written in large blocks.
+*	Formatting does not depend on the locale, so the decimal separator is
+*	always a dot.
+*/
+
+class mesh_writer
+{
+	public:
+		mesh_writer();
+
+		bool open(const std::string& filename, mesh::file_type type = mesh::TYPE_EXT, bool binary = false, mesh::compression_type compression = mesh::COMPRESSION_EXT);
+		bool open(std::ostream& out, mesh::file_type type, bool binary = false);
+		bool close();
+
+		void set_precision(int precision);
+
+		void write_header(size_t num_vertices, size_t num_faces);
+		void write_vertex(const v3ctor& position, bool on_boundary);
+		void write_face(const size_t* vertices, size_t n);
+
+
+	private:
+		compressed_ofstream file;	///< Output file, if a file name has been specified
+		std::ostream* out;		///< Stream that receives the data
+
+		mesh::file_type type;		///< Format of the data; never TYPE_EXT
+		bool binary;			///< Flag signalling binary PLY output
+		bool swap;			///< Flag signalling that binary data needs to be swapped
+
+		char number_format;		///< Format of coordinates in ASCII files (see append_double())
+		int number_precision;		///< Precision of coordinates in ASCII files
+
+		std::vector<char> buffer;	///< Data that has not been written yet
+
+		void flush(size_t min_size);
+
+		// Writers own their file and must not be copied
+		mesh_writer(const mesh_writer&);
+		mesh_writer& operator=(const mesh_writer&);
+};
+
+} // end of namespace "psalm"
+
+#endif
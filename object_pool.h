@@ -0,0 +1,277 @@
+/*!
+*	@file	object_pool.h
+*	@brief	Slab allocator for mesh elements
+*/
+
+#ifndef __OBJECT_POOL_H__
+#define __OBJECT_POOL_H__
+
+#include <vector>
+#include <new>
+#include <cstddef>
+#include <algorithm>
+
+#include <boost/type_traits/aligned_storage.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+
+namespace psalm
+{
+
+/*!
+*	@class object_pool
+*	@brief Allocates objects of a fixed type from large slabs of memory
+*
+*	Instead of requesting memory for each object separately, the pool
+*	allocates slabs that are able to hold a fixed number of objects. If the
+*	number of objects is known in advance, reserve() allocates a single
+*	slab that is large enough for all of them. New objects are placed
+*	consecutively into the current slab, so objects that are created one
+*	after another are also stored next to each other. Released objects are
+*	put on a free list and their memory is reused by subsequent
+*	allocations.
+*
+*	Only the objects themselves are stored in the slabs. Memory that an
+*	object requests on its own, e.g. the adjacency lists of a vertex, is
+*	not provided by the pool.
+*
+*	The pool keeps track of the objects that are currently alive. Calling
+*	clear() destroys all of them and returns the slabs to the system, so
+*	the owner of the pool need not destroy its objects one by one. The
+*	destructor of every object that is alive is still called, though.
+*/
+
+template <class T, size_t slab_size = 1024> class object_pool
+{
+	public:
+		object_pool();
+		~object_pool();
+
+		T* allocate();
+		void release(T* object);
+		void reserve(size_t n);
+
+		void clear();
+		void swap(object_pool<T, slab_size>& other);
+
+		size_t num_slabs() const;
+		size_t num_objects() const;
+
+	private:
+
+		/*!
+		*	@struct node
+		*	@brief Storage for a single object
+		*
+		*	The storage is the first member of the node, so pointers
+		*	to objects and pointers to nodes may be converted into
+		*	each other.
+		*/
+
+		struct node
+		{
+			typename boost::aligned_storage<sizeof(T), boost::alignment_of<T>::value>::type storage;
+			bool alive;	///< Signals that the object is currently constructed
+		};
+
+		/*!
+		*	@struct slab
+		*	@brief Contiguous storage for several objects
+		*/
+
+		struct slab
+		{
+			node* nodes;	///< Storage for the objects
+			size_t size;	///< Number of objects that fit into the slab
+			size_t used;	///< Number of objects that have been handed out
+		};
+
+		std::vector<slab> slabs;	///< Slabs, the last one is filled first
+		std::vector<size_t> partial;	///< Indices of slabs that still have room, but have
+						///< been replaced as the current slab by reserve()
+
+		std::vector<T*> free_list;	///< Released objects that may be reused
+
+		size_t allocations;		///< Number of slabs allocated so far
+		size_t objects;			///< Number of objects that are alive
+
+		// Pools own their memory and may not be copied
+		object_pool(const object_pool<T, slab_size>&);
+		object_pool<T, slab_size>& operator=(const object_pool<T, slab_size>&);
+};
+
+/*!
+*	Creates an empty pool. No memory is allocated until the first object
+*	is requested.
+*/
+
+template <class T, size_t slab_size> object_pool<T, slab_size>::object_pool()
+{
+	allocations	= 0;
+	objects		= 0;
+}
+
+/*!
+*	Destroys all objects that are still alive and frees the slabs.
+*/
+
+template <class T, size_t slab_size> object_pool<T, slab_size>::~object_pool()
+{
+	clear();
+}
+
+/*!
+*	Returns memory for a new object. The object has _not_ been constructed
+*	yet; the caller is supposed to use placement new, e.g.
+*
+*		new(pool.allocate()) T(...);
+*
+*	@return Pointer to uninitialized memory for one object
+*/
+
+template <class T, size_t slab_size> T* object_pool<T, slab_size>::allocate()
+{
+	T* object;
+	if(!free_list.empty())
+	{
+		object = free_list.back();
+		free_list.pop_back();
+	}
+	else
+	{
+		if(slabs.empty() || slabs.back().used == slabs.back().size)
+		{
+			// Continue with a slab that has been put aside by
+			// reserve() before allocating a new one
+			if(!partial.empty())
+			{
+				std::swap(slabs[partial.back()], slabs.back());
+				partial.pop_back();
+			}
+			else
+				reserve(slab_size);
+		}
+
+		slab& s = slabs.back();
+		object = reinterpret_cast<T*>(&s.nodes[s.used].storage);
+		s.used++;
+	}
+
+	reinterpret_cast<node*>(object)->alive = true;
+	objects++;
+
+	return(object);
+}
+
+/*!
+*	Destroys an object and puts its memory on the free list.
+*
+*	@param object Object that has been allocated by this pool
+*/
+
+template <class T, size_t slab_size> void object_pool<T, slab_size>::release(T* object)
+{
+	if(object == NULL)
+		return;
+
+	object->~T();
+
+	reinterpret_cast<node*>(object)->alive = false;
+	free_list.push_back(object);
+
+	objects--;
+}
+
+/*!
+*	Ensures that the next n objects can be allocated without requesting
+*	more than one slab from the system. If the current slab is too small,
+*	a new slab for (at least) n objects is allocated. Memory on the free
+*	list is not taken into account. The remaining room of the current slab
+*	is not lost: The slab is filled as soon as the new slab is full.
+*
+*	@param n Number of objects that will be allocated
+*/
+
+template <class T, size_t slab_size> void object_pool<T, slab_size>::reserve(size_t n)
+{
+	if(!slabs.empty() && slabs.back().size - slabs.back().used >= n)
+		return;
+
+	if(!slabs.empty() && slabs.back().used < slabs.back().size)
+		partial.push_back(slabs.size()-1);
+
+	slab s;
+	s.size	= std::max(n, slab_size);
+	s.used	= 0;
+	s.nodes	= new node[s.size];
+
+	slabs.push_back(s);
+	allocations++;
+}
+
+/*!
+*	Destroys all objects that are alive and frees all slabs. Every object
+*	that is alive has to be destroyed separately, so the cost is linear in
+*	the number of objects; memory is returned with one call per slab,
+*	though. The number of slabs that have been allocated is not reset by
+*	this function.
+*/
+
+template <class T, size_t slab_size> void object_pool<T, slab_size>::clear()
+{
+	for(size_t i = 0; i < slabs.size(); i++)
+	{
+		for(size_t j = 0; j < slabs[i].used; j++)
+		{
+			if(slabs[i].nodes[j].alive)
+				reinterpret_cast<T*>(&slabs[i].nodes[j].storage)->~T();
+		}
+
+		delete[] slabs[i].nodes;
+	}
+
+	slabs.clear();
+	partial.clear();
+	free_list.clear();
+
+	objects = 0;
+}
+
+/*!
+*	Exchanges the contents of two pools. Pointers to objects remain valid,
+*	but they are owned by the other pool afterwards.
+*
+*	@param other Pool to swap with
+*/
+
+template <class T, size_t slab_size> void object_pool<T, slab_size>::swap(object_pool<T, slab_size>& other)
+{
+	slabs.swap(other.slabs);
+	partial.swap(other.partial);
+	free_list.swap(other.free_list);
+
+	std::swap(allocations, other.allocations);
+	std::swap(objects, other.objects);
+}
+
+/*!
+*	@return Number of slabs that have been requested from the system since
+*	the pool has been created
+*/
+
+template <class T, size_t slab_size> inline size_t object_pool<T, slab_size>::num_slabs() const
+{
+	return(allocations);
+}
+
+/*!
+*	@return Number of objects that are currently alive
+*/
+
+template <class T, size_t slab_size> inline size_t object_pool<T, slab_size>::num_objects() const
+{
+	return(objects);
+}
+
+} // end of namespace "psalm"
+
+#endif
@@ -0,0 +1,418 @@
+/*!
+*	@file	ply.cpp
+*	@brief	Functions for parsing the header and the binary data of PLY files
+*/
+
+#include <sstream>
+
+#include "ply.h"
+
+namespace psalm
+{
+
+/*!
+*	Creates an empty header for ASCII data.
+*/
+
+ply_header::ply_header()
+{
+	data_format = FORMAT_ASCII;
+}
+
+/*!
+*	@param name Name of the property
+*
+*	@return Index of the property within the element or the number of
+*	properties if the element does not have a property with this name
+*/
+
+size_t ply_header::element::find_property(const std::string& name) const
+{
+	for(size_t i = 0; i < properties.size(); i++)
+	{
+		if(properties[i].name == name)
+			return(i);
+	}
+
+	return(properties.size());
+}
+
+/*!
+*	@return Index of the property that stores the vertex indices of a face
+*	or the number of properties if there is no such property
+*/
+
+size_t ply_header::element::find_face_property() const
+{
+	size_t i = find_property("vertex_indices");
+	if(i == properties.size())
+		i = find_property("vertex_index");
+
+	return(i);
+}
+
+/*!
+*	@return Index of the coordinate (0, 1, 2) that is stored in each
+*	property of the element or 3 for properties that do not store a
+*	coordinate. Only properties of vertices store coordinates.
+*/
+
+std::vector<size_t> ply_header::element::map_coordinates() const
+{
+	std::vector<size_t> coordinates(properties.size(), 3);
+	if(name == "vertex")
+	{
+		coordinates[find_property("x")] = 0;
+		coordinates[find_property("y")] = 1;
+		coordinates[find_property("z")] = 2;
+	}
+
+	return(coordinates);
+}
+
+/*!
+*	Reads the header of a PLY file. Afterwards, the stream points to the
+*	first byte of the data. Comments and `obj_info` lines are skipped.
+*
+*	@param in Input stream (file, standard input)
+*	@return true if the header could be parsed, else false
+*/
+
+bool ply_header::read(std::istream& in)
+{
+	elements.clear();
+	data_format = FORMAT_ASCII;
+
+	std::string line;
+	std::getline(in, line);
+
+	// Files written on other platforms may use CRLF line endings
+	if(!line.empty() && line[line.length()-1] == '\r')
+		line.erase(line.length()-1);
+
+	if(line != "ply")
+	{
+		std::cerr << "psalm: I am missing a \"ply\" header for the input data.\n";
+		return(false);
+	}
+
+	bool has_format = false;
+	while(std::getline(in, line))
+	{
+		if(!line.empty() && line[line.length()-1] == '\r')
+			line.erase(line.length()-1);
+
+		std::istringstream parser(line);
+		std::string keyword;
+		parser >> keyword;
+
+		if(keyword.empty() || keyword == "comment" || keyword == "obj_info")
+			continue;
+		else if(keyword == "end_header")
+		{
+			if(!has_format)
+			{
+				std::cerr << "psalm: PLY header does not specify a format.\n";
+				return(false);
+			}
+
+			for(std::vector<element>::iterator it = elements.begin(); it != elements.end(); it++)
+				compute_layout(*it);
+
+			return(true);
+		}
+		else if(keyword == "format")
+		{
+			std::string name;
+			parser >> name;
+
+			if(name == "ascii")
+				data_format = FORMAT_ASCII;
+			else if(name == "binary_little_endian")
+				data_format = FORMAT_BINARY_LITTLE_ENDIAN;
+			else if(name == "binary_big_endian")
+				data_format = FORMAT_BINARY_BIG_ENDIAN;
+			else
+			{
+				std::cerr << "psalm: Unknown PLY format \"" << name << "\".\n";
+				return(false);
+			}
+
+			has_format = true;
+		}
+		else if(keyword == "element")
+		{
+			element e;
+			e.count		= 0;
+			e.stride	= 0;
+
+			parser >> e.name >> e.count;
+			if(parser.fail())
+			{
+				std::cerr << "psalm: Can't parse element declaration \"" << line << "\".\n";
+				return(false);
+			}
+
+			elements.push_back(e);
+		}
+		else if(keyword == "property")
+		{
+			if(elements.empty())
+			{
+				std::cerr << "psalm: Got \"" << line << "\" before any element declaration.\n";
+				return(false);
+			}
+
+			property p;
+			p.is_list	= false;
+			p.count_type	= TYPE_INVALID;
+			p.offset	= 0;
+
+			std::string type_name;
+			parser >> type_name;
+
+			if(type_name == "list")
+			{
+				std::string count_type_name;
+				parser >> count_type_name >> type_name;
+
+				p.is_list	= true;
+				p.count_type	= parse_type(count_type_name);
+			}
+
+			p.value_type = parse_type(type_name);
+			parser >> p.name;
+
+			if(	parser.fail() ||
+				p.value_type == TYPE_INVALID ||
+				(p.is_list && p.count_type == TYPE_INVALID))
+			{
+				std::cerr << "psalm: Can't parse property declaration \"" << line << "\".\n";
+				return(false);
+			}
+
+			elements.back().properties.push_back(p);
+		}
+		else
+		{
+			std::cerr << "psalm: Unknown PLY header line \"" << line << "\".\n";
+			return(false);
+		}
+	}
+
+	std::cerr << "psalm: PLY header is not terminated by \"end_header\".\n";
+	return(false);
+}
+
+/*!
+*	Adds an element to the header. This permits describing the layout of
+*	other formats, e.g. OFF files, in terms of PLY elements.
+*
+*	@param name	Name of the element
+*	@param count	Number of instances
+*/
+
+void ply_header::add_element(const std::string& name, size_t count)
+{
+	element e;
+	e.name		= name;
+	e.count		= count;
+	e.stride	= 0;
+
+	elements.push_back(e);
+}
+
+/*!
+*	Adds a scalar property to the last element of the header.
+*
+*	@param name		Name of the property
+*	@param value_type	Type of the property
+*/
+
+void ply_header::add_property(const std::string& name, type value_type)
+{
+	property p;
+	p.name		= name;
+	p.value_type	= value_type;
+	p.count_type	= TYPE_INVALID;
+	p.is_list	= false;
+	p.offset	= 0;
+
+	elements.back().properties.push_back(p);
+	compute_layout(elements.back());
+}
+
+/*!
+*	Adds a list property to the last element of the header.
+*
+*	@param name		Name of the property
+*	@param count_type	Type of the length of the list
+*	@param value_type	Type of the list items
+*/
+
+void ply_header::add_list_property(const std::string& name, type count_type, type value_type)
+{
+	property p;
+	p.name		= name;
+	p.value_type	= value_type;
+	p.count_type	= count_type;
+	p.is_list	= true;
+	p.offset	= 0;
+
+	elements.back().properties.push_back(p);
+	compute_layout(elements.back());
+}
+
+/*!
+*	@param t Type of a value
+*	@return Size of the type in bytes or 0 for invalid types
+*/
+
+size_t ply_header::get_size(type t)
+{
+	switch(t)
+	{
+		case TYPE_INT8:
+		case TYPE_UINT8:
+			return(1);
+
+		case TYPE_INT16:
+		case TYPE_UINT16:
+			return(2);
+
+		case TYPE_INT32:
+		case TYPE_UINT32:
+		case TYPE_FLOAT32:
+			return(4);
+
+		case TYPE_FLOAT64:
+			return(8);
+
+		default:
+			return(0);
+	}
+}
+
+/*!
+*	Parses the name of a type. Both the original names (e.g. "uchar") and
+*	the names with explicit sizes (e.g. "uint8") are accepted.
+*
+*	@param name Name of the type
+*	@return Type or TYPE_INVALID if the name is unknown
+*/
+
+ply_header::type ply_header::parse_type(const std::string& name)
+{
+	if(name == "char" || name == "int8")
+		return(TYPE_INT8);
+	else if(name == "uchar" || name == "uint8")
+		return(TYPE_UINT8);
+	else if(name == "short" || name == "int16")
+		return(TYPE_INT16);
+	else if(name == "ushort" || name == "uint16")
+		return(TYPE_UINT16);
+	else if(name == "int" || name == "int32")
+		return(TYPE_INT32);
+	else if(name == "uint" || name == "uint32")
+		return(TYPE_UINT32);
+	else if(name == "float" || name == "float32")
+		return(TYPE_FLOAT32);
+	else if(name == "double" || name == "float64")
+		return(TYPE_FLOAT64);
+	else
+		return(TYPE_INVALID);
+}
+
+/*!
+*	Computes the offsets of all properties of an element and the size of
+*	an element record. Offsets of properties that follow a list property
+*	are relative to the end of the list.
+*
+*	@param e Element to process
+*/
+
+void ply_header::compute_layout(element& e)
+{
+	size_t offset	= 0;
+	bool fixed_size	= true;
+
+	for(std::vector<property>::iterator it = e.properties.begin(); it != e.properties.end(); it++)
+	{
+		it->offset = offset;
+		if(it->is_list)
+		{
+			fixed_size	= false;
+			offset		= 0;
+		}
+		else
+			offset += get_size(it->value_type);
+	}
+
+	e.stride = (fixed_size ? offset : 0);
+}
+
+/*!
+*	Creates a new reader for the given stream.
+*
+*	@param in Input stream, which has to point to the data of the file
+*/
+
+ply_binary_reader::ply_binary_reader(std::istream& in)
+	: in(&in), buffer(1 << 20), data(&buffer[0]), pos(0), end(0)
+{
+}
+
+/*!
+*	Creates a new reader for data that is stored in memory.
+*
+*	@param begin	First byte of the data of the file
+*	@param end	End of the data
+*/
+
+ply_binary_reader::ply_binary_reader(const char* begin, const char* end)
+	: in(NULL), data(begin), pos(0), end(end-begin)
+{
+}
+
+/*!
+*	Provides the next bytes of the data.
+*
+*	@param n Number of bytes
+*
+*	@return Pointer to the bytes or NULL if the data does not contain
+*	enough bytes. For streams, the pointer is invalidated by the next call.
+*/
+
+const char* ply_binary_reader::get(size_t n)
+{
+	if(end - pos < n)
+	{
+		if(in == NULL)
+			return(NULL);
+
+		// Move remaining data to the front and refill the buffer
+		std::copy(buffer.begin()+pos, buffer.begin()+end, buffer.begin());
+		end -= pos;
+		pos = 0;
+
+		if(buffer.size() < n)
+			buffer.resize(n);
+
+		while(end < n && in->good())
+		{
+			in->read(&buffer[end], buffer.size()-end);
+			end += static_cast<size_t>(in->gcount());
+		}
+
+		data = &buffer[0];
+		if(end < n)
+			return(NULL);
+	}
+
+	const char* res = data+pos;
+	pos += n;
+
+	return(res);
+}
+
+} // end of namespace "psalm"
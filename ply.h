@@ -0,0 +1,314 @@
+/*!
+*	@file	ply.h
+*	@brief	Classes for parsing the header and the binary data of PLY files
+*/
+
+#ifndef __PLY_H__
+#define __PLY_H__
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+
+#include <boost/cstdint.hpp>
+
+namespace psalm
+{
+
+/*!
+*	@class ply_header
+*	@brief Describes the layout of the data of a PLY file
+*
+*	The header lists the elements of the file (e.g. vertices and faces)
+*	together with their properties. For every property, the offset within
+*	an element record is precomputed, so binary data may be accessed
+*	directly. Elements that contain list properties do not have a fixed
+*	size; their properties are stored with the offset of the preceding
+*	list, which is sufficient for reading them sequentially.
+*/
+
+class ply_header
+{
+	public:
+		enum format
+		{
+			FORMAT_ASCII,
+			FORMAT_BINARY_LITTLE_ENDIAN,
+			FORMAT_BINARY_BIG_ENDIAN
+		};
+
+		enum type
+		{
+			TYPE_INVALID,
+			TYPE_INT8,
+			TYPE_UINT8,
+			TYPE_INT16,
+			TYPE_UINT16,
+			TYPE_INT32,
+			TYPE_UINT32,
+			TYPE_FLOAT32,
+			TYPE_FLOAT64
+		};
+
+		/*!
+		*	@struct property
+		*	@brief Property of an element
+		*/
+
+		struct property
+		{
+			std::string name;	///< Name of the property
+			type value_type;	///< Type of the value or of the list items
+			type count_type;	///< Type of the list length; only for lists
+			bool is_list;		///< Flag signalling a list property
+			size_t offset;		///< Offset within the element record
+		};
+
+		/*!
+		*	@struct element
+		*	@brief Element of a PLY file, e.g. vertices or faces
+		*/
+
+		struct element
+		{
+			std::string name;			///< Name of the element
+			size_t count;				///< Number of instances
+			std::vector<property> properties;	///< Properties in the order of the file
+
+			/*!
+			*	Size of a single record in binary files or 0 if the
+			*	element contains list properties.
+			*/
+
+			size_t stride;
+
+			size_t find_property(const std::string& name) const;
+			size_t find_face_property() const;
+
+			std::vector<size_t> map_coordinates() const;
+		};
+
+		ply_header();
+
+		bool read(std::istream& in);
+
+		void add_element(const std::string& name, size_t count);
+		void add_property(const std::string& name, type value_type);
+		void add_list_property(const std::string& name, type count_type, type value_type);
+
+		format get_format() const;
+		bool is_binary() const;
+		bool needs_swap() const;
+
+		size_t num_elements() const;
+		const element& get_element(size_t i) const;
+
+		static size_t get_size(type t);
+		static type parse_type(const std::string& name);
+		static bool is_little_endian_host();
+
+		static double decode(const char* data, type t, bool swap);
+		template <class T> static void encode(std::vector<char>& buffer, T value, bool swap);
+
+	private:
+		format data_format;		///< Format of the data following the header
+		std::vector<element> elements;	///< Elements in the order of the file
+
+		void compute_layout(element& e);
+};
+
+/*!
+*	@class ply_binary_reader
+*	@brief Buffered sequential access to the binary data of a PLY file
+*
+*	Instead of reading every value separately, the reader fills a large
+*	buffer and hands out pointers into it. This keeps the number of calls
+*	to the stream small regardless of the layout of the elements. If the
+*	data is already available in memory, e.g. as a mapped file, pointers
+*	into the data are handed out directly.
+*/
+
+class ply_binary_reader
+{
+	public:
+		ply_binary_reader(std::istream& in);
+		ply_binary_reader(const char* begin, const char* end);
+
+		const char* get(size_t n);
+
+	private:
+		std::istream* in;		///< Stream containing the data; NULL for data in memory
+		std::vector<char> buffer;	///< Data that has been read from the stream
+		const char* data;		///< Data that is currently available
+		size_t pos;			///< Position of the next unread byte
+		size_t end;			///< End of valid data
+};
+
+/*!
+*	@return Format of the data that follows the header
+*/
+
+inline ply_header::format ply_header::get_format() const
+{
+	return(data_format);
+}
+
+/*!
+*	@return true if the data is stored in one of the binary formats
+*/
+
+inline bool ply_header::is_binary() const
+{
+	return(data_format != FORMAT_ASCII);
+}
+
+/*!
+*	@return true if the byte order of the data differs from the byte order
+*	of the current machine
+*/
+
+inline bool ply_header::needs_swap() const
+{
+	if(data_format == FORMAT_ASCII)
+		return(false);
+
+	return((data_format == FORMAT_BINARY_LITTLE_ENDIAN) != is_little_endian_host());
+}
+
+/*!
+*	@return Number of elements in the file
+*/
+
+inline size_t ply_header::num_elements() const
+{
+	return(elements.size());
+}
+
+/*!
+*	@param i Index of element; not checked
+*	@return ith element of the file
+*/
+
+inline const ply_header::element& ply_header::get_element(size_t i) const
+{
+	return(elements[i]);
+}
+
+/*!
+*	@return true if the current machine stores the least significant byte
+*	first
+*/
+
+inline bool ply_header::is_little_endian_host()
+{
+	const boost::uint16_t probe = 1;
+	return(*reinterpret_cast<const unsigned char*>(&probe) == 1);
+}
+
+/*!
+*	Converts a binary value to a double.
+*
+*	@param data	Pointer to the value; no alignment is required
+*	@param t	Type of the value
+*	@param swap	Signals that the bytes of the value have to be reversed
+*
+*	@return Value as double or 0 for invalid types
+*/
+
+inline double ply_header::decode(const char* data, type t, bool swap)
+{
+	char bytes[8];
+	size_t n = get_size(t);
+
+	std::memcpy(bytes, data, n);
+	if(swap)
+		std::reverse(bytes, bytes+n);
+
+	switch(t)
+	{
+		case TYPE_INT8:
+		{
+			boost::int8_t value;
+			std::memcpy(&value, bytes, n);
+			return(value);
+		}
+
+		case TYPE_UINT8:
+		{
+			boost::uint8_t value;
+			std::memcpy(&value, bytes, n);
+			return(value);
+		}
+
+		case TYPE_INT16:
+		{
+			boost::int16_t value;
+			std::memcpy(&value, bytes, n);
+			return(value);
+		}
+
+		case TYPE_UINT16:
+		{
+			boost::uint16_t value;
+			std::memcpy(&value, bytes, n);
+			return(value);
+		}
+
+		case TYPE_INT32:
+		{
+			boost::int32_t value;
+			std::memcpy(&value, bytes, n);
+			return(value);
+		}
+
+		case TYPE_UINT32:
+		{
+			boost::uint32_t value;
+			std::memcpy(&value, bytes, n);
+			return(value);
+		}
+
+		case TYPE_FLOAT32:
+		{
+			float value;
+			std::memcpy(&value, bytes, n);
+			return(value);
+		}
+
+		case TYPE_FLOAT64:
+		{
+			double value;
+			std::memcpy(&value, bytes, n);
+			return(value);
+		}
+
+		default:
+			return(0.0);
+	}
+}
+
+/*!
+*	Appends a binary value to a buffer.
+*
+*	@param buffer	Buffer for the output data
+*	@param value	Value to append; the size of its type determines the
+*			number of bytes that are written
+*	@param swap	Signals that the bytes of the value have to be reversed
+*/
+
+template <class T> inline void ply_header::encode(std::vector<char>& buffer, T value, bool swap)
+{
+	char bytes[sizeof(T)];
+	std::memcpy(bytes, &value, sizeof(T));
+	if(swap)
+		std::reverse(bytes, bytes+sizeof(T));
+
+	buffer.insert(buffer.end(), bytes, bytes+sizeof(T));
+}
+
+} // end of namespace "psalm"
+
+#endif
@@ -0,0 +1,205 @@
+/*!
+*	@file	property.h
+*	@brief	Per-element properties stored as contiguous arrays
+*/
+
+#ifndef __PROPERTY_H__
+#define __PROPERTY_H__
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace psalm
+{
+
+/*!
+*	@class property_base
+*	@brief Type-independent interface of a property
+*
+*	The mesh uses this interface for keeping the size of all properties in
+*	sync with the number of elements.
+*/
+
+class property_base
+{
+	public:
+		property_base(const std::string& name);
+		virtual ~property_base();
+
+		const std::string& get_name() const;
+
+		virtual void resize(size_t n)			= 0;
+		virtual void move(size_t from, size_t to)	= 0;
+		virtual void reserve(size_t n)			= 0;
+		virtual property_base* clone() const		= 0;
+
+	private:
+		std::string name;	///< Name under which the property is registered
+};
+
+/*!
+*	@class property
+*	@brief Stores a value of a fixed type for every element of the mesh
+*
+*	The values of a property are stored in a single array that is indexed
+*	by the slot of an element, i.e. by its position in the corresponding
+*	vector of the mesh. Algorithms thus only pay for the data they
+*	actually use, and the elements themselves remain small. New elements
+*	are initialized with the default value of the property.
+*
+*	Properties are created and owned by the mesh. References to them
+*	remain valid until the property is removed or the mesh is destroyed,
+*	but references to single values are invalidated when elements are
+*	added.
+*/
+
+template <class T> class property : public property_base
+{
+	public:
+		property(const std::string& name, const T& default_value, size_t n);
+
+		T& operator[](size_t i);
+		const T& operator[](size_t i) const;
+
+		size_t size() const;
+		const T& get_default_value() const;
+
+		void resize(size_t n);
+		void move(size_t from, size_t to);
+		void reserve(size_t n);
+		property_base* clone() const;
+
+	private:
+		std::vector<T> values;	///< One value for every element
+		T default_value;	///< Value for new elements
+};
+
+/*!
+*	Creates a new property.
+*
+*	@param name Name of the property
+*/
+
+inline property_base::property_base(const std::string& name)
+	: name(name)
+{
+}
+
+/*!
+*	Empty destructor; required for deleting properties via the base
+*	class.
+*/
+
+inline property_base::~property_base()
+{
+}
+
+/*!
+*	@return Name of the property
+*/
+
+inline const std::string& property_base::get_name() const
+{
+	return(name);
+}
+
+/*!
+*	Creates a new property with a value for every existing element.
+*
+*	@param name		Name of the property
+*	@param default_value	Value for new elements
+*	@param n		Current number of elements
+*/
+
+template <class T> property<T>::property(const std::string& name, const T& default_value, size_t n)
+	: property_base(name), values(n, default_value), default_value(default_value)
+{
+}
+
+/*!
+*	@param i Slot of element; not checked
+*	@return Value of the property for the given element
+*/
+
+template <class T> inline T& property<T>::operator[](size_t i)
+{
+	return(values[i]);
+}
+
+/*!
+*	@param i Slot of element; not checked
+*	@return Const reference to value of the property for the given element
+*/
+
+template <class T> inline const T& property<T>::operator[](size_t i) const
+{
+	return(values[i]);
+}
+
+/*!
+*	@return Number of values, i.e. the number of elements
+*/
+
+template <class T> inline size_t property<T>::size() const
+{
+	return(values.size());
+}
+
+/*!
+*	@return Value that is assigned to new elements
+*/
+
+template <class T> inline const T& property<T>::get_default_value() const
+{
+	return(default_value);
+}
+
+/*!
+*	Changes the number of values. New values are set to the default
+*	value.
+*
+*	@param n New number of values
+*/
+
+template <class T> void property<T>::resize(size_t n)
+{
+	values.resize(n, default_value);
+}
+
+/*!
+*	Assigns the value of one element to another one. This mirrors moving
+*	an element to another slot when the mesh removes empty slots.
+*
+*	@param from	Current slot of the element
+*	@param to	New slot of the element
+*/
+
+template <class T> void property<T>::move(size_t from, size_t to)
+{
+	values[to] = values[from];
+}
+
+/*!
+*	Reserves memory for the given number of values.
+*
+*	@param n Expected number of values
+*/
+
+template <class T> void property<T>::reserve(size_t n)
+{
+	values.reserve(n);
+}
+
+/*!
+*	@return Copy of the property; has to be deleted by the caller
+*/
+
+template <class T> property_base* property<T>::clone() const
+{
+	return(new property<T>(*this));
+}
+
+} // end of namespace "psalm"
+
+#endif
@@ -17,6 +17,11 @@
 #include <cerrno>
 #include <cstring>
 
+#if __cplusplus >= 201103L
+	#include <atomic>
+	#include <thread>
+#endif
+
 #include <unistd.h>
 #include <getopt.h>
 #include <libgen.h>
@@ -33,9 +38,10 @@
   #include "FairingAlgorithms/CurvatureFlow.h"
 #endif
 
+#include "bounded_queue.h"
 #include "mesh.h"
+#include "mesh_stream.h"
 
-psalm::mesh scene_mesh;
 std::string input;
 std::string output;
 
@@ -146,6 +152,322 @@ std::set<size_t> parse_value_string(std::string argument)
 	return(res);
 }
 
+/*!
+*	Creates the subdivision algorithm that has been selected on the
+*	command-line and sets all of its parameters. Every call creates a new
+*	instance, so several meshes may be subdivided concurrently.
+*
+*	@param vm			Parsed command-line options
+*	@param extra_weights		Custom weights for the Doo-Sabin scheme
+*					(ignored if empty)
+*	@param subdivision_algorithm	New algorithm; NULL if the user did not
+*					choose any algorithm
+*
+*	@return false if the options are invalid, else true
+*/
+
+bool create_subdivision_algorithm(	const po::variables_map& vm,
+					const psalm::weights_map& extra_weights,
+					psalm::SubdivisionAlgorithm*& subdivision_algorithm)
+{
+	subdivision_algorithm = NULL;
+
+	// We use this instance to create an instance of a subdivision
+	// algorithm class. Further class parameters are set _afterwards_,
+	// sometimes depending on the type of subdivision algorithm.
+	if(vm.count("algorithm"))
+	{
+		std::string algorithm_str = vm["algorithm"].as<std::string>();
+		std::transform(algorithm_str.begin(), algorithm_str.end(), algorithm_str.begin(), (int(*)(int)) tolower);
+
+		if(	algorithm_str == "catmull-clark"	||
+			algorithm_str == "catmull"		||
+			algorithm_str == "clark"		||
+			algorithm_str == "cc")
+		{
+			subdivision_algorithm = new psalm::CatmullClark();
+		}
+		else if(algorithm_str == "doo-sabin"		||
+			algorithm_str == "doo"			||
+			algorithm_str == "sabin"		||
+			algorithm_str == "ds")
+		{
+			subdivision_algorithm = new psalm::DooSabin();
+		}
+		else if(algorithm_str == "loop"	||
+			algorithm_str == "l")
+		{
+			subdivision_algorithm = new psalm::Loop();
+		}
+		else if(algorithm_str == "liepa")
+		{
+			subdivision_algorithm = new psalm::Liepa();
+		}
+		else
+		{
+			std::cerr << "psalm: \"" << algorithm_str << "\" is an unknown algorithm.\n";
+			return(false);
+		}
+	}
+
+	// The remaining options only configure the algorithm
+	if(!subdivision_algorithm)
+		return(true);
+
+	// Only applicable if the subdivision algorithm is the Doo-Sabin
+	// subdivision scheme
+	if(extra_weights.size() != 0)
+	{
+		psalm::DooSabin* ds_algorithm = dynamic_cast<psalm::DooSabin*>(subdivision_algorithm);
+		if(ds_algorithm)
+			ds_algorithm->set_custom_weights(extra_weights);
+	}
+
+	if(vm.count("weights"))
+	{
+		std::string weights_str = vm["weights"].as<std::string>();
+		std::transform(weights_str.begin(), weights_str.end(), weights_str.begin(), (int(*)(int)) tolower);
+
+		if(	weights_str == "catmull-clark"	||
+			weights_str == "catmull"	||
+			weights_str == "clark"		||
+			weights_str == "cc")
+		{
+			subdivision_algorithm->set_weights(psalm::SubdivisionAlgorithm::catmull_clark);
+		}
+		else if(weights_str == "doo-sabin"	||
+			weights_str == "doo"		||
+			weights_str == "sabin"		||
+			weights_str == "ds")
+		{
+			subdivision_algorithm->set_weights(psalm::SubdivisionAlgorithm::doo_sabin);
+		}
+		else if(weights_str == "degenerate")
+		{
+			subdivision_algorithm->set_weights(psalm::SubdivisionAlgorithm::degenerate);
+		}
+		else
+		{
+			std::cerr << "psalm: \"" << weights_str << "\" is an unknown weight scheme.\n";
+
+			delete(subdivision_algorithm);
+			subdivision_algorithm = NULL;
+
+			return(false);
+		}
+	}
+
+	// Various small flags
+
+	if(vm.count("handle-creases"))
+		subdivision_algorithm->set_crease_handling_flag();
+
+	if(vm.count("geometric"))
+		subdivision_algorithm->set_geometric_point_creation_flag();
+
+	if(vm.count("preserve-boundaries"))
+		subdivision_algorithm->set_boundary_preservation_flag();
+
+	if(vm.count("statistics"))
+		subdivision_algorithm->set_statistics_flag();
+
+	// This only works for B-spline-based subdivision algorithms, hence the
+	// dynamic_cast.
+	if(vm.count("b-spline-weights"))
+	{
+		psalm::BsplineSubdivisionAlgorithm* b_spline_algorithm = dynamic_cast<psalm::BsplineSubdivisionAlgorithm*>(subdivision_algorithm);
+		if(b_spline_algorithm)
+			b_spline_algorithm->set_bspline_weights_usage();
+	}
+
+	return(true);
+}
+
+/*!
+*	Creates the fairing algorithm that has been selected on the
+*	command-line.
+*
+*	@param vm Parsed command-line options
+*	@return New algorithm or NULL if no fairing has been requested
+*/
+
+psalm::FairingAlgorithm* create_fairing_algorithm(const po::variables_map& vm)
+{
+	psalm::FairingAlgorithm* fairing_algorithm = NULL;
+
+	// As there is currently only _one_ fairing algorithm, there is really
+	// not much choice here
+	if(vm.count("fair"))
+	{
+// FIXME: Should be conditionally disabled...
+#if 0
+		fairing_algorithm = new psalm::CurvatureFlow();
+#endif
+	}
+
+	return(fairing_algorithm);
+}
+
+/*!
+*	@struct job
+*	@brief Input file that is processed by psalm
+*
+*	Every input file is loaded into its own mesh, processed, and saved.
+*	If several files are specified, the jobs are passed through a pipeline
+*	(see main()).
+*/
+
+struct job
+{
+	std::string input_filename;
+	std::string output_filename;
+	psalm::mesh::file_type output_type;
+
+	bool stream_output;		///< Flag signalling that the last subdivision step is not stored in the mesh
+	bool success;			///< Flag signalling that the result has been saved
+
+	psalm::mesh scene_mesh;		///< Mesh of the input file
+	psalm::mesh_stream result;	///< Result of the last subdivision step if stream_output is set
+};
+
+/*!
+*	Applies the subdivision algorithm, the fairing algorithm, and the
+*	pruning operations to the mesh of a job.
+*
+*	@param j			Job whose mesh has been loaded
+*	@param subdivision_algorithm	Subdivision algorithm (may be NULL)
+*	@param fairing_algorithm	Fairing algorithm (may be NULL)
+*	@param steps			Number of subdivision steps
+*	@param remove_faces		Numbers of sides of faces to remove
+*	@param remove_vertices		Valencies of vertices to remove
+*/
+
+void process_job(	job& j,
+			psalm::SubdivisionAlgorithm* subdivision_algorithm,
+			psalm::FairingAlgorithm* fairing_algorithm,
+			size_t steps,
+			const std::set<size_t>& remove_faces,
+			const std::set<size_t>& remove_vertices)
+{
+	if(j.stream_output)
+	{
+		// The mesh of the last-but-one step is not needed anymore
+		if(subdivision_algorithm->apply_to(j.scene_mesh, steps, j.result))
+		{
+			j.scene_mesh.destroy();
+			return;
+		}
+
+		// If a step failed, the mesh contains the result of the last
+		// successful step, which is saved instead.
+		j.stream_output = false;
+		j.result.clear();
+	}
+
+	// It is possible that the user did not choose a subdivision
+	// algorithm. psalm tries to work as a mesh converter in this
+	// instance.
+	else if(subdivision_algorithm)
+		subdivision_algorithm->apply_to(j.scene_mesh, steps);
+
+	// Ditto for the fairing algorithm.
+	if(fairing_algorithm)
+		fairing_algorithm->apply_to(j.scene_mesh);
+
+	j.scene_mesh.prune(remove_faces, remove_vertices);
+}
+
+/*!
+*	Saves the result of a job.
+*
+*	@param j		Job that has been processed
+*	@param binary		Flag signalling binary PLY output
+*	@param compression	Compression format of the output
+*	@param precision	Precision of coordinates in ASCII files
+*
+*	@return true if the result could be saved, else false
+*/
+
+bool save_job(job& j, bool binary, psalm::mesh::compression_type compression, int precision)
+{
+	if(j.stream_output)
+		return(j.result.save(j.output_filename, j.output_type, binary, compression, precision));
+	else
+		return(j.scene_mesh.save(j.output_filename, j.output_type, binary, compression, precision));
+}
+
+/*!
+*	Frees the meshes of a job after its result has been saved or if the
+*	job failed.
+*
+*	@param j Job to release
+*/
+
+void release_job(job& j)
+{
+	j.scene_mesh.destroy();
+	j.result.clear();
+}
+
+/*!
+*	Reports an exception that occurred while running a job.
+*
+*	@param j Job that failed
+*	@param e Exception that has been caught
+*/
+
+void report_job_error(const job& j, const std::exception& e)
+{
+	std::cerr	<< "psalm: Error: Unable to process \""
+			<< (j.input_filename.empty() ? "-" : j.input_filename)
+			<< "\": " << e.what() << "\n";
+}
+
+/*!
+*	Loads, processes, and saves a job. Errors only affect the current job:
+*	If the input file cannot be loaded, no output file is written, and
+*	exceptions (e.g. if memory runs out) are reported instead of being
+*	passed on. The meshes of the job are released afterwards.
+*
+*	@param j			Job to run
+*	@param type			Type of the input and output data
+*	@param compression		Compression format of input and output data
+*	@param binary			Flag signalling binary PLY output
+*	@param precision		Precision of coordinates in ASCII files
+*	@param subdivision_algorithm	Subdivision algorithm (may be NULL)
+*	@param fairing_algorithm	Fairing algorithm (may be NULL)
+*	@param steps			Number of subdivision steps
+*	@param remove_faces		Numbers of sides of faces to remove
+*	@param remove_vertices		Valencies of vertices to remove
+*/
+
+void run_job(	job& j,
+		psalm::mesh::file_type type,
+		psalm::mesh::compression_type compression,
+		bool binary,
+		int precision,
+		psalm::SubdivisionAlgorithm* subdivision_algorithm,
+		psalm::FairingAlgorithm* fairing_algorithm,
+		size_t steps,
+		const std::set<size_t>& remove_faces,
+		const std::set<size_t>& remove_vertices)
+{
+	try
+	{
+		if(j.scene_mesh.load(j.input_filename, type, compression))
+		{
+			process_job(j, subdivision_algorithm, fairing_algorithm, steps, remove_faces, remove_vertices);
+			j.success = save_job(j, binary, compression, precision);
+		}
+	}
+	catch(const std::exception& e)
+	{
+		report_job_error(j, e);
+	}
+
+	release_job(j);
+}
+
 /*!
 *	Handles user interaction.
 *
@@ -155,13 +477,16 @@ std::set<size_t> parse_value_string(std::string argument)
 
 int main(int argc, char* argv[])
 {
-	psalm::mesh::file_type type = psalm::mesh::TYPE_EXT;
+	psalm::mesh::file_type type			= psalm::mesh::TYPE_EXT;
+	psalm::mesh::compression_type compression	= psalm::mesh::COMPRESSION_EXT;
 
 	std::set<size_t> remove_faces;
 	std::set<size_t> remove_vertices;
 	psalm::weights_map extra_weights;
 
 	size_t steps	= 0;
+	size_t num_jobs	= 1;
+	int precision	= psalm::mesh::PRECISION_DEFAULT;
 
 	psalm::SubdivisionAlgorithm* subdivision_algorithm	= NULL;
 	psalm::FairingAlgorithm* fairing_algorithm		= NULL;
@@ -182,12 +507,24 @@ int main(int argc, char* argv[])
 			"Selects type of input data. Valid values:\n"\
 			"* ply (Stanford PLY files)\n"\
 			"* obj (Wavefront OBJ files)\n"\
-			"* off (Geomview object files)")
+			"* off (Geomview object files)\n"\
+			"* psm (psalm binary snapshots)\n"\
+			"Append .gz or .zst (e.g. ply.gz) for compressed data.")
 
 		(	"output,o",
 			po::value<std::string>(&output)->default_value(""),
 			"Sets output file")
 
+		(	"binary,B",
+			"Writes PLY files in binary format (little endian)")
+
+		(	"precision",
+			po::value<int>(&precision),
+			"Writes coordinates in ASCII files with <arg> decimal places (at most 64). "\
+			"0 selects the shortest representation that is read back exactly. By "\
+			"default, PLY files use 8 decimal places and OBJ and OFF files use 6 "\
+			"significant digits.")
+
 		(	"steps,n",
 			po::value<size_t>(&steps),
 			"Sets number of subdivision steps to perform on the input mesh.")
@@ -195,6 +532,11 @@ int main(int argc, char* argv[])
 		(	"statistics,s",
 			"Prints statistics to STDERR")
 
+		(	"jobs,j",
+			po::value<size_t>(&num_jobs),
+			"Processes up to <arg> input files concurrently; 0 uses one job per "\
+			"processor. Every job keeps its mesh in memory until it has been saved.")
+
 		(	"help,h",
 			"Shows this screen");
 
@@ -300,12 +642,23 @@ int main(int argc, char* argv[])
 	{
 		std::string type_str = vm["type"].as<std::string>();
 		std::transform(type_str.begin(), type_str.end(), type_str.begin(), (int(*)(int)) tolower);
+
+		// A suffix selects the compression format of input and output
+		// data
+		if(psalm::mesh::get_compression(type_str) != psalm::mesh::COMPRESSION_NONE)
+		{
+			compression	= psalm::mesh::get_compression(type_str);
+			type_str	= type_str.substr(0, type_str.find_last_of('.'));
+		}
+
 		if(type_str == "ply")
 			type = psalm::mesh::TYPE_PLY;
 		else if(type_str == "obj")
 			type = psalm::mesh::TYPE_OBJ;
 		else if(type_str == "off")
 			type = psalm::mesh::TYPE_OFF;
+		else if(type_str == "psm")
+			type = psalm::mesh::TYPE_PSM;
 		else
 		{
 			std::cerr << "psalm: \"" << type_str << "\" is an unknown mesh data type.\n";
@@ -313,56 +666,13 @@ int main(int argc, char* argv[])
 		}
 	}
 
-	// As there is currently only _one_ fairing algorithm, there is really
-	// not much choice here
-	if(vm.count("fair"))
-        {
-// FIXME: Should be conditionally disabled...
-#if 0
-		fairing_algorithm = new psalm::CurvatureFlow();
-#endif
-        }
-
-	// We use this instance to create an instance of a subdivision
-	// algorithm class. Further class parameters are set _afterwards_,
-	// sometimes depending on the type of subdivision algorithm.
-	if(vm.count("algorithm"))
-	{
-		std::string algorithm_str = vm["algorithm"].as<std::string>();
-		std::transform(algorithm_str.begin(), algorithm_str.end(), algorithm_str.begin(), (int(*)(int)) tolower);
-
-		if(	algorithm_str == "catmull-clark"	||
-			algorithm_str == "catmull"		||
-			algorithm_str == "clark"		||
-			algorithm_str == "cc")
-		{
-			subdivision_algorithm = new psalm::CatmullClark();
-		}
-		else if(algorithm_str == "doo-sabin"		||
-			algorithm_str == "doo"			||
-			algorithm_str == "sabin"		||
-			algorithm_str == "ds")
-		{
-			subdivision_algorithm = new psalm::DooSabin();
-		}
-		else if(algorithm_str == "loop"	||
-			algorithm_str == "l")
-		{
-			subdivision_algorithm = new psalm::Loop();
-		}
-		else if(algorithm_str == "liepa")
-		{
-			subdivision_algorithm = new psalm::Liepa();
-		}
-		else
-		{
-			std::cerr << "psalm: \"" << algorithm_str << "\" is an unknown algorithm.\n";
-			return(-1);
-		}
-	}
+	fairing_algorithm = create_fairing_algorithm(vm);
+	if(!create_subdivision_algorithm(vm, extra_weights, subdivision_algorithm))
+		return(-1);
 
 	// Only applicable if the subdivision algorithm is the Doo-Sabin
-	// subdivision scheme
+	// subdivision scheme. The weights are loaded once and passed to
+	// every instance of the algorithm.
 	if(vm.count("extra-weights"))
 	{
 		psalm::DooSabin* ds_algorithm = dynamic_cast<psalm::DooSabin*>(subdivision_algorithm);
@@ -372,6 +682,10 @@ int main(int argc, char* argv[])
 			if(extra_weights.size() == 0)
 			{
 				std::cerr << "psalm: Unwilling to continue with empty weights file.\n";
+
+				delete(subdivision_algorithm);
+				delete(fairing_algorithm);
+
 				return(-1);
 			}
 
@@ -381,36 +695,6 @@ int main(int argc, char* argv[])
 			std::cerr << "psalm: Warning: Weights file specified, but no Doo-Sabin algorithm.\n";
 	}
 
-	if(vm.count("weights"))
-	{
-		std::string weights_str = vm["weights"].as<std::string>();
-		std::transform(weights_str.begin(), weights_str.end(), weights_str.begin(), (int(*)(int)) tolower);
-
-		if(	weights_str == "catmull-clark"	||
-			weights_str == "catmull"	||
-			weights_str == "clark"		||
-			weights_str == "cc")
-		{
-			subdivision_algorithm->set_weights(psalm::SubdivisionAlgorithm::catmull_clark);
-		}
-		else if(weights_str == "doo-sabin"	||
-			weights_str == "doo"		||
-			weights_str == "sabin"		||
-			weights_str == "ds")
-		{
-			subdivision_algorithm->set_weights(psalm::SubdivisionAlgorithm::doo_sabin);
-		}
-		else if(weights_str == "degenerate")
-		{
-			subdivision_algorithm->set_weights(psalm::SubdivisionAlgorithm::degenerate);
-		}
-		else
-		{
-			std::cerr << "psalm: \"" << weights_str << "\" is an unknown weight scheme.\n";
-			return(-1);
-		}
-	}
-
 	// This is parsed using an external function because the parameter
 	// string consists of comma-separated values
 
@@ -420,27 +704,16 @@ int main(int argc, char* argv[])
 	if(vm.count("remove-vertices"))
 		remove_vertices = parse_value_string(vm["remove-vertices"].as<std::string>());
 
-	// Various small flags
+	bool binary = (vm.count("binary") > 0);
 
-	if(vm.count("handle-creases"))
-		subdivision_algorithm->set_crease_handling_flag();
-
-	if(vm.count("geometric"))
-		subdivision_algorithm->set_geometric_point_creation_flag();
-
-	if(vm.count("preserve-boundaries"))
-		subdivision_algorithm->set_boundary_preservation_flag();
+	if(vm.count("precision") && (precision < 0 || precision > 64))
+	{
+		std::cerr << "psalm: Precision must be between 0 and 64 decimal places.\n";
 
-	if(vm.count("statistics"))
-		subdivision_algorithm->set_statistics_flag();
+		delete(subdivision_algorithm);
+		delete(fairing_algorithm);
 
-	// This only works for B-spline-based subdivision algorithms, hence the
-	// dynamic_cast.
-	if(vm.count("b-spline-weights"))
-	{
-		psalm::BsplineSubdivisionAlgorithm* b_spline_algorithm = dynamic_cast<psalm::BsplineSubdivisionAlgorithm*>(subdivision_algorithm);
-		if(b_spline_algorithm)
-			b_spline_algorithm->set_bspline_weights_usage();
+		return(-1);
 	}
 
 	// Read further command-line parameters; these are all supposed to be
@@ -477,49 +750,226 @@ int main(int argc, char* argv[])
 	if(files.size() == 0)
 		files.push_back("");
 
-	// Apply subdivision algorithm to all files
+	// Prepare a job for every file
 
+	std::vector<job*> jobs;
 	for(std::vector<std::string>::iterator it = files.begin(); it != files.end(); it++)
 	{
-		scene_mesh.load(*it, type);
-
-		// It is possible that the user did not choose a subdivision
-		// algorithm. psalm tries to work as a mesh converter in this
-		// instance.
-		if(subdivision_algorithm)
-			subdivision_algorithm->apply_to(scene_mesh, steps);
-
-		// Ditto for the fairing algorithm.
-		if(fairing_algorithm)
-			fairing_algorithm->apply_to(scene_mesh);
-
-		scene_mesh.prune(remove_faces, remove_vertices);
+		job* j			= new job;
+		j->input_filename	= *it;
+		j->success		= false;
 
 		// If an output file has been set (even if it is empty), it
-		// will be used.
-		if(output_set)
-			scene_mesh.save(output, type);
+		// will be used. If no output file has been set and the input
+		// file name is not empty, the output will be written to a
+		// file. Else, the output will be written to STDOUT.
+
+		j->output_filename	= output;
+		j->output_type		= type;
 
-		// If no output file has been set and the input file name is
-		// not empty, the output will be written to a file.
-		else if(it->length() > 0)
+		if(!output_set && it->length() > 0)
 		{
+			// The extension of a compression format is kept,
+			// i.e. the suffix is inserted before the extension of
+			// the mesh format.
 			size_t ext_pos = (*it).find_last_of(".");
+			if(ext_pos != std::string::npos && psalm::mesh::get_compression(*it) != psalm::mesh::COMPRESSION_NONE)
+				ext_pos = std::min(ext_pos, (*it).find_last_of(".", ext_pos-1));
+
 			if(ext_pos == std::string::npos)
-				scene_mesh.save(*it+".subdivided", type);
+				j->output_filename = *it+".subdivided";
 			else
-				scene_mesh.save( (*it).substr(0, ext_pos) + "_subdivided"
-						+(*it).substr(ext_pos));
+			{
+				j->output_filename	= (*it).substr(0, ext_pos) + "_subdivided" + (*it).substr(ext_pos);
+				j->output_type		= psalm::mesh::TYPE_EXT;
+			}
 		}
 
-		// If no output file has been set and the input file name is
-		// empty, the output will be written to STDOUT.
-		else
-			scene_mesh.save("", type);
+		// If the result of the subdivision algorithm is only written to
+		// a file, the mesh of the last step does not need to be built.
+		// Its vertices and faces are written directly instead. Holes
+		// and PSM files require the topology of the mesh, though.
+		std::string output_extension = psalm::mesh::get_extension(j->output_filename);
+		j->stream_output = (	subdivision_algorithm &&
+					steps > 0 &&
+					!fairing_algorithm &&
+					remove_faces.empty() &&
+					remove_vertices.empty() &&
+					j->output_type != psalm::mesh::TYPE_PSM &&
+					!(j->output_type == psalm::mesh::TYPE_EXT && (output_extension == ".hole" || output_extension == ".psm")));
+
+		jobs.push_back(j);
+	}
+
+	// Standard input and output may only be used by one job at a time, so
+	// these jobs are not run concurrently.
+	bool uses_standard_streams = false;
+	for(size_t i = 0; i < jobs.size(); i++)
+	{
+		if(jobs[i]->input_filename.empty() || jobs[i]->output_filename.empty())
+			uses_standard_streams = true;
+	}
+
+#if __cplusplus >= 201103L
+	if(num_jobs == 0)
+		num_jobs = std::max(std::thread::hardware_concurrency(), 1u);
+#else
+	num_jobs = 1;
+#endif
+
+	// Apply subdivision algorithm to all files. For several files, the
+	// next file is loaded and the previous result is saved by separate
+	// threads while the current mesh is processed. The queues between
+	// the threads hold a single job, so only a few meshes are kept in
+	// memory at the same time. The results are saved in the order of
+	// the input files.
+	//
+	// If the user requested several jobs, every worker thread takes the
+	// next file and processes it from start to end, using its own
+	// instances of the algorithms. Thus, at most one mesh per worker is
+	// kept in memory. The files are finished in arbitrary order, but the
+	// names of the output files do not depend on the order.
+
+#if __cplusplus >= 201103L
+	if(num_jobs > 1 && jobs.size() > 1 && !uses_standard_streams)
+	{
+		std::atomic<size_t> next_job(0);
+		std::vector<std::thread> workers;
+
+		for(size_t i = 0; i < std::min(num_jobs, jobs.size()); i++)
+		{
+			workers.push_back(std::thread([&]()
+			{
+				// The options have already been checked, so
+				// creating the algorithms cannot fail
+				psalm::SubdivisionAlgorithm* worker_subdivision_algorithm = NULL;
+				psalm::FairingAlgorithm* worker_fairing_algorithm = create_fairing_algorithm(vm);
+
+				create_subdivision_algorithm(vm, extra_weights, worker_subdivision_algorithm);
+
+				for(size_t k = next_job++; k < jobs.size(); k = next_job++)
+				{
+					run_job(	*jobs[k],
+							type,
+							compression,
+							binary,
+							precision,
+							worker_subdivision_algorithm,
+							worker_fairing_algorithm,
+							steps,
+							remove_faces,
+							remove_vertices);
+				}
+
+				delete(worker_subdivision_algorithm);
+				delete(worker_fairing_algorithm);
+			}));
+		}
+
+		for(size_t i = 0; i < workers.size(); i++)
+			workers[i].join();
+	}
+	else if(jobs.size() > 1)
+	{
+		psalm::bounded_queue<job*> loaded_jobs(1);
+		psalm::bounded_queue<job*> processed_jobs(1);
+
+		// As in run_job(), errors only affect the current job. A job
+		// that fails in one of the threads is released and not passed
+		// on, so the queues keep flowing and are always closed.
+
+		std::thread loader([&]()
+		{
+			for(size_t i = 0; i < jobs.size(); i++)
+			{
+				bool loaded = false;
+				try
+				{
+					loaded = jobs[i]->scene_mesh.load(jobs[i]->input_filename, type, compression);
+				}
+				catch(const std::exception& e)
+				{
+					report_job_error(*jobs[i], e);
+				}
+
+				if(!loaded || !loaded_jobs.push(jobs[i]))
+					release_job(*jobs[i]);
+			}
+
+			loaded_jobs.close();
+		});
+
+		std::thread saver([&]()
+		{
+			job* j;
+			while(processed_jobs.pop(j))
+			{
+				try
+				{
+					j->success = save_job(*j, binary, compression, precision);
+				}
+				catch(const std::exception& e)
+				{
+					report_job_error(*j, e);
+				}
+
+				release_job(*j);
+			}
+		});
+
+		job* j;
+		while(loaded_jobs.pop(j))
+		{
+			bool processed = false;
+			try
+			{
+				process_job(*j, subdivision_algorithm, fairing_algorithm, steps, remove_faces, remove_vertices);
+				processed = true;
+			}
+			catch(const std::exception& e)
+			{
+				report_job_error(*j, e);
+			}
+
+			if(!processed || !processed_jobs.push(j))
+				release_job(*j);
+		}
+
+		processed_jobs.close();
+
+		loader.join();
+		saver.join();
+	}
+	else
+#endif
+	{
+		for(size_t i = 0; i < jobs.size(); i++)
+		{
+			run_job(	*jobs[i],
+					type,
+					compression,
+					binary,
+					precision,
+					subdivision_algorithm,
+					fairing_algorithm,
+					steps,
+					remove_faces,
+					remove_vertices);
+		}
+	}
+
+	// Failed jobs have already been reported; they only affect the exit
+	// status.
+
+	bool success = true;
+	for(size_t i = 0; i < jobs.size(); i++)
+	{
+		success = (success && jobs[i]->success);
+		delete(jobs[i]);
 	}
 
 	delete(subdivision_algorithm);
 	delete(fairing_algorithm);
 
-	return(0);
+	return(success ? 0 : -1);
 }
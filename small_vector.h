@@ -0,0 +1,221 @@
+/*!
+*	@file	small_vector.h
+*	@brief	Vector with inline storage for a small number of elements
+*/
+
+#ifndef __SMALL_VECTOR_H__
+#define __SMALL_VECTOR_H__
+
+#include <cstddef>
+#include <algorithm>
+
+namespace psalm
+{
+
+/*!
+*	@class small_vector
+*	@brief Vector that stores up to N elements without allocating memory
+*
+*	The first N elements are stored inline, i.e. within the object itself.
+*	Only if more elements are added, the vector switches to a buffer on
+*	the heap. Faces use this class for their vertices and edges: Triangles
+*	and quadrangles, which make up the vast majority of all faces, thus
+*	require no additional allocations at all.
+*
+*	The element type needs to be default-constructible and assignable.
+*/
+
+template <class T, size_t N> class small_vector
+{
+	public:
+		small_vector();
+		small_vector(const small_vector<T, N>& other);
+		~small_vector();
+
+		small_vector<T, N>& operator=(const small_vector<T, N>& other);
+
+		void push_back(const T& value);
+		void reserve(size_t capacity);
+		void clear();
+
+		size_t size() const;
+		bool empty() const;
+
+		T& operator[](size_t i);
+		const T& operator[](size_t i) const;
+
+	private:
+		T storage[N];	///< Inline storage for the first N elements
+		T* heap;	///< Heap buffer; NULL as long as storage suffices
+
+		size_t n;	///< Number of elements
+		size_t capacity;///< Number of elements that fit into the buffer
+
+		T* data();
+		const T* data() const;
+};
+
+/*!
+*	Creates an empty vector.
+*/
+
+template <class T, size_t N> small_vector<T, N>::small_vector()
+{
+	heap		= NULL;
+	n		= 0;
+	capacity	= N;
+}
+
+/*!
+*	Copies another vector. The copy only uses the heap if the number of
+*	elements exceeds the inline storage.
+*
+*	@param other Vector to copy
+*/
+
+template <class T, size_t N> small_vector<T, N>::small_vector(const small_vector<T, N>& other)
+{
+	heap		= NULL;
+	n		= 0;
+	capacity	= N;
+
+	*this = other;
+}
+
+/*!
+*	Releases the heap buffer, if any.
+*/
+
+template <class T, size_t N> small_vector<T, N>::~small_vector()
+{
+	delete[] heap;
+}
+
+/*!
+*	Assigns the contents of another vector.
+*
+*	@param other Vector to copy
+*	@return Reference to the current vector
+*/
+
+template <class T, size_t N> small_vector<T, N>& small_vector<T, N>::operator=(const small_vector<T, N>& other)
+{
+	if(this == &other)
+		return(*this);
+
+	clear();
+	reserve(other.n);
+
+	std::copy(other.data(), other.data() + other.n, data());
+	n = other.n;
+
+	return(*this);
+}
+
+/*!
+*	Appends an element to the vector. The heap buffer grows geometrically.
+*
+*	@param value Element to append
+*/
+
+template <class T, size_t N> void small_vector<T, N>::push_back(const T& value)
+{
+	if(n == capacity)
+		reserve(2*capacity);
+
+	data()[n++] = value;
+}
+
+/*!
+*	Ensures that the vector is able to hold the given number of elements
+*	without further allocations.
+*
+*	@param capacity Requested capacity
+*/
+
+template <class T, size_t N> void small_vector<T, N>::reserve(size_t capacity)
+{
+	if(capacity <= this->capacity)
+		return;
+
+	T* buffer = new T[capacity];
+	std::copy(data(), data() + n, buffer);
+
+	delete[] heap;
+
+	heap		= buffer;
+	this->capacity	= capacity;
+}
+
+/*!
+*	Removes all elements and releases the heap buffer.
+*/
+
+template <class T, size_t N> void small_vector<T, N>::clear()
+{
+	delete[] heap;
+
+	heap		= NULL;
+	n		= 0;
+	capacity	= N;
+}
+
+/*!
+*	@return Number of elements
+*/
+
+template <class T, size_t N> inline size_t small_vector<T, N>::size() const
+{
+	return(n);
+}
+
+/*!
+*	@return true if the vector contains no elements
+*/
+
+template <class T, size_t N> inline bool small_vector<T, N>::empty() const
+{
+	return(n == 0);
+}
+
+/*!
+*	@param i Index of element; not checked
+*	@return Element at specified index
+*/
+
+template <class T, size_t N> inline T& small_vector<T, N>::operator[](size_t i)
+{
+	return(data()[i]);
+}
+
+/*!
+*	@param i Index of element; not checked
+*	@return Const reference to element at specified index
+*/
+
+template <class T, size_t N> inline const T& small_vector<T, N>::operator[](size_t i) const
+{
+	return(data()[i]);
+}
+
+/*!
+*	@return Pointer to the buffer that is currently in use
+*/
+
+template <class T, size_t N> inline T* small_vector<T, N>::data()
+{
+	return(heap ? heap : storage);
+}
+
+/*!
+*	@return Const pointer to the buffer that is currently in use
+*/
+
+template <class T, size_t N> inline const T* small_vector<T, N>::data() const
+{
+	return(heap ? heap : storage);
+}
+
+} // end of namespace "psalm"
+
+#endif
@@ -0,0 +1,172 @@
+/*!
+*	@file	stencil_table.cpp
+*	@brief	Functions for sparse weights that map control points to refined points
+*/
+
+#include <algorithm>
+#include <iostream>
+
+#include "stencil_table.h"
+#include "mesh.h"
+#include "v3ctor_kernels.h"
+
+namespace psalm
+{
+
+/*!
+*	Creates an empty table without any rows or columns.
+*/
+
+stencil_table::stencil_table()
+{
+	num_control_points = 0;
+	offsets.assign(1, 0);
+}
+
+/*!
+*	Replaces the table by the identity, i.e. every refined point is equal
+*	to the corresponding control point.
+*
+*	@param n Number of rows and columns
+*/
+
+void stencil_table::set_identity(size_t n)
+{
+	num_control_points = n;
+
+	offsets.resize(n+1);
+	columns.resize(n);
+	weights.assign(n, 1.0);
+
+	for(size_t i = 0; i < n; i++)
+	{
+		offsets[i]	= i;
+		columns[i]	= i;
+	}
+
+	offsets[n] = n;
+}
+
+/*!
+*	Replaces the contents of the table by rows in compressed form. The
+*	arrays are swapped into the table, i.e. they contain the previous
+*	contents of the table afterwards.
+*
+*	@param num_columns	Number of control points
+*	@param offsets		Start of every row; the last entry marks the end
+*				of the last row
+*	@param columns		Control points of all rows, sorted within every
+*				row
+*	@param weights		Weights of all rows
+*/
+
+void stencil_table::assign(	size_t num_columns,
+				std::vector<size_t>& offsets,
+				std::vector<size_t>& columns,
+				std::vector<double>& weights)
+{
+	num_control_points = num_columns;
+
+	this->offsets.swap(offsets);
+	this->columns.swap(columns);
+	this->weights.swap(weights);
+}
+
+/*!
+*	Exchanges the contents of two tables.
+*
+*	@param T Table to exchange contents with
+*/
+
+void stencil_table::swap(stencil_table& T)
+{
+	std::swap(num_control_points, T.num_control_points);
+
+	offsets.swap(T.offsets);
+	columns.swap(T.columns);
+	weights.swap(T.weights);
+}
+
+/*!
+*	Calculates the refined points for the given control points. The rows
+*	are evaluated in parallel.
+*
+*	@param control_points	Positions of the control points
+*	@param refined_points	Positions of the refined points; will be resized
+*				to the number of rows
+*
+*	@return false if the number of control points does not match the
+*	number of columns, else true
+*/
+
+bool stencil_table::apply(const std::vector<v3ctor>& control_points, std::vector<v3ctor>& refined_points) const
+{
+	if(control_points.size() != num_control_points)
+	{
+		std::cerr	<< "psalm: Stencil table requires " << num_control_points << " control points, "
+				<< "but " << control_points.size() << " have been specified\n";
+		return(false);
+	}
+
+	long n = static_cast<long>(num_rows());
+	refined_points.resize(n);
+
+	if(num_control_points == 0)
+		return(true);
+
+	const v3ctor* P		= &control_points[0];
+	const size_t* C		= columns.empty() ? NULL : &columns[0];
+	const double* W		= weights.empty() ? NULL : &weights[0];
+
+	#pragma omp parallel for schedule(static)
+	for(long i = 0; i < n; i++)
+	{
+		size_t begin		= offsets[i];
+		refined_points[i]	= calc_indexed_combination(P, C+begin, W+begin, offsets[i+1]-begin);
+	}
+
+	return(true);
+}
+
+/*!
+*	Calculates the refined points for the vertices of a control mesh and
+*	stores them as the vertex positions of a refined mesh. The vertices of
+*	both meshes are identified by their slots. Usually, the refined mesh
+*	is the one that has been created along with the table, so its topology
+*	may be reused for new positions of the control mesh.
+*
+*	@param control_mesh	Mesh whose vertices are the control points
+*	@param refined_mesh	Mesh whose vertices receive the refined points
+*
+*	@return false if the number of vertices of one of the meshes does not
+*	match the table, else true
+*/
+
+bool stencil_table::apply(const mesh& control_mesh, mesh& refined_mesh) const
+{
+	if(refined_mesh.num_vertices() != num_rows())
+	{
+		std::cerr	<< "psalm: Stencil table creates " << num_rows() << " refined points, "
+				<< "but the mesh contains " << refined_mesh.num_vertices() << " vertices\n";
+		return(false);
+	}
+
+	// Slots of removed vertices do not occur in any stencil
+	std::vector<v3ctor> control_points(control_mesh.num_vertices());
+	for(size_t i = 0; i < control_points.size(); i++)
+	{
+		if(control_mesh.get_vertex(i) != NULL)
+			control_points[i] = control_mesh.get_vertex(i)->get_position();
+	}
+
+	std::vector<v3ctor> refined_points;
+	if(!apply(control_points, refined_points))
+		return(false);
+
+	for(size_t i = 0; i < refined_points.size(); i++)
+		refined_mesh.get_vertex(i)->set_position(refined_points[i]);
+
+	return(true);
+}
+
+} // end of namespace "psalm"
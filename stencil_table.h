@@ -0,0 +1,123 @@
+/*!
+*	@file	stencil_table.h
+*	@brief	Sparse weights that map control points to refined points
+*/
+
+#ifndef __STENCIL_TABLE_H__
+#define __STENCIL_TABLE_H__
+
+#include <cstddef>
+#include <vector>
+
+#include "v3ctor.h"
+
+namespace psalm
+{
+
+class mesh;
+
+/*!
+*	@class stencil_table
+*	@brief Sparse matrix that maps control points to refined points
+*
+*	Every row of the table is the stencil of a refined point, i.e. a list
+*	of control points and their weights. The refined point is the weighted
+*	sum of these control points. Stencil tables are created by subdivision
+*	algorithms, which analyse the topology of the control mesh only once
+*	(see SubdivisionAlgorithm::create_stencil_table()). Afterwards, the
+*	refined points for new positions of the control points are calculated
+*	by apply().
+*
+*	The rows are stored in compressed form: The columns and weights of all
+*	rows are stored consecutively, sorted by column within every row.
+*/
+
+class stencil_table
+{
+	public:
+		stencil_table();
+
+		void set_identity(size_t n);
+		void assign(	size_t num_columns,
+				std::vector<size_t>& offsets,
+				std::vector<size_t>& columns,
+				std::vector<double>& weights);
+
+		void swap(stencil_table& T);
+
+		size_t num_rows() const;
+		size_t num_columns() const;
+		size_t num_entries() const;
+
+		size_t get_row(size_t i, const size_t*& columns, const double*& weights) const;
+
+		bool apply(const std::vector<v3ctor>& control_points, std::vector<v3ctor>& refined_points) const;
+		bool apply(const mesh& control_mesh, mesh& refined_mesh) const;
+
+	private:
+		size_t num_control_points;	///< Number of columns
+
+		std::vector<size_t> offsets;	///< Start of every row in the arrays of columns and
+						///< weights; contains one additional entry for the end
+						///< of the last row
+		std::vector<size_t> columns;	///< Control points of all rows
+		std::vector<double> weights;	///< Weights of all rows
+};
+
+/*!
+*	@return Number of rows, i.e. refined points
+*/
+
+inline size_t stencil_table::num_rows() const
+{
+	return(offsets.size()-1);
+}
+
+/*!
+*	@return Number of columns, i.e. control points
+*/
+
+inline size_t stencil_table::num_columns() const
+{
+	return(num_control_points);
+}
+
+/*!
+*	@return Number of weights in all rows
+*/
+
+inline size_t stencil_table::num_entries() const
+{
+	return(columns.size());
+}
+
+/*!
+*	Returns the stencil of a refined point.
+*
+*	@param i	Index of row
+*	@param columns	Pointer to the control points of the row
+*	@param weights	Pointer to the weights of the row
+*
+*	@return Number of weights in the row
+*/
+
+inline size_t stencil_table::get_row(size_t i, const size_t*& columns, const double*& weights) const
+{
+	size_t n = offsets[i+1] - offsets[i];
+	if(n != 0)
+	{
+		columns = &this->columns[offsets[i]];
+		weights = &this->weights[offsets[i]];
+	}
+	else
+	{
+		columns = NULL;
+		weights = NULL;
+	}
+
+	return(n);
+}
+
+} // end of namespace "psalm"
+
+#endif
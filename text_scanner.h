@@ -0,0 +1,332 @@
+/*!
+*	@file	text_scanner.h
+*	@brief	Tokenizer for ASCII mesh data stored in memory
+*/
+
+#ifndef __TEXT_SCANNER_H__
+#define __TEXT_SCANNER_H__
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#if __cplusplus >= 201703L
+	#include <charconv>
+#endif
+
+namespace psalm
+{
+
+/*!
+*	@class text_scanner
+*	@brief Splits a range of characters into lines and tokens
+*
+*	The scanner operates directly on the data, e.g. on a memory-mapped
+*	file, without copying it. Numbers are parsed by hand (integers) or via
+*	std::from_chars (floating point values) if the standard library
+*	provides it. Both are independent of the current locale, in contrast
+*	to the stream operators.
+*
+*	Tokens never extend beyond the end of a line: All read functions skip
+*	blanks, but stop at line breaks. Use skip_line() to advance to the
+*	next line or skip_whitespace() to ignore line breaks altogether.
+*/
+
+class text_scanner
+{
+	public:
+		text_scanner(const char* begin, const char* end);
+
+		bool eof() const;
+		bool eol();
+
+		void skip_line();
+		void skip_whitespace();
+		void skip_token();
+
+		bool read_long(long& value);
+		bool read_size(size_t& value);
+		bool read_double(double& value);
+
+		bool match(const char* token);
+		bool peek(char c);
+
+		const char* get_position() const;
+		std::string get_line() const;
+
+	private:
+		const char* pos;	///< Next unread character
+		const char* end;	///< End of the data
+		const char* line;	///< First character of the current line
+
+		void skip_blanks();
+		bool is_delimiter() const;
+};
+
+/*!
+*	Creates a new scanner.
+*
+*	@param begin	First character of the data
+*	@param end	End of the data
+*/
+
+inline text_scanner::text_scanner(const char* begin, const char* end)
+	: pos(begin), end(end), line(begin)
+{
+}
+
+/*!
+*	@return true if all data has been read
+*/
+
+inline bool text_scanner::eof() const
+{
+	return(pos >= end);
+}
+
+/*!
+*	Skips blanks and checks whether the end of the current line has been
+*	reached.
+*
+*	@return true if the current line contains no further tokens
+*/
+
+inline bool text_scanner::eol()
+{
+	skip_blanks();
+	return(pos >= end || *pos == '\n');
+}
+
+/*!
+*	Advances to the first character of the next line, ignoring the rest of
+*	the current line.
+*/
+
+inline void text_scanner::skip_line()
+{
+	if(pos >= end)
+		return;
+
+	const char* next = static_cast<const char*>(std::memchr(pos, '\n', end-pos));
+
+	pos	= (next ? next+1 : end);
+	line	= pos;
+}
+
+/*!
+*	Skips all whitespace characters, including line breaks.
+*/
+
+inline void text_scanner::skip_whitespace()
+{
+	for(;;)
+	{
+		skip_blanks();
+		if(pos < end && *pos == '\n')
+		{
+			pos++;
+			line = pos;
+		}
+		else
+			break;
+	}
+}
+
+/*!
+*	Skips the remaining characters of the current token.
+*/
+
+inline void text_scanner::skip_token()
+{
+	while(!is_delimiter())
+		pos++;
+}
+
+/*!
+*	Reads a signed integer. The integer may be followed by other
+*	characters of the same token, which are not consumed.
+*
+*	@param value Parsed value
+*	@return true if an integer could be read, else false
+*/
+
+inline bool text_scanner::read_long(long& value)
+{
+	skip_blanks();
+
+	bool negative = false;
+	if(pos < end && (*pos == '-' || *pos == '+'))
+		negative = (*pos++ == '-');
+
+	if(pos >= end || *pos < '0' || *pos > '9')
+		return(false);
+
+	long res = 0;
+	while(pos < end && *pos >= '0' && *pos <= '9')
+		res = 10*res + (*pos++ - '0');
+
+	value = (negative ? -res : res);
+	return(true);
+}
+
+/*!
+*	Reads an unsigned integer. In contrast to read_long(), the integer has
+*	to form a complete token.
+*
+*	@param value Parsed value
+*	@return true if an integer could be read, else false
+*/
+
+inline bool text_scanner::read_size(size_t& value)
+{
+	skip_blanks();
+
+	if(pos >= end || *pos < '0' || *pos > '9')
+		return(false);
+
+	size_t res = 0;
+	while(pos < end && *pos >= '0' && *pos <= '9')
+		res = 10*res + (*pos++ - '0');
+
+	value = res;
+	return(is_delimiter());
+}
+
+/*!
+*	Reads a floating point value, which has to form a complete token.
+*
+*	@param value Parsed value
+*	@return true if a value could be read, else false
+*/
+
+inline bool text_scanner::read_double(double& value)
+{
+	skip_blanks();
+
+	// Neither std::from_chars() nor the stream operators require a plus
+	// sign, but some exporters write one
+	if(pos < end && *pos == '+')
+		pos++;
+
+	if(pos >= end)
+		return(false);
+
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+	std::from_chars_result res = std::from_chars(pos, end, value);
+	if(res.ec != std::errc())
+		return(false);
+
+	pos = res.ptr;
+#else
+	// std::strtod() requires a terminated string, which the data is not
+	// guaranteed to contain
+	char buffer[64];
+	size_t n = 0;
+
+	while(n < sizeof(buffer)-1 && !is_delimiter())
+		buffer[n++] = *pos++;
+
+	buffer[n] = '\0';
+
+	char* parsed_end = NULL;
+	value = std::strtod(buffer, &parsed_end);
+	if(n == 0 || parsed_end != buffer+n)
+		return(false);
+#endif
+
+	return(is_delimiter());
+}
+
+/*!
+*	Checks whether the next token of the current line equals the given
+*	string. If so, the token is consumed.
+*
+*	@param token Expected token
+*	@return true if the token matches, else false
+*/
+
+inline bool text_scanner::match(const char* token)
+{
+	skip_blanks();
+
+	const char* saved = pos;
+	while(*token != '\0' && pos < end && *pos == *token)
+	{
+		pos++;
+		token++;
+	}
+
+	if(*token == '\0' && is_delimiter())
+		return(true);
+
+	pos = saved;
+	return(false);
+}
+
+/*!
+*	Checks whether the next token of the current line starts with the
+*	given character. No characters are consumed except for blanks.
+*
+*	@param c Expected character
+*	@return true if the next token starts with the character, else false
+*/
+
+inline bool text_scanner::peek(char c)
+{
+	skip_blanks();
+	return(pos < end && *pos == c);
+}
+
+/*!
+*	@return Pointer to the next unread character
+*/
+
+inline const char* text_scanner::get_position() const
+{
+	return(pos);
+}
+
+/*!
+*	@return Contents of the current line; used for error messages
+*/
+
+inline std::string text_scanner::get_line() const
+{
+	if(line >= end)
+		return(std::string());
+
+	const char* line_end = static_cast<const char*>(std::memchr(line, '\n', end-line));
+	if(line_end == NULL)
+		line_end = end;
+
+	if(line_end > line && *(line_end-1) == '\r')
+		line_end--;
+
+	return(std::string(line, line_end));
+}
+
+/*!
+*	Skips blanks, i.e. whitespace characters except for line breaks.
+*	Carriage returns are treated as blanks, so files with CRLF line
+*	endings are parsed correctly.
+*/
+
+inline void text_scanner::skip_blanks()
+{
+	while(pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r' || *pos == '\v' || *pos == '\f'))
+		pos++;
+}
+
+/*!
+*	@return true if the current character ends a token
+*/
+
+inline bool text_scanner::is_delimiter() const
+{
+	return(pos >= end || *pos == ' ' || *pos == '\t' || *pos == '\n' || *pos == '\r' || *pos == '\v' || *pos == '\f');
+}
+
+} // end of namespace "psalm"
+
+#endif
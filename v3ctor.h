@@ -32,12 +32,19 @@
 #ifndef __V3CTOR_H__
 #define __V3CTOR_H__
 
+#include <cmath>
 #include <ostream>
+#include <iomanip>
 
 /*!
 *	@class v3ctor
 *	@brief Simple 3-dimensional vector class implementation. Allows some
 *	common manipulations such as the scalar product or the cross product.
+*
+*	All functions are defined inline so that the compiler is able to
+*	optimize vector arithmetic within loops. The components are stored
+*	contiguously; batch operations on several vectors are provided by
+*	v3ctor_kernels.h.
 */
 
 class v3ctor
@@ -54,28 +61,299 @@ class v3ctor
 		v3ctor& operator*=(const double& a);
 		v3ctor  operator/ (const double& a) const;
 		v3ctor& operator/=(const double& a);
-		v3ctor& operator= (const v3ctor& b);
 		v3ctor  operator| (const v3ctor& b) const;
 
 		double		operator*(const v3ctor& a) const;
 		double&		operator[](short i);
 		const double&	operator[](short i) const;
 
+		const double* data() const;
+
 		v3ctor normalize() const;
 		double length() const;
 
 		friend std::ostream& operator<<(std::ostream& o, const v3ctor& v);
 
 	private:
-		double x;
-		double y;
-		double z;
+		double c[3];	///< Components of the vector, i.e. x, y, and z
 };
 
-double distance_to_plane(const v3ctor& a, const v3ctor& b, const v3ctor& c, const v3ctor & x);
-v3ctor perpendicular_foot(const v3ctor& a, const v3ctor& b, const v3ctor& c, const v3ctor& x);
+/*!
+*	Constructor; sets components to zero.
+*/
+
+inline v3ctor::v3ctor()
+{
+	c[0] = c[1] = c[2] = 0.0;
+}
+
+/*!
+*	Initializes components with user-defined values.
+*/
+
+inline v3ctor::v3ctor(double x, double y, double z)
+{
+	c[0] = x;
+	c[1] = y;
+	c[2] = z;
+}
+
+/*!
+*	Adds two vectors.
+*/
+
+inline v3ctor v3ctor::operator+(const v3ctor& b) const
+{
+	return(v3ctor(c[0] + b.c[0], c[1] + b.c[1], c[2] + b.c[2]));
+}
+
+/*!
+*	Adds vector to the current vector.
+*/
+
+inline v3ctor& v3ctor::operator+=(const v3ctor& b)
+{
+	c[0] += b.c[0];
+	c[1] += b.c[1];
+	c[2] += b.c[2];
+
+	return(*this);
+}
+
+/*!
+*	Subtracts two vectors from one another.
+*/
+
+inline v3ctor v3ctor::operator-(const v3ctor& b) const
+{
+	return(v3ctor(c[0] - b.c[0], c[1] - b.c[1], c[2] - b.c[2]));
+}
+
+/*!
+*	Subtracts vector from current vector.
+*/
+
+inline v3ctor& v3ctor::operator-=(const v3ctor& b)
+{
+	c[0] -= b.c[0];
+	c[1] -= b.c[1];
+	c[2] -= b.c[2];
+
+	return(*this);
+}
+
+/*!
+*	Multiplies vector by scalar.
+*/
+
+inline v3ctor v3ctor::operator*(const double& a) const
+{
+	return(v3ctor(c[0]*a, c[1]*a, c[2]*a));
+}
+
+/*!
+*	Multiplies current vector by scalar value.
+*/
+
+inline v3ctor& v3ctor::operator*=(const double& a)
+{
+	c[0] *= a;
+	c[1] *= a;
+	c[2] *= a;
+
+	return(*this);
+}
+
+/*!
+*	Divides vector by scalar value.
+*/
+
+inline v3ctor v3ctor::operator/(const double& a) const
+{
+	if(a == 0.0)
+		throw "Attempted division by zero.\n";
+	else
+		return(operator*(1/a));
+}
+
+/*!
+*	Divides current vector by scalar.
+*/
+
+inline v3ctor& v3ctor::operator/=(const double& a)
+{
+	if(a == 0.0)
+		throw "Attempted division by zero.\n";
+	else
+		return(operator*=(1/a));
+}
+
+/*!
+*	Computes standard euclidean scalar product of two vectors.
+*/
+
+inline double v3ctor::operator*(const v3ctor& b) const
+{
+	return(c[0]*b.c[0] + c[1]*b.c[1] + c[2]*b.c[2]);
+}
+
+/*!
+*	Computes cross product of two vectors.
+*/
+
+inline v3ctor v3ctor::operator|(const v3ctor& b) const
+{
+	return(v3ctor(	c[1]*b.c[2]-c[2]*b.c[1],
+			c[2]*b.c[0]-c[0]*b.c[2],
+			c[0]*b.c[1]-c[1]*b.c[0]));
+}
+
+/*!
+*	@param i Index of element to access; not checked
+*	@return Reference to element i of the vector
+*/
+
+inline double& v3ctor::operator[](short i)
+{
+	return(c[i]);
+}
+
+/*!
+*	@param i Index of element to access; not checked
+*	@return Const reference to element i of the vector
+*/
+
+inline const double& v3ctor::operator[](short i) const
+{
+	return(c[i]);
+}
+
+/*!
+*	@return Pointer to the three contiguous components of the vector
+*/
+
+inline const double* v3ctor::data() const
+{
+	return(c);
+}
+
+/*!
+*	Normalizes a vector.
+*/
+
+inline v3ctor v3ctor::normalize() const
+{
+	double len = length();
+	if(len == 0)
+		return(*this);
+	else
+		return(operator/(len));
+}
+
+/*!
+*	Computes standard Euclidean length, i.e., the norm, of a vector.
+*/
+
+inline double v3ctor::length() const
+{
+	return(sqrt(c[0]*c[0]+c[1]*c[1]+c[2]*c[2]));
+}
+
+/*!
+*	Provides a simple output capability for v3ctor objects: All
+*	components of the vector are separated by spaces. Afterwards,
+*	an std::endl will be added.
+*
+*	@warning	This function uses std::fixed and std::setprecision(8)
+*			for the output stream.
+*
+*	@param	o	Stream for output
+*	@param	v	V3ctor object for output
+*
+*	@return	Stream containing data of v3ctor v.
+*/
+
+inline std::ostream& operator<<(std::ostream& o, const v3ctor& v)
+{
+	return(o	<< std::fixed << std::setprecision(8)
+			<< v.c[0] << " "
+			<< v.c[1] << " "
+			<< v.c[2] << std::endl);
+}
+
+/*!
+*	Calculates the distance between a plane given by three points and
+*	another point.
+*
+*	@param a First point in plane
+*	@param b Second point in plane
+*	@param c Third point in plane
+*	@param x Point for which the distance is to be determined
+*
+*	@return Absolute distance value
+*/
+
+inline double distance_to_plane(const v3ctor& a, const v3ctor& b, const v3ctor& c, const v3ctor & x)
+{
+	v3ctor normal = ((b-a)|(c-a)).normalize();
+	return(fabs(normal*(x-a)));
+}
+
+/*!
+*	Calculates the perpendicular foot of a point with respect to a plane
+*	given by three points.
+*
+*	@param a First point in plane
+*	@param b Second point in plane
+*	@param c Third point in plane
+*	@param x Point for which the perpendicular foot is to be determined
+*
+*	@return Position of perpendicular foot
+*/
+
+inline v3ctor perpendicular_foot(const v3ctor& a, const v3ctor& b, const v3ctor& c, const v3ctor& x)
+{
+	v3ctor normal = ((b-a)|(c-a)).normalize();
+	double d = -(normal*a);
+
+	return(normal*(-d)-normal*(x*normal)+x);
+}
+
+/*!
+*	Calculates distance from a point to a line specified by two points.
+*
+*	@param a First point on line
+*	@param b Second point on line
+*	@param x Point for which the distance is to be determined
+*
+*	@return Absolute distance from point x to line given by a and b
+*/
+
+inline double distance_to_line(const v3ctor& a, const v3ctor& b, const v3ctor& x)
+{
+	double double_area = ((a-x)|(b-x)).length();
+	double side_length = (a-b).length();
+
+	return(double_area/side_length);
+}
+
+/*!
+*	Calculates the perpendicular foot of a point with respect to a line
+*	given by two points.
+*
+*	@param a First point on line
+*	@param b Second point on line
+*	@param x Point for which the perpendicular foot is to be determined
+*
+*	@return Position of perpendicular foot
+*/
+
+inline v3ctor perpendicular_foot(const v3ctor& a, const v3ctor& b, const v3ctor& x)
+{
+	double length = (b-a).length();
+	double t = (a-x)*(b-a)/(length*length)*(-1.0);
 
-double distance_to_line(const v3ctor& a, const v3ctor& b, const v3ctor& x);
-v3ctor perpendicular_foot(const v3ctor& a, const v3ctor& b, const v3ctor& x);
+	return(a+(b-a)*t);
+}
 
 #endif
@@ -0,0 +1,299 @@
+/*!
+*	@file	v3ctor_kernels.h
+*	@brief	Batch operations on several vectors
+*
+*	The functions in this file operate on arrays of pointers to vectors,
+*	as vertex positions are usually scattered throughout memory. If the
+*	compiler targets SSE2 or AVX, the components are gathered into SIMD
+*	registers; otherwise, plain loops are used. For every vector, the
+*	operations are carried out in the same order as in a loop over the
+*	v3ctor operators.
+*/
+
+#ifndef __V3CTOR_KERNELS_H__
+#define __V3CTOR_KERNELS_H__
+
+#include <cstddef>
+#include <cmath>
+
+#if defined(__AVX__)
+	#include <immintrin.h>
+#elif defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
+
+#include "v3ctor.h"
+
+/*!
+*	Calculates an affine combination of several points, i.e. the sum of
+*	the points multiplied by their weights. The weights are not required
+*	to sum to one.
+*
+*	@param P Pointers to points
+*	@param w Weights of the points
+*	@param n Number of points
+*
+*	@return Weighted sum of the points
+*/
+
+inline v3ctor calc_affine_combination(const v3ctor* const* P, const double* w, size_t n)
+{
+#if defined(__AVX__)
+	const __m256i mask = _mm256_set_epi64x(0, -1, -1, -1);
+
+	__m256d acc = _mm256_setzero_pd();
+	for(size_t i = 0; i < n; i++)
+	{
+		__m256d p = _mm256_maskload_pd(P[i]->data(), mask);
+		acc = _mm256_add_pd(acc, _mm256_mul_pd(p, _mm256_set1_pd(w[i])));
+	}
+
+	double res[4];
+	_mm256_storeu_pd(res, acc);
+
+	return(v3ctor(res[0], res[1], res[2]));
+#elif defined(__SSE2__)
+	__m128d xy	= _mm_setzero_pd();
+	double z	= 0.0;
+
+	for(size_t i = 0; i < n; i++)
+	{
+		const double* p = P[i]->data();
+
+		xy = _mm_add_pd(xy, _mm_mul_pd(_mm_loadu_pd(p), _mm_set1_pd(w[i])));
+		z += p[2]*w[i];
+	}
+
+	double res[2];
+	_mm_storeu_pd(res, xy);
+
+	return(v3ctor(res[0], res[1], z));
+#else
+	v3ctor res;
+	for(size_t i = 0; i < n; i++)
+		res += (*P[i])*w[i];
+
+	return(res);
+#endif
+}
+
+/*!
+*	Calculates an affine combination of points that are selected from an
+*	array by their indices. Stencil tables use this for evaluating their
+*	rows.
+*
+*	@param P	Array of points
+*	@param indices	Indices of the points in the array
+*	@param w	Weights of the points
+*	@param n	Number of points
+*
+*	@return Weighted sum of the points
+*/
+
+inline v3ctor calc_indexed_combination(const v3ctor* P, const size_t* indices, const double* w, size_t n)
+{
+#if defined(__AVX__)
+	const __m256i mask = _mm256_set_epi64x(0, -1, -1, -1);
+
+	__m256d acc = _mm256_setzero_pd();
+	for(size_t i = 0; i < n; i++)
+	{
+		__m256d p = _mm256_maskload_pd(P[indices[i]].data(), mask);
+		acc = _mm256_add_pd(acc, _mm256_mul_pd(p, _mm256_set1_pd(w[i])));
+	}
+
+	double res[4];
+	_mm256_storeu_pd(res, acc);
+
+	return(v3ctor(res[0], res[1], res[2]));
+#elif defined(__SSE2__)
+	__m128d xy	= _mm_setzero_pd();
+	double z	= 0.0;
+
+	for(size_t i = 0; i < n; i++)
+	{
+		const double* p = P[indices[i]].data();
+
+		xy = _mm_add_pd(xy, _mm_mul_pd(_mm_loadu_pd(p), _mm_set1_pd(w[i])));
+		z += p[2]*w[i];
+	}
+
+	double res[2];
+	_mm_storeu_pd(res, xy);
+
+	return(v3ctor(res[0], res[1], z));
+#else
+	v3ctor res;
+	for(size_t i = 0; i < n; i++)
+		res += P[indices[i]]*w[i];
+
+	return(res);
+#endif
+}
+
+/*!
+*	Calculates the sum of several points.
+*
+*	@param P Pointers to points
+*	@param n Number of points
+*
+*	@return Sum of the points
+*/
+
+inline v3ctor calc_sum(const v3ctor* const* P, size_t n)
+{
+#if defined(__AVX__)
+	const __m256i mask = _mm256_set_epi64x(0, -1, -1, -1);
+
+	__m256d acc = _mm256_setzero_pd();
+	for(size_t i = 0; i < n; i++)
+		acc = _mm256_add_pd(acc, _mm256_maskload_pd(P[i]->data(), mask));
+
+	double res[4];
+	_mm256_storeu_pd(res, acc);
+
+	return(v3ctor(res[0], res[1], res[2]));
+#elif defined(__SSE2__)
+	__m128d xy	= _mm_setzero_pd();
+	double z	= 0.0;
+
+	for(size_t i = 0; i < n; i++)
+	{
+		const double* p = P[i]->data();
+
+		xy = _mm_add_pd(xy, _mm_loadu_pd(p));
+		z += p[2];
+	}
+
+	double res[2];
+	_mm_storeu_pd(res, xy);
+
+	return(v3ctor(res[0], res[1], z));
+#else
+	v3ctor res;
+	for(size_t i = 0; i < n; i++)
+		res += *P[i];
+
+	return(res);
+#endif
+}
+
+/*!
+*	Calculates the centroid of several points.
+*
+*	@param P Pointers to points
+*	@param n Number of points; must not be zero
+*
+*	@return Centroid of the points
+*/
+
+inline v3ctor calc_centroid(const v3ctor* const* P, size_t n)
+{
+	return(calc_sum(P, n)/static_cast<double>(n));
+}
+
+/*!
+*	Calculates the area of a single triangle.
+*
+*	@param a First vertex of the triangle
+*	@param b Second vertex of the triangle
+*	@param c Third vertex of the triangle
+*
+*	@return Unsigned area of the triangle
+*/
+
+inline double calc_triangle_area(const v3ctor& a, const v3ctor& b, const v3ctor& c)
+{
+	return(0.5*((b-a)|(c-a)).length());
+}
+
+/*!
+*	Calculates the total area of several triangles. The SIMD versions
+*	process two (SSE2) or four (AVX) triangles at once.
+*
+*	@param T Pointers to the vertices of the triangles; the array contains
+*	three consecutive entries for every triangle
+*
+*	@param n Number of triangles
+*
+*	@return Sum of the unsigned areas of all triangles
+*/
+
+inline double calc_total_area(const v3ctor* const* T, size_t n)
+{
+	double area	= 0.0;
+	size_t i	= 0;
+
+#if defined(__AVX__)
+	__m256d lanes = _mm256_setzero_pd();
+	for(; i+4 <= n; i += 4)
+	{
+		const v3ctor* const* t = T+3*i;
+		__m256d e[2][3];
+
+		// Edge vectors b-a and c-a for the four triangles
+		for(short j = 0; j < 2; j++)
+		{
+			for(short k = 0; k < 3; k++)
+			{
+				e[j][k] = _mm256_sub_pd(_mm256_set_pd(	(*t[10+j])[k],
+									(*t[7+j])[k],
+									(*t[4+j])[k],
+									(*t[1+j])[k]),
+							_mm256_set_pd(	(*t[9])[k],
+									(*t[6])[k],
+									(*t[3])[k],
+									(*t[0])[k]));
+			}
+		}
+
+		__m256d x = _mm256_sub_pd(_mm256_mul_pd(e[0][1], e[1][2]), _mm256_mul_pd(e[0][2], e[1][1]));
+		__m256d y = _mm256_sub_pd(_mm256_mul_pd(e[0][2], e[1][0]), _mm256_mul_pd(e[0][0], e[1][2]));
+		__m256d z = _mm256_sub_pd(_mm256_mul_pd(e[0][0], e[1][1]), _mm256_mul_pd(e[0][1], e[1][0]));
+
+		__m256d length = _mm256_sqrt_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(x, x), _mm256_mul_pd(y, y)), _mm256_mul_pd(z, z)));
+		lanes = _mm256_add_pd(lanes, length);
+	}
+
+	double res[4];
+	_mm256_storeu_pd(res, lanes);
+	area = 0.5*((res[0]+res[1])+(res[2]+res[3]));
+#elif defined(__SSE2__)
+	__m128d lanes = _mm_setzero_pd();
+	for(; i+2 <= n; i += 2)
+	{
+		const v3ctor* const* t = T+3*i;
+		__m128d e[2][3];
+
+		// Edge vectors b-a and c-a for both triangles
+		for(short j = 0; j < 2; j++)
+		{
+			for(short k = 0; k < 3; k++)
+			{
+				e[j][k] = _mm_sub_pd(	_mm_set_pd((*t[4+j])[k], (*t[1+j])[k]),
+							_mm_set_pd((*t[3])[k], (*t[0])[k]));
+			}
+		}
+
+		__m128d x = _mm_sub_pd(_mm_mul_pd(e[0][1], e[1][2]), _mm_mul_pd(e[0][2], e[1][1]));
+		__m128d y = _mm_sub_pd(_mm_mul_pd(e[0][2], e[1][0]), _mm_mul_pd(e[0][0], e[1][2]));
+		__m128d z = _mm_sub_pd(_mm_mul_pd(e[0][0], e[1][1]), _mm_mul_pd(e[0][1], e[1][0]));
+
+		__m128d length = _mm_sqrt_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(x, x), _mm_mul_pd(y, y)), _mm_mul_pd(z, z)));
+		lanes = _mm_add_pd(lanes, length);
+	}
+
+	double res[2];
+	_mm_storeu_pd(res, lanes);
+	area = 0.5*(res[0]+res[1]);
+#endif
+
+	// Remaining triangles (or all of them if no SIMD instructions are
+	// available)
+	for(; i < n; i++)
+		area += calc_triangle_area(*T[3*i], *T[3*i+1], *T[3*i+2]);
+
+	return(area);
+}
+
+#endif
@@ -9,6 +9,7 @@
 
 #include "vertex.h"
 #include "edge.h"
+#include "circulator.h"
 
 namespace psalm
 {
@@ -20,10 +21,8 @@ namespace psalm
 vertex::vertex()
 {
 	boundary	= false;
-	vertex_point	= NULL;
 	id		= std::numeric_limits<size_t>::max();
-	region		= std::numeric_limits<size_t>::max();
-	scale_attribute	= 0.0;
+	slot		= std::numeric_limits<size_t>::max();
 
 	// FIXME: this->set(...) should be called here in order to avoid code
 	// duplication
@@ -40,12 +39,8 @@ vertex::vertex()
 
 vertex::vertex(double x, double y, double z, size_t id)
 {
-	set(x, y, z, 0.0, 0.0, 0.0, id);
-}
-
-vertex::vertex(double x, double y, double z, double nx, double ny, double nz, size_t id)
-{
-	set(x, y, z, nx, ny, nz, id);
+	set(x, y, z, id);
+	slot = std::numeric_limits<size_t>::max();
 }
 
 /*!
@@ -58,44 +53,19 @@ vertex::vertex(double x, double y, double z, double nx, double ny, double nz, si
 */
 
 void vertex::set(double x, double y, double z, size_t id)
-{
-	set(	x,
-		y,
-		z,
-		0.0, // default normal vector
-		0.0,
-		0.0,
-		id);
-}
-
-void vertex::set(double x, double y, double z, double nx, double ny, double nz, size_t id)
 {
 	this->p[0]	= x;
 	this->p[1]	= y;
 	this->p[2]	= z;
-	this->n[0]	= nx;
-	this->n[1]	= ny;
-	this->n[2]	= nz;
 	this->id	= id;
 
-	// Needs to be initialized, otherwise it cannot be determined whether a
-	// vertex already has a vertex point
-	vertex_point = NULL;
-
 	// By default, no vertex is a boundary vertex. This attribute only
 	// becomes relevant if boundary vertices are to be preserved.
 	boundary = false;
-
-	// Sensible default for any vertex. Negative values make no sense, as
-	// the scale attribute is composed of edge lengths.
-	scale_attribute = 0.0;
-
-	// By default, no region is assigned to the vertex
-	region = std::numeric_limits<size_t>::max();
 }
 
 /*!
-*	@return ID of the vertex
+*	@return External ID of the vertex
 */
 
 size_t vertex::get_id() const
@@ -103,6 +73,21 @@ size_t vertex::get_id() const
 	return(id);
 }
 
+/*!
+*	Reserves memory for the incident edges and adjacent faces of the
+*	vertex. This is useful if their number is known in advance, e.g. when
+*	building a mesh from index buffers.
+*
+*	@param num_edges Expected number of incident edges
+*	@param num_faces Expected number of adjacent faces
+*/
+
+void vertex::reserve(size_t num_edges, size_t num_faces)
+{
+	E.reserve(num_edges);
+	F.reserve(num_faces);
+}
+
 /*!
 *	Adds incident edge to vertex.
 *
@@ -276,7 +261,11 @@ v3ctor vertex::discrete_bilaplacian() const
 
 /*!
 *	Enumerates all neighbours of the current vertex and returns them in a
-*	vector. The order of the enumeration is not fixed.
+*	vector. For manifold vertices, the neighbours are sorted in
+*	counterclockwise order.
+*
+*	@warning This function allocates a new vector for every call. Use a
+*	vertex_edge_circulator instead when iterating over the neighbours.
 *
 *	@returns Vector of neighbouring vertices, i.e. the 1-ring neighbourhood
 *	of the vertex
@@ -285,17 +274,10 @@ v3ctor vertex::discrete_bilaplacian() const
 std::vector<const vertex*> vertex::get_neighbours() const
 {
 	std::vector<const vertex*> res;
+	res.reserve(this->valency());
 
-	// We enumerate the neighbours by enumerating all incident edges and
-	// storing those vertices that are not equal to the current vertex
-	for(size_t i = 0; i < this->valency(); i++)
-	{
-		const edge* e = this->get_edge(i);
-		if(e->get_u() == this)
-			res.push_back(e->get_v());
-		else
-			res.push_back(e->get_u());
-	}
+	for(vertex_edge_circulator it(this); it.valid(); it.next())
+		res.push_back(it.get_vertex());
 
 	return(res);
 }
@@ -306,9 +288,11 @@ std::vector<const vertex*> vertex::get_neighbours() const
 *	The face is one face around the vertex, whereas the vertex of the pair
 *	is an adjacent vertex that is also part of the returned face.
 *
-*	Note that the results vector will definitely contain duplicate faces.
-*	This is irrelevant because they will be used for area calculations
-*	only.
+*	Note that every face is contained twice, once for each of its edges
+*	that are incident to the current vertex.
+*
+*	@warning This function allocates a new vector for every call. Use a
+*	vertex_face_circulator instead when iterating over the 1-ring.
 *
 *	@return Vector of pairs of faces and vertices
 */
@@ -316,27 +300,16 @@ std::vector<const vertex*> vertex::get_neighbours() const
 std::vector< std::pair<const face*, const vertex*> > vertex::get_1_ring() const
 {
 	std::vector< std::pair<const face*, const vertex*> > res;
+	res.reserve(2*this->num_adjacent_faces());
 
-	for(size_t i = 0; i < this->valency(); i++)
+	for(vertex_face_circulator it(this); it.valid(); it.next())
 	{
-		const vertex* adjacent_vertex;
-
-		// Find adjacent vertex
-
-		const edge* e = this->get_edge(i);
-		if(e->get_u() == this)
-			adjacent_vertex = e->get_v();
-		else
-			adjacent_vertex = e->get_u();
-
-		// If _both_ faces around the edge exist, we can add two pairs
-		// to the results vector
-
-		if(e->get_f())
-			res.push_back(std::make_pair(e->get_f(), adjacent_vertex));
-
-		if(e->get_g())
-			res.push_back(std::make_pair(e->get_g(), adjacent_vertex));
+		const edge* edges[2] = {it.get_edge(), it.get_next_edge()};
+		for(size_t i = 0; i < 2; i++)
+		{
+			if(edges[i] != NULL)
+				res.push_back(std::make_pair(it.get_face(), (edges[i]->get_u() == this ? edges[i]->get_v() : edges[i]->get_u())));
+		}
 	}
 
 	return(res);
@@ -371,23 +344,37 @@ std::pair<double, double> vertex::find_opposite_angles(const vertex* v) const
 	else
 		tmp = v;
 
-	// store first and second adjacent face of the edge; if one of these is
-	// NULL, we will not continue
-	const face* faces[2] = {NULL, NULL};
-
 	for(size_t i = 0; i < tmp->valency(); i++)
 	{
 		const edge* e = tmp->get_edge(i);
 		if(	(e->get_u() == u && e->get_v() == v) ||
 			(e->get_u() == v && e->get_v() == u))
-		{
-			faces[0] = e->get_f();
-			faces[1] = e->get_g();
-
-			break;
-		}
+			return(find_opposite_angles(e));
 	}
 
+	return(res);
+}
+
+/*!
+*	Finds the two angles opposite to an edge that is incident to the
+*	current vertex. In contrast to find_opposite_angles(const vertex*),
+*	the edge need not be searched. This function is implemented for
+*	triangular meshes only.
+*
+*	@param e Edge whose start or end vertex is the current vertex
+*
+*	@return	The two opposite angles (in radians); errors are indicated by
+*		negative angles in both components.
+*/
+
+std::pair<double, double> vertex::find_opposite_angles(const edge* e) const
+{
+	std::pair<double, double> res(-1.0, -1.0);
+
+	// Adjacent faces of the edge; if one of these is NULL, we will not
+	// continue
+	const face* faces[2] = {e->get_f(), e->get_g()};
+
 	if(	!faces[0] ||
 		!faces[1])
 	{
@@ -396,6 +383,8 @@ std::pair<double, double> vertex::find_opposite_angles(const vertex* v) const
 		return(res);
 	}
 
+	const vertex* v = (e->get_u() == this ? e->get_v() : e->get_u());
+
 	res = std::make_pair(	find_opposite_angle(v, faces[0]),
 				find_opposite_angle(v, faces[1]));
 
@@ -601,12 +590,8 @@ double vertex::calc_voronoi_area() const
 {
 	double area = 0.0;
 
-	std::vector<const vertex*> neighbours = this->get_neighbours();
-	if(neighbours.size() == 0)
-		return(area);
-
-	for(size_t i = 0; i < neighbours.size(); i++)
-		area += this->calc_voronoi_region(neighbours[i]);
+	for(vertex_edge_circulator it(this); it.valid(); it.next())
+		area += this->calc_voronoi_region(it.get_vertex());
 
 	return(area);
 }
@@ -623,28 +608,34 @@ double vertex::calc_mixed_area() const
 {
 	double area = 0.0;
 
-	std::vector< std::pair<const face*, const vertex*> > ring = this->get_1_ring();
-	if(ring.size() == 0)
-		return(area);
-
-	for(size_t i = 0; i < ring.size(); i++)
+	// Every face contributes twice, i.e. once for each of its edges that
+	// are incident to the current vertex
+	for(vertex_face_circulator it(this); it.valid(); it.next())
 	{
-		const face* f	= ring[i].first;
-		const vertex* v	= ring[i].second;
+		const face* f = it.get_face();
+		const edge* edges[2] = {it.get_edge(), it.get_next_edge()};
 
-		if(const_cast<face*>(f)->is_obtuse())
+		for(size_t i = 0; i < 2; i++)
 		{
-			// FIXME: It should be checked where the obtuse angle
-			// is located. If it is located at the vertex, half of
-			// the triangle area should be used.
+			if(edges[i] == NULL)
+				continue;
 
-			std::cerr << "psalm: FIXME: Non-obtuse faces are not calculated correctly" << std::endl;
-			area += f->calc_area()*0.25;
-		}
+			const vertex* v = (edges[i]->get_u() == this ? edges[i]->get_v() : edges[i]->get_u());
 
-		// non-obtuse triangle; use Voronoi region
-		else
-			area += this->calc_voronoi_region(v, f);
+			if(const_cast<face*>(f)->is_obtuse())
+			{
+				// FIXME: It should be checked where the obtuse angle
+				// is located. If it is located at the vertex, half of
+				// the triangle area should be used.
+
+				std::cerr << "psalm: FIXME: Non-obtuse faces are not calculated correctly" << std::endl;
+				area += f->calc_area()*0.25;
+			}
+
+			// non-obtuse triangle; use Voronoi region
+			else
+				area += this->calc_voronoi_region(v, f);
+		}
 	}
 
 	return(area);
@@ -680,20 +671,19 @@ double vertex::calc_mean_curvature() const
 	if(std::abs(voronoi_area) < 8*std::numeric_limits<double>::epsilon())
 		return(0.0);
 
-	std::vector<const vertex*> neighbours = this->get_neighbours();
-	if(neighbours.size() == 0)
+	if(this->valency() == 0)
 		return(0.0);
 
 	// The length of this (non-unit!) normal will be the mean curvature
 	v3ctor scaled_normal;
 
-	for(size_t i = 0; i < neighbours.size(); i++)
+	for(vertex_edge_circulator it(this); it.valid(); it.next())
 	{
-		std::pair<double, double> angles = this->find_opposite_angles(neighbours[i]);
+		std::pair<double, double> angles = this->find_opposite_angles(it.get_edge());
 		if(angles.first < 0.0 || angles.second < 0.0)
 			return(0.0);
 
-		scaled_normal +=	 (this->get_position() - neighbours[i]->get_position())
+		scaled_normal +=	 (this->get_position() - it.get_vertex()->get_position())
 					*(1.0/tan(angles.first) + 1.0/tan(angles.second));
 	}
 
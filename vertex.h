@@ -28,30 +28,15 @@ class vertex
 	public:
 		vertex();
 		vertex(double x, double y, double z, size_t id);
-		vertex(double x, double y, double z, double nx, double ny, double nz, size_t id);
 
 		void set(double x, double y, double z, size_t id);
-		void set(double x, double y, double z, double nx, double ny, double nz, size_t id);
 
 		void set_position(const v3ctor& v);
 		void set_position(double x, double y, double z);
 
 		const v3ctor& get_position() const;
-		const v3ctor& get_normal() const;
 
-		void set_normal(const v3ctor& n);
-		void set_normal(double nx, double ny, double nz);
-
-		/*!
-		*	@brief Pointer to vertex point.
-		*
-		*	Pointer to vertex point that corresponds to the current
-		*	edge. This pointer is only set and read during
-		*	subdivision algorithms and must \e not be relied on
-		*	within other functions.
-		*/
-
-		vertex* vertex_point;
+		void reserve(size_t num_edges, size_t num_faces);
 
 		void add_edge(edge* e);
 		void remove_edge(const edge* e);
@@ -73,13 +58,12 @@ class vertex
 		v3ctor discrete_laplacian() const;
 		v3ctor discrete_bilaplacian() const;
 
-		void set_scale_attribute(double value);
-		double get_scale_attribute() const;
 
 		std::vector<const vertex*> get_neighbours() const;
 		std::vector< std::pair<const face*, const vertex*> > get_1_ring() const;
 
 		std::pair<double, double> find_opposite_angles(const vertex* v) const;
+		std::pair<double, double> find_opposite_angles(const edge* e) const;
 		double find_opposite_angle(const vertex* v, const face* f) const;
 		double find_interior_angle(const face* f) const;
 
@@ -91,23 +75,43 @@ class vertex
 		double calc_mixed_area() const;
 		double calc_ring_area() const;
 
-		size_t region; // XXX: Identifies region the vertex belongs to
+		size_t get_slot() const;
+		void set_slot(size_t slot);
 
 	private:
 		std::vector<edge*> E;
 		std::vector<const face*> F;
 
 		v3ctor p;		///< Position
-		v3ctor n;		///< Normal vector (need not be set)
 
-		size_t id;		///< ID (used by the mesh to distinguish between certain types of vertices)
+		size_t id;		///< External ID; only used when writing the mesh, never for lookups
+		size_t slot;		///< Position of the vertex in the vertex vector of the mesh; maintained by the mesh
 		bool boundary;		///< Flag signalling that the vertex is a boundary vertex
 
-		double scale_attribute;	///< Scale attribute for Liepa's refinement scheme
-
 		double calc_voronoi_region(const vertex* v, const face* f = NULL) const;
 };
 
+/*!
+*	@return Position of the vertex in the vertex vector of the mesh
+*/
+
+inline size_t vertex::get_slot() const
+{
+	return(slot);
+}
+
+/*!
+*	Sets the position of the vertex in the vertex vector of the mesh. This
+*	function is only supposed to be called by the mesh.
+*
+*	@param slot New position of the vertex
+*/
+
+inline void vertex::set_slot(size_t slot)
+{
+	this->slot = slot;
+}
+
 /*!
 *	Sets a new position for the vertex. All other attributes of the vertex
 *	remain unchanged.
@@ -138,57 +142,6 @@ inline const v3ctor& vertex::get_position() const
 	return(p);
 }
 
-/*!
-*	Sets a new normal for the vertex. All other attributes of the vertex
-*	remain unchanged.
-*
-*	@param n New vertex normal
-*/
-
-inline void vertex::set_normal(const v3ctor& n)
-{
-	this->n[0] = n[0];
-	this->n[1] = n[1];
-	this->n[2] = n[2];
-}
-
-inline void vertex::set_normal(double nx, double ny, double nz)
-{
-	n[0] = nx;
-	n[1] = ny;
-	n[2] = nz;
-}
-
-/*!
-*	@return Const reference to vertex normal.
-*/
-
-inline const v3ctor& vertex::get_normal() const
-{
-	return(n);
-}
-
-/*!
-*	Sets scale attribute for vertex. The attribute needs to be calculated
-*	somewhere else.
-*
-*	@param value Attribute value
-*/
-
-inline void vertex::set_scale_attribute(double value)
-{
-	this->scale_attribute = value;
-}
-
-/*!
-*	@return Current value of scale attribute
-*/
-
-inline double vertex::get_scale_attribute() const
-{
-	return(scale_attribute);
-}
-
 /*!
 *	Removes an edge from the edge references of this vertex. This function
 *	is required for operations that change the structure of the mesh.